@@ -4,6 +4,7 @@
 
 #include "InertialSense.h"
 #include "ISLogger.h"
+#include "ISLogColumns.h"
 #include "luna_data_sets.h"
 
 //#include "Eigen/Core"
@@ -134,6 +135,7 @@ public:
     pybind11::list getSerialNumbers();
     pybind11::list protocolVersion();
     void ins1ToIns2(int device_id=0);
+    pybind11::dict getColumns(int device_id, int did, std::vector<std::string> fields, double start_time, double end_time);
     void exitHack(int exit_code=0);
     
     template <typename T>
@@ -150,6 +152,8 @@ private:
     void forwardData(int device_id);
 
     cISLogger logger_;
+    std::string log_directory_;
+    std::vector<std::string> serials_;
     DeviceLog* dev_log_ = nullptr;
     pybind11::list serialNumbers_; 
 
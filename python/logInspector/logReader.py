@@ -148,6 +148,12 @@ class Log:
     def ins1ToIns2(self, device_id=0):
         self.c_log.ins1ToIns2(device_id)
 
+    def getColumns(self, did, fields=[], device_id=0, start_time=-sys.float_info.max, end_time=sys.float_info.max):
+        """Selected fields of a data set as numpy arrays, keyed by field name, plus '_TIME_' timestamps in seconds.
+        Reads the log once without building the data set structs.  An empty field list returns all fields.
+        start_time and end_time are GPS time of week in seconds."""
+        return self.c_log.getColumns(device_id, did, fields, start_time, end_time)
+
     def exitHack(self, exit_code=0):
         self.c_log.exitHack(exit_code)
         
@@ -31,10 +31,12 @@ ext_modules = [
          '../../src/data_sets.c',
          '../../src/DataChunk.cpp',
          '../../src/DataChunkSorted.cpp',
+         '../../src/DataColumnar.cpp',
          '../../src/DataCSV.cpp',
          '../../src/DataJSON.cpp',
          '../../src/DataKML.cpp',
          '../../src/DeviceLog.cpp',
+         '../../src/DeviceLogColumnar.cpp',
          '../../src/DeviceLogCSV.cpp',
          '../../src/DeviceLogJSON.cpp',
          '../../src/DeviceLogKML.cpp',
@@ -46,9 +48,13 @@ ext_modules = [
          '../../src/ISDisplay.cpp',
          '../../src/ISEarth.c',
          '../../src/ISFileManager.cpp',
+         '../../src/ISLogColumns.cpp',
          '../../src/ISLogFile.cpp',
+         '../../src/ISLogFileAsync.cpp',
+         '../../src/ISLogFileMapped.cpp',
          '../../src/ISLogger.cpp',
          '../../src/ISLogStats.cpp',
+         '../../src/ISLogTimeIndex.cpp',
          '../../src/ISMatrix.c',
          '../../src/ISPose.c',
          '../../src/ISSerialPort.cpp',
@@ -64,7 +70,8 @@ ext_modules = [
          '../../src/tinyxml.cpp',
          '../../src/tinyxmlerror.cpp',
          '../../src/tinyxmlparser.cpp'],
-        define_macros = [('EXCLUDE_BOOTLOADER', 1)],
+        define_macros = [('EXCLUDE_BOOTLOADER', 1), ('USE_ZLIB', 1)],
+        libraries = ['z'],
         include_dirs = [
             # Path to pybind11 headers
             'include',
@@ -101,6 +101,9 @@ bool LogReader::init(py::object python_class, std::string log_directory, py::lis
     cout << endl;
     serialNumbers_ = py::cast(serialNumbers);
 
+    log_directory_ = log_directory;
+    serials_ = stl_serials;
+
     // python_parent_ = python_class;
     g_python_parent = python_class;
     return true;
@@ -352,6 +355,63 @@ void LogReader::ins1ToIns2(int device_id)
     forward_message( DID_INS_2, dev_log_->ins2, device_id );
 }
 
+static py::dtype columnDtype(const data_info_t& info)
+{
+    switch (info.dataType)
+    {
+    case DataTypeInt8:      return py::dtype::of<int8_t>();
+    case DataTypeUInt8:     return py::dtype::of<uint8_t>();
+    case DataTypeInt16:     return py::dtype::of<int16_t>();
+    case DataTypeUInt16:    return py::dtype::of<uint16_t>();
+    case DataTypeInt32:     return py::dtype::of<int32_t>();
+    case DataTypeUInt32:    return py::dtype::of<uint32_t>();
+    case DataTypeInt64:     return py::dtype::of<int64_t>();
+    case DataTypeUInt64:    return py::dtype::of<uint64_t>();
+    case DataTypeFloat:     return py::dtype::of<float>();
+    case DataTypeDouble:    return py::dtype::of<double>();
+    case DataTypeString:    return py::dtype("S" + to_string(info.dataSize));
+    default:                return py::dtype("V" + to_string(info.dataSize));
+    }
+}
+
+// Hand a column buffer to numpy without copying, the array owns the buffer
+template <typename T>
+static py::array columnArray(std::vector<T>& values, py::dtype dtype, size_t count, size_t itemSize)
+{
+    std::vector<T>* owned = new std::vector<T>();
+    owned->swap(values);
+    py::capsule owner(owned, [](void* p) { delete (std::vector<T>*)p; });
+    return py::array(dtype, std::vector<py::ssize_t>{ (py::ssize_t)count }, std::vector<py::ssize_t>{ (py::ssize_t)itemSize }, owned->data(), owner);
+}
+
+py::dict LogReader::getColumns(int device_id, int did, std::vector<std::string> fields, double start_time, double end_time)
+{
+    // Separate logger so the read does not disturb load()
+    py::dict result;
+    cISLogger logger;
+    if (!logger.LoadFromDirectory(log_directory_, cISLogger::LOGTYPE_DAT, serials_) &&
+        !logger.LoadFromDirectory(log_directory_, cISLogger::LOGTYPE_SDAT, serials_))
+    {
+        return result;
+    }
+
+    cISLogColumns columns;
+    if (!columns.Init(did, fields))
+    {
+        throw py::value_error("unknown data set or field");
+    }
+    columns.Read(logger, device_id, start_time, end_time);
+
+    size_t count = columns.RowCount();
+    for (size_t i = 0; i < columns.Columns().size(); i++)
+    {
+        sLogColumn& column = columns.Columns()[i];
+        result[py::str(column.info.name)] = columnArray(column.data, columnDtype(column.info), count, column.info.dataSize);
+    }
+    result["_TIME_"] = columnArray(columns.Timestamps(), py::dtype::of<double>(), count, sizeof(double));
+    return result;
+}
+
 void LogReader::exitHack(int exit_code)
 {
     // Nasty hack
@@ -375,6 +435,8 @@ PYBIND11_MODULE(log_reader, m) {
             .def("getSerialNumbers", &LogReader::getSerialNumbers)
             .def("protocolVersion", &LogReader::protocolVersion)
             .def("ins1ToIns2", &LogReader::ins1ToIns2)
+            .def("getColumns", &LogReader::getColumns, py::arg("device_id"), py::arg("did"), py::arg("fields") = std::vector<std::string>(),
+                py::arg("start_time") = -DBL_MAX, py::arg("end_time") = DBL_MAX)
             .def("exitHack", &LogReader::exitHack);
 
 #include "pybindMacros.h"
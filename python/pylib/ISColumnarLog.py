@@ -0,0 +1,85 @@
+'''
+Reader for columnar (.icol) logs written by cISLogger with log type "icol".
+
+Each .icol file holds one data set.  Column data is stored contiguously per row group, so a
+row group is returned as numpy views of the memory mapped file without copying.
+
+    import pylib.ISColumnarLog as icol
+    cols = icol.load(glob.glob('LOG_SN30000_*_DID_INS_2.icol'))
+    df = pandas.DataFrame(cols)
+'''
+import numpy as np
+
+COLUMNAR_FILE_MARKER = 0x4C4F4349
+COLUMNAR_ROW_GROUP_MARKER = 0x50524752
+COLUMNAR_VERSION = 1
+ORDER_ID_COLUMN = '_ID_'
+
+fileHeaderDtype = np.dtype([('marker', '<u4'), ('version', '<u2'), ('columnCount', '<u2'), ('dataId', '<u4'), ('dataSize', '<u4')])
+columnDtype = np.dtype([('dataOffset', '<u4'), ('dataSize', '<u4'), ('dataType', '<u4'), ('dataFlags', '<u4'), ('name', 'S48')])
+rowGroupHeaderDtype = np.dtype([('marker', '<u4'), ('rowCount', '<u4'), ('byteSize', '<u8')])
+
+# eDataType in DataCSV.h
+_dataTypes = ['<i1', '<u1', '<i2', '<u2', '<i4', '<u4', '<i8', '<u8', '<f4', '<f8', 'S', 'V']
+
+
+def _align(n):
+    return (n + 7) & ~7
+
+
+def _columnDtype(column):
+    t = _dataTypes[column['dataType']]
+    if t in ('S', 'V'):
+        return np.dtype(t + str(column['dataSize']))
+    return np.dtype(t)
+
+
+class ColumnarFile:
+    def __init__(self, filename):
+        self.data = np.memmap(filename, dtype=np.uint8, mode='r')
+        header = self.data[:fileHeaderDtype.itemsize].view(fileHeaderDtype)[0]
+        if header['marker'] != COLUMNAR_FILE_MARKER or header['version'] != COLUMNAR_VERSION:
+            raise ValueError('%s is not a columnar log file' % filename)
+        self.dataId = int(header['dataId'])
+        self.dataSize = int(header['dataSize'])
+        pos = fileHeaderDtype.itemsize
+        end = pos + int(header['columnCount']) * columnDtype.itemsize
+        columns = self.data[pos:end].view(columnDtype)
+        self.names = [c['name'].decode('ascii') for c in columns]
+        self.dtypes = [_columnDtype(c) for c in columns]
+        self._dataStart = _align(end)
+
+    def rowGroups(self):
+        ''' Yield a dict of column name to numpy array for each row group.  Arrays are views of the file. '''
+        pos = self._dataStart
+        while pos + rowGroupHeaderDtype.itemsize <= len(self.data):
+            header = self.data[pos:pos + rowGroupHeaderDtype.itemsize].view(rowGroupHeaderDtype)[0]
+            pos += rowGroupHeaderDtype.itemsize
+            rowCount = int(header['rowCount'])
+            end = pos + int(header['byteSize'])
+            if header['marker'] != COLUMNAR_ROW_GROUP_MARKER or end > len(self.data):
+                break
+            group = {}
+            for name, dtype in zip(self.names, self.dtypes):
+                size = rowCount * dtype.itemsize
+                group[name] = self.data[pos:pos + size].view(dtype)
+                pos += _align(size)
+            pos = end
+            yield group
+
+
+def load(filenames):
+    '''
+    Load one or more .icol files of the same data set, in order, into a dict of column name to numpy array.
+    A single row group is returned without copying, otherwise row groups are concatenated.
+    '''
+    if isinstance(filenames, str):
+        filenames = [filenames]
+    groups = []
+    for filename in sorted(filenames):
+        groups.extend(ColumnarFile(filename).rowGroups())
+    if not groups:
+        return {}
+    if len(groups) == 1:
+        return groups[0]
+    return {name: np.concatenate([g[name] for g in groups]) for name in groups[0]}
@@ -80,7 +80,6 @@ int cDataCSV::ReadHeaderFromFile(FILE* pFile, uint32_t id, vector<data_info_t>&
 	{
 		return 0;
 	}
-	const map_name_to_info_t* offsetMap = cISDataMappings::GetMapInfo(id);
 	stringstream stream(line);
 	string columnHeader;
 	columnHeaders.clear();
@@ -101,14 +100,14 @@ int cDataCSV::ReadHeaderFromFile(FILE* pFile, uint32_t id, vector<data_info_t>&
 		}
 		else
 		{
-			map_name_to_info_t::const_iterator offset = offsetMap->find(columnHeader);
-			if (offset == offsetMap->end())
+			const data_info_t* info = cISDataMappings::GetFieldInfo(id, columnHeader);
+			if (info == NULLPTR)
 			{
 				columnHeaders.push_back({ 0xFFFFFFFF, 0xFFFFFFFF, DataTypeBinary, (eDataFlags)0, columnHeader });
 			}
 			else
 			{
-				columnHeaders.push_back(offset->second);
+				columnHeaders.push_back(*info);
 			}
 		}
 	}
@@ -127,60 +126,69 @@ int cDataCSV::WriteDataToFile(uint64_t orderId, FILE* pFile, const p_data_hdr_t&
 	{
 		return 0;
 	}
-	string s;
-    if (!DataToStringCSV(dataHdr, dataBuf, s))
+	char id[32];
+	int idLength = SNPRINTF(id, sizeof(id), "%llu,", (long long unsigned int)orderId);
+	int length = DataToBufferCSV(dataHdr, dataBuf, idLength);
+	if (length < 0)
 	{
 		return 0;
 	}
-	char tmp[64];
-	SNPRINTF(tmp, 64, "%llu", (long long unsigned int)orderId);
-	fputs(tmp, pFile);
-	fputc(',', pFile);
-	fputs(s.c_str(), pFile);
+	memcpy(m_buffer.data(), id, idLength);
+	fwrite(m_buffer.data(), 1, length, pFile);
 
 	// return the data string length plus comma plus order id string
-    return (int)s.length() + 1 + (int)strnlen(tmp, sizeof(tmp));
+	return length;
 }
 
 bool cDataCSV::StringCSVToData(string& s, p_data_hdr_t& hdr, uint8_t* buf, uint32_t bufSize, const vector<data_info_t>& columnHeaders)
 {
-	const map_name_to_info_t* offsetMap = cISDataMappings::GetMapInfo(hdr.id);
-	if (offsetMap == NULLPTR || hdr.offset != 0 || hdr.size == 0 || bufSize < hdr.size)
+	return LineCSVToData(s.c_str(), s.length(), hdr, buf, bufSize, columnHeaders);
+}
+
+
+bool cDataCSV::LineCSVToData(const char* line, size_t length, p_data_hdr_t& hdr, uint8_t* buf, uint32_t bufSize, const vector<data_info_t>& columnHeaders)
+{
+	if (cISDataMappings::GetMapInfo(hdr.id) == NULLPTR || hdr.offset != 0 || hdr.size == 0 || bufSize < hdr.size)
 	{
 		return false;
 	}
-	while (s.length() > 0 && (s[s.size() - 1] == '\r' || s[s.size() - 1] == '\n'))
+	while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == '\n'))
 	{
-		s.resize(s.size() - 1);
+		length--;
 	}
-	// for parsing logic, last comma will allow last field to parse properly
-	s += ",";
-	string columnData;
-	string::const_iterator start = s.begin();
-	uint32_t index = 0;
 	hdr.offset = 0;
 	hdr.size = cISDataMappings::GetSize(hdr.id);
-	bool inQuotes = false;
-	uint32_t foundQuotes = 0;
 	memset(buf, 0, hdr.size);
-	for (string::const_iterator i = start; i < s.end() && index < columnHeaders.size(); i++)
+
+	const char* end = line + length;
+	const char* start = line;
+	uint32_t index = 0;
+	bool inQuotes = false;
+	int foundQuotes = 0;
+	for (const char* i = line; index < columnHeaders.size(); i++)
 	{
-		if (*i == ',' && !inQuotes)
+		if (i == end || (*i == ',' && !inQuotes))
 		{
-			// end field
-			columnData = string(start + foundQuotes, i - foundQuotes);
-			start = i + 1;
+			// end field, quotes around the field are removed
 			const data_info_t& data = columnHeaders[index++];
-            if (data.dataOffset < MAX_DATASET_SIZE && !cISDataMappings::StringToData(columnData.c_str(), (int)columnData.length(), &hdr, buf, data))
+			const char* fieldStart = start + foundQuotes;
+			const char* fieldEnd = i - foundQuotes;
+			if (data.dataOffset < MAX_DATASET_SIZE && (data.dataOffset + data.dataSize > hdr.size || fieldEnd < fieldStart ||
+				!cISDataMappings::FieldToVariable(fieldStart, (int)(fieldEnd - fieldStart), buf + data.dataOffset, data.dataType, data.dataSize)))
 			{
 				return false;
 			}
-			foundQuotes = false;
+			if (i == end)
+			{
+				break;
+			}
+			start = i + 1;
+			foundQuotes = 0;
 		}
 		else if (*i == '"')
 		{
 			inQuotes = !inQuotes;
-			foundQuotes |= (uint32_t)inQuotes;
+			foundQuotes |= (int)inQuotes;
 		}
 	}
 	return true;
@@ -189,42 +197,35 @@ bool cDataCSV::StringCSVToData(string& s, p_data_hdr_t& hdr, uint8_t* buf, uint3
 
 bool cDataCSV::DataToStringCSV(const p_data_hdr_t& hdr, const uint8_t* buf, string& csv)
 {
-	csv.clear();
-	string columnData;
-	const map_name_to_info_t* offsetMap = cISDataMappings::GetMapInfo(hdr.id);
-	if (offsetMap == NULLPTR)
+	int length = DataToBufferCSV(hdr, buf, 0);
+	if (length < 0)
 	{
+		csv.clear();
 		return false;
 	}
-	char tmp[IS_DATA_MAPPING_MAX_STRING_LENGTH];
-	const uint8_t* bufPtr = buf;
-	uint8_t tmpBuffer[MAX_DATASET_SIZE];
-	uint32_t size = cISDataMappings::GetSize(hdr.id);
-	if (size > hdr.size)
-	{
-		// copy into temp buffer, zeroing out bytes that are not part of this packet
-		memset(tmpBuffer, 0, hdr.offset);
-		memcpy(tmpBuffer + hdr.offset, buf, hdr.size);
-		uint32_t dataEnd = hdr.offset + hdr.size;
-		memset(tmpBuffer + dataEnd, 0, size - dataEnd);
-		bufPtr = tmpBuffer;
-	}
+	csv.assign(m_buffer.data(), length);
+	return true;
+}
 
-	// copy header as we are now storing an entire struct, even if we got a partial hdr and buf
-	p_data_hdr_t hdrCopy = hdr;
-	hdrCopy.offset = 0;
-	hdrCopy.size = size;
 
-	for (map_name_to_info_t::const_iterator offset = offsetMap->begin(); offset != offsetMap->end(); offset++)
+int cDataCSV::DataToBufferCSV(const p_data_hdr_t& hdr, const uint8_t* buf, size_t prefix)
+{
+	const data_serialize_plan_t* plan = cISDataMappings::GetSerializePlan(hdr.id);
+	if (plan == NULLPTR)
 	{
-		cISDataMappings::DataToString(offset->second, &hdrCopy, bufPtr, tmp);
-		if (csv.length() != 0)
-		{
-			csv += ",";
-		}
-		csv += tmp;
+		return -1;
 	}
-	csv += "\n";
-	return true;
+	size_t bufferSize = prefix + plan->maxStringLength + 2;
+	if (m_buffer.size() < bufferSize)
+	{
+		m_buffer.resize(bufferSize);
+	}
+	int length = cISDataMappings::DataSetToString(hdr, buf, m_buffer.data() + prefix, false);
+	if (length < 0)
+	{
+		return -1;
+	}
+	length += (int)prefix;
+	m_buffer[length++] = '\n';
+	return length;
 }
-
@@ -74,6 +74,13 @@ public:
 	*/
 	bool StringCSVToData(std::string& s, p_data_hdr_t& hdr, uint8_t* buf, uint32_t bufSize, const std::vector<data_info_t>& columnHeaders);
 
+	/**
+	* Parse a csv line in place into a data packet, same as StringCSVToData without copying the line or its fields
+	* line the csv line, does not need to be null terminated
+	* length number of chars in line
+	*/
+	bool LineCSVToData(const char* line, size_t length, p_data_hdr_t& hdr, uint8_t* buf, uint32_t bufSize, const std::vector<data_info_t>& columnHeaders);
+
 	/**
 	* Convert data to a csv string
 	* buf is assumed to be large enough to hold the data structure
@@ -81,6 +88,16 @@ public:
 	* return true if success, false if no map found
 	*/
     bool DataToStringCSV(const p_data_hdr_t& hdr, const uint8_t* buf, std::string& csv);
+
+private:
+	/**
+	* Serialize a data set into m_buffer with cISDataMappings::DataSetToString
+	* prefix chars reserved at the start of m_buffer for the caller
+	* returns the length of the line including prefix and newline, -1 if no map found
+	*/
+	int DataToBufferCSV(const p_data_hdr_t& hdr, const uint8_t* buf, size_t prefix);
+
+	std::vector<char> m_buffer;		// reused for every record
 };
 
 #endif // DATA_CVS_H
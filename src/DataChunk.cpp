@@ -18,11 +18,15 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "ISLogFileBase.h"
 #include "ISLogFileFactory.h"
 
+#ifdef USE_ZLIB
+#	include <zlib.h>
+#endif
+
 cDataChunk::cDataChunk()
 {
 	Clear();
 	m_hdr.marker = DATA_CHUNK_MARKER;
-	m_hdr.version = 1;
+	m_hdr.version = DATA_CHUNK_VERSION;
 	m_hdr.classification = ' ' << 8 | 'U';
 	m_hdr.grpNum = 0;				//!< Chunk group number
 	m_hdr.devSerialNum = 0;			//!< Serial number
@@ -30,6 +34,9 @@ cDataChunk::cDataChunk()
     m_buffTail = m_buffHead + DEFAULT_CHUNK_DATA_SIZE;
 	m_dataHead = m_buffHead;
 	m_dataTail = m_buffHead;
+	m_compressionLevel = CHUNK_COMPRESSION_NONE;
+	m_compressionFilter = false;
+	m_compressSize = 0;
 
 	SetName("PDAT");
 }
@@ -132,26 +139,37 @@ int32_t cDataChunk::WriteToFile(cISLogFileBase* pFile, int groupNumber)
 
 	m_hdr.grpNum = groupNumber;
 
+	// Compress on the calling (logger) thread, the file only sees the smaller chunk
+	sChunkHeader hdr = m_hdr;
+	const uint8_t* data = m_dataHead;
+	if (m_compressionLevel > CHUNK_COMPRESSION_NONE && Compress())
+	{
+		hdr.version = DATA_CHUNK_VERSION_COMPRESSED;
+		hdr.dataSize = m_compressSize;
+		hdr.invDataSize = ~hdr.dataSize;
+		data = m_compressBuffer.data();
+	}
+
 	// Write chunk header to file
-	int32_t nBytes = static_cast<int32_t>(pFile->write(&m_hdr, sizeof(sChunkHeader)));
+	int32_t nBytes = static_cast<int32_t>(pFile->write(&hdr, sizeof(sChunkHeader)));
 
 	// Write any additional chunk header
 	nBytes += WriteAdditionalChunkHeader(pFile);
 
 	// Write chunk data to file
-	nBytes += static_cast<int32_t>(pFile->write(m_dataHead, m_hdr.dataSize));
+	nBytes += static_cast<int32_t>(pFile->write(data, hdr.dataSize));
 
 #if LOG_DEBUG_CHUNK_WRITE
 	static int totalBytes = 0;
 	totalBytes += nBytes;
-	printf("cDataChunk::WriteToFile %d : %d  -  %x %d", totalBytes, nBytes, m_hdr.marker, m_hdr.dataSize);
-	if (nBytes != (sizeof(sChunkHeader) + (int)m_hdr.dataSize))
+	printf("cDataChunk::WriteToFile %d : %d  -  %x %d", totalBytes, nBytes, hdr.marker, hdr.dataSize);
+	if (nBytes != (sizeof(sChunkHeader) + (int)hdr.dataSize))
 		printf("ERROR WRITING!");
 	printf("\n");
 #endif
 
 	// Error writing to file
-	if (nBytes != GetHeaderSize() + (int)m_hdr.dataSize)
+	if (nBytes != GetHeaderSize() + (int)hdr.dataSize)
 	{
 		return -1;
 	}
@@ -192,9 +210,29 @@ int32_t cDataChunk::ReadFromFile(cISLogFileBase* pFile)
 //         return -1;
 //     }
 
-	// Read chunk data
-	m_dataTail += static_cast<int32_t>(pFile->read(m_buffHead, m_hdr.dataSize));
-	nBytes += GetDataSize();
+	// Read chunk data, which never exceeds the chunk buffer (compressed chunks are only written if they shrink)
+	uint32_t fileDataSize = m_hdr.dataSize;
+	if (fileDataSize > DEFAULT_CHUNK_DATA_SIZE)
+	{
+		Clear();
+		return -1;
+	}
+	if (m_hdr.version == DATA_CHUNK_VERSION_COMPRESSED)
+	{
+		m_compressBuffer.resize(fileDataSize);
+		int32_t n = static_cast<int32_t>(pFile->read(m_compressBuffer.data(), fileDataSize));
+		if (n != (int32_t)fileDataSize || !Decompress(m_compressBuffer.data(), fileDataSize))
+		{
+			Clear();
+			return -1;
+		}
+		nBytes += n;
+	}
+	else
+	{
+		m_dataTail += static_cast<int32_t>(pFile->read(m_buffHead, m_hdr.dataSize));
+		nBytes += GetDataSize();
+	}
 
 #if LOG_DEBUG_CHUNK_READ
 	static int totalBytes = 0;
@@ -207,7 +245,7 @@ int32_t cDataChunk::ReadFromFile(cISLogFileBase* pFile)
 	printf("\n");
 #endif
 
-	if (m_hdr.marker == DATA_CHUNK_MARKER && nBytes == static_cast<int>(GetHeaderSize() + m_hdr.dataSize))
+	if (m_hdr.marker == DATA_CHUNK_MARKER && nBytes == static_cast<int>(GetHeaderSize() + fileDataSize))
 	{
 
 #if LOG_CHUNK_STATS
@@ -256,6 +294,167 @@ int32_t cDataChunk::ReadFromFile(cISLogFileBase* pFile)
 }
 
 
+bool cDataChunk::CompressionSupported()
+{
+#ifdef USE_ZLIB
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+// Compress chunk data into m_compressBuffer.  Returns false if compression is unavailable or does not reduce the size.
+bool cDataChunk::Compress()
+{
+#ifdef USE_ZLIB
+	uint32_t size = m_hdr.dataSize;
+	const uint8_t* src = m_dataHead;
+	if (m_compressionFilter)
+	{
+		m_filterBuffer.resize(size);
+		FilterData(m_dataHead, m_filterBuffer.data(), size, true);
+		src = m_filterBuffer.data();
+	}
+
+	uLongf compressedSize = compressBound(size);
+	m_compressBuffer.resize(sizeof(sChunkCompressionHeader) + compressedSize);
+	if (compress2(m_compressBuffer.data() + sizeof(sChunkCompressionHeader), &compressedSize, src, size, _MIN(m_compressionLevel, Z_BEST_COMPRESSION)) != Z_OK ||
+		sizeof(sChunkCompressionHeader) + compressedSize >= size)
+	{
+		return false;
+	}
+
+	sChunkCompressionHeader cHdr = {};
+	cHdr.codec = CHUNK_CODEC_ZLIB;
+	cHdr.filter = (m_compressionFilter ? CHUNK_FILTER_DELTA : CHUNK_FILTER_NONE);
+	cHdr.dataSize = size;
+	memcpy(m_compressBuffer.data(), &cHdr, sizeof(cHdr));
+	m_compressSize = (uint32_t)(sizeof(sChunkCompressionHeader) + compressedSize);
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+bool cDataChunk::Decompress(const uint8_t* data, uint32_t size)
+{
+	sChunkCompressionHeader cHdr;
+	if (data == NULLPTR || size < sizeof(cHdr))
+	{
+		return false;
+	}
+	memcpy(&cHdr, data, sizeof(cHdr));
+	if (cHdr.codec != CHUNK_CODEC_ZLIB || cHdr.dataSize > DEFAULT_CHUNK_DATA_SIZE)
+	{
+		return false;
+	}
+
+#ifdef USE_ZLIB
+	uLongf dataSize = cHdr.dataSize;
+	if (uncompress(m_buffHead, &dataSize, data + sizeof(cHdr), size - sizeof(cHdr)) != Z_OK || dataSize != cHdr.dataSize)
+	{
+		return false;
+	}
+#else
+	static bool reported = false;
+	if (!reported)
+	{	// Otherwise compressed logs look like they end at the first compressed chunk
+		reported = true;
+		fprintf(stderr, "cDataChunk::Decompress FAILED, compressed log chunks need a build with USE_ZLIB\n");
+	}
+	return false;
+#endif
+
+	if (cHdr.filter == CHUNK_FILTER_DELTA)
+	{
+		FilterData(m_buffHead, m_buffHead, cHdr.dataSize, false);
+	}
+
+	// Chunk now holds uncompressed data
+	m_dataHead = m_buffHead;
+	m_dataTail = m_buffHead + cHdr.dataSize;
+	m_hdr.version = DATA_CHUNK_VERSION;
+	m_hdr.dataSize = cHdr.dataSize;
+	m_hdr.invDataSize = ~m_hdr.dataSize;
+	return true;
+}
+
+
+void cDataChunk::FilterData(const uint8_t* src, uint8_t* dst, int32_t size, bool encode)
+{
+	// Data is a series of p_data_hdr_t and data set.  Headers are left as is.
+	const uint8_t* ref = (encode ? src : dst);
+	int32_t prev[DID_COUNT];
+	for (uint32_t i = 0; i < DID_COUNT; i++)
+	{
+		prev[i] = -1;
+	}
+
+	int32_t pos = 0;
+	while (pos + (int32_t)sizeof(p_data_hdr_t) <= size)
+	{
+		p_data_hdr_t hdr;
+		memcpy(&hdr, src + pos, sizeof(hdr));
+		if (dst != src)
+		{
+			memcpy(dst + pos, src + pos, sizeof(hdr));
+		}
+		pos += sizeof(hdr);
+		if ((int32_t)hdr.size > size - pos)
+		{
+			break;
+		}
+
+		bool match = false;
+		if (hdr.id < DID_COUNT && prev[hdr.id] >= 0)
+		{
+			p_data_hdr_t prevHdr;
+			memcpy(&prevHdr, src + prev[hdr.id] - sizeof(p_data_hdr_t), sizeof(prevHdr));
+			match = (prevHdr.size == hdr.size && prevHdr.offset == hdr.offset);
+		}
+		if (match)
+		{
+			DeltaData(src + pos, ref + prev[hdr.id], dst + pos, hdr.size, encode);
+		}
+		else if (dst != src)
+		{
+			memcpy(dst + pos, src + pos, hdr.size);
+		}
+
+		if (hdr.id < DID_COUNT)
+		{
+			prev[hdr.id] = pos;
+		}
+		pos += hdr.size;
+	}
+
+	if (dst != src && pos < size)
+	{
+		memcpy(dst + pos, src + pos, size - pos);
+	}
+}
+
+
+void cDataChunk::DeltaData(const uint8_t* src, const uint8_t* prev, uint8_t* dst, uint32_t size, bool encode)
+{
+	uint32_t i = 0;
+	for (; i + 4 <= size; i += 4)
+	{
+		uint32_t value, prevValue;
+		memcpy(&value, src + i, 4);
+		memcpy(&prevValue, prev + i, 4);
+		value = (encode ? value - prevValue : value + prevValue);
+		memcpy(dst + i, &value, 4);
+	}
+	if (dst != src)
+	{
+		memcpy(dst + i, src + i, size - i);
+	}
+}
+
+
 int32_t cDataChunk::WriteAdditionalChunkHeader(cISLogFileBase* /*pFile*/)
 {
 	return 0;
@@ -21,8 +21,20 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #endif
 
 #define DATA_CHUNK_MARKER           0xFC05EA32
+#define DATA_CHUNK_VERSION          1
+#define DATA_CHUNK_VERSION_COMPRESSED   2       // Chunk data is a sChunkCompressionHeader followed by the compressed data
+
+// Chunk compression levels (zlib levels 1-9)
+#define CHUNK_COMPRESSION_NONE      0
+#define CHUNK_COMPRESSION_FAST      1
+#define CHUNK_COMPRESSION_DENSE     9
+
+#define CHUNK_CODEC_ZLIB            1
+#define CHUNK_FILTER_NONE           0
+#define CHUNK_FILTER_DELTA          1           // Data sets stored as 32 bit word differences from the previous data set of the same DID
 
 #include <stdint.h>
+#include <vector>
 
 #include "com_manager.h"
 #include "ISLogFileBase.h"
@@ -65,6 +77,14 @@ struct sChunkHeader
 #endif
 };
 
+struct sChunkCompressionHeader
+{
+	uint8_t		codec;				//!< CHUNK_CODEC_ZLIB
+	uint8_t		filter;				//!< CHUNK_FILTER_NONE or CHUNK_FILTER_DELTA
+	uint16_t	reserved;			//!< Unused
+	uint32_t	dataSize;			//!< Uncompressed chunk data length in bytes
+};
+
 POP_PACK
 
 class cDataChunk
@@ -83,6 +103,24 @@ public:
 	int32_t ReadFromFile(cISLogFileBase* pFile);
 	int32_t PushBack(uint8_t* d1, int32_t d1Size, uint8_t* d2 = NULL, int32_t d2Size = 0);
 
+	/**
+	* Compress chunk data written by WriteToFile.  Chunks that do not shrink are written uncompressed.
+	* @param level zlib level, CHUNK_COMPRESSION_NONE (0) to CHUNK_COMPRESSION_DENSE (9).  Ignored without USE_ZLIB.
+	* @param deltaFilter store each data set as the difference from the previous one of the same DID before compressing
+	*/
+	void SetCompression(int level, bool deltaFilter = true) { m_compressionLevel = level; m_compressionFilter = deltaFilter; }
+
+	/**
+	* Load the data of a compressed chunk.  m_hdr must hold the chunk header and any additional header already.
+	* @param data chunk data following the headers
+	* @param size chunk data size from the header
+	* @return true if the data was decompressed into the chunk
+	*/
+	bool Decompress(const uint8_t* data, uint32_t size);
+
+	/** True if chunk compression is available (built with USE_ZLIB) */
+	static bool CompressionSupported();
+
 	virtual void Clear();
 
 	sChunkHeader m_hdr;
@@ -101,7 +139,28 @@ protected:
 	virtual int32_t ReadAdditionalChunkHeader(cISLogFileBase* pFile);
 	virtual int32_t GetHeaderSize();
 
+	/**
+	* Apply or remove the delta filter.  Data sets are replaced by the 32 bit word differences from the previous data set 
+	* of the same DID, so slowly changing values and counters become small repeating numbers.  src and dst may be the 
+	* same buffer when decoding.
+	*/
+	virtual void FilterData(const uint8_t* src, uint8_t* dst, int32_t size, bool encode);
+
+	/**
+	* Delta encode or decode one data set
+	* @param prev previous data set, already decoded when decoding
+	*/
+	static void DeltaData(const uint8_t* src, const uint8_t* prev, uint8_t* dst, uint32_t size, bool encode);
+
 private:
+	bool Compress();
+
+	int m_compressionLevel;
+	bool m_compressionFilter;
+	std::vector<uint8_t> m_filterBuffer;		// Delta filtered data
+	std::vector<uint8_t> m_compressBuffer;		// Compression header and compressed data
+	uint32_t m_compressSize;
+
     uint8_t m_buffHead[DEFAULT_CHUNK_DATA_SIZE];    // Start of buffer
     uint8_t* m_buffTail;    // End of buffer
     uint8_t* m_dataHead;    // Front of data in buffer.  This moves as data is read.
@@ -165,6 +165,23 @@ int32_t cSortedDataChunk::GetHeaderSize()
 }
 
 
+void cSortedDataChunk::FilterData(const uint8_t* src, uint8_t* dst, int32_t size, bool encode)
+{
+	// Data is a series of serial number and data set of the same DID and size.  Serial numbers are left as is.
+	if (dst != src)
+	{
+		memcpy(dst, src, size);
+	}
+
+	const uint8_t* ref = (encode ? src : dst);
+	int32_t stride = (int32_t)(sizeof(uint32_t) + m_subHdr.dHdr.size);
+	for (int32_t pos = stride + (int32_t)sizeof(uint32_t); pos + (int32_t)m_subHdr.dHdr.size <= size; pos += stride)
+	{
+		DeltaData(src + pos, ref + pos - stride, dst + pos, m_subHdr.dHdr.size, encode);
+	}
+}
+
+
 uint32_t cSortedDataChunk::GetDataSerNum()
 {
 	p_cnk_data_t* cnkData = (p_cnk_data_t*)GetDataPtr();
@@ -55,6 +55,7 @@ public:
 	int32_t WriteAdditionalChunkHeader(cISLogFileBase* pFile) OVERRIDE;
 	int32_t ReadAdditionalChunkHeader(cISLogFileBase* pFile) OVERRIDE;
 	int32_t GetHeaderSize() OVERRIDE;
+	void FilterData(const uint8_t* src, uint8_t* dst, int32_t size, bool encode) OVERRIDE;
 	uint32_t GetDataSerNum();
 
 	sChunkSubHeader m_subHdr;
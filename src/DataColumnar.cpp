@@ -0,0 +1,208 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <string.h>
+#include <algorithm>
+
+#include "DataColumnar.h"
+#include "ISDataMappings.h"
+
+using namespace std;
+
+
+static bool columnOffsetLess(const sColumnarColumn& a, const sColumnarColumn& b)
+{
+	return a.dataOffset < b.dataOffset;
+}
+
+
+bool cDataColumnar::GetColumns(uint32_t id, vector<sColumnarColumn>& columns)
+{
+	columns.clear();
+	const map_name_to_info_t* offsetMap = cISDataMappings::GetMapInfo(id);
+	if (offsetMap == NULLPTR || cISDataMappings::GetSize(id) == 0)
+	{
+		return false;
+	}
+
+	sColumnarColumn col;
+	memset(&col, 0, sizeof(col));
+	col.dataOffset = COLUMNAR_ORDER_ID_OFFSET;
+	col.dataSize = sizeof(uint64_t);
+	col.dataType = DataTypeUInt64;
+	strncpy(col.name, "_ID_", COLUMNAR_NAME_LENGTH - 1);
+	columns.push_back(col);
+
+	for (map_name_to_info_t::const_iterator it = offsetMap->begin(); it != offsetMap->end(); it++)
+	{
+		const data_info_t& info = it->second;
+		memset(&col, 0, sizeof(col));
+		col.dataOffset = info.dataOffset;
+		col.dataSize = info.dataSize;
+		col.dataType = info.dataType;
+		col.dataFlags = info.dataFlags;
+		strncpy(col.name, it->first.c_str(), COLUMNAR_NAME_LENGTH - 1);
+		columns.push_back(col);
+	}
+
+	// Mapping is sorted by name, store fields in data set order
+	stable_sort(columns.begin() + 1, columns.end(), columnOffsetLess);
+	return true;
+}
+
+
+int cDataColumnar::WriteHeaderToFile(FILE* pFile, uint32_t id, uint32_t dataSize, const vector<sColumnarColumn>& columns)
+{
+	if (pFile == NULL || columns.empty())
+	{
+		return 0;
+	}
+
+	sColumnarFileHeader hdr;
+	hdr.marker = COLUMNAR_FILE_MARKER;
+	hdr.version = COLUMNAR_VERSION;
+	hdr.columnCount = (uint16_t)columns.size();
+	hdr.dataId = id;
+	hdr.dataSize = dataSize;
+
+	size_t nBytes = fwrite(&hdr, 1, sizeof(hdr), pFile);
+	nBytes += fwrite(columns.data(), 1, columns.size() * sizeof(sColumnarColumn), pFile);
+	return (int)nBytes;
+}
+
+
+int cDataColumnar::ReadHeaderFromFile(FILE* pFile, uint32_t& id, uint32_t& dataSize, vector<sColumnarColumn>& columns)
+{
+	columns.clear();
+	sColumnarFileHeader hdr;
+	if (pFile == NULL || fread(&hdr, 1, sizeof(hdr), pFile) != sizeof(hdr) ||
+		hdr.marker != COLUMNAR_FILE_MARKER || hdr.version != COLUMNAR_VERSION || hdr.columnCount == 0)
+	{
+		return 0;
+	}
+
+	columns.resize(hdr.columnCount);
+	size_t columnBytes = columns.size() * sizeof(sColumnarColumn);
+	if (fread(columns.data(), 1, columnBytes, pFile) != columnBytes || columns[0].dataOffset != COLUMNAR_ORDER_ID_OFFSET)
+	{
+		columns.clear();
+		return 0;
+	}
+	for (size_t i = 0; i < columns.size(); i++)
+	{
+		columns[i].name[COLUMNAR_NAME_LENGTH - 1] = '\0';
+	}
+
+	id = hdr.dataId;
+	dataSize = hdr.dataSize;
+	return (int)(sizeof(hdr) + columnBytes);
+}
+
+
+int cDataColumnar::WriteRowGroupToFile(FILE* pFile, const vector<sColumnarColumn>& columns, uint32_t dataSize, const vector<uint64_t>& orderIds, const vector<uint8_t>& rows)
+{
+	uint32_t rowCount = (uint32_t)orderIds.size();
+	if (pFile == NULL || rowCount == 0 || rows.size() < (size_t)rowCount * dataSize)
+	{
+		return 0;
+	}
+
+	sColumnarRowGroupHeader hdr;
+	hdr.marker = COLUMNAR_ROW_GROUP_MARKER;
+	hdr.rowCount = rowCount;
+	hdr.byteSize = 0;
+	for (size_t c = 0; c < columns.size(); c++)
+	{
+		hdr.byteSize += COLUMNAR_ALIGN((size_t)columns[c].dataSize * rowCount);
+	}
+
+	// Transpose rows into columns
+	vector<uint8_t> data((size_t)hdr.byteSize, 0);
+	uint8_t* dst = data.data();
+	for (size_t c = 0; c < columns.size(); c++)
+	{
+		const sColumnarColumn& col = columns[c];
+		if (col.dataOffset == COLUMNAR_ORDER_ID_OFFSET)
+		{
+			memcpy(dst, orderIds.data(), rowCount * sizeof(uint64_t));
+		}
+		else if (col.dataOffset + col.dataSize <= dataSize)
+		{
+			const uint8_t* src = rows.data() + col.dataOffset;
+			uint8_t* out = dst;
+			for (uint32_t r = 0; r < rowCount; r++, src += dataSize, out += col.dataSize)
+			{
+				memcpy(out, src, col.dataSize);
+			}
+		}
+		dst += COLUMNAR_ALIGN((size_t)col.dataSize * rowCount);
+	}
+
+	size_t nBytes = fwrite(&hdr, 1, sizeof(hdr), pFile);
+	nBytes += fwrite(data.data(), 1, data.size(), pFile);
+	if (nBytes != sizeof(hdr) + data.size())
+	{
+		return 0;
+	}
+	return (int)nBytes;
+}
+
+
+uint32_t cDataColumnar::ReadRowGroupFromFile(FILE* pFile, const vector<sColumnarColumn>& columns, vector<uint8_t>& buffer, vector<size_t>& columnStart)
+{
+	sColumnarRowGroupHeader hdr;
+	if (pFile == NULL || fread(&hdr, 1, sizeof(hdr), pFile) != sizeof(hdr) || hdr.marker != COLUMNAR_ROW_GROUP_MARKER)
+	{
+		return 0;
+	}
+
+	// Validate the column sizes against the row group size before reading it
+	size_t byteSize = 0;
+	columnStart.resize(columns.size());
+	for (size_t c = 0; c < columns.size(); c++)
+	{
+		columnStart[c] = byteSize;
+		byteSize += COLUMNAR_ALIGN((size_t)columns[c].dataSize * hdr.rowCount);
+	}
+	if (byteSize != hdr.byteSize)
+	{
+		return 0;
+	}
+
+	buffer.resize(byteSize);
+	if (fread(buffer.data(), 1, byteSize, pFile) != byteSize)
+	{
+		return 0;
+	}
+	return hdr.rowCount;
+}
+
+
+uint64_t cDataColumnar::ColumnsToData(const vector<sColumnarColumn>& columns, const vector<uint8_t>& buffer, const vector<size_t>& columnStart, uint32_t row, uint8_t* buf, uint32_t bufSize)
+{
+	uint64_t orderId = 0;
+	for (size_t c = 0; c < columns.size(); c++)
+	{
+		const sColumnarColumn& col = columns[c];
+		const uint8_t* src = buffer.data() + columnStart[c] + (size_t)row * col.dataSize;
+		if (col.dataOffset == COLUMNAR_ORDER_ID_OFFSET)
+		{
+			memcpy(&orderId, src, sizeof(orderId));
+		}
+		else if (col.dataOffset + col.dataSize <= bufSize)
+		{
+			memcpy(buf + col.dataOffset, src, col.dataSize);
+		}
+	}
+	return orderId;
+}
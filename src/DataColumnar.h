@@ -0,0 +1,103 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef DATA_COLUMNAR_H
+#define DATA_COLUMNAR_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "com_manager.h"
+#include "DataCSV.h"
+
+/*
+* Columnar log file layout, all values little endian and native size:
+*
+* sColumnarFileHeader
+* sColumnarColumn[columnCount]			column 0 is the _ID_ order id, the rest are the data set fields
+* repeated row groups:
+*	sColumnarRowGroupHeader
+*	column 0 values[rowCount], column 1 values[rowCount], ...		each column padded to 8 bytes
+*
+* Every section starts 8 byte aligned so the columns can be used in place from a memory mapped file.
+*/
+
+#define COLUMNAR_FILE_MARKER			0x4C4F4349		// "ICOL"
+#define COLUMNAR_ROW_GROUP_MARKER		0x50524752		// "RGRP"
+#define COLUMNAR_VERSION				1
+#define COLUMNAR_NAME_LENGTH			48
+#define COLUMNAR_ORDER_ID_OFFSET		0xFFFFFFFF		// sColumnarColumn::dataOffset of the _ID_ column
+#define COLUMNAR_ROW_GROUP_MAX_BYTES	(256 * 1024)	// row data buffered per data set before a row group is written
+#define COLUMNAR_ROW_GROUP_MAX_ROWS		8192
+#define COLUMNAR_ALIGN(n)				(((n) + 7) & ~(size_t)7)
+
+typedef struct
+{
+	uint32_t marker;			//!< COLUMNAR_FILE_MARKER
+	uint16_t version;			//!< COLUMNAR_VERSION
+	uint16_t columnCount;		//!< Number of sColumnarColumn following this header
+	uint32_t dataId;			//!< Data set id
+	uint32_t dataSize;			//!< Data set size, the size of a row
+} sColumnarFileHeader;
+
+typedef struct
+{
+	uint32_t dataOffset;		//!< Field offset in the data set, COLUMNAR_ORDER_ID_OFFSET for the order id
+	uint32_t dataSize;			//!< Bytes per value
+	uint32_t dataType;			//!< eDataType
+	uint32_t dataFlags;			//!< eDataFlags
+	char name[COLUMNAR_NAME_LENGTH];	//!< Field name, null terminated
+} sColumnarColumn;
+
+typedef struct
+{
+	uint32_t marker;			//!< COLUMNAR_ROW_GROUP_MARKER
+	uint32_t rowCount;			//!< Number of rows
+	uint64_t byteSize;			//!< Bytes of column data following this header
+} sColumnarRowGroupHeader;
+
+class cDataColumnar
+{
+public:
+	/**
+	* Get the columns for a data set from the data mappings, sorted by offset.  Column 0 is the order id.
+	* returns false if the data set has no mapping
+	*/
+	static bool GetColumns(uint32_t id, std::vector<sColumnarColumn>& columns);
+
+	int WriteHeaderToFile(FILE* pFile, uint32_t id, uint32_t dataSize, const std::vector<sColumnarColumn>& columns);
+	int ReadHeaderFromFile(FILE* pFile, uint32_t& id, uint32_t& dataSize, std::vector<sColumnarColumn>& columns);
+
+	/**
+	* Transpose buffered rows into columns and write them as a row group
+	* orderIds order id of each row
+	* rows rows of dataSize bytes each
+	* returns number of bytes written, 0 on error
+	*/
+	int WriteRowGroupToFile(FILE* pFile, const std::vector<sColumnarColumn>& columns, uint32_t dataSize, const std::vector<uint64_t>& orderIds, const std::vector<uint8_t>& rows);
+
+	/**
+	* Read the next row group, buffer receives the column data and columnStart the offset of each column in buffer
+	* returns the number of rows, 0 at end of file or on error
+	*/
+	uint32_t ReadRowGroupFromFile(FILE* pFile, const std::vector<sColumnarColumn>& columns, std::vector<uint8_t>& buffer, std::vector<size_t>& columnStart);
+
+	/**
+	* Gather one row from a row group back into a data set
+	* returns the order id of the row
+	*/
+	static uint64_t ColumnsToData(const std::vector<sColumnarColumn>& columns, const std::vector<uint8_t>& buffer, const std::vector<size_t>& columnStart, uint32_t row, uint8_t* buf, uint32_t bufSize);
+};
+
+#endif // DATA_COLUMNAR_H
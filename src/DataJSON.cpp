@@ -24,6 +24,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <stddef.h>
 #include <inttypes.h>
 #include <math.h>
+#include <algorithm>
 #include "DataJSON.h"
 #include "ISLogger.h"
 #include "data_sets.h"
@@ -46,8 +47,8 @@ int cDataJSON::WriteDataToFile(cISLogFileBase* pFile, const p_data_hdr_t& dataHd
 		return 0;
 	}
 
-	string s;
-    if (!DataToStringJSON(dataHdr, dataBuf, s))
+	int length = DataToBufferJSON(dataHdr, dataBuf);
+	if (length < 0)
 	{
 		return 0;
 	}
@@ -55,37 +56,53 @@ int cDataJSON::WriteDataToFile(cISLogFileBase* pFile, const p_data_hdr_t& dataHd
     {
         pFile->puts(prefix);
     }
-	pFile->puts(s.c_str());
-    return (int)s.length();
+	pFile->write(m_buffer.data(), length);
+    return length;
 }
 
 bool cDataJSON::StringJSONToData(string& s, p_data_hdr_t& hdr, uint8_t* buf, uint32_t bufSize)
 {
-    (void)s;
-    (void)buf;
-    (void)bufSize;
+	return ObjectJSONToData(s.c_str(), s.length(), hdr, buf, bufSize);
+}
 
-    size_t pos = s.find("\"id\":");
-    if (pos == string::npos)
-    {
-        return false;
-    }
-    uint32_t id = strtoul(s.c_str() + pos + 5, NULLPTR, 10);
-    hdr.id = id;
-	const map_name_to_info_t* offsetMap = cISDataMappings::GetMapInfo(hdr.id);
-    if (offsetMap == NULLPTR)
+
+bool cDataJSON::ObjectJSONToData(const char* s, size_t length, p_data_hdr_t& hdr, uint8_t* buf, uint32_t bufSize)
+{
+	static const char idKey[] = "\"id\":";
+	const char* end = s + length;
+	const char* idPos = std::search(s, end, idKey, idKey + sizeof(idKey) - 1);
+	if (idPos == end)
+	{
+		return false;
+	}
+	uint32_t id = 0;
+	for (const char* c = idPos + sizeof(idKey) - 1; c < end && *c >= '0' && *c <= '9'; c++)
+	{
+		id = id * 10 + (uint32_t)(*c - '0');
+	}
+	hdr.id = id;
+	const data_serialize_plan_t* plan = cISDataMappings::GetSerializePlan(hdr.id);
+	if (plan == NULLPTR)
 	{
 		return false;
 	}
-    hdr.size = cISDataMappings::GetSize(hdr.id);
+	hdr.offset = 0;
+	hdr.size = cISDataMappings::GetSize(hdr.id);
+	if (bufSize < hdr.size)
+	{
+		return false;
+	}
+	memset(buf, 0, hdr.size);
+
 	char c;
 	char pc = 0;
-	map_name_to_info_t::const_iterator offset;
-	string fieldName;
+	const char* nameStart = NULLPTR;
+	const char* nameEnd = NULLPTR;
 	size_t fieldStart = 0;
+	size_t nextOp = 0;		// fields are usually in the order DataToStringJSON wrote them
 	bool inName = true;
 	bool inQuote = false;
-	for (size_t i = 0; i < s.size(); i++)
+	for (size_t i = 0; i < length; i++)
 	{
 		c = s[i];
 		if (c == '"' && pc != '\\')
@@ -93,38 +110,63 @@ bool cDataJSON::StringJSONToData(string& s, p_data_hdr_t& hdr, uint8_t* buf, uin
 			if ((inQuote = !inQuote))
 			{
 				fieldStart = i + 1;
+				if (inName)
+				{
+					nameStart = s + i + 1;
+				}
 				pc = c;
 				continue;
 			}
+			else if (inName)
+			{
+				nameEnd = s + i;
+			}
 		}
 
 		if (inName)
 		{
 			if (c == ':')
 			{
-                fieldStart = i + 1;
+				fieldStart = i + 1;
 				inName = inQuote = false;
 				pc = c;
 				continue;
 			}
-			else if (inQuote)
-			{
-				fieldName.append(1, c);
-			}
 		}
-        else if ((c == '}' || c == '"' || (!inQuote && c == ',')) && pc != '\\')
+		else if ((c == '}' || c == '"' || (!inQuote && c == ',')) && pc != '\\')
 		{
-            if (fieldStart != 0)
+			if (fieldStart != 0 && nameStart != NULLPTR && nameEnd >= nameStart)
 			{
-				offset = offsetMap->find(fieldName);
-                string json = s.substr(fieldStart, i - fieldStart);
-                if (offset != offsetMap->end() && !cISDataMappings::StringToData(json.c_str(), (int)json.size(), &hdr, buf, offset->second, 10, true))
+				// Field from the plan if it is next, otherwise look it up by name
+				size_t nameLength = nameEnd - nameStart;
+				uint32_t dataOffset = 0, dataSize = 0;
+				eDataType dataType = DataTypeCount;
+				if (nextOp < plan->ops.size() && plan->ops[nextOp].jsonName.size() == nameLength + 4 &&
+					memcmp(plan->ops[nextOp].jsonName.data() + 2, nameStart, nameLength) == 0)
+				{
+					const data_serialize_op_t& op = plan->ops[nextOp++];
+					dataOffset = op.dataOffset;
+					dataSize = op.dataSize;
+					dataType = op.dataType;
+				}
+				else
+				{
+					const data_info_t* info = cISDataMappings::GetFieldInfo(hdr.id, nameStart, nameLength);
+					if (info != NULLPTR)
+					{
+						dataOffset = info->dataOffset;
+						dataSize = info->dataSize;
+						dataType = info->dataType;
+					}
+				}
+				if (dataType != DataTypeCount && (dataOffset + dataSize > hdr.size ||
+					!cISDataMappings::FieldToVariable(s + fieldStart, (int)(i - fieldStart), buf + dataOffset, dataType, dataSize, true)))
 				{
 					return false;
 				}
 			}
-            fieldName.clear();
-            fieldStart = 0;
+			nameStart = nameEnd = NULLPTR;
+			fieldStart = 0;
 			inName = true;
 		}
 		pc = c;
@@ -136,43 +178,36 @@ bool cDataJSON::StringJSONToData(string& s, p_data_hdr_t& hdr, uint8_t* buf, uin
 
 bool cDataJSON::DataToStringJSON(const p_data_hdr_t& hdr, const uint8_t* buf, string& json)
 {
-    json.clear();
-	const map_name_to_info_t* offsetMap = cISDataMappings::GetMapInfo(hdr.id);
-	if (offsetMap == NULLPTR)
+	int length = DataToBufferJSON(hdr, buf);
+	if (length < 0)
 	{
+		json.clear();
 		return false;
 	}
-	char tmp[IS_DATA_MAPPING_MAX_STRING_LENGTH];
-	const uint8_t* bufPtr = buf;
-	uint8_t tmpBuffer[MAX_DATASET_SIZE];
-	uint32_t size = cISDataMappings::GetSize(hdr.id);
-	if (size > hdr.size)
-	{
-		// copy into temp buffer, zeroing out bytes that are not part of this packet
-		memset(tmpBuffer, 0, hdr.offset);
-		memcpy(tmpBuffer + hdr.offset, buf, hdr.size);
-		uint32_t dataEnd = hdr.offset + hdr.size;
-		memset(tmpBuffer + dataEnd, 0, size - dataEnd);
-		bufPtr = tmpBuffer;
-	}
+	json.assign(m_buffer.data(), length);
+	return true;
+}
 
-	// copy header as we are now storing an entire struct, even if we got a partial hdr and buf
-	p_data_hdr_t hdrCopy = hdr;
-	hdrCopy.offset = 0;
-	hdrCopy.size = size;
 
-	SNPRINTF(tmp, sizeof(tmp), "{\"id\":%d", (int)hdr.id);
-	json.append(tmp);
-	for (map_name_to_info_t::const_iterator offset = offsetMap->begin(); offset != offsetMap->end(); offset++)
+int cDataJSON::DataToBufferJSON(const p_data_hdr_t& hdr, const uint8_t* buf)
+{
+	const data_serialize_plan_t* plan = cISDataMappings::GetSerializePlan(hdr.id);
+	if (plan == NULLPTR)
 	{
-		cISDataMappings::DataToString(offset->second, &hdrCopy, bufPtr, tmp, true);
-		json.append(1, ',');
-		json.append(1, '"');
-		json.append(offset->second.name);
-		json.append(1, '"');
-		json.append(1, ':');
-		json.append(tmp);
+		return -1;
 	}
-	json.append(1, '}');
-	return true;
+	size_t bufferSize = plan->maxStringLength + 32;
+	if (m_buffer.size() < bufferSize)
+	{
+		m_buffer.resize(bufferSize);
+	}
+	int length = SNPRINTF(m_buffer.data(), 32, "{\"id\":%d", (int)hdr.id);
+	int fieldsLength = cISDataMappings::DataSetToString(hdr, buf, m_buffer.data() + length, true);
+	if (fieldsLength < 0)
+	{
+		return -1;
+	}
+	length += fieldsLength;
+	m_buffer[length++] = '}';
+	return length;
 }
@@ -15,6 +15,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <string>
 #include <map>
+#include <vector>
 #include <regex>
 
 #include "com_manager.h"
@@ -59,6 +60,13 @@ public:
 	*/
     bool StringJSONToData(std::string& s, p_data_hdr_t& hdr, uint8_t* buf, uint32_t bufSize);
 
+	/**
+	* Parse a json object in place into a data packet, same as StringJSONToData without copying the object or its fields
+	* json the json object, does not need to be null terminated
+	* length number of chars in json
+	*/
+	bool ObjectJSONToData(const char* json, size_t length, p_data_hdr_t& hdr, uint8_t* buf, uint32_t bufSize);
+
 	/**
     * Convert data to a json string
 	* buf is assumed to be large enough to hold the data structure
@@ -66,6 +74,15 @@ public:
 	* return true if success, false if no map found
 	*/
     bool DataToStringJSON(const p_data_hdr_t& hdr, const uint8_t* buf, std::string& json);
+
+private:
+	/**
+	* Serialize a data set into m_buffer with cISDataMappings::DataSetToString
+	* returns the length of the json object, -1 if no map found
+	*/
+	int DataToBufferJSON(const p_data_hdr_t& hdr, const uint8_t* buf);
+
+	std::vector<char> m_buffer;		// reused for every record
 };
 
 #endif // DATA_JSON_H
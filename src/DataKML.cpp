@@ -23,7 +23,6 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <stdlib.h>
 #include <stddef.h>
 
-#include "tinyxml.h"
 #include "DataKML.h"
 #include "ISLogger.h"
 #include "ISPose.h"
@@ -35,6 +34,10 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #	include "../../cpp/libs/IS_internal.h"
 #endif
 
+#ifdef USE_ZLIB
+#	include <zlib.h>
+#endif
+
 
 cDataKML::cDataKML()
 {
@@ -62,22 +65,20 @@ std::string cDataKML::GetDatasetName(int kid)
 #include <stdio.h>
 #include <time.h>
 
-int cDataKML::WriteDataToFile(std::vector<sKmlLogData>& list, const p_data_hdr_t* dataHdr, const uint8_t* dataBuf)
+bool cDataKML::DataToKmlLogData(const p_data_hdr_t* dataHdr, const uint8_t* dataBuf, sKmlLogData& data)
 {
 	uDatasets& d = (uDatasets&)(*dataBuf);
 	ixEuler theta;
-    sKmlLogData data;
 	bool deadreckoning = false;
 
 #ifdef USE_IS_INTERNAL
 // 	uInternalDatasets &i = (uInternalDatasets&)(*dataBuf);
 #endif
 
-	// Write date to file
 	switch (dataHdr->id)
 	{
 	default:		// Unidentified dataset
-        return 0;
+		return false;
 
 	case DID_INS_1:
 		deadreckoning = !(d.ins1.insStatus & INS_STATUS_GPS_AIDING_POS);
@@ -103,9 +104,222 @@ int cDataKML::WriteDataToFile(std::vector<sKmlLogData>& list, const p_data_hdr_t
         break;
 	}
 
-    list.push_back(data);
+	return true;
+}
+
+
+static void putLE16(uint8_t* ptr, uint16_t value)
+{
+	ptr[0] = (uint8_t)value;
+	ptr[1] = (uint8_t)(value >> 8);
+}
+
+static void putLE32(uint8_t* ptr, uint32_t value)
+{
+	putLE16(ptr, (uint16_t)value);
+	putLE16(ptr + 2, (uint16_t)(value >> 16));
+}
+
+
+struct sKmzStream
+{
+#ifdef USE_ZLIB
+	z_stream                zstream;
+	std::vector<char>       buffer;
+	uint32_t                crc;
+	uint64_t                size;				// Compressed byte size
+#endif
+};
+
+
+cKmlFile::cKmlFile()
+{
+	m_file = NULL;
+	m_kmz = NULL;
+	m_ok = false;
+	m_size = 0;
+	m_bufferSize = 0;
+}
+
+cKmlFile::~cKmlFile()
+{
+	Close();
+}
+
+bool cKmlFile::KmzSupported()
+{
+#ifdef USE_ZLIB
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool cKmlFile::Open(const std::string& fileName, bool kmz)
+{
+	Close();
+
+	if (kmz && !KmzSupported())
+	{
+		return false;
+	}
+
+	m_file = fopen(fileName.c_str(), "wb");
+	if (m_file == NULL)
+	{
+		return false;
+	}
+	m_ok = true;
+	m_size = 0;
+	m_bufferSize = 0;
+	m_buffer.resize(KML_FILE_BUFFER_SIZE);
+
+#ifdef USE_ZLIB
+	if (kmz)
+	{
+		// Local file header, sizes and CRC are filled in by Close()
+		uint8_t header[30 + sizeof(KMZ_DOC_NAME) - 1] = {};
+		putLE32(header, 0x04034b50);
+		putLE16(header + 4, 20);						// version needed to extract
+		putLE16(header + 8, Z_DEFLATED);				// compression method
+		putLE16(header + 12, (1 << 5) | 1);				// 1980-01-01
+		putLE16(header + 26, sizeof(KMZ_DOC_NAME) - 1);
+		memcpy(header + 30, KMZ_DOC_NAME, sizeof(KMZ_DOC_NAME) - 1);
+		m_ok = (fwrite(header, sizeof(header), 1, m_file) == 1);
+
+		m_kmz = new sKmzStream();
+		m_ok = m_ok && (deflateInit2(&m_kmz->zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+		m_kmz->buffer.resize(KML_FILE_BUFFER_SIZE);
+		m_kmz->crc = crc32(0L, Z_NULL, 0);
+		m_kmz->size = 0;
+	}
+#endif
+
+	return m_ok;
+}
+
+void cKmlFile::Write(const char* str, size_t size)
+{
+	if (m_file == NULL)
+	{
+		return;
+	}
+	m_size += size;
+
+	while (size > 0)
+	{
+		size_t n = _MIN(size, m_buffer.size() - m_bufferSize);
+		memcpy(m_buffer.data() + m_bufferSize, str, n);
+		m_bufferSize += n;
+		str += n;
+		size -= n;
+		if (m_bufferSize == m_buffer.size())
+		{
+			Flush();
+		}
+	}
+}
+
+bool cKmlFile::Flush(bool finish)
+{
+#ifdef USE_ZLIB
+	if (m_kmz)
+	{
+		z_stream& zs = m_kmz->zstream;
+		m_kmz->crc = crc32(m_kmz->crc, (const Bytef*)m_buffer.data(), (uInt)m_bufferSize);
+		zs.next_in = (Bytef*)m_buffer.data();
+		zs.avail_in = (uInt)m_bufferSize;
+		int status;
+		do
+		{
+			zs.next_out = (Bytef*)m_kmz->buffer.data();
+			zs.avail_out = (uInt)m_kmz->buffer.size();
+			status = deflate(&zs, (finish ? Z_FINISH : Z_NO_FLUSH));
+			size_t n = m_kmz->buffer.size() - zs.avail_out;
+			if (n > 0 && fwrite(m_kmz->buffer.data(), 1, n, m_file) != n)
+			{
+				m_ok = false;
+			}
+			m_kmz->size += n;
+		} while (status == Z_OK && (zs.avail_out == 0 || finish));
+		if (status == Z_STREAM_ERROR || (finish && status != Z_STREAM_END))
+		{
+			m_ok = false;
+		}
+		m_bufferSize = 0;
+		return m_ok;
+	}
+#else
+	(void)finish;
+#endif
 
-    return 0;
+	if (m_bufferSize > 0 && fwrite(m_buffer.data(), 1, m_bufferSize, m_file) != m_bufferSize)
+	{
+		m_ok = false;
+	}
+	m_bufferSize = 0;
+	return m_ok;
 }
 
+bool cKmlFile::Close()
+{
+	if (m_file == NULL)
+	{
+		return false;
+	}
 
+	Flush(true);
+
+#ifdef USE_ZLIB
+	if (m_kmz)
+	{
+		deflateEnd(&m_kmz->zstream);
+
+		// Central directory and end of central directory records
+		const uint32_t nameSize = sizeof(KMZ_DOC_NAME) - 1;
+		const uint32_t dirOffset = (uint32_t)(30 + nameSize + m_kmz->size);
+		uint8_t dir[46 + nameSize + 22] = {};
+		putLE32(dir, 0x02014b50);
+		putLE16(dir + 4, 20);							// version made by
+		putLE16(dir + 6, 20);							// version needed to extract
+		putLE16(dir + 10, Z_DEFLATED);
+		putLE16(dir + 14, (1 << 5) | 1);
+		putLE32(dir + 16, m_kmz->crc);
+		putLE32(dir + 20, (uint32_t)m_kmz->size);
+		putLE32(dir + 24, (uint32_t)m_size);
+		putLE16(dir + 28, nameSize);
+		memcpy(dir + 46, KMZ_DOC_NAME, nameSize);
+		uint8_t* end = dir + 46 + nameSize;
+		putLE32(end, 0x06054b50);
+		putLE16(end + 8, 1);							// entries on this disk
+		putLE16(end + 10, 1);							// total entries
+		putLE32(end + 12, 46 + nameSize);				// directory size
+		putLE32(end + 16, dirOffset);
+		if (fwrite(dir, sizeof(dir), 1, m_file) != 1)
+		{
+			m_ok = false;
+		}
+
+		// Complete the local file header
+		uint8_t sizes[12];
+		putLE32(sizes, m_kmz->crc);
+		putLE32(sizes + 4, (uint32_t)m_kmz->size);
+		putLE32(sizes + 8, (uint32_t)m_size);
+		if (fseek(m_file, 14, SEEK_SET) != 0 || fwrite(sizes, sizeof(sizes), 1, m_file) != 1)
+		{
+			m_ok = false;
+		}
+		delete m_kmz;
+		m_kmz = NULL;
+	}
+#endif
+
+	if (fclose(m_file) != 0)
+	{
+		m_ok = false;
+	}
+	m_file = NULL;
+	m_buffer.clear();
+	m_buffer.shrink_to_fit();
+	return m_ok;
+}
@@ -13,17 +13,20 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #ifndef DATA_KML_H
 #define DATA_KML_H
 
-// #include <stdio.h>
+#include <stdio.h>
+#include <string.h>
 #include <string>
 #include <vector>
 
-#include "tinyxml.h"
 #include "com_manager.h"
 
 #ifdef USE_IS_INTERNAL
 #	include "../../cpp/libs/IS_internal.h"
 #endif
 
+#define KML_FILE_BUFFER_SIZE		65536
+#define KMZ_DOC_NAME				"doc.kml"
+
 
 struct sKmlLogData
 {
@@ -103,7 +106,68 @@ public:
 	
 	cDataKML();
 	std::string GetDatasetName(int kid);
-    int WriteDataToFile(std::vector<sKmlLogData>& list, const p_data_hdr_t* dataHdr, const uint8_t* dataBuf);
+
+	/**
+	* Convert a data set to a KML sample
+	* @param dataHdr data header
+	* @param dataBuf data buffer
+	* @param data receives the sample
+	* @return true if the data set has a position, false otherwise
+	*/
+	bool DataToKmlLogData(const p_data_hdr_t* dataHdr, const uint8_t* dataBuf, sKmlLogData& data);
+};
+
+
+/**
+* Output file for streamed KML.  Writes go through a fixed size buffer so memory does not grow with the file.  
+* When opened as KMZ the document is deflated into a single entry zip archive (requires USE_ZLIB).
+*/
+class cKmlFile
+{
+public:
+	cKmlFile();
+	~cKmlFile();
+
+	/**
+	* Open a file for writing
+	* @param fileName file name
+	* @param kmz true to write a zip archive holding the document as KMZ_DOC_NAME
+	* @return true if the file was opened
+	*/
+	bool Open(const std::string& fileName, bool kmz = false);
+
+	/**
+	* Flush buffered data and finish the file.  For KMZ this writes the zip directory.
+	* @return true if all data was written
+	*/
+	bool Close();
+
+	bool IsOpen() { return m_file != NULL; }
+	void Write(const char* str, size_t size);
+	void Write(const char* str) { Write(str, strlen(str)); }
+	void Write(const std::string& str) { Write(str.c_str(), str.size()); }
+
+	/** Uncompressed bytes written since Open */
+	uint64_t Size() { return m_size; }
+
+	/** True if KMZ output is available (built with USE_ZLIB) */
+	static bool KmzSupported();
+
+private:
+#if CPP11_IS_ENABLED
+	cKmlFile(const cKmlFile& copy) = delete;
+#else
+	cKmlFile(const cKmlFile& copy); // Disable copy constructors
+#endif
+
+	bool Flush(bool finish = false);
+
+	FILE*                   m_file;
+	struct sKmzStream*      m_kmz;					// Deflate state, NULL for KML
+	bool                    m_ok;
+	uint64_t                m_size;
+	std::vector<char>       m_buffer;
+	size_t                  m_bufferSize;
 };
 
 #endif // DATA_KML_H
@@ -26,6 +26,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "ISConstants.h"
 #include "ISDataMappings.h"
 #include "ISLogFileFactory.h"
+#include "ISLogTimeIndex.h"
 
 using namespace std;
 
@@ -41,8 +42,18 @@ cDeviceLog::cDeviceLog()
 	m_altClampToGround = true;
 	m_enableGpsLogging = true;
 	m_showTracks = true;
+	m_showPoints = true;
 	m_showPointTimestamps = true;
 	m_pointUpdatePeriodSec = 1.0f;
+	m_kmlDecimation = 0.0;
+	m_kmlCompress = false;
+	m_asyncFileWrite = false;
+	m_mappedRead = false;
+	m_syncPeriodMs = 0;
+	m_timeIndexPeriodMs = 0;
+	m_compressionLevel = 0;
+	m_compressionFilter = false;
+	m_writeThreads = 1;
 	m_logStats.Clear();
 }
 
@@ -120,7 +131,7 @@ bool cDeviceLog::SetupReadInfo(const string& directory, const string& serialNum,
 	m_fileNames.clear();
 	vector<ISFileManager::file_info_t> fileInfos;
 	SetSerialNumber((uint32_t)strtoul(serialNum.c_str(), NULL, 10));
-	ISFileManager::GetDirectorySpaceUsed(directory, string("[\\/\\\\]" IS_LOG_FILE_PREFIX) + serialNum + "_", fileInfos, false, false);
+	ISFileManager::GetDirectorySpaceUsed(directory, string("[\\/\\\\]" IS_LOG_FILE_PREFIX) + serialNum + "_.*\\" + LogFileExtention() + "$", fileInfos, false, false);
 	if (fileInfos.size() != 0)
 	{
 		m_fileName = fileInfos[0].name;
@@ -174,7 +185,14 @@ bool cDeviceLog::OpenNewSaveFile()
 		serNum = m_pHandle;
 	}
 	string fileName = GetNewFileName(serNum, m_fileCount, NULL);
-	m_pFile = CreateISLogFile(fileName, "wb");
+	if (m_asyncFileWrite)
+	{	// Rollover does not wait on the disk, the previous file is written and closed in the background
+		m_pFile = CreateISLogFileAsync(fileName, "wb", m_maxFileSize, m_syncPeriodMs);
+	}
+	else
+	{
+		m_pFile = CreateISLogFile(fileName, "wb");
+	}
 	m_fileSize = 0;
 
 	if (m_pFile && m_pFile->isOpened())
@@ -205,7 +223,7 @@ bool cDeviceLog::OpenNextReadFile()
 	}
 	
 	m_fileName = m_fileNames[m_fileCount++];
-	m_pFile = CreateISLogFile(m_fileName, "rb");
+	m_pFile = OpenReadFile(m_fileName);
 
 	if (m_pFile)
 	{
@@ -224,6 +242,25 @@ bool cDeviceLog::OpenNextReadFile()
 	}
 }
 
+void cDeviceLog::SetMappedRead(bool enable)
+{
+#if PLATFORM_IS_LINUX || PLATFORM_IS_APPLE
+	m_mappedRead = enable;
+#else
+	(void)enable;
+	m_mappedRead = false;
+#endif
+}
+
+cISLogFileBase* cDeviceLog::OpenReadFile(const std::string& fileName)
+{
+	if (m_mappedRead)
+	{
+		return CreateISLogFileMapped(fileName);
+	}
+	return CreateISLogFile(fileName, "rb");
+}
+
 string cDeviceLog::GetNewFileName(uint32_t serialNumber, uint32_t fileCount, const char* suffix)
 {
 	// file name 
@@ -252,6 +289,20 @@ string cDeviceLog::GetNewFileName(uint32_t serialNumber, uint32_t fileCount, con
 }
 
 
+string cDeviceLog::GetTimeIndexFileName(uint32_t serialNumber)
+{
+	// One index per device log, i.e. LOG_SN30013_20170103_151023.idx
+	char filename[200];
+	SNPRINTF(filename, sizeof(filename), "%s/%s%d_%s%s",
+		m_directory.c_str(),
+		IS_LOG_FILE_PREFIX,
+		(int)serialNumber,
+		m_timeStamp.c_str(),
+		LOG_TIME_INDEX_EXTENSION);
+	return filename;
+}
+
+
 void cDeviceLog::SetDeviceInfo(const dev_info_t *info)
 {
 	if (info == NULL)
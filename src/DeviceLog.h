@@ -45,13 +45,21 @@ public:
 	virtual void SetSerialNumber(uint32_t serialNumber) = 0;
 	virtual std::string LogFileExtention() = 0;
 	virtual void Flush() {}
+	void SetAsyncFileWrite(bool enable, uint32_t syncPeriodMs) { m_asyncFileWrite = enable; m_syncPeriodMs = syncPeriodMs; }
+	void SetMappedRead(bool enable);
+	void SetTimeIndex(uint32_t periodMs) { m_timeIndexPeriodMs = periodMs; }
+	void SetCompression(int level, bool deltaFilter) { m_compressionLevel = level; m_compressionFilter = deltaFilter; }
+	void SetWriteThreads(uint32_t threads) { m_writeThreads = threads; }		// formatting threads, used by log types with a file per data set
+	virtual bool SeekToTime(double time) { (void)time; return false; }
     bool SetupReadInfo(const std::string& directory, const std::string& deviceName, const std::string& timeStamp);
     void SetDeviceInfo(const dev_info_t *info);
     const dev_info_t* GetDeviceInfo() { return &m_devInfo; }
+	const cLogStats& GetStats() { return m_logStats; }
 	uint64_t FileSize() { return m_fileSize; }
 	uint64_t LogSize() { return m_logSize; }
 	uint32_t FileCount() { return m_fileCount; }
 	std::string GetNewFileName(uint32_t serialNumber, uint32_t fileCount, const char* suffix);
+	std::string GetTimeIndexFileName(uint32_t serialNumber);
 	void SetKmlConfig(bool gpsData =true, bool showTracks =true, bool showPoints =true, bool showPointTimestamps =true, double pointUpdatePeriodSec=1.0, bool altClampToGround=true)
 	{ 
 		m_enableGpsLogging = gpsData;
@@ -61,10 +69,12 @@ public:
 		m_pointUpdatePeriodSec = pointUpdatePeriodSec;
 		m_altClampToGround = altClampToGround; 
 	}
+	void SetKmlOutput(double decimationToleranceM, bool kmz) { m_kmlDecimation = decimationToleranceM; m_kmlCompress = kmz; }
 
 protected:
 	bool OpenNewSaveFile();
 	bool OpenNextReadFile();
+	cISLogFileBase* OpenReadFile(const std::string& fileName);
     void OnReadData(p_data_t* data);
 
 	std::vector<std::string> m_fileNames;
@@ -86,6 +96,15 @@ protected:
 	bool                    m_showPoints;
 	bool                    m_showPointTimestamps;
 	double                  m_pointUpdatePeriodSec;
+	double                  m_kmlDecimation;		// Track decimation tolerance in meters, 0 = off
+	bool                    m_kmlCompress;			// Write .kmz
+	bool                    m_asyncFileWrite;
+	bool                    m_mappedRead;
+	uint32_t                m_syncPeriodMs;
+	uint32_t                m_timeIndexPeriodMs;	// 0 = no time index
+	int                     m_compressionLevel;		// .dat / .sdat chunk compression, 0 = none
+	bool                    m_compressionFilter;
+	uint32_t                m_writeThreads;			// > 1 to format data sets on worker threads
 
 private:
     cLogStats               m_logStats;
@@ -22,6 +22,10 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <stdlib.h>
 #include <stddef.h>
 #include <climits>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #include "ISPose.h"
 #include "DeviceLogCSV.h"
@@ -31,8 +35,52 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 using namespace std;
 
 
+// Data set queued for a writer thread, followed by the data padded to 8 bytes
+struct sCsvRecord
+{
+	cCsvLog* log;
+	uint64_t orderId;
+	uint32_t serialNumber;
+	p_data_hdr_t hdr;
+};
+
+#define CSV_RECORD_SIZE(dataSize)	(sizeof(sCsvRecord) + (((dataSize) + 7) & ~7))
+
+// Writer thread and the batches queued for it
+struct sCsvWriter
+{
+	sCsvWriter() : records(0), inFlight(0), logSize(0), stop(false), failed(false) {}
+
+	thread writeThread;
+	mutex queueMutex;
+	condition_variable cond;				// batch queued, written or stop
+	deque<vector<uint8_t> > jobs;			// batches waiting to be written
+	vector<vector<uint8_t> > freeBatches;	// written batches, reused
+	vector<uint8_t> batch;					// being filled by SaveData
+	uint64_t records;						// data sets queued, SaveData only
+	int inFlight;							// batches queued or being written
+	uint64_t logSize;						// bytes written, not yet added to the device log size
+	bool stop;
+	bool failed;
+	cDataCSV csv;							// writer thread only
+};
+
+
+cDeviceLogCSV::cDeviceLogCSV()
+{
+	m_nextId = 0;
+}
+
+
+cDeviceLogCSV::~cDeviceLogCSV()
+{
+	StopWriters();
+}
+
+
 void cDeviceLogCSV::InitDeviceForWriting(int pHandle, std::string timestamp, std::string directory, uint64_t maxDiskSpace, uint32_t maxFileSize)
 {
+	StopWriters();
 	m_logs.clear();
 	m_nextId = 0;
 	cDeviceLog::InitDeviceForWriting(pHandle, timestamp, directory, maxDiskSpace, maxFileSize);
@@ -69,8 +117,8 @@ void cDeviceLogCSV::InitDeviceForReading()
 				}
 				m_currentFiles[id] = files;
 				m_currentFileIndex[id] = 0;
-				while (OpenNewFile(log, true) && !GetNextLineForFile(log)) {}
-				if (log.nextLine.length() != 0)
+				while (OpenNewFile(log) && !GetNextLineForFile(log)) {}
+				if (log.lineLength != 0)
 				{
 					m_logs[id] = log;
 				}
@@ -82,6 +130,7 @@ void cDeviceLogCSV::InitDeviceForReading()
 
 bool cDeviceLogCSV::CloseAllFiles()
 {
+	StopWriters();
 	cDeviceLog::CloseAllFiles();
 
 	for (map<uint32_t, cCsvLog>::iterator i = m_logs.begin(); i != m_logs.end(); i++)
@@ -98,7 +147,7 @@ bool cDeviceLogCSV::CloseAllFiles()
 }
 
 
-bool cDeviceLogCSV::OpenNewFile(cCsvLog& log, bool readonly)
+bool cDeviceLogCSV::OpenNewFile(cCsvLog& log)
 {
 	const char* dataSetName = cISDataMappings::GetDataSetName(log.dataId);
 	if (dataSetName == NULL)
@@ -113,72 +162,42 @@ bool cDeviceLogCSV::OpenNewFile(cCsvLog& log, bool readonly)
 		log.pFile = NULL;
 	}
 
-	// Ensure directory exists
-	if (m_directory.empty())
-	{
-		return false;
-	}
-
-	_MKDIR(m_directory.c_str());
-
-	// Open new file
-	uint32_t serNum = m_devInfo.serialNumber;
-	if (!serNum)
-	{
-		serNum = m_pHandle;
-	}
-
 	string fileName;
-	if (readonly)
-	{
 tryNextFile:
+	{
+		uint32_t index = m_currentFileIndex[log.dataId];
+		vector<string>& files = m_currentFiles[log.dataId];
+		if (index >= files.size())
 		{
-			uint32_t index = m_currentFileIndex[log.dataId];
-			vector<string>& files = m_currentFiles[log.dataId];
-			if (index >= files.size())
-			{
-				m_logs.erase(log.dataId);
-				return false;
-			}
-			fileName = files[index++];
-			m_currentFileIndex[log.dataId] = index;
-			log.pFile = fopen(fileName.c_str(), "r");
-			log.fileCount++;
-			struct stat st;
-			stat(fileName.c_str(), &st);
-			log.fileSize = st.st_size;
-			m_logSize += log.fileSize;
-			if (m_csv.ReadHeaderFromFile(log.pFile, log.dataId, log.columnHeaders) == 0)
-			{
-				goto tryNextFile;
-			}
+			m_logs.erase(log.dataId);
+			return false;
 		}
-	}
-	else
-	{
+		fileName = files[index++];
+		m_currentFileIndex[log.dataId] = index;
+		log.pFile = fopen(fileName.c_str(), "r");
 		log.fileCount++;
-		fileName = GetNewFileName(serNum, log.fileCount, dataSetName);
-		log.pFile = fopen(fileName.c_str(), "w");
-
-		// Write Header
-		int fileBytes = m_csv.WriteHeaderToFile(log.pFile, log.dataId);
-
-		// File byte size
-		log.fileSize = fileBytes;
-		m_logSize += fileBytes;
+		log.readPos = log.readEnd = 0;
+		struct stat st;
+		stat(fileName.c_str(), &st);
+		log.fileSize = st.st_size;
+		m_logSize += log.fileSize;
+		if (m_csv.ReadHeaderFromFile(log.pFile, log.dataId, log.columnHeaders) == 0)
+		{
+			goto tryNextFile;
+		}
 	}
 
 	if (log.pFile)
 	{
 #if LOG_DEBUG_FILE_WRITE
-		printf("cDeviceLogCSV::OpenNewFile %s %s\n", (readonly?"read":"write"), fileName.c_str());
+		printf("cDeviceLogCSV::OpenNewFile read %s\n", fileName.c_str());
 #endif
 		return true;
 	}
 	else
 	{
 #if LOG_DEBUG_FILE_WRITE
-		printf("cDeviceLogCSV::OpenNewFile FAILED to open save file: %s\n", fileName.c_str());
+		printf("cDeviceLogCSV::OpenNewFile FAILED to open file: %s\n", fileName.c_str());
 #endif
 		m_logs.erase(log.dataId);
 		return false;
@@ -186,51 +205,176 @@ tryNextFile:
 }
 
 
-bool cDeviceLogCSV::GetNextLineForFile(cCsvLog& log)
+// Called from the writer threads, only touches log and the passed in csv and logSize
+bool cDeviceLogCSV::OpenNewWriteFile(cCsvLog& log, cDataCSV& csv, uint32_t serialNumber, uint64_t& logSize)
 {
-	if (log.pFile == NULL)
+	const char* dataSetName = cISDataMappings::GetDataSetName(log.dataId);
+	if (dataSetName == NULL)
 	{
 		return false;
 	}
-	char lineBuffer[8192];
-	if (fgets(lineBuffer, _ARRAY_BYTE_COUNT(lineBuffer), log.pFile) == NULL)
+
+	// Close existing file
+	if (log.pFile)
 	{
-		return false;
+		fclose(log.pFile);
+		log.pFile = NULL;
 	}
-	log.nextLine = lineBuffer;
-	size_t index = log.nextLine.find(',', 0);
-	if (index < log.nextLine.size())
+
+	// Ensure directory exists
+	if (m_directory.empty())
 	{
-		log.orderId = strtoull(log.nextLine.c_str(), NULL, 10);
+		return false;
 	}
-	else
+
+	_MKDIR(m_directory.c_str());
+
+	// Open new file
+	log.fileCount++;
+	string fileName = GetNewFileName(serialNumber, log.fileCount, dataSetName);
+	log.pFile = fopen(fileName.c_str(), "w");
+	if (log.pFile == NULL)
 	{
+#if LOG_DEBUG_FILE_WRITE
+		printf("cDeviceLogCSV::OpenNewWriteFile FAILED to open save file: %s\n", fileName.c_str());
+#endif
 		return false;
 	}
+
+#if LOG_DEBUG_FILE_WRITE
+	printf("cDeviceLogCSV::OpenNewWriteFile %s\n", fileName.c_str());
+#endif
+
+	// Write Header
+	int fileBytes = csv.WriteHeaderToFile(log.pFile, log.dataId);
+
+	// File byte size
+	log.fileSize = fileBytes;
+	logSize += fileBytes;
 	return true;
 }
 
 
+bool cDeviceLogCSV::GetNextLineForFile(cCsvLog& log)
+{
+	log.lineLength = 0;
+	if (log.pFile == NULL)
+	{
+		return false;
+	}
+
+	while (true)
+	{
+		// Next line in the buffer
+		size_t remaining = log.readEnd - log.readPos;
+		const char* data = log.readBuffer.data();
+		const char* newline = (remaining != 0 ? (const char*)memchr(data + log.readPos, '\n', remaining) : NULL);
+		size_t lineEnd;
+		if (newline != NULL)
+		{
+			lineEnd = newline - data;
+		}
+		else
+		{
+			// Move the partial line to the start of the buffer and read more, growing the buffer for long lines
+			if (remaining != 0 && log.readPos != 0)
+			{
+				memmove(log.readBuffer.data(), data + log.readPos, remaining);
+			}
+			log.readPos = 0;
+			log.readEnd = remaining;
+			if (log.readBuffer.size() < remaining + CSV_READ_BUFFER_SIZE / 2)
+			{
+				log.readBuffer.resize(_MAX(log.readBuffer.size() * 2, (size_t)CSV_READ_BUFFER_SIZE));
+			}
+			size_t count = fread(log.readBuffer.data() + log.readEnd, 1, log.readBuffer.size() - log.readEnd, log.pFile);
+			log.readEnd += count;
+			if (count != 0)
+			{
+				continue;
+			}
+			if (remaining == 0)
+			{	// end of file
+				return false;
+			}
+			// last line without a newline
+			lineEnd = log.readEnd;
+		}
+
+		log.lineStart = log.readPos;
+		log.lineLength = lineEnd - log.readPos;
+		log.readPos = _MIN(lineEnd + 1, log.readEnd);
+
+		// Order id is column 0, skip lines without one
+		const char* line = log.readBuffer.data() + log.lineStart;
+		if (memchr(line, ',', log.lineLength) != NULL)
+		{
+			uint64_t orderId = 0;
+			for (; *line >= '0' && *line <= '9'; line++)
+			{
+				orderId = orderId * 10 + (uint64_t)(*line - '0');
+			}
+			log.orderId = orderId;
+			return true;
+		}
+		log.lineLength = 0;
+	}
+}
+
+
 bool cDeviceLogCSV::SaveData(p_data_hdr_t* dataHdr, const uint8_t* dataBuf)
 {
     cDeviceLog::SaveData(dataHdr, dataBuf);
 
-	// Reference current log
-	cCsvLog& log = m_logs[dataHdr->id];
-	log.dataId = dataHdr->id;
+	if (m_writeThreads > 1 && m_writers.empty())
+	{
+		StartWriters();
+	}
 
-	// Create first file it it doesn't exist, return out if failure
-	if (log.pFile == NULL && (!OpenNewFile(log, false) || log.pFile == NULL))
+	// Reference current log, new data sets go to the writer thread with the least data queued so far
+	map<uint32_t, cCsvLog>::iterator it = m_logs.find(dataHdr->id);
+	if (it == m_logs.end())
 	{
-		return false;
+		it = m_logs.insert(make_pair(dataHdr->id, cCsvLog())).first;
+		it->second.dataId = dataHdr->id;
+		for (uint32_t i = 1; i < m_writers.size(); i++)
+		{
+			if (m_writers[i]->records < m_writers[it->second.writer]->records)
+			{
+				it->second.writer = i;
+			}
+		}
 	}
-	else if (dataHdr->id == DID_DEV_INFO)
+	cCsvLog& log = it->second;
+
+	uint32_t serialNumber = m_devInfo.serialNumber;
+	if (!serialNumber)
+	{
+		serialNumber = m_pHandle;
+	}
+	if (dataHdr->id == DID_DEV_INFO)
 	{
 		memcpy(&m_devInfo, dataBuf, sizeof(dev_info_t));
 	}
 
+	if (!m_writers.empty())
+	{
+		return QueueData(log, serialNumber, *dataHdr, dataBuf);
+	}
+	return WriteDataToFile(log, m_csv, serialNumber, m_nextId++, *dataHdr, dataBuf, m_logSize);
+}
+
+
+bool cDeviceLogCSV::WriteDataToFile(cCsvLog& log, cDataCSV& csv, uint32_t serialNumber, uint64_t orderId, const p_data_hdr_t& dataHdr, const uint8_t* dataBuf, uint64_t& logSize)
+{
+	// Create first file it it doesn't exist, return out if failure
+	if (log.pFile == NULL && !OpenNewWriteFile(log, csv, serialNumber, logSize))
+	{
+		return false;
+	}
+
 	// Write date to file
-    int nBytes = m_csv.WriteDataToFile(m_nextId++, log.pFile, *dataHdr, dataBuf);
+    int nBytes = csv.WriteDataToFile(orderId, log.pFile, dataHdr, dataBuf);
 	if (ferror(log.pFile) != 0)
 	{
 		return false;
@@ -238,7 +382,7 @@ bool cDeviceLogCSV::SaveData(p_data_hdr_t* dataHdr, const uint8_t* dataBuf)
 
 	// File byte size
 	log.fileSize += nBytes;
-	m_logSize += nBytes;
+	logSize += nBytes;
 
 	if (log.fileSize >= m_maxFileSize)
 	{
@@ -252,6 +396,124 @@ bool cDeviceLogCSV::SaveData(p_data_hdr_t* dataHdr, const uint8_t* dataBuf)
 }
 
 
+void cDeviceLogCSV::StartWriters()
+{
+	for (uint32_t i = 0; i < m_writeThreads; i++)
+	{
+		m_writers.push_back(unique_ptr<sCsvWriter>(new sCsvWriter()));
+		sCsvWriter* writer = m_writers.back().get();
+		writer->batch.reserve(CSV_WRITE_BATCH_SIZE + CSV_RECORD_SIZE(sizeof(p_data_t)));
+		writer->writeThread = thread(&cDeviceLogCSV::RunWriter, this, writer);
+	}
+}
+
+
+// Write everything queued and join the writer threads
+void cDeviceLogCSV::StopWriters()
+{
+	for (size_t i = 0; i < m_writers.size(); i++)
+	{
+		sCsvWriter& writer = *m_writers[i];
+		if (!writer.batch.empty())
+		{
+			SubmitBatch(writer);
+		}
+		{
+			lock_guard<mutex> lock(writer.queueMutex);
+			writer.stop = true;
+		}
+		writer.cond.notify_all();
+		writer.writeThread.join();
+		m_logSize += writer.logSize;
+	}
+	m_writers.clear();
+}
+
+
+bool cDeviceLogCSV::QueueData(cCsvLog& log, uint32_t serialNumber, const p_data_hdr_t& dataHdr, const uint8_t* dataBuf)
+{
+	sCsvWriter& writer = *m_writers[log.writer];
+	sCsvRecord record;
+	record.log = &log;
+	record.orderId = m_nextId++;
+	record.serialNumber = serialNumber;
+	record.hdr = dataHdr;
+
+	size_t pos = writer.batch.size();
+	writer.batch.resize(pos + CSV_RECORD_SIZE(dataHdr.size));
+	memcpy(&writer.batch[pos], &record, sizeof(record));
+	memcpy(&writer.batch[pos + sizeof(record)], dataBuf, dataHdr.size);
+	writer.records++;
+
+	if (writer.batch.size() >= CSV_WRITE_BATCH_SIZE)
+	{
+		return SubmitBatch(writer);
+	}
+	return true;
+}
+
+
+// Hand the batch being filled to the writer thread, waits if CSV_WRITE_MAX_IN_FLIGHT batches are already queued
+bool cDeviceLogCSV::SubmitBatch(sCsvWriter& writer)
+{
+	bool failed;
+	{
+		unique_lock<mutex> lock(writer.queueMutex);
+		writer.cond.wait(lock, [&writer] { return writer.inFlight < CSV_WRITE_MAX_IN_FLIGHT; });
+		writer.jobs.push_back(vector<uint8_t>());
+		writer.jobs.back().swap(writer.batch);
+		writer.inFlight++;
+		if (!writer.freeBatches.empty())
+		{
+			writer.batch.swap(writer.freeBatches.back());
+			writer.freeBatches.pop_back();
+		}
+		m_logSize += writer.logSize;
+		writer.logSize = 0;
+		failed = writer.failed;
+	}
+	writer.cond.notify_all();
+	return !failed;
+}
+
+
+void cDeviceLogCSV::RunWriter(sCsvWriter* writer)
+{
+	unique_lock<mutex> lock(writer->queueMutex);
+	while (true)
+	{
+		writer->cond.wait(lock, [writer] { return writer->stop || !writer->jobs.empty(); });
+		if (writer->jobs.empty())
+		{	// stopped and everything written
+			break;
+		}
+		vector<uint8_t> batch;
+		batch.swap(writer->jobs.front());
+		writer->jobs.pop_front();
+		lock.unlock();
+
+		uint64_t logSize = 0;
+		bool ok = true;
+		for (size_t pos = 0; pos < batch.size(); )
+		{
+			sCsvRecord record;
+			memcpy(&record, &batch[pos], sizeof(record));
+			ok = WriteDataToFile(*record.log, writer->csv, record.serialNumber, record.orderId, record.hdr, &batch[pos + sizeof(record)], logSize) && ok;
+			pos += CSV_RECORD_SIZE(record.hdr.size);
+		}
+		batch.clear();
+
+		lock.lock();
+		writer->freeBatches.push_back(vector<uint8_t>());
+		writer->freeBatches.back().swap(batch);
+		writer->inFlight--;
+		writer->logSize += logSize;
+		writer->failed = writer->failed || !ok;
+		writer->cond.notify_all();
+	}
+}
+
+
 p_data_t* cDeviceLogCSV::ReadData()
 {
 
@@ -297,18 +559,17 @@ p_data_t* cDeviceLogCSV::ReadDataFromFile(cCsvLog& log)
 	}
 	m_dataBuffer.hdr.id = log.dataId;
 	m_dataBuffer.hdr.size = log.dataSize;
-	if (m_csv.StringCSVToData(log.nextLine, m_dataBuffer.hdr, m_dataBuffer.buf, _ARRAY_BYTE_COUNT(m_dataBuffer.buf), log.columnHeaders))
+	m_dataBuffer.hdr.offset = 0;
+	if (m_csv.LineCSVToData(log.readBuffer.data() + log.lineStart, log.lineLength, m_dataBuffer.hdr, m_dataBuffer.buf, _ARRAY_BYTE_COUNT(m_dataBuffer.buf), log.columnHeaders))
 	{
 		if (m_dataBuffer.hdr.id == DID_DEV_INFO)
 		{
 			memcpy(&m_devInfo, m_dataBuffer.buf, sizeof(dev_info_t));
 		}
-		log.nextLine.clear();
-		while (!GetNextLineForFile(log) && OpenNewFile(log, true)) {}
+		while (!GetNextLineForFile(log) && OpenNewFile(log)) {}
 		return &m_dataBuffer;
 	}
-	log.nextLine.clear();
-	while (!GetNextLineForFile(log) && OpenNewFile(log, true)) {}
+	while (!GetNextLineForFile(log) && OpenNewFile(log)) {}
 	return NULL;
 }
 
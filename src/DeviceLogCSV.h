@@ -17,15 +17,22 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 
 #include "DataCSV.h"
 #include "DeviceLog.h"
 #include "com_manager.h"
 
+#define CSV_READ_BUFFER_SIZE	(128 * 1024)
+#define CSV_WRITE_BATCH_SIZE	(64 * 1024)		// bytes of data sets handed to a writer thread at once
+#define CSV_WRITE_MAX_IN_FLIGHT	4				// batches queued per writer thread before SaveData waits
+
+struct sCsvWriter;
+
 class cCsvLog
 {
 public:
-	cCsvLog() : pFile(NULL), fileCount(0), fileSize(0), dataId(0), orderId(0) { }
+	cCsvLog() : pFile(NULL), fileCount(0), fileSize(0), dataId(0), orderId(0), writer(0), readPos(0), readEnd(0), lineStart(0), lineLength(0) { }
 
 	FILE* pFile;
 	uint32_t fileCount;
@@ -33,14 +40,27 @@ public:
 	uint32_t dataId;
 	uint32_t dataSize;
 	uint64_t orderId;
-	std::string nextLine;
+	uint32_t writer;		// writer thread that owns this file when writing with threads
 	std::vector<data_info_t> columnHeaders;
+
+	// Lines are parsed in place from the read buffer
+	std::vector<char> readBuffer;
+	size_t readPos;			// start of unread data in readBuffer
+	size_t readEnd;			// end of valid data in readBuffer
+	size_t lineStart;		// next line in readBuffer
+	size_t lineLength;		// 0 if no next line
 };
 
 
+/**
+* Writes one csv file per data set.  With SetWriteThreads(n > 1) each data set is assigned to one of n writer threads, 
+* which format and write its file in the order the data was saved.  SaveData only queues the data in that case.
+*/
 class cDeviceLogCSV : public cDeviceLog
 {
 public:
+	cDeviceLogCSV();
+	~cDeviceLogCSV();
 	void InitDeviceForWriting(int pHandle, std::string timestamp, std::string directory, uint64_t maxDiskSpace, uint32_t maxFileSize) OVERRIDE;
 	void InitDeviceForReading() OVERRIDE;
 	bool CloseAllFiles() OVERRIDE;
@@ -50,8 +70,17 @@ public:
 	std::string LogFileExtention() OVERRIDE { return std::string(".csv"); }
 
 private:
-	bool OpenNewFile(cCsvLog& log, bool readOnly);
+	bool OpenNewFile(cCsvLog& log);
+	bool OpenNewWriteFile(cCsvLog& log, cDataCSV& csv, uint32_t serialNumber, uint64_t& logSize);
 	bool GetNextLineForFile(cCsvLog& log);
+	bool WriteDataToFile(cCsvLog& log, cDataCSV& csv, uint32_t serialNumber, uint64_t orderId, const p_data_hdr_t& dataHdr, const uint8_t* dataBuf, uint64_t& logSize);
+
+	// Writer threads
+	void StartWriters();
+	void StopWriters();
+	bool QueueData(cCsvLog& log, uint32_t serialNumber, const p_data_hdr_t& dataHdr, const uint8_t* dataBuf);
+	bool SubmitBatch(sCsvWriter& writer);
+	void RunWriter(sCsvWriter* writer);
 
 	p_data_t* ReadDataFromFile(cCsvLog& log);
 	std::map<uint32_t, cCsvLog> m_logs;
@@ -60,6 +89,7 @@ private:
 	std::map<uint32_t, uint32_t> m_currentFileIndex; // contains the current csv file index for each data set
 	p_data_t m_dataBuffer;
 	uint64_t m_nextId; // for writing the log, column 0 of csv is an incrementing id. This lets us read the log back in order.
+	std::vector<std::unique_ptr<sCsvWriter> > m_writers;
 };
 
 #endif // DEVICE_LOG_CSV_H
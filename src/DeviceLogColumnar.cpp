@@ -0,0 +1,342 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <climits>
+
+#include "DeviceLogColumnar.h"
+#include "ISFileManager.h"
+#include "ISDataMappings.h"
+
+using namespace std;
+
+
+void cDeviceLogColumnar::InitDeviceForWriting(int pHandle, std::string timestamp, std::string directory, uint64_t maxDiskSpace, uint32_t maxFileSize)
+{
+	m_logs.clear();
+	m_nextId = 0;
+	cDeviceLog::InitDeviceForWriting(pHandle, timestamp, directory, maxDiskSpace, maxFileSize);
+}
+
+
+void cDeviceLogColumnar::InitDeviceForReading()
+{
+	cDeviceLog::InitDeviceForReading();
+
+	// Create a list of files for each possible data set
+	m_logs.clear();
+	m_currentFiles.clear();
+	m_currentFileIndex.clear();
+	for (uint32_t id = DID_NULL + 1; id < DID_COUNT; id++)
+	{
+		const char* dataSet = cISDataMappings::GetDataSetName(id);
+		if (dataSet != NULL)
+		{
+			string dataSetRegex = string("_[0-9]{4}_") + dataSet + "\\.icol$";
+			if (m_devInfo.serialNumber > 0 && m_devInfo.serialNumber < 4294967295)	// < 0xFFFFFFFF
+			{	// Include serial number if valid
+				dataSetRegex = "LOG_SN" + to_string(m_devInfo.serialNumber) + ".*?" + dataSetRegex;
+			}
+			vector<ISFileManager::file_info_t> infos;
+			vector<string> files;
+			ISFileManager::GetDirectorySpaceUsed(m_directory, dataSetRegex, infos, false, false);
+			if (infos.size() != 0)
+			{
+				cColumnarLog log;
+				log.dataId = id;
+				for (size_t i = 0; i < infos.size(); i++)
+				{
+					files.push_back(infos[i].name);
+				}
+				m_currentFiles[id] = files;
+				m_currentFileIndex[id] = 0;
+				if (OpenNewFile(log, true) && GetNextRowForFile(log))
+				{
+					m_logs[id] = log;
+				}
+				else if (log.pFile)
+				{
+					fclose(log.pFile);
+				}
+			}
+		}
+	}
+}
+
+
+bool cDeviceLogColumnar::CloseAllFiles()
+{
+	cDeviceLog::CloseAllFiles();
+
+	for (map<uint32_t, cColumnarLog>::iterator i = m_logs.begin(); i != m_logs.end(); i++)
+	{
+		cColumnarLog& log = i->second;
+		if (m_writeMode)
+		{
+			WriteRowGroup(log);
+		}
+		if (log.pFile)
+		{
+			fclose(log.pFile);
+			log.pFile = NULL;
+		}
+	}
+	m_logs.clear();
+	return true;
+}
+
+
+bool cDeviceLogColumnar::FlushToFile()
+{
+	if (!m_writeMode)
+	{
+		return false;
+	}
+
+	for (map<uint32_t, cColumnarLog>::iterator i = m_logs.begin(); i != m_logs.end(); i++)
+	{
+		WriteRowGroup(i->second);
+		if (i->second.pFile)
+		{
+			fflush(i->second.pFile);
+		}
+	}
+	return true;
+}
+
+
+bool cDeviceLogColumnar::OpenNewFile(cColumnarLog& log, bool readonly)
+{
+	const char* dataSetName = cISDataMappings::GetDataSetName(log.dataId);
+	if (dataSetName == NULL || m_directory.empty())
+	{
+		return false;
+	}
+
+	// Close existing file
+	if (log.pFile)
+	{
+		fclose(log.pFile);
+		log.pFile = NULL;
+	}
+
+	string fileName;
+	if (readonly)
+	{
+		// Skip files without a valid header
+		vector<string>& files = m_currentFiles[log.dataId];
+		uint32_t& index = m_currentFileIndex[log.dataId];
+		while (log.pFile == NULL && index < files.size())
+		{
+			fileName = files[index++];
+			log.pFile = fopen(fileName.c_str(), "rb");
+			log.fileCount++;
+			if (log.pFile == NULL)
+			{
+				continue;
+			}
+			uint32_t dataId;
+			int headerSize = m_columnar.ReadHeaderFromFile(log.pFile, dataId, log.dataSize, log.columns);
+			if (headerSize == 0 || dataId != log.dataId || log.dataSize > MAX_DATASET_SIZE)
+			{
+				fclose(log.pFile);
+				log.pFile = NULL;
+				continue;
+			}
+			log.fileSize = headerSize;
+			m_logSize += headerSize;
+		}
+	}
+	else
+	{
+		_MKDIR(m_directory.c_str());
+
+		uint32_t serNum = m_devInfo.serialNumber;
+		if (!serNum)
+		{
+			serNum = m_pHandle;
+		}
+
+		log.fileCount++;
+		fileName = GetNewFileName(serNum, log.fileCount, dataSetName);
+		log.pFile = fopen(fileName.c_str(), "wb");
+
+		// Write header
+		int fileBytes = m_columnar.WriteHeaderToFile(log.pFile, log.dataId, log.dataSize, log.columns);
+		log.fileSize = fileBytes;
+		m_logSize += fileBytes;
+	}
+
+	if (log.pFile)
+	{
+#if LOG_DEBUG_FILE_WRITE
+		printf("cDeviceLogColumnar::OpenNewFile %s %s\n", (readonly?"read":"write"), fileName.c_str());
+#endif
+		return true;
+	}
+	else
+	{
+#if LOG_DEBUG_FILE_WRITE
+		printf("cDeviceLogColumnar::OpenNewFile FAILED to open file: %s\n", fileName.c_str());
+#endif
+		return false;
+	}
+}
+
+
+bool cDeviceLogColumnar::WriteRowGroup(cColumnarLog& log)
+{
+	if (log.orderIds.empty())
+	{
+		return true;
+	}
+
+	// Create file if it doesn't exist
+	if (log.pFile == NULL && !OpenNewFile(log, false))
+	{
+		return false;
+	}
+
+	int nBytes = m_columnar.WriteRowGroupToFile(log.pFile, log.columns, log.dataSize, log.orderIds, log.rows);
+	log.orderIds.clear();
+	log.rows.clear();
+	if (nBytes <= 0)
+	{
+		return false;
+	}
+
+	// File byte size
+	log.fileSize += nBytes;
+	m_logSize += nBytes;
+
+	if (log.fileSize >= m_maxFileSize)
+	{
+		// Close existing file
+		fclose(log.pFile);
+		log.pFile = NULL;
+		log.fileSize = 0;
+	}
+
+	return true;
+}
+
+
+bool cDeviceLogColumnar::SaveData(p_data_hdr_t* dataHdr, const uint8_t* dataBuf)
+{
+	cDeviceLog::SaveData(dataHdr, dataBuf);
+
+	if (dataHdr->id == DID_DEV_INFO)
+	{
+		copyDataPToStructP2(&m_devInfo, dataHdr, dataBuf, sizeof(dev_info_t));
+	}
+
+	// Reference current log
+	cColumnarLog& log = m_logs[dataHdr->id];
+	if (log.columns.empty())
+	{
+		log.dataId = dataHdr->id;
+		log.dataSize = cISDataMappings::GetSize(log.dataId);
+		if (!cDataColumnar::GetColumns(log.dataId, log.columns))
+		{	// Data set has no mapping, nothing to write
+			return true;
+		}
+	}
+
+	// Buffer the row, fields outside of a partial data set are zero
+	size_t rowStart = log.rows.size();
+	log.rows.resize(rowStart + log.dataSize, 0);
+	if (dataHdr->offset < log.dataSize)
+	{
+		memcpy(log.rows.data() + rowStart + dataHdr->offset, dataBuf, _MIN(dataHdr->size, log.dataSize - dataHdr->offset));
+	}
+	log.orderIds.push_back(m_nextId++);
+
+	if (log.rows.size() >= COLUMNAR_ROW_GROUP_MAX_BYTES || log.orderIds.size() >= COLUMNAR_ROW_GROUP_MAX_ROWS)
+	{
+		return WriteRowGroup(log);
+	}
+
+	return true;
+}
+
+
+bool cDeviceLogColumnar::GetNextRowForFile(cColumnarLog& log)
+{
+	while (log.rowIndex >= log.rowCount)
+	{
+		log.rowIndex = 0;
+		log.rowCount = m_columnar.ReadRowGroupFromFile(log.pFile, log.columns, log.buffer, log.columnStart);
+		if (log.rowCount == 0 && !OpenNewFile(log, true))
+		{
+			return false;
+		}
+	}
+
+	// Order id is column 0
+	memcpy(&log.orderId, log.buffer.data() + log.columnStart[0] + (size_t)log.rowIndex * sizeof(uint64_t), sizeof(uint64_t));
+	return true;
+}
+
+
+p_data_t* cDeviceLogColumnar::ReadData()
+{
+	// Next row is the lowest order id of all data sets
+	cColumnarLog* nextLog = NULL;
+	uint64_t nextId = ULLONG_MAX;
+	for (map<uint32_t, cColumnarLog>::iterator i = m_logs.begin(); i != m_logs.end(); i++)
+	{
+		if (i->second.orderId < nextId || nextLog == NULL)
+		{
+			nextLog = &i->second;
+			nextId = i->second.orderId;
+		}
+	}
+	if (nextLog == NULL)
+	{
+		return NULL;
+	}
+
+	cColumnarLog& log = *nextLog;
+	m_dataBuffer.hdr.id = log.dataId;
+	m_dataBuffer.hdr.size = log.dataSize;
+	m_dataBuffer.hdr.offset = 0;
+	memset(m_dataBuffer.buf, 0, log.dataSize);
+	cDataColumnar::ColumnsToData(log.columns, log.buffer, log.columnStart, log.rowIndex++, m_dataBuffer.buf, log.dataSize);
+
+	if (m_dataBuffer.hdr.id == DID_DEV_INFO)
+	{
+		memcpy(&m_devInfo, m_dataBuffer.buf, _MIN(sizeof(dev_info_t), log.dataSize));
+	}
+
+	if (!GetNextRowForFile(log))
+	{	// No more data for this data set
+		if (log.pFile)
+		{
+			fclose(log.pFile);
+		}
+		uint32_t dataId = log.dataId;
+		m_logs.erase(dataId);
+	}
+
+	cDeviceLog::OnReadData(&m_dataBuffer);
+	return &m_dataBuffer;
+}
+
+
+void cDeviceLogColumnar::SetSerialNumber(uint32_t serialNumber)
+{
+	m_devInfo.serialNumber = serialNumber;
+}
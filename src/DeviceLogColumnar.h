@@ -0,0 +1,80 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef DEVICE_LOG_COLUMNAR_H
+#define DEVICE_LOG_COLUMNAR_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "DataColumnar.h"
+#include "DeviceLog.h"
+#include "com_manager.h"
+
+class cColumnarLog
+{
+public:
+	cColumnarLog() : pFile(NULL), fileCount(0), fileSize(0), dataId(0), dataSize(0), rowCount(0), rowIndex(0), orderId(0) { }
+
+	FILE* pFile;
+	uint32_t fileCount;
+	uint64_t fileSize;
+	uint32_t dataId;
+	uint32_t dataSize;
+	std::vector<sColumnarColumn> columns;
+
+	// Writing, rows buffered until a row group is written
+	std::vector<uint64_t> orderIds;
+	std::vector<uint8_t> rows;
+
+	// Reading, the current row group
+	std::vector<uint8_t> buffer;
+	std::vector<size_t> columnStart;
+	uint32_t rowCount;
+	uint32_t rowIndex;
+	uint64_t orderId;		// order id of the next row
+};
+
+
+/**
+* Columnar log, one file per data set with one typed column per mapped field, written in row groups.  See DataColumnar.h 
+* for the file layout.
+*/
+class cDeviceLogColumnar : public cDeviceLog
+{
+public:
+	void InitDeviceForWriting(int pHandle, std::string timestamp, std::string directory, uint64_t maxDiskSpace, uint32_t maxFileSize) OVERRIDE;
+	void InitDeviceForReading() OVERRIDE;
+	bool CloseAllFiles() OVERRIDE;
+	bool FlushToFile() OVERRIDE;
+	bool SaveData(p_data_hdr_t* dataHdr, const uint8_t* dataBuf) OVERRIDE;
+	p_data_t* ReadData() OVERRIDE;
+	void SetSerialNumber(uint32_t serialNumber) OVERRIDE;
+	std::string LogFileExtention() OVERRIDE { return std::string(".icol"); }
+
+private:
+	bool OpenNewFile(cColumnarLog& log, bool readOnly);
+	bool WriteRowGroup(cColumnarLog& log);
+	bool GetNextRowForFile(cColumnarLog& log);
+
+	std::map<uint32_t, cColumnarLog> m_logs;
+	cDataColumnar m_columnar;
+	std::map<uint32_t, std::vector<std::string> > m_currentFiles; // all files for each data set
+	std::map<uint32_t, uint32_t> m_currentFileIndex; // contains the current file index for each data set
+	p_data_t m_dataBuffer;
+	uint64_t m_nextId; // for writing the log, column 0 is an incrementing id.  This lets us read the log back in order.
+};
+
+#endif // DEVICE_LOG_COLUMNAR_H
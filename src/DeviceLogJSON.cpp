@@ -48,39 +48,62 @@ bool cDeviceLogJSON::CloseAllFiles()
 
 bool cDeviceLogJSON::GetNextItemForFile()
 {
-	m_jsonString.clear();
+	m_itemLength = 0;
 	if (m_pFile == NULLPTR)
 	{
 		return false;
 	}
 	int stack = 0;
-	int pc = 0;
-	int i;
-	while ((i = m_pFile->getch()) != EOF)
+	char pc = 0;
+	size_t itemStart = 0;
+	size_t i = m_readPos;
+	while (true)
 	{
-		char c = (char)i;
-		if (c == '{' && pc != '\\')
+		if (i == m_readEnd)
 		{
-			stack++;
+			// Keep the partial object, move it to the start of the buffer and read more
+			size_t keep = (stack != 0 ? itemStart : i);
+			if (keep != 0)
+			{
+				memmove(m_readBuffer.data(), m_readBuffer.data() + keep, m_readEnd - keep);
+				m_readEnd -= keep;
+				itemStart -= _MIN(itemStart, keep);
+				i -= keep;
+			}
+			if (m_readBuffer.size() < m_readEnd + JSON_READ_BUFFER_SIZE / 2)
+			{
+				m_readBuffer.resize(_MAX(m_readBuffer.size() * 2, (size_t)JSON_READ_BUFFER_SIZE));
+			}
+			size_t count = m_pFile->read(m_readBuffer.data() + m_readEnd, m_readBuffer.size() - m_readEnd);
+			if (count == 0)
+			{	// end of file, drop any partial object
+				m_readPos = m_readEnd = 0;
+				return false;
+			}
+			m_readEnd += count;
 		}
-		else if (c == '}' && pc != '\\')
+
+		char c = m_readBuffer[i];
+		if (c == '{' && pc != '\\')
 		{
-			stack--;
-			if (stack == 0)
+			if (stack++ == 0)
 			{
-                m_jsonString.append(1, c);
-				break;
+				itemStart = i;
 			}
 		}
-
-        if (stack != 0)
+		else if (c == '}' && pc != '\\' && stack != 0)
 		{
-			m_jsonString.append(1, c);
+			if (--stack == 0)
+			{
+				m_itemStart = itemStart;
+				m_itemLength = i + 1 - itemStart;
+				m_readPos = i + 1;
+				return true;
+			}
 		}
-
 		pc = c;
+		i++;
 	}
-	return (m_jsonString.size() != 0);
 }
 
 
@@ -150,7 +173,7 @@ p_data_t* cDeviceLogJSON::ReadDataFromFile()
 		return NULLPTR;
 	}
     while (!GetNextItemForFile() && OpenNextReadFile()) {}
-	if (m_json.StringJSONToData(m_jsonString, m_dataBuffer.hdr, m_dataBuffer.buf, _ARRAY_BYTE_COUNT(m_dataBuffer.buf)))
+	if (m_itemLength != 0 && m_json.ObjectJSONToData(m_readBuffer.data() + m_itemStart, m_itemLength, m_dataBuffer.hdr, m_dataBuffer.buf, _ARRAY_BYTE_COUNT(m_dataBuffer.buf)))
 	{
 		if (m_dataBuffer.hdr.id == DID_DEV_INFO)
 		{
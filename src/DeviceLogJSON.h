@@ -22,9 +22,12 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "DeviceLog.h"
 #include "com_manager.h"
 
+#define JSON_READ_BUFFER_SIZE	(128 * 1024)
+
 class cDeviceLogJSON : public cDeviceLog
 {
 public:
+	cDeviceLogJSON() : m_readPos(0), m_readEnd(0), m_itemStart(0), m_itemLength(0) {}
 	bool CloseAllFiles() OVERRIDE;
     bool SaveData(p_data_hdr_t* dataHdr, const uint8_t* dataBuf) OVERRIDE;
 	p_data_t* ReadData() OVERRIDE;
@@ -35,8 +38,14 @@ private:
 	bool GetNextItemForFile();
 
 	p_data_t* ReadDataFromFile();
-	std::string m_jsonString;
 	cDataJSON m_json;
+
+	// Objects are parsed in place from the read buffer
+	std::vector<char> m_readBuffer;
+	size_t m_readPos;		// start of unread data in m_readBuffer
+	size_t m_readEnd;		// end of valid data in m_readBuffer
+	size_t m_itemStart;		// next json object in m_readBuffer
+	size_t m_itemLength;
 	p_data_t m_dataBuffer;
 };
 
@@ -25,14 +25,66 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "DeviceLogKML.h"
 #include "ISLogger.h"
 #include "ISConstants.h"
+#include "ISFileManager.h"
 
 using namespace std;
 
+#define BUF_SIZE	100
+
+static const char* kmlPointStyleId = "stylesel_";
+
+// colors are ABGR
+static void kmlStyle(int kid, const char* &colorStr, const char* &colorDrStr, const char* &iconUrl)
+{
+	colorStr = "";
+	colorDrStr = "ff00a5ff";	// orange
+	iconUrl = "http://maps.google.com/mapfiles/kml/shapes/shaded_dot.png";
+	// 		iconUrl = "http://earth.google.com/images/kml-icons/track-directional/track-none.png";
+
+	switch (kid)
+	{
+	case cDataKML::KID_INS:
+		iconUrl = "http://earth.google.com/images/kml-icons/track-directional/track-0.png";
+		colorStr = "ff00ffff";  	// yellow
+		colorDrStr = "ff00a5ff";	// orange
+		break;
+	case cDataKML::KID_GPS:
+		colorStr = "ff0000ff";  // red
+		break;
+	case cDataKML::KID_GPS1:
+		colorStr = "ffff0000";  // blue
+		break;
+    case cDataKML::KID_RTK:
+		colorStr = "ffffff00";  // cyan
+        break;
+	case cDataKML::KID_REF:
+		iconUrl = "http://earth.google.com/images/kml-icons/track-directional/track-0.png";
+		colorStr = "ffff00ff";  	// magenta
+		colorDrStr = "ffcd00cd";	// tinted magenta
+		break;
+	}
+}
+
+static int kmlCoordinates(char* buf, const sKmlLogData& item, const char* suffix)
+{
+	double lat = _CLAMP(item.lla[0] * DEG2RADMULT, -C_PIDIV2, C_PIDIV2) * RAD2DEGMULT;
+	double lon = _CLAMP(item.lla[1] * DEG2RADMULT, -C_PI, C_PI) * RAD2DEGMULT;
+	double alt = _CLAMP(item.lla[2], -1000, 100000);
+	return snprintf(buf, BUF_SIZE, "%.8lf,%.8lf,%.3lf%s", lon, lat, alt, suffix);
+}
+
+
+cDeviceLogKML::~cDeviceLogKML()
+{
+	CloseAllFiles();
+}
+
+
 void cDeviceLogKML::InitDeviceForWriting(int pHandle, std::string timestamp, std::string directory, uint64_t maxDiskSpace, uint32_t maxFileSize)
 {
 	for (int kid=0; kid<cDataKML::MAX_NUM_KID; kid++ )
 	{
-		m_Log[kid].data.clear();
+		m_Log[kid].file.Close();
 		m_Log[kid].fileName.clear();
 		m_Log[kid].fileCount = 0;
 		m_Log[kid].fileDataSize = 0;
@@ -58,15 +110,8 @@ bool cDeviceLogKML::CloseAllFiles()
 }
 
 
-bool cDeviceLogKML::CloseWriteFile(int kid, sKmlLog &log)
+bool cDeviceLogKML::OpenNewSaveFile(int kid, sKmlLog &log, const sKmlLogData& first)
 {
-	// Ensure we have data
-	int64_t dataSize = (int64_t)log.data.size();
-	if (dataSize <= 0)
-	{
-		return false;
-	}
-
 	// Ensure directory exists
 	if (m_directory.empty())
 	{
@@ -105,324 +150,421 @@ bool cDeviceLogKML::CloseWriteFile(int kid, sKmlLog &log)
 	}
 
 	log.fileName = GetNewFileName(serNum, log.fileCount, m_kml.GetDatasetName(kid).c_str());
+	if (!log.file.Open(log.fileName, m_kmlCompress && cKmlFile::KmzSupported()))
+	{
+		return false;
+	}
 
-#define BUF_SIZE	100
-	char buf[BUF_SIZE];
-	int styleCnt = 1;
-	string altitudeMode;
-	string iconScale = "0.5";
-	string labelScale = "0.5";
-	string iconUrl;
-
-	if (m_showPointTimestamps)
-		labelScale = "0.5";
-	else
-		labelScale = "0.01";
-
-	// Altitude mode
-	if(m_altClampToGround)
-		altitudeMode = "clampToGround";
-	else
-		altitudeMode = "absolute";
+	log.styleKid = kid;
+	log.fileSize = 0;
+	log.styleCnt = 1;
+	log.pointDeadReckoning = first.deadReckoning;
+	log.pointNextTime = first.time;
+	log.trackSegments.clear();
+	log.trackActive = false;
+	log.tracksNum = 0;
+	log.window.clear();
 
-	// Style
-	string styleStr, colorStr, colorDrStr = "ff00a5ff";	// orange
+	// Add XML version info and document
+	log.file.Write(
+		"<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"
+		"<kml xmlns=\"http://www.opengis.net/kml/2.2\" xmlns:gx=\"http://www.google.com/kml/ext/2.2\">\n");
+	log.file.Write((m_showPoints || m_showTracks) ? "    <Document>\n" : "    <Document />\n");
 
-	iconUrl = "http://maps.google.com/mapfiles/kml/shapes/shaded_dot.png";
-	// 		iconUrl = "http://earth.google.com/images/kml-icons/track-directional/track-none.png";
+	// Tracks follow the points in the document, so stage track coordinates until the file is closed
+	if (m_showPoints && m_showTracks)
+	{
+		log.trackFileName = log.fileName + ".tracks";
+		if (!log.trackFile.Open(log.trackFileName))
+		{
+			return false;
+		}
+	}
 
-	// colors are ABGR
-	switch (kid)
+	// Sample (dot) style
+	if (m_showPoints)
 	{
-	case cDataKML::KID_INS:
-		iconUrl = "http://earth.google.com/images/kml-icons/track-directional/track-0.png";
-		colorStr = "ff00ffff";  	// yellow
-		colorDrStr = "ff00a5ff";	// orange
-		break;
-	case cDataKML::KID_GPS:
-		colorStr = "ff0000ff";  // red
-		break;
-	case cDataKML::KID_GPS1:
-		colorStr = "ffff0000";  // blue
-		break;
-    case cDataKML::KID_RTK:
-		colorStr = "ffffff00";  // cyan
-        break;
-	case cDataKML::KID_REF:
-		iconUrl = "http://earth.google.com/images/kml-icons/track-directional/track-0.png";
-		colorStr = "ffff00ff";  	// magenta
-		colorDrStr = "ffcd00cd";	// tinted magenta
-		break;
+		const char *colorStr, *colorDrStr, *iconUrl;
+		kmlStyle(log.styleKid, colorStr, colorDrStr, iconUrl);
+
+		log.file.Write("        <Style id=\"");
+		log.file.Write(kmlPointStyleId);
+		log.file.Write("\">\n"
+			"            <IconStyle>\n"
+			"                <color>");
+		log.file.Write(log.pointDeadReckoning ? colorDrStr : colorStr);
+		log.file.Write("</color>\n"
+			"                <colorMode>normal</colorMode>\n"
+			"                <scale>0.5</scale>\n"
+			"                <heading>0</heading>\n"
+			"                <Icon>\n"
+			"                    <href>");
+		log.file.Write(iconUrl);
+		log.file.Write("</href>\n"
+			"                </Icon>\n"
+			"            </IconStyle>\n"
+			"            <LabelStyle>\n"
+			"                <colorMode>normal</colorMode>\n"
+			"                <scale>");
+		log.file.Write(m_showPointTimestamps ? "0.5" : "0.01");
+		log.file.Write("</scale>\n"
+			"            </LabelStyle>\n"
+			"        </Style>\n");
 	}
 
-	// Add XML version info and document
-	TiXmlElement
-		*Style, *LineStyle, *IconStyle, *LabelStyle,
-		*Placemark, *Point, *LineString,
-		*heading,
-		*elem, *href;
+	return true;
+}
+
 
-	TiXmlDocument tDoc;
+bool cDeviceLogKML::CloseWriteFile(int kid, sKmlLog &log)
+{
+	(void)kid;
 
-	TiXmlDeclaration* decl = new TiXmlDeclaration("1.0", "UTF-8", "");
-	tDoc.LinkEndChild(decl);
+	// Ensure we have data
+	if (!log.file.IsOpen())
+	{
+		return false;
+	}
 
-	TiXmlElement* kml = new TiXmlElement("kml");
-	tDoc.LinkEndChild(kml);
+	EndTrack(log);
 
-	TiXmlElement* Document = new TiXmlElement("Document");
-	kml->LinkEndChild(Document);
-	kml->SetAttribute("xmlns", "http://www.opengis.net/kml/2.2");
-	kml->SetAttribute("xmlns:gx", "http://www.google.com/kml/ext/2.2");
+	bool success = true;
+	if (log.trackFile.IsOpen())
+	{
+		success = CopyTracks(log);
+	}
 
-	// Show sample (dot)
-	if (m_showPoints)
+	if (m_showPoints || m_showTracks)
 	{
-		int tracksNum = 0;
+		log.file.Write("    </Document>\n");
+	}
+	log.file.Write("</kml>\n");
 
-		double nextTime = log.data[0].time;
-		for (size_t i = 0; i < log.data.size(); )
-		{
-			bool deadReckoning = log.data[i].deadReckoning;
+	if (!log.file.Close())
+	{
+		success = false;
+	}
+	log.fileSize = 0;
+	log.trackSegments.clear();
+	log.window.clear();
+	log.window.shrink_to_fit();
 
-			// Style
-			styleStr = string("stylesel_");
+	return success;
+}
 
-			Style = new TiXmlElement("Style");
-			Style->SetAttribute("id", styleStr);
-			Document->LinkEndChild(Style);
 
-			// Icon style
-			IconStyle = new TiXmlElement("IconStyle");
-			Style->LinkEndChild(IconStyle);
+void cDeviceLogKML::WritePoint(sKmlLog& log, const sKmlLogData& item)
+{
+	// Log only every iconUpdatePeriodSec
+	if (item.time < log.pointNextTime)
+	{
+		return;
+	}
+	log.pointNextTime = item.time - fmod(item.time, m_pointUpdatePeriodSec) + m_pointUpdatePeriodSec;
 
-			elem = new TiXmlElement("color");
-			elem->LinkEndChild(new TiXmlText((deadReckoning ? colorDrStr : colorStr)));
-			IconStyle->LinkEndChild(elem);
+	char buf[BUF_SIZE];
 
-			elem = new TiXmlElement("colorMode");
-			elem->LinkEndChild(new TiXmlText("normal"));
-			IconStyle->LinkEndChild(elem);
+	// Placemark
+	log.file.Write("        <Placemark>\n"
+		"            <name>");
+	switch (log.styleKid)
+	{
+	case cDataKML::KID_GPS:
+	case cDataKML::KID_GPS1:
+	case cDataKML::KID_GPS2:
+	case cDataKML::KID_RTK:
+		log.file.Write(buf, snprintf(buf, BUF_SIZE, "%.1f", item.time));
+		break;
+	default:
+		log.file.Write(buf, snprintf(buf, BUF_SIZE, "%.3f", item.time));
+		break;
+	}
+	log.file.Write("</name>\n"
+		"            <styleUrl>#");
+	log.file.Write(kmlPointStyleId);
 
-			elem = new TiXmlElement("scale");
-			elem->LinkEndChild(new TiXmlText(iconScale));
-			IconStyle->LinkEndChild(elem);
+	// Style - to indicate heading
+	int headingStyle = 0;
+	if (item.theta[2] != 0.0f)
+	{
+		headingStyle = log.styleCnt++;
+		log.file.Write(buf, snprintf(buf, BUF_SIZE, "%d", headingStyle));
+	}
 
-			heading = new TiXmlElement("heading");
-			heading->LinkEndChild(new TiXmlText("0"));
-			IconStyle->LinkEndChild(heading);
+	log.file.Write("</styleUrl>\n"
+		"            <Point>\n"
+		"                <coordinates>");
+	log.file.Write(buf, kmlCoordinates(buf, item, ""));
+	log.file.Write("</coordinates>\n"
+		"                <altitudeMode>");
+	log.file.Write(m_altClampToGround ? "clampToGround" : "absolute");
+	log.file.Write("</altitudeMode>\n"
+		"            </Point>\n"
+		"        </Placemark>\n");
+
+	if (headingStyle)
+	{
+		const char *colorStr, *colorDrStr, *iconUrl;
+		kmlStyle(log.styleKid, colorStr, colorDrStr, iconUrl);
+		float heading = item.theta[2] * C_RAD2DEG_F;
+
+		log.file.Write("        <Style id=\"");
+		log.file.Write(kmlPointStyleId);
+		log.file.Write(buf, snprintf(buf, BUF_SIZE, "%d", headingStyle));
+		log.file.Write("\">\n"
+			"            <IconStyle>\n"
+			"                <color>");
+		log.file.Write(log.pointDeadReckoning ? colorDrStr : colorStr);
+		log.file.Write("</color>\n"
+			"                <colorMode>normal</colorMode>\n"
+			"                <scale>0.5</scale>\n"
+			"                <heading>");
+		log.file.Write(buf, snprintf(buf, BUF_SIZE, "%f", heading));
+		log.file.Write("</heading>\n"
+			"                <Icon>\n"
+			"                    <href>");
+		log.file.Write(iconUrl);
+		log.file.Write("</href>\n"
+			"                </Icon>\n"
+			"            </IconStyle>\n"
+			"            <LabelStyle>\n"
+			"                <colorMode>normal</colorMode>\n"
+			"                <scale>");
+		log.file.Write(m_showPointTimestamps ? "0.5" : "0.01");
+		log.file.Write("</scale>\n"
+			"            </LabelStyle>\n"
+			"        </Style>\n");
+	}
+}
 
-			href = new TiXmlElement("href");
-			href->LinkEndChild(new TiXmlText(iconUrl));
-			elem = new TiXmlElement("Icon");
-			elem->LinkEndChild(href);
-			IconStyle->LinkEndChild(elem);
 
-			// Label style
-			LabelStyle = new TiXmlElement("LabelStyle");
-			Style->LinkEndChild(LabelStyle);
+void cDeviceLogKML::WriteTrackStart(cKmlFile& file, sKmlLog& log, bool deadReckoning)
+{
+	const char *colorStr, *colorDrStr, *iconUrl;
+	kmlStyle(log.styleKid, colorStr, colorDrStr, iconUrl);
+	string styleStr = string(kmlPointStyleId) + to_string(log.styleCnt++);
+
+	// Track style
+	file.Write("        <Style id=\"" + styleStr + "\">\n"
+		"            <LineStyle>\n"
+		"                <color>");
+	file.Write(deadReckoning ? colorDrStr : colorStr);
+	file.Write("</color>\n"
+		"                <colorMode>normal</colorMode>\n"
+		"                <width>2</width>\n"
+		"            </LineStyle>\n"
+		"        </Style>\n");
+
+	// Track
+	file.Write("        <Placemark>\n"
+		"            <name>Tracks" + to_string(log.tracksNum++) + "</name>\n"
+		"            <description>SN tracks</description>\n"
+		"            <styleUrl>#" + styleStr + "</styleUrl>\n"
+		"            <LineString>\n"
+		"                <coordinates>");
+}
 
-			elem = new TiXmlElement("colorMode");
-			elem->LinkEndChild(new TiXmlText("normal"));
-			LabelStyle->LinkEndChild(elem);
 
-			elem = new TiXmlElement("scale");
-			elem->LinkEndChild(new TiXmlText(labelScale));
-			LabelStyle->LinkEndChild(elem);
+void cDeviceLogKML::WriteTrackEnd(cKmlFile& file)
+{
+	file.Write("</coordinates>\n"
+		"                <extrude>1</extrude>\n"
+		"                <altitudeMode>");
+	file.Write(m_altClampToGround ? "clampToGround" : "absolute");
+	file.Write("</altitudeMode>\n"
+		"            </LineString>\n"
+		"        </Placemark>\n");
+}
 
-			while (i < log.data.size())
-			{
-				sKmlLogData& item = (log.data[i]);
-
-				// Log only every iconUpdatePeriodSec
-				if (item.time < nextTime)
-				{
-					i++;
-					continue;
-				}
-				nextTime = item.time - fmod(item.time, m_pointUpdatePeriodSec) + m_pointUpdatePeriodSec;
-
-				// Placemark
-				Placemark = new TiXmlElement("Placemark");
-				Document->LinkEndChild(Placemark);
-
-				// Name
-				elem = new TiXmlElement("name");
-				ostringstream timeStream;
-				switch (kid)
-				{
-				case cDataKML::KID_GPS:
-				case cDataKML::KID_GPS1:
-				case cDataKML::KID_GPS2:
-				case cDataKML::KID_RTK:
-					timeStream << fixed << setprecision(1) << item.time;
-					break;
-				default:
-					timeStream << fixed << setprecision(3) << item.time;
-					break;
-				}
-				elem->LinkEndChild(new TiXmlText(timeStream.str()));
-				Placemark->LinkEndChild(elem);
-
-				// styleUrl
-				elem = new TiXmlElement("styleUrl");
-				if (item.theta[2] != 0.0f)
-				{	// Style - to indicate heading
-					string styleCntStr = styleStr + to_string(styleCnt++);
-					TiXmlNode* StyleNode = Style->Clone();
-					StyleNode->ToElement()->SetAttribute("id", styleCntStr);
-					StyleNode->FirstChildElement("IconStyle")->FirstChildElement("heading")->FirstChild()->ToText()->SetValue(to_string(item.theta[2] * C_RAD2DEG_F));
-					Document->LinkEndChild(StyleNode);
-
-					elem->LinkEndChild(new TiXmlText("#" + styleCntStr));
-				}
-				else
-				{
-					elem->LinkEndChild(new TiXmlText("#" + styleStr));
-				}
-				Placemark->LinkEndChild(elem);
-
-				Point = new TiXmlElement("Point");
-				Placemark->LinkEndChild(Point);
-
-				elem = new TiXmlElement("coordinates");
-#if 1
-				double lat = _CLAMP(item.lla[0] * DEG2RADMULT, -C_PIDIV2, C_PIDIV2) * RAD2DEGMULT;
-				double lon = _CLAMP(item.lla[1] * DEG2RADMULT, -C_PI, C_PI) * RAD2DEGMULT;
-				double alt = _CLAMP(item.lla[2], -1000, 100000);
-				snprintf(buf, BUF_SIZE, "%.8lf,%.8lf,%.3lf", lon, lat, alt);
-				elem->LinkEndChild(new TiXmlText(buf));
-#else
-				ostringstream coordinateStream;	// Not getting digits of precision
-				coordinateStream
-					<< fixed
-					<< setprecision(8)
-					<< item->lla[1] << ","  // Lat
-					<< item->lla[0] << ","  // Lon
-					<< setprecision(3)
-					<< item->lla[2] << " "; // Alt
-				elem->LinkEndChild(new TiXmlText(coordinateStream.str()));
-#endif
-				Point->LinkEndChild(elem);
 
-				elem = new TiXmlElement("altitudeMode");
-				elem->LinkEndChild(new TiXmlText(altitudeMode));
-				Point->LinkEndChild(elem);
+void cDeviceLogKML::WriteTrackCoordinates(sKmlLog& log, const sKmlLogData& item)
+{
+	char buf[BUF_SIZE];
+	cKmlFile& file = (log.trackFile.IsOpen() ? log.trackFile : log.file);
+	file.Write(buf, kmlCoordinates(buf, item, " "));
+}
 
-				i++;
-			}
-			tracksNum++;
-		}
-	}// if (m_showSample)
 
+void cDeviceLogKML::WriteTrackPoint(sKmlLog& log, const sKmlLogData& item)
+{
+	if (log.trackActive && item.deadReckoning != log.trackDeadReckoning)
+	{	// Switch from dead reckoning type
+		EndTrack(log);
+	}
 
-	// Show path (track)
-	if (m_showTracks)
+	if (!log.trackActive)
 	{
-		int tracksNum = 0;
-
-		for (size_t i=0; i < log.data.size(); )
+		log.trackActive = true;
+		log.trackDeadReckoning = item.deadReckoning;
+		if (log.trackFile.IsOpen())
 		{
-			bool deadReckoning = log.data[i].deadReckoning;
-
-			// Track style
-			styleStr = string("stylesel_") + to_string(styleCnt++);
+			log.trackStart = log.trackFile.Size();
+		}
+		else
+		{
+			WriteTrackStart(log.file, log, item.deadReckoning);
+		}
+		WriteTrackCoordinates(log, item);
+		if (m_kmlDecimation > 0.0)
+		{
+			log.window.push_back(item);
+		}
+		return;
+	}
 
-			Style = new TiXmlElement("Style");
-			Style->SetAttribute("id", styleStr);
-			Document->LinkEndChild(Style);
+	if (m_kmlDecimation <= 0.0)
+	{
+		WriteTrackCoordinates(log, item);
+		return;
+	}
 
-			LineStyle = new TiXmlElement("LineStyle");
-			Style->LinkEndChild(LineStyle);
+	log.window.push_back(item);
+	if (log.window.size() >= KML_DECIMATION_WINDOW)
+	{
+		DecimateTrack(log);
+	}
+}
 
-			elem = new TiXmlElement("color");
-			elem->LinkEndChild(new TiXmlText( (deadReckoning ? colorDrStr : colorStr) ));
-			LineStyle->LinkEndChild(elem);
 
-			elem = new TiXmlElement("colorMode");
-			elem->LinkEndChild(new TiXmlText("normal"));
-			LineStyle->LinkEndChild(elem);
+void cDeviceLogKML::EndTrack(sKmlLog& log)
+{
+	if (!log.trackActive)
+	{
+		return;
+	}
 
-			elem = new TiXmlElement("width");
-			elem->LinkEndChild(new TiXmlText("2"));
-			LineStyle->LinkEndChild(elem);
+	DecimateTrack(log);
+	if (log.trackFile.IsOpen())
+	{
+		sKmlTrackSegment segment;
+		segment.deadReckoning = log.trackDeadReckoning;
+		segment.size = log.trackFile.Size() - log.trackStart;
+		log.trackSegments.push_back(segment);
+	}
+	else
+	{
+		WriteTrackEnd(log.file);
+	}
+	log.trackActive = false;
+	log.window.clear();
+}
 
-			// Track
-			Placemark = new TiXmlElement("Placemark");
-			Document->LinkEndChild(Placemark);
 
-			elem = new TiXmlElement("name");
-			elem->LinkEndChild(new TiXmlText("Tracks"+to_string(tracksNum)));
-			Placemark->LinkEndChild(elem);
+void cDeviceLogKML::DecimateTrack(sKmlLog& log)
+{
+	std::vector<sKmlLogData>& w = log.window;
+	size_t n = w.size();
+	if (n < 2)
+	{
+		return;
+	}
 
-			elem = new TiXmlElement("description");
-			elem->LinkEndChild(new TiXmlText("SN tracks"));
-			Placemark->LinkEndChild(elem);
+	// Douglas-Peucker over the window in local level meters.  The window end points are kept so consecutive windows join.
+	double cosLat = cos(w[0].lla[0] * C_DEG2RAD);
+	std::vector<double> pos(3 * n);
+	for (size_t i = 0; i < n; i++)
+	{
+		pos[3 * i + 0] = (w[i].lla[0] - w[0].lla[0]) * C_DEG2RAD * C_WGS84_a;
+		pos[3 * i + 1] = (w[i].lla[1] - w[0].lla[1]) * C_DEG2RAD * C_WGS84_a * cosLat;
+		pos[3 * i + 2] = w[i].lla[2] - w[0].lla[2];
+	}
 
-			elem = new TiXmlElement("styleUrl");
-			elem->LinkEndChild(new TiXmlText("#" + styleStr));
-			Placemark->LinkEndChild(elem);
+	std::vector<uint8_t> keep(n, 0);
+	keep[0] = keep[n - 1] = 1;
+	std::vector<std::pair<size_t, size_t> > stack;
+	stack.push_back(std::make_pair((size_t)0, n - 1));
+	double tolerance2 = m_kmlDecimation * m_kmlDecimation;
+	while (!stack.empty())
+	{
+		size_t first = stack.back().first;
+		size_t last = stack.back().second;
+		stack.pop_back();
 
-			LineString = new TiXmlElement("LineString");
-			Placemark->LinkEndChild(LineString);
+		double ab[3], len2 = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			ab[k] = pos[3 * last + k] - pos[3 * first + k];
+			len2 += ab[k] * ab[k];
+		}
 
-			ostringstream coordinateStream;
-			int j = 0;
-			while (i < log.data.size())
+		// Farthest sample from the segment first-last
+		double maxDist2 = 0;
+		size_t index = first;
+		for (size_t i = first + 1; i < last; i++)
+		{
+			double ap[3], t = 0;
+			for (int k = 0; k < 3; k++)
 			{
-				if (deadReckoning != log.data[i].deadReckoning)
-				{	// Switch from dead reckoning type
-					break;
-				}
-
-				sKmlLogData& item = (log.data[i]);
-				double lat = _CLAMP(item.lla[0] * DEG2RADMULT, -C_PIDIV2, C_PIDIV2) * RAD2DEGMULT;
-				double lon = _CLAMP(item.lla[1] * DEG2RADMULT, -C_PI, C_PI) * RAD2DEGMULT;
-				double alt = _CLAMP(item.lla[2], -1000, 100000);
-
-				if (i >= log.data.size() - 2)
-				{
-					j++;
-				}
-
-				snprintf(buf, BUF_SIZE, "%.8lf,%.8lf,%.3lf ", lon, lat, alt);
-				// 			if (strcmp("-111.65863637,40.05570543,1418.282 ", buf) == 0)
-				// 			{
-				// 				j++;
-				// 			}
-				// 			qDebug() << string(buf);
-				//			std::cout << "Value of str is : ";
-				coordinateStream << string(buf);
-				i++;
+				ap[k] = pos[3 * i + k] - pos[3 * first + k];
+				t += ap[k] * ab[k];
 			}
+			t = (len2 > 0 ? _CLAMP(t / len2, 0.0, 1.0) : 0.0);
+			double dist2 = 0;
+			for (int k = 0; k < 3; k++)
+			{
+				double d = ap[k] - t * ab[k];
+				dist2 += d * d;
+			}
+			if (dist2 > maxDist2)
+			{
+				maxDist2 = dist2;
+				index = i;
+			}
+		}
 
-			elem = new TiXmlElement("coordinates");
-			elem->LinkEndChild(new TiXmlText(coordinateStream.str()));
-			LineString->LinkEndChild(elem);
+		if (maxDist2 > tolerance2)
+		{
+			keep[index] = 1;
+			stack.push_back(std::make_pair(first, index));
+			stack.push_back(std::make_pair(index, last));
+		}
+	}
 
-			elem = new TiXmlElement("extrude");
-			elem->LinkEndChild(new TiXmlText("1"));
-			LineString->LinkEndChild(elem);
+	for (size_t i = 1; i < n; i++)
+	{
+		if (keep[i])
+		{
+			WriteTrackCoordinates(log, w[i]);
+		}
+	}
 
-			elem = new TiXmlElement("altitudeMode");
-			elem->LinkEndChild(new TiXmlText(altitudeMode));
-			LineString->LinkEndChild(elem);
+	w[0] = w[n - 1];
+	w.resize(1);
+}
 
-			tracksNum++;
-		}
 
-	}
+bool cDeviceLogKML::CopyTracks(sKmlLog& log)
+{
+	bool success = log.trackFile.Close();
 
-	// Write XML to file
-	if (!tDoc.SaveFile(log.fileName.c_str()))
+	FILE* file = fopen(log.trackFileName.c_str(), "rb");
+	if (file == NULL)
 	{
 		return false;
 	}
 
-	// Remove data
-	log.data.clear();
+	std::vector<char> buf(KML_FILE_BUFFER_SIZE);
+	for (size_t i = 0; i < log.trackSegments.size(); i++)
+	{
+		sKmlTrackSegment& segment = log.trackSegments[i];
+		WriteTrackStart(log.file, log, segment.deadReckoning);
+		for (uint64_t size = segment.size; size > 0; )
+		{
+			size_t n = fread(buf.data(), 1, (size_t)_MIN(size, (uint64_t)buf.size()), file);
+			if (n == 0)
+			{
+				success = false;
+				break;
+			}
+			log.file.Write(buf.data(), n);
+			size -= n;
+		}
+		WriteTrackEnd(log.file);
+	}
 
-	return true;
+	fclose(file);
+	ISFileManager::DeleteFile(log.trackFileName);
+	return success;
 }
 
 
@@ -520,17 +662,33 @@ bool cDeviceLogKML::WriteDateToFile(const p_data_hdr_t *dataHdr, const uint8_t*
 		break;
 	}
 
+	sKmlLogData item;
+	if (!m_kml.DataToKmlLogData(dataHdr, dataBuf, item))
+	{
+		return true;
+	}
+
 	// Reference current log
 	sKmlLog &log = m_Log[kid];
+	if (!log.file.IsOpen() && !OpenNewSaveFile(kid, log, item))
+	{
+		return false;
+	}
 
 	// Write date to file
-    m_kml.WriteDataToFile(log.data, dataHdr, dataBuf);
+	if (m_showPoints)
+	{
+		WritePoint(log, item);
+	}
+	if (m_showTracks)
+	{
+		WriteTrackPoint(log, item);
+	}
 
 	// File byte size
-    int nBytes = (int)(log.data.size() * cDataKML::BYTES_PER_KID(kid));
-	log.fileSize = nBytes;
+	log.fileSize += cDataKML::BYTES_PER_KID(kid);
 	m_fileSize = _MAX(m_fileSize, log.fileSize);
-	m_logSize = nBytes;
+	m_logSize = log.fileSize;
 
 	if (log.fileSize >= m_maxFileSize)
 	{
@@ -26,14 +26,37 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #endif
 
 
-struct sKmlLog
+#define KML_DECIMATION_WINDOW		1024		// Max track samples held for Douglas-Peucker decimation
+
+struct sKmlTrackSegment
 {
-	std::vector<sKmlLogData> data;
+	bool					deadReckoning;
+	uint64_t				size;				// Coordinate text byte size
+};
 
+struct sKmlLog
+{
+	cKmlFile				file;
 	std::string				fileName;
 	uint32_t				fileCount;
 	uint32_t				fileDataSize;		// Byte size of chunk data.  Excludes chunk header.
 	uint32_t				fileSize;
+	int						styleKid;			// KID used for file style, KID_INS becomes KID_REF for reference INS
+
+	// Points
+	bool					pointDeadReckoning;	// Icon style color, from the first sample
+	double					pointNextTime;
+	int						styleCnt;
+
+	// Tracks.  When points are shown, coordinates are staged in trackFile and the tracks written after the points on close.
+	cKmlFile				trackFile;
+	std::string				trackFileName;
+	std::vector<sKmlTrackSegment> trackSegments;
+	bool					trackActive;
+	bool					trackDeadReckoning;
+	uint64_t				trackStart;			// Coordinate text byte offset of the current segment
+	int						tracksNum;
+	std::vector<sKmlLogData> window;			// Samples waiting for decimation, window[0] was already written
 };
 
 
@@ -41,6 +64,7 @@ struct sKmlLog
 class cDeviceLogKML : public cDeviceLog
 {
 public:
+	~cDeviceLogKML();
 	void InitDeviceForWriting(int pHandle, std::string timestamp, std::string directory, uint64_t maxDiskSpace, uint32_t maxFileSize) OVERRIDE;
 	bool CloseAllFiles() OVERRIDE;
 	bool CloseWriteFile(int kid, sKmlLog& log);
@@ -48,13 +72,21 @@ public:
     bool SaveData(p_data_hdr_t* dataHdr, const uint8_t* dataBuf) OVERRIDE;
 	p_data_t* ReadData() OVERRIDE;
 	void SetSerialNumber(uint32_t serialNumber) OVERRIDE;
-	std::string LogFileExtention() OVERRIDE { return std::string(".kml"); }
+	std::string LogFileExtention() OVERRIDE { return std::string((m_kmlCompress && cKmlFile::KmzSupported()) ? ".kmz" : ".kml"); }
 
 private:
-	bool OpenNewSaveFile(int kid, sKmlLog &log) { (void)kid; (void)log; return true; }
+	bool OpenNewSaveFile(int kid, sKmlLog &log, const sKmlLogData& first);
 	p_data_t* ReadDataFromChunk();
 	bool ReadChunkFromFile();
     bool WriteDateToFile(const p_data_hdr_t *dataHdr, const uint8_t *dataBuf);
+	void WritePoint(sKmlLog& log, const sKmlLogData& item);
+	void WriteTrackPoint(sKmlLog& log, const sKmlLogData& item);
+	void WriteTrackCoordinates(sKmlLog& log, const sKmlLogData& item);
+	void WriteTrackStart(cKmlFile& file, sKmlLog& log, bool deadReckoning);
+	void WriteTrackEnd(cKmlFile& file);
+	void EndTrack(sKmlLog& log);
+	void DecimateTrack(sKmlLog& log);
+	bool CopyTracks(sKmlLog& log);
 
 	cDataKML                m_kml;
 	sKmlLog                 m_Log[cDataKML::MAX_NUM_KID];
@@ -20,10 +20,13 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <stdio.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <algorithm>
 
 #include "DeviceLogSerial.h"
 #include "ISLogger.h"
 #include "ISLogFileFactory.h"
+#include "ISFileManager.h"
+#include "ISDataMappings.h"
 
 using namespace std;
 
@@ -32,6 +35,9 @@ void cDeviceLogSerial::InitDeviceForWriting(int pHandle, std::string timestamp,
 //     m_chunk.Init(chunkSize);
 	m_chunk.Clear();
 	m_chunk.m_hdr.pHandle = pHandle;
+	m_chunk.SetCompression(m_compressionLevel, m_compressionFilter);
+	m_chunkTime = 0.0;
+	m_timeIndex.Close();
 
 	cDeviceLog::InitDeviceForWriting(pHandle, timestamp, directory, maxDiskSpace, maxFileSize);
 }
@@ -46,6 +52,7 @@ bool cDeviceLogSerial::CloseAllFiles()
 
 	// Close file
 	CloseISLogFile(m_pFile);
+	m_timeIndex.Flush();
 
 	return true;
 }
@@ -105,6 +112,12 @@ bool cDeviceLogSerial::SaveData(p_data_hdr_t* dataHdr, const uint8_t* dataBuf)
 		return false;
 	}
 
+	// Chunks are indexed by the first GPS time of week in them, other time bases are not comparable
+	if (m_timeIndexPeriodMs != 0 && m_chunkTime == 0.0)
+	{
+		m_chunkTime = cISDataMappings::GetTimeOfWeek(dataHdr, dataBuf);
+	}
+
 	return true;
 }
 
@@ -129,6 +142,16 @@ bool cDeviceLogSerial::WriteChunkToFile()
 		return false;
 	}
 
+	if (m_chunkTime != 0.0)
+	{
+		if (!m_timeIndex.IsOpened())
+		{
+			m_timeIndex.OpenForWriting(GetTimeIndexFileName(m_devInfo.serialNumber ? m_devInfo.serialNumber : m_pHandle), m_timeIndexPeriodMs);
+		}
+		m_timeIndex.Add(m_chunkTime, m_fileCount, (uint32_t)m_fileSize);
+		m_chunkTime = 0.0;
+	}
+
 	// Write chunk to file
 	int fileBytes = m_chunk.WriteToFile(m_pFile, 0);
 	if (!m_pFile->good())
@@ -149,10 +172,10 @@ p_data_t* cDeviceLogSerial::ReadData()
 	p_data_t* data = NULL;
 
 	// Read data from chunk
-	while (!(data = ReadDataFromChunk()))
+	while (!(data = (m_mappedRead ? ReadDataFromMappedChunk() : ReadDataFromChunk())))
 	{
 		// Read next chunk from file
-		if (!ReadChunkFromFile())
+		if (!(m_mappedRead ? MapNextChunk() : ReadChunkFromFile()))
 		{
 			return NULL;
 		}
@@ -200,6 +223,103 @@ bool cDeviceLogSerial::ReadChunkFromFile()
 }
 
 
+p_data_t* cDeviceLogSerial::ReadDataFromMappedChunk()
+{
+	if (m_mapPos == NULLPTR || m_mapPos + sizeof(p_data_hdr_t) > m_mapEnd)
+	{
+		return NULL;
+	}
+
+	p_data_t* data = (p_data_t*)m_mapPos;
+	uint8_t* next = m_mapPos + sizeof(p_data_hdr_t) + data->hdr.size;
+	if (next > m_mapEnd)
+	{	// Corrupt, skip rest of chunk
+		m_mapPos = m_mapEnd;
+		return NULL;
+	}
+	m_mapPos = next;
+	return data;
+}
+
+
+bool cDeviceLogSerial::MapNextChunk()
+{
+	// Index is stale if the file was closed or reopened since it was built
+	std::size_t mapSize;
+	if (m_pFile == NULLPTR || m_pFile->mappedData(mapSize) != m_mapData)
+	{
+		m_chunkOffsets.clear();
+		m_chunkIndex = 0;
+		if (m_pFile != NULLPTR)
+		{
+			IndexMappedChunks();
+		}
+	}
+
+	while (m_chunkIndex >= m_chunkOffsets.size())
+	{
+		if (!OpenNextReadFile())
+		{
+			// No more data or error opening next file
+			m_mapPos = m_mapEnd = NULLPTR;
+			return false;
+		}
+		IndexMappedChunks();
+	}
+
+	std::size_t offset = m_chunkOffsets[m_chunkIndex++];
+	memcpy(&m_chunk.m_hdr, m_mapData + offset, sizeof(sChunkHeader));
+	m_mapPos = (uint8_t*)m_mapData + offset + sizeof(sChunkHeader);
+	m_mapEnd = m_mapPos + m_chunk.m_hdr.dataSize;
+
+	// Compressed chunks are expanded into the chunk buffer and read from there
+	if (m_chunk.m_hdr.version == DATA_CHUNK_VERSION_COMPRESSED)
+	{
+		if (m_chunk.Decompress(m_mapPos, m_chunk.m_hdr.dataSize))
+		{
+			m_mapPos = m_chunk.GetDataPtr();
+			m_mapEnd = m_mapPos + m_chunk.GetDataSize();
+		}
+		else
+		{	// Corrupt, skip chunk
+			m_mapPos = m_mapEnd;
+		}
+	}
+
+	// Keeps read ahead moving with the reader
+	m_pFile->seek((long int)offset, SEEK_SET);
+	return true;
+}
+
+
+void cDeviceLogSerial::IndexMappedChunks()
+{
+	m_chunkOffsets.clear();
+	m_chunkIndex = 0;
+	m_mapData = m_pFile->mappedData(m_mapSize);
+	if (m_mapData == NULLPTR)
+	{
+		return;
+	}
+
+	// Same validation as cDataChunk::ReadFromFile, the first bad chunk ends the file
+	std::size_t offset = 0;
+	while (offset + sizeof(sChunkHeader) <= m_mapSize)
+	{
+		const sChunkHeader* hdr = (const sChunkHeader*)(m_mapData + offset);
+		if (hdr->marker != DATA_CHUNK_MARKER ||
+			hdr->dataSize != ~(hdr->invDataSize) ||
+			hdr->dataSize > DEFAULT_CHUNK_DATA_SIZE ||
+			hdr->dataSize > m_mapSize - offset - sizeof(sChunkHeader))
+		{
+			break;
+		}
+		m_chunkOffsets.push_back(offset);
+		offset += sizeof(sChunkHeader) + hdr->dataSize;
+	}
+}
+
+
 void cDeviceLogSerial::SetSerialNumber(uint32_t serialNumber)
 {
 	m_devInfo.serialNumber = serialNumber;
@@ -213,6 +333,52 @@ void cDeviceLogSerial::Flush()
 	{
 		m_pFile->flush();
 	}
+	m_timeIndex.Flush();
+}
+
+
+bool cDeviceLogSerial::SeekToTime(double time)
+{
+	if (m_writeMode)
+	{
+		return false;
+	}
+
+	if (m_timeIndex.Entries().empty() && !m_timeIndex.Load(GetTimeIndexFileName(m_devInfo.serialNumber)))
+	{
+		return false;
+	}
+
+	const sTimeIndexEntry* entry = m_timeIndex.Find(time);
+
+	// Find the log file by name, older files may have been removed to free disk space
+	string fileName = ISFileManager::GetFileName(GetNewFileName(m_devInfo.serialNumber, entry->fileNumber, NULL));
+	for (uint32_t i = 0; i < m_fileNames.size(); i++)
+	{
+		if (ISFileManager::GetFileName(m_fileNames[i]) != fileName)
+		{
+			continue;
+		}
+
+		m_fileCount = i;
+		if (!OpenNextReadFile())
+		{
+			return false;
+		}
+
+		// Drop anything buffered from the previous position
+		m_chunk.Clear();
+		if (m_mappedRead)
+		{
+			IndexMappedChunks();
+			m_chunkIndex = lower_bound(m_chunkOffsets.begin(), m_chunkOffsets.end(), (size_t)entry->offset) - m_chunkOffsets.begin();
+			m_mapPos = m_mapEnd = NULLPTR;
+			return true;
+		}
+		return m_pFile->seek((long int)entry->offset, SEEK_SET) == 0;
+	}
+
+	return false;
 }
 
 
@@ -19,6 +19,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include "DataChunk.h"
 #include "DeviceLog.h"
+#include "ISLogTimeIndex.h"
 #include "com_manager.h"
 
 
@@ -27,7 +28,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 class cDeviceLogSerial : public cDeviceLog
 {
 public:
-    cDeviceLogSerial(){}
+    cDeviceLogSerial() : m_mapData(NULLPTR), m_mapSize(0), m_mapPos(NULLPTR), m_mapEnd(NULLPTR), m_chunkIndex(0), m_chunkTime(0.0) {}
 
 	void InitDeviceForWriting(int pHandle, std::string timestamp, std::string directory, uint64_t maxDiskSpace, uint32_t maxFilesize) OVERRIDE;
 	bool CloseAllFiles() OVERRIDE;
@@ -37,6 +38,7 @@ public:
 	void SetSerialNumber(uint32_t serialNumber) OVERRIDE;
 	std::string LogFileExtention() OVERRIDE { return std::string(".dat"); }
 	void Flush() OVERRIDE;
+	bool SeekToTime(double time) OVERRIDE;
 
 	cDataChunk m_chunk;
 
@@ -44,6 +46,20 @@ private:
 	p_data_t* ReadDataFromChunk();
 	bool ReadChunkFromFile();
 	bool WriteChunkToFile();
+	p_data_t* ReadDataFromMappedChunk();
+	bool MapNextChunk();
+	void IndexMappedChunks();
+
+	// Memory mapped read state, data is handed out directly from the mapping
+	const uint8_t* m_mapData;
+	std::size_t m_mapSize;
+	uint8_t* m_mapPos;
+	uint8_t* m_mapEnd;
+	std::vector<std::size_t> m_chunkOffsets;	// offsets of valid chunk headers in the mapped file
+	std::size_t m_chunkIndex;
+
+	cISLogTimeIndex m_timeIndex;
+	double m_chunkTime;		// first GPS time of week in the chunk being written, 0 if none yet
 };
 
 #endif // DEVICE_LOG_SERIAL_H
@@ -39,7 +39,9 @@ cDeviceLogSorted::cDeviceLogSorted()
     for (uint32_t i = 0; i < DID_COUNT; i++)
     {
         m_chunks[i] = NULLPTR;
+        m_chunksAvailable[i] = false;
     }
+    m_readHeapLoaded = false;
 }
 
 
@@ -74,6 +76,9 @@ void cDeviceLogSorted::InitDeviceForReading()
 	m_lastSerNum = 0xFFFFFFFF;
 	cDeviceLog::InitDeviceForReading();
 
+	m_readHeap = decltype(m_readHeap)();
+	m_readHeapLoaded = false;
+
 	// Open all files
 	OpenAllReadFiles();
 }
@@ -91,7 +96,7 @@ bool cDeviceLogSorted::OpenAllReadFiles()
 	for (m_fileCount = 0; m_fileCount < m_fileNames.size(); m_fileCount++)
 	{
 		m_fileName = m_fileNames[m_fileCount];
-		m_pFiles.push_back(CreateISLogFile(m_fileName, "rb"));
+		m_pFiles.push_back(OpenReadFile(m_fileName));
 
 		if (m_pFiles.back())
 		{	// Success
@@ -108,15 +113,45 @@ bool cDeviceLogSorted::OpenAllReadFiles()
 		}
 	}
 
+	// Only DIDs that appear in the files are searched for.  Searching for a missing DID reads every remaining chunk.
 	for (uint32_t id = 0; id < DID_COUNT; id++)
 	{
-		m_chunksAvailable[id] = true;
+		m_chunksAvailable[id] = false;
+	}
+	for (unsigned int i = 0; i < m_pFiles.size(); i++)
+	{
+		ScanChunkDataIds(m_pFiles[i]);
 	}
 
 	return true;
 }
 
 
+void cDeviceLogSorted::ScanChunkDataIds(cISLogFileBase* pFile)
+{
+	long int startPos = pFile->tell();
+	sChunkHeader hdr;
+	sChunkSubHeader subHdr;
+
+	// Walk the chunk headers, skipping over the chunk data
+	while (pFile->read(&hdr, sizeof(hdr)) == sizeof(hdr) &&
+		hdr.dataSize == ~(hdr.invDataSize) &&
+		pFile->read(&subHdr, sizeof(subHdr)) == sizeof(subHdr))
+	{
+		if (subHdr.dHdr.id < DID_COUNT)
+		{
+			m_chunksAvailable[subHdr.dHdr.id] = true;
+		}
+		if (pFile->seek((long int)hdr.dataSize, SEEK_CUR) != 0)
+		{
+			break;
+		}
+	}
+
+	pFile->seek(startPos, SEEK_SET);
+}
+
+
 bool cDeviceLogSorted::CloseAllFiles()
 {
 	// Write remaining data to file
@@ -173,6 +208,7 @@ bool cDeviceLogSorted::SaveData(p_data_hdr_t* dataHdr, const uint8_t* dataBuf)
         m_chunks[id]->m_subHdr.dHdr = *dataHdr;
         m_chunks[id]->m_hdr.pHandle = m_pHandle;
         m_chunks[id]->m_hdr.devSerialNum = m_devInfo.serialNumber;
+        m_chunks[id]->SetCompression(m_compressionLevel, m_compressionFilter);
     }
     cSortedDataChunk* chunk = m_chunks[id];
 
@@ -281,9 +317,8 @@ bool cDeviceLogSorted::WriteChunkToFile(uint32_t id)
 }
 
 
-// Re-serialize data to original order
-// Consider using a queue where data from chunks are added on one end and the serial order # is checked on the other end.
-// This function needs to scan across all chunk queues and find the next lowest data to pop off.
+// Re-serialize data to original order.  Each DID chunk is a queue in serial number order, so the next record is 
+// always at the front of one of them and a min heap keyed on the front serial numbers merges them.
 
 // Read serialized data
 p_data_t* cDeviceLogSorted::ReadData()
@@ -311,100 +346,104 @@ p_data_t* cDeviceLogSorted::ReadData()
 
 p_data_t* cDeviceLogSorted::SerializeDataFromChunks()
 {
+	if (!m_readHeapLoaded)
+	{	// Load the first chunk of every DID
+		m_readHeapLoaded = true;
+		for (uint32_t id = 1; id < DID_COUNT; id++)
+		{
+			PushReadChunk(id);
+		}
+	}
 
-tryAgain:
-
-	uint32_t foundId = UINT_MAX;
-	uint32_t minSerialNum = UINT_MAX;
-    cSortedDataChunk *chunk;
-
-	// while there is data in any chunk, find the chunk with the next id
-	for (uint32_t id = 1; id < DID_COUNT; id++)
+	// The chunk holding the lowest data serial number is on top of the heap
+	while (!m_readHeap.empty())
 	{
-		if (!m_chunksAvailable[id])
-		{
+		uint32_t foundId = m_readHeap.top().second;
+		m_readHeap.pop();
+
+		cSortedDataChunk *chunk = m_chunks[foundId];
+		if (chunk->GetDataSize() == 0)
+		{	// Refill marker.  Every record older than the next chunk of this DID has been read, so read it now.
+			PushReadChunk(foundId);
 			continue;
 		}
 
-        chunk = m_chunks[id];
-        if (chunk == NULLPTR || chunk->GetDataSize() == 0)
+		p_cnk_data_t* cnkData = (p_cnk_data_t*)(chunk->GetDataPtr());
+
+		// Increment data serial number to one larger than current
+		m_dataSerNum = chunk->GetDataSerNum() + 1;
+
+		// Size = serial number plus data size
+		int pSize = chunk->m_subHdr.dHdr.size + sizeof(uint32_t);
+		p_data_t* data = NULL;
+
+		if (chunk->m_subHdr.dHdr.size <= MAX_DATASET_SIZE)
 		{
-			// Chunk is empty.  Search all files for new chuck.
-			if (ReadNextChunkFromFiles(id))
-			{
-				chunk = m_chunks[id];
-			}
-			if (chunk == NULLPTR || chunk->GetDataSize() == 0)
-			{
-				m_chunksAvailable[id] = false;
-				continue;
-			}
+			// Data fits in temp buf
+
+			// Copy data header
+			m_data.hdr = chunk->m_subHdr.dHdr;
+
+			// Copy data buffer, ensure not to overrun chunk memory in case of corrupt data
+			memcpy(m_data.buf, cnkData->buf, _MIN(chunk->GetDataSize(), (int32_t)(m_data.hdr.size)));
+			data = &m_data;
+		}
+		else
+		{
+			perror("Data is larger than max data set size");
 		}
 
-		uint32_t dataSerNum = chunk->GetDataSerNum();
-        if (dataSerNum == UINT_MAX)
-        {
-            continue;
-        }
-		if (dataSerNum == m_dataSerNum)
-		{	// Found exact match.
-			foundId = id;
-			break;
+		chunk->PopFront(pSize);
+
+		// Queue the next record of this DID.  Once the chunk is empty the next chunk is read from file when the 
+		// marker reaches the top, as late as possible so that older chunks are trimmed from the file search.
+		if (chunk->GetDataSize() != 0)
+		{
+			PushReadChunk(foundId);
 		}
-		if (dataSerNum < minSerialNum)
-		{	// Search for lowest serial number
-			foundId = id;
-			minSerialNum = dataSerNum;
+		else if (m_chunksAvailable[foundId])
+		{
+			m_readHeap.push(read_key_t(m_dataSerNum, foundId));
 		}
-	}
 
-	if (foundId == UINT_MAX)
-	{   // No more data left
-		return NULL;
+		if (data)
+		{
+			return data;
+		}
 	}
 
-    chunk = m_chunks[foundId];
-	p_cnk_data_t* cnkData = (p_cnk_data_t*)(chunk->GetDataPtr());
+	// No more data left
+	return NULL;
+}
 
-#if 0	// Error check for gap data serial number.  Verify we didn't drop any data.
 
-	if (m_lastSerNum == UINT_MAX)
+void cDeviceLogSorted::PushReadChunk(uint32_t id)
+{
+	if (!m_chunksAvailable[id])
 	{
-		m_lastSerNum = m_dataSerNum;
+		return;
 	}
-	if (m_dataSerNum - m_lastSerNum > 1)
+
+	cSortedDataChunk *chunk = m_chunks[id];
+	if (chunk == NULLPTR || chunk->GetDataSize() == 0)
 	{
-		cout << endl << "Gap in data: " << foundId << "\t" << m_dataSerNum;
+		// Chunk is empty.  Search all files for new chuck.
+		if (ReadNextChunkFromFiles(id))
+		{
+			chunk = m_chunks[id];
+		}
+		if (chunk == NULLPTR || chunk->GetDataSize() == 0)
+		{
+			m_chunksAvailable[id] = false;
+			return;
+		}
 	}
-	m_lastSerNum = m_dataSerNum;
-
-#endif
-
-	// Increment data serial number to one larger than current
-	m_dataSerNum = chunk->GetDataSerNum() + 1;
-	
-	if (chunk->m_subHdr.dHdr.size <= MAX_DATASET_SIZE)
-	{   
-		// Data fits in temp buf
-
-        // Copy data header
-		m_data.hdr = chunk->m_subHdr.dHdr;
 
-		// Copy data buffer, ensure not to overrun chunk memory in case of corrupt data
-		memcpy(m_data.buf, cnkData->buf, _MIN(chunk->GetDataSize(), (int32_t)(m_data.hdr.size)));
-
-        // Size = serial number plus data size
-		int pSize = chunk->m_subHdr.dHdr.size + sizeof(uint32_t);
-
-		chunk->PopFront(pSize);
-		return &m_data;
+	uint32_t dataSerNum = chunk->GetDataSerNum();
+	if (dataSerNum != UINT_MAX)
+	{
+		m_readHeap.push(read_key_t(dataSerNum, id));
 	}
-    else
-    {
-        perror("Data is larger than max data set size");
-    }
-
-	goto tryAgain;
 }
 
 
@@ -17,6 +17,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <string>
 #include <vector>
 #include <list>
+#include <queue>
+#include <functional>
 
 #include "DeviceLog.h"
 #include "DataChunkSorted.h"
@@ -30,6 +32,7 @@ public:
 	void InitDeviceForWriting(int pHandle, std::string timestamp, std::string directory, uint64_t maxDiskSpace, uint32_t maxFileSize) OVERRIDE;
 	void InitDeviceForReading() OVERRIDE;
 	bool OpenAllReadFiles();
+	void ScanChunkDataIds(cISLogFileBase* pFile);
 	bool CloseAllFiles() OVERRIDE;
 	bool FlushToFile() OVERRIDE;
     bool SaveData(p_data_hdr_t* dataHdr, const uint8_t* dataBuf) OVERRIDE;
@@ -41,6 +44,7 @@ public:
 	bool m_chunksAvailable[DID_COUNT];
 
 	p_data_t* SerializeDataFromChunks();
+	void PushReadChunk(uint32_t id);
 	bool ReadNextChunkFromFiles(uint32_t id);
 	bool ReadChunkFromFiles(cSortedDataChunk *chunk, uint32_t id);
 	bool WriteChunkToFile(uint32_t id);
@@ -52,6 +56,11 @@ public:
 
 	std::vector<cISLogFileBase*> m_pFiles;
 
+	// Min heap of (next data serial number, DID) across all non-empty read chunks
+	typedef std::pair<uint32_t, uint32_t> read_key_t;
+	std::priority_queue<read_key_t, std::vector<read_key_t>, std::greater<read_key_t> > m_readHeap;
+	bool m_readHeapLoaded;
+
 };
 
 #endif // DEVICE_LOG_SORTED_H
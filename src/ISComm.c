@@ -12,6 +12,22 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include "ISComm.h"
 
+// Select the widest vector unit available for the receive byte scanner
+#if defined(__AVX2__)
+#define IS_COMM_SCAN_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IS_COMM_SCAN_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define IS_COMM_SCAN_NEON
+#include <arm_neon.h>
+#endif
+
+#if (defined(IS_COMM_SCAN_AVX2) || defined(IS_COMM_SCAN_SSE2)) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 const unsigned int g_validBaudRates[IS_BAUDRATE_COUNT] = {
 	// Actual on uINS:
 	IS_BAUDRATE_18750000,   // 18750000 (uINS ser1 only)
@@ -28,6 +44,7 @@ const unsigned int g_validBaudRates[IS_BAUDRATE_COUNT] = {
 };
 
 static int s_packetEncodingEnabled = 1;
+static int s_fastScanEnabled = 1;
 
 
 /**
@@ -112,31 +129,38 @@ int validateBaudRate(unsigned int baudRate)
 	return -1;
 }
 
+/** Non-zero for bytes that must be encoded in the binary packet format (see ePktSpecialChars) */
+static const uint8_t s_encodeTable[256] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1,
+};
+
 // Replace special character with encoded equivalent and add to buffer
-static uint8_t* encodeByteAddToBuffer(uint32_t val, uint8_t* ptrDest)
+static __inline uint8_t* encodeByteAddToBuffer(uint32_t val, uint8_t* ptrDest)
 {
-	switch (val)
+	if (s_encodeTable[val] && s_packetEncodingEnabled)
+	{
+		*ptrDest++ = PSC_RESERVED_KEY;
+		*ptrDest++ = (uint8_t)~val;
+	}
+	else
 	{
-	case PSC_ASCII_START_BYTE:
-	case PSC_ASCII_END_BYTE:
-	case PSC_START_BYTE:
-	case PSC_END_BYTE:
-	case PSC_RESERVED_KEY:
-	case UBLOX_START_BYTE1:
-	case RTCM3_START_BYTE:
-		if (s_packetEncodingEnabled)
-		{
-			*ptrDest++ = PSC_RESERVED_KEY;
-			*ptrDest++ = (uint8_t)~val;
-		}
-		else
-		{
-			*ptrDest++ = (uint8_t)val;
-		}
-		break;
-	default:
 		*ptrDest++ = (uint8_t)val;
-		break;
 	}
 
 	return ptrDest;
@@ -545,6 +569,196 @@ protocol_type_t is_comm_parse_byte(is_comm_instance_t* instance, uint8_t byte)
 	return is_comm_parse(instance);
 }
 
+#if defined(IS_COMM_SCAN_AVX2) || defined(IS_COMM_SCAN_SSE2)
+// Index of the lowest set bit.  mask must be non-zero.
+static __inline int lowestBitIndex(uint32_t mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+/** Maximum number of key bytes matched by scanForKeyBytes() */
+#define SCAN_MAX_KEYS	8
+
+/**
+* Find the first byte in [ptr, end) that matches any of the key bytes.  Up to SCAN_MAX_KEYS keys are supported.
+* @return pointer to the matching byte or end if no byte matches.
+*/
+static uint8_t* scanForKeyBytes(uint8_t* ptr, uint8_t* end, const uint8_t* keys, int keyCount)
+{
+	// Unused key slots repeat the first key so they never add a false match
+	uint8_t k[SCAN_MAX_KEYS];
+	for (int i = 0; i < SCAN_MAX_KEYS; i++)
+	{
+		k[i] = keys[i < keyCount ? i : 0];
+	}
+
+#if defined(IS_COMM_SCAN_AVX2)
+	{
+		__m256i v[SCAN_MAX_KEYS];
+		for (int i = 0; i < SCAN_MAX_KEYS; i++)
+		{
+			v[i] = _mm256_set1_epi8((char)k[i]);
+		}
+		for (; end - ptr >= 32; ptr += 32)
+		{
+			__m256i d = _mm256_loadu_si256((const __m256i*)(void*)ptr);
+			__m256i m = _mm256_or_si256(
+				_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(d, v[0]), _mm256_cmpeq_epi8(d, v[1])),
+								_mm256_or_si256(_mm256_cmpeq_epi8(d, v[2]), _mm256_cmpeq_epi8(d, v[3]))),
+				_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(d, v[4]), _mm256_cmpeq_epi8(d, v[5])),
+								_mm256_or_si256(_mm256_cmpeq_epi8(d, v[6]), _mm256_cmpeq_epi8(d, v[7]))));
+			uint32_t mask = (uint32_t)_mm256_movemask_epi8(m);
+			if (mask)
+			{
+				return ptr + lowestBitIndex(mask);
+			}
+		}
+	}
+#endif
+
+#if defined(IS_COMM_SCAN_AVX2) || defined(IS_COMM_SCAN_SSE2)
+	{
+		__m128i v[SCAN_MAX_KEYS];
+		for (int i = 0; i < SCAN_MAX_KEYS; i++)
+		{
+			v[i] = _mm_set1_epi8((char)k[i]);
+		}
+		for (; end - ptr >= 16; ptr += 16)
+		{
+			__m128i d = _mm_loadu_si128((const __m128i*)(void*)ptr);
+			__m128i m = _mm_or_si128(
+				_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(d, v[0]), _mm_cmpeq_epi8(d, v[1])),
+							 _mm_or_si128(_mm_cmpeq_epi8(d, v[2]), _mm_cmpeq_epi8(d, v[3]))),
+				_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(d, v[4]), _mm_cmpeq_epi8(d, v[5])),
+							 _mm_or_si128(_mm_cmpeq_epi8(d, v[6]), _mm_cmpeq_epi8(d, v[7]))));
+			uint32_t mask = (uint32_t)_mm_movemask_epi8(m);
+			if (mask)
+			{
+				return ptr + lowestBitIndex(mask);
+			}
+		}
+	}
+#elif defined(IS_COMM_SCAN_NEON)
+	{
+		uint8x16_t v[SCAN_MAX_KEYS];
+		for (int i = 0; i < SCAN_MAX_KEYS; i++)
+		{
+			v[i] = vdupq_n_u8(k[i]);
+		}
+		for (; end - ptr >= 16; ptr += 16)
+		{
+			uint8x16_t d = vld1q_u8(ptr);
+			uint8x16_t m = vorrq_u8(
+				vorrq_u8(vorrq_u8(vceqq_u8(d, v[0]), vceqq_u8(d, v[1])), vorrq_u8(vceqq_u8(d, v[2]), vceqq_u8(d, v[3]))),
+				vorrq_u8(vorrq_u8(vceqq_u8(d, v[4]), vceqq_u8(d, v[5])), vorrq_u8(vceqq_u8(d, v[6]), vceqq_u8(d, v[7]))));
+			if (vmaxvq_u8(m))
+			{	// Match is in this block, locate it below
+				break;
+			}
+		}
+	}
+#else
+	{	// Portable fallback: test 8 bytes at a time for a zero byte after XOR with each key
+		const uint64_t ones = 0x0101010101010101ULL;
+		const uint64_t highs = 0x8080808080808080ULL;
+		uint64_t m[SCAN_MAX_KEYS];
+		for (int i = 0; i < keyCount; i++)
+		{
+			m[i] = ones * k[i];
+		}
+		for (; end - ptr >= 8; ptr += 8)
+		{
+			uint64_t w, found = 0;
+			memcpy(&w, ptr, sizeof(w));
+			for (int i = 0; i < keyCount; i++)
+			{
+				uint64_t x = w ^ m[i];
+				found |= (x - ones) & ~x;
+			}
+			if (found & highs)
+			{	// Match is in this word, locate it below
+				break;
+			}
+		}
+	}
+#endif
+
+	for (; ptr < end; ptr++)
+	{
+		for (int i = 0; i < keyCount; i++)
+		{
+			if (*ptr == k[i])
+			{
+				return ptr;
+			}
+		}
+	}
+	return ptr;
+}
+
+/**
+* Skip over bytes that cannot change the parser state.  These are bytes preceding the next start byte while searching 
+* (after the parse error has already been reported), binary and ASCII body bytes that are not end or invalid bytes, 
+* and the counted body of ublox and RTCM3 packets.
+* @return pointer to the next byte that must go through the byte parser.
+*/
+static uint8_t* skipToNextKeyByte(is_comm_instance_t* instance, uint8_t* ptr, uint8_t* end)
+{
+	uint8_t keys[SCAN_MAX_KEYS];
+	int keyCount = 0;
+
+	switch (instance->hasStartByte)
+	{
+	case 0:
+		if (instance->parseState != -1)
+		{	// Next byte is either a start byte or reports a parse error
+			return ptr;
+		}
+		if (instance->config.enableISB)		{ keys[keyCount++] = PSC_START_BYTE; }
+		if (instance->config.enableASCII)	{ keys[keyCount++] = PSC_ASCII_START_BYTE; }
+		if (instance->config.enableUblox)	{ keys[keyCount++] = UBLOX_START_BYTE1; }
+		if (instance->config.enableRTCM3)	{ keys[keyCount++] = RTCM3_START_BYTE; }
+		if (keyCount == 0)
+		{	// All protocols disabled, every byte is discarded
+			return end;
+		}
+		break;
+
+	case PSC_START_BYTE:
+		keys[keyCount++] = PSC_END_BYTE;
+		break;
+
+	case PSC_ASCII_START_BYTE:
+		keys[keyCount++] = PSC_ASCII_END_BYTE;
+		keys[keyCount++] = PSC_START_BYTE;
+		keys[keyCount++] = PSC_END_BYTE;
+		keys[keyCount++] = 0;
+		break;
+
+	case UBLOX_START_BYTE1:
+	case RTCM3_START_BYTE:
+		if (instance->parseState < -1)
+		{	// Counting down the packet body.  Leave the final byte for the byte parser to run the checksum.
+			int skip = _MIN(-instance->parseState - 1, (int)(end - ptr));
+			instance->parseState += skip;
+			return ptr + skip;
+		}
+		return ptr;
+
+	default:
+		return ptr;
+	}
+
+	return scanForKeyBytes(ptr, end, keys, keyCount);
+}
+
 #define FOUND_START_BYTE(init)		if(init){ instance->hasStartByte = byte; instance->buf.head = instance->buf.scan-1; }
 #define START_BYTE_SEARCH_ERROR()	
 
@@ -556,6 +770,15 @@ protocol_type_t is_comm_parse(is_comm_instance_t* instance)
 	// Search for packet
 	while (buf->scan < buf->tail)
 	{
+		if (s_fastScanEnabled)
+		{	// Jump to the next byte that can change the parser state
+			buf->scan = skipToNextKeyByte(instance, buf->scan, buf->tail);
+			if (buf->scan >= buf->tail)
+			{
+				break;
+			}
+		}
+
 		uint8_t byte = *(buf->scan++);
 
 		// Check for start byte if we haven't found it yet
@@ -741,6 +964,52 @@ int is_comm_ack(is_comm_instance_t* instance, uint32_t did)
 }
 #endif
 
+/** Bytes that are escaped in the binary packet body */
+static const uint8_t s_specialBytes[] = 
+{
+	PSC_RESERVED_KEY, PSC_START_BYTE, PSC_END_BYTE, PSC_ASCII_START_BYTE, PSC_ASCII_END_BYTE, UBLOX_START_BYTE1, RTCM3_START_BYTE
+};
+
+/**
+* XOR bytes into the 24 bit packet checksum.  Bytes are shifted by 0, 8, 16 bits in rotation starting at shifter.
+* Runs of 24 bytes are folded as three 64 bit words, as bytes 24 apart share the same shift.
+* @return the updated checksum.  shifter is updated for the next byte.
+*/
+static uint32_t checksum24Accumulate(uint32_t checksum, const uint8_t* ptr, int len, uint32_t* shifter)
+{
+	uint32_t phase = *shifter >> 3;
+
+	if (len >= 24)
+	{
+		uint64_t acc[3] = { 0, 0, 0 };
+		for (; len >= 24; len -= 24, ptr += 24)
+		{
+			uint64_t w[3];
+			memcpy(w, ptr, sizeof(w));
+			acc[0] ^= w[0];
+			acc[1] ^= w[1];
+			acc[2] ^= w[2];
+		}
+
+		// Fold accumulated bytes back into the checksum (byte order independent)
+		uint8_t lanes[24];
+		memcpy(lanes, acc, sizeof(lanes));
+		for (uint32_t i = 0; i < 24; i++)
+		{
+			checksum ^= (uint32_t)lanes[i] << (8 * ((phase + i) % 3));
+		}
+	}
+
+	for (; len > 0; len--)
+	{
+		checksum ^= (uint32_t)(*ptr++) << (8 * phase);
+		phase = (phase == 2 ? 0 : phase + 1);
+	}
+
+	*shifter = phase << 3;
+	return checksum;
+}
+
 void is_decode_binary_packet_footer(packet_ftr_t* ftr, uint8_t* ptrSrc, uint8_t** ptrSrcEnd, uint32_t* checksum)
 {
 	int state = 0;
@@ -829,111 +1098,121 @@ int is_decode_binary_packet_byte(uint8_t** _ptrSrc, uint8_t** _ptrDest, uint32_t
 }
 
 int is_encode_binary_packet(void* srcBuffer, unsigned int srcBufferLength, packet_hdr_t* hdr, uint8_t additionalPktFlags, void* encodedPacket, int encodedPacketLength)
+{
+	bufPtr_t body;
+	body.ptr = (uint8_t*)srcBuffer;
+	body.size = srcBufferLength;
+
+	return is_encode_binary_packet_sg(&body, (srcBufferLength > 0), hdr, additionalPktFlags, encodedPacket, encodedPacketLength);
+}
+
+int is_encode_binary_packet_sg(const bufPtr_t* bodyBufs, int bodyBufCount, packet_hdr_t* hdr, uint8_t additionalPktFlags, void* encodedPacket, int encodedPacketLength)
 {
 	// Ensure data size is small enough, assuming packet size could double after encoding.
-	if (srcBufferLength > MAX_PKT_BODY_SIZE)
+	uint32_t bodySize = 0;
+	for (int i = 0; i < bodyBufCount; i++)
+	{
+		bodySize += bodyBufs[i].size;
+	}
+	if (bodySize > MAX_PKT_BODY_SIZE)
 	{
 		return -1;
 	}
 
-	// Update Packet Counter
-	uint8_t* ptrSrc;
-	uint8_t* ptrSrcEnd;
 	uint8_t* ptrDest = (uint8_t*)encodedPacket;
 	uint8_t* ptrDestEnd = ptrDest + encodedPacketLength;
 	uint32_t shifter = 0;
 	uint32_t checkSumValue = CHECKSUM_SEED;
 	uint32_t val;
 
-	if (ptrDest >= ptrDestEnd)
+	// Header and footer are at most 7 bytes each when every byte is encoded
+	if (encodedPacketLength < (int)MAX_PKT_OVERHEAD_SIZE)
 	{
 		return -1;
 	}
+	ptrDestEnd -= 7;	// Reserve footer space so only the body needs bounds checks
+
 	// Packet header -------------------------------------------------------------------------------------------
 	*ptrDest++ = PSC_START_BYTE;
 
 	// PID
-	if (ptrDest >= ptrDestEnd)
-	{
-		return -1;
-	}
 	val = hdr->pid;
 	ptrDest = encodeByteAddToBuffer(val, ptrDest);
 	checkSumValue ^= val;
 
 	// Counter
-	if (ptrDest >= ptrDestEnd)
-	{
-		return -1;
-	}
 	val = hdr->counter;
 	ptrDest = encodeByteAddToBuffer(val, ptrDest);
 	checkSumValue ^= (val << 8);
 
 	// Flags
-	if (ptrDest >= ptrDestEnd)
-	{
-		return -1;
-	}
 	val = hdr->flags | additionalPktFlags | CPU_IS_LITTLE_ENDIAN | CM_PKT_FLAGS_CHECKSUM_24_BIT;
 	ptrDest = encodeByteAddToBuffer(val, ptrDest);
 	checkSumValue ^= (val << 16);
 
 	// Packet body ----------------------------------------------------------------------------------------------
-	if (srcBufferLength > 0)
+	for (int i = 0; i < bodyBufCount; i++)
 	{
-		ptrSrc = (uint8_t*)srcBuffer;
-		ptrSrcEnd = ptrSrc + srcBufferLength;
+		uint8_t* ptrSrc = bodyBufs[i].ptr;
+		uint8_t* ptrSrcEnd = ptrSrc + bodyBufs[i].size;
 
-		// copy body bytes, doing encoding and checksum
-		while (ptrSrc != ptrSrcEnd && ptrDest < ptrDestEnd)
-		{
-			val = *ptrSrc++;
-			checkSumValue ^= (val << shifter);
+		// Checksum is over the decoded bytes
+		checkSumValue = checksum24Accumulate(checkSumValue, ptrSrc, (int)bodyBufs[i].size, &shifter);
 
-			// increment shifter
-			shifter += 8;
+		if (!s_packetEncodingEnabled)
+		{
+			if (ptrDestEnd - ptrDest < (int)bodyBufs[i].size)
+			{
+				return -1;
+			}
+			memcpy(ptrDest, ptrSrc, bodyBufs[i].size);
+			ptrDest += bodyBufs[i].size;
+			continue;
+		}
 
-			// reset if shifter equals 24
-			shifter *= (shifter != 24);
+		while (ptrSrc < ptrSrcEnd)
+		{
+			// Copy run of bytes that need no encoding
+			uint8_t* ptrRunEnd = scanForKeyBytes(ptrSrc, ptrSrcEnd, s_specialBytes, _ARRAY_ELEMENT_COUNT(s_specialBytes));
+			int runSize = (int)(ptrRunEnd - ptrSrc);
+			if (ptrDestEnd - ptrDest < runSize)
+			{
+				return -1;
+			}
+			memcpy(ptrDest, ptrSrc, runSize);
+			ptrDest += runSize;
+			ptrSrc = ptrRunEnd;
 
-			ptrDest = encodeByteAddToBuffer(val, ptrDest);
+			// Encode special bytes
+			for (; ptrSrc < ptrSrcEnd && s_encodeTable[*ptrSrc]; ptrSrc++)
+			{
+				if (ptrDestEnd - ptrDest < 2)
+				{
+					return -1;
+				}
+				*ptrDest++ = PSC_RESERVED_KEY;
+				*ptrDest++ = (uint8_t)~(*ptrSrc);
+			}
 		}
 	}
 
 	// footer ----------------------------------------------------------------------------------------------------
 
 	// checksum byte 3
-	if (ptrDest >= ptrDestEnd)
-	{
-		return -1;
-	}
 	val = (uint8_t)((checkSumValue >> 16) & 0xFF);
 	ptrDest = encodeByteAddToBuffer(val, ptrDest);
 
 	// checksum byte 2
-	if (ptrDest >= ptrDestEnd)
-	{
-		return -1;
-	}
 	val = (uint8_t)(checkSumValue >> 8) & 0xFF;
 	ptrDest = encodeByteAddToBuffer(val, ptrDest);
 
 	// checksum byte 1
-	if (ptrDest >= ptrDestEnd)
-	{
-		return -1;
-	}
 	val = (uint8_t)(checkSumValue & 0xFF);
 	ptrDest = encodeByteAddToBuffer(val, ptrDest);
 
 	// packet end byte
-	if (ptrDest >= ptrDestEnd)
-	{
-		return -1;
-	}
 	*ptrDest++ = PSC_END_BYTE;
-    return (int)(ptrDest - (uint8_t*)encodedPacket);
+	return (int)(ptrDest - (uint8_t*)encodedPacket);
 }
 
 // This function will decode a packet in place if altBuf is NULL.
@@ -980,6 +1259,25 @@ int is_decode_binary_packet(packet_t* pkt, unsigned char* pbuf, int pbufSize)
 	ptrDest = pkt->body.ptr;
 	while (ptrSrc < ptrSrcEnd)
 	{
+		// Bytes up to the next special byte need no decoding
+		uint8_t* ptrRunEnd = scanForKeyBytes(ptrSrc, ptrSrcEnd, s_specialBytes, _ARRAY_ELEMENT_COUNT(s_specialBytes));
+		int runSize = (int)(ptrRunEnd - ptrSrc);
+		if (runSize)
+		{
+			if (ptrDest != ptrSrc)
+			{	// Shift data down over removed escape and header bytes.  ptrDest is never ahead of ptrSrc.
+				memmove(ptrDest, ptrSrc, runSize);
+			}
+			checkSumValue = checksum24Accumulate(checkSumValue, ptrDest, runSize, &shifter);
+			ptrSrc += runSize;
+			ptrDest += runSize;
+			if (ptrSrc >= ptrSrcEnd)
+			{
+				break;
+			}
+		}
+
+		// Escaped byte, anything else is corrupt data
 		if (is_decode_binary_packet_byte(&ptrSrc, &ptrDest, &checkSumValue, shifter))
 		{
 			return -1;
@@ -1057,6 +1355,11 @@ void is_enable_packet_encoding(int enabled)
 	s_packetEncodingEnabled = enabled;
 }
 
+void is_comm_enable_fast_scan(int enabled)
+{
+	s_fastScanEnabled = enabled;
+}
+
 /** Copies packet data into a data structure.  Returns 0 on success, -1 on failure. */
 char is_comm_copy_to_struct(void *sptr, const is_comm_instance_t *instance, const unsigned int maxsize)
 {    
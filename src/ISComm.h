@@ -674,10 +674,13 @@ int is_comm_stop_broadcasts_current_port(is_comm_instance_t* instance);
 // -------------------------------------------------------------------------------------------------------------------------------
 // common encode / decode for com manager and simple interface
 int is_encode_binary_packet(void* srcBuffer, unsigned int srcBufferLength, packet_hdr_t* hdr, uint8_t additionalPktFlags, void* encodedPacket, int encodedPacketLength);
+/** Same as is_encode_binary_packet() except the packet body is gathered from bodyBufCount separate buffers (i.e. data header and data), avoiding a copy into one contiguous buffer. */
+int is_encode_binary_packet_sg(const bufPtr_t* bodyBufs, int bodyBufCount, packet_hdr_t* hdr, uint8_t additionalPktFlags, void* encodedPacket, int encodedPacketLength);
 int is_decode_binary_packet(packet_t *pkt, unsigned char* pbuf, int pbufSize);
 int is_decode_binary_packet_byte(uint8_t** _ptrSrc, uint8_t** _ptrDest, uint32_t* checksum, uint32_t shift);
 void is_decode_binary_packet_footer(packet_ftr_t* ftr, uint8_t* ptrSrc, uint8_t** ptrSrcEnd, uint32_t* checksum);
 void is_enable_packet_encoding(int enabled); // default is enabled
+void is_comm_enable_fast_scan(int enabled); // default is enabled.  Vectorized skip to the next start/end byte in is_comm_parse().  Disable to parse one byte per iteration.
 
 unsigned int calculate24BitCRCQ(unsigned char* buffer, unsigned int len);
 unsigned int getBitsAsUInt32(const unsigned char* buffer, unsigned int pos, unsigned int len);
@@ -20,6 +20,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <stdio.h>
 #include <assert.h>
 #include <string.h>
+#include <ctype.h>
+#include <float.h>
 
 #include "ISDataMappings.h"
 #include "DataJSON.h"
@@ -35,8 +37,6 @@ using namespace std;
 
 #if PLATFORM_IS_EMBEDDED
 cISDataMappings* cISDataMappings::s_map;
-#else
-cISDataMappings cISDataMappings::s_map;
 #endif
 
 const unsigned char g_asciiToLowerMap[256] =
@@ -195,25 +195,157 @@ static void PopulateSizeMappings(uint32_t sizeMap[DID_COUNT])
 
 }
 
-static void PopulateTimestampField(uint32_t id, const data_info_t** timestamps, map_name_to_info_t mappings[DID_COUNT])
+static const data_info_t* FindFirstField(const map_name_to_info_t& offsetMap, const string* names, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		map_name_to_info_t::const_iterator field = offsetMap.find(names[i]);
+		if (field != offsetMap.end())
+		{
+			return (const data_info_t*)&field->second;
+		}
+	}
+	return NULLPTR;
+}
+
+static void PopulateTimestampField(uint32_t id, const data_info_t** timestamps, const data_info_t** timesOfWeek, map_name_to_info_t mappings[DID_COUNT])
 {
 	static const string timestampFields[] = { "time", "timeOfWeek", "timeOfWeekMs", "seconds" };
+	static const string timeOfWeekFields[] = { "timeOfWeek", "timeOfWeekMs" };
 	const map_name_to_info_t& offsetMap = mappings[id];
 
-	if (offsetMap.size() != 0)
+	// NULL if none, ensures value is not garbage
+	timestamps[id] = FindFirstField(offsetMap, timestampFields, _ARRAY_ELEMENT_COUNT(timestampFields));
+	timesOfWeek[id] = FindFirstField(offsetMap, timeOfWeekFields, _ARRAY_ELEMENT_COUNT(timeOfWeekFields));
+}
+
+static void PopulateSerializePlan(uint32_t id, data_serialize_plan_t* plans, const uint32_t* sizes, map_name_to_info_t mappings[DID_COUNT])
+{
+	data_serialize_plan_t& plan = plans[id];
+	const map_name_to_info_t& offsetMap = mappings[id];
+	plan.ops.clear();
+	plan.ops.reserve(offsetMap.size());
+	plan.dataSize = sizes[id];
+	plan.maxStringLength = 0;
+
+	// Same order as the csv header, which iterates the map
+	for (map_name_to_info_t::const_iterator i = offsetMap.begin(); i != offsetMap.end(); i++)
+	{
+		const data_info_t& info = i->second;
+		data_serialize_op_t op;
+		op.dataOffset = info.dataOffset;
+		op.dataSize = info.dataSize;
+		op.dataType = info.dataType;
+		op.dataFlags = info.dataFlags;
+		op.jsonName = ",\"" + info.name + "\":";
+		plan.ops.push_back(op);
+
+		uint32_t valueLength = 32;
+		if (info.dataType == DataTypeString || info.dataType == DataTypeBinary)
+		{
+			valueLength = _MIN(2 * info.dataSize + 4, IS_DATA_MAPPING_MAX_STRING_LENGTH);
+		}
+		plan.maxStringLength += (uint32_t)op.jsonName.size() + valueLength;
+	}
+}
+
+static uint32_t NameHash(const char* name, size_t length, uint32_t seed)
+{
+	// FNV-1a over lower case chars so names that differ only in case hash the same, then mix so the low bits pick the slot
+	uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+	for (size_t i = 0; i < length; i++)
+	{
+		hash = (hash ^ g_asciiToLowerMap[(unsigned char)name[i]]) * 16777619u;
+	}
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6Bu;
+	hash ^= hash >> 13;
+	return hash;
+}
+
+static bool NameEqualsNoCase(const char* name, size_t length, const std::string& other)
+{
+	if (length != other.size())
+	{
+		return false;
+	}
+	for (size_t i = 0; i < length; i++)
 	{
-		for (size_t i = 0; i < _ARRAY_ELEMENT_COUNT(timestampFields); i++)
+		if (g_asciiToLowerMap[(unsigned char)name[i]] != g_asciiToLowerMap[(unsigned char)other[i]])
 		{
-			map_name_to_info_t::const_iterator timestampField = offsetMap.find(timestampFields[i]);
-			if (timestampField != offsetMap.end())
+			return false;
+		}
+	}
+	return true;
+}
+
+static int FindName(const data_name_table_t& table, const char* name, size_t length)
+{
+	if (table.slots.size() == 0)
+	{
+		return -1;
+	}
+	return (int)table.slots[NameHash(name, length, table.seed) & table.mask] - 1;
+}
+
+// Find a seed and table size that place every name in its own slot.  Names that differ only in case share a slot, the first one wins.
+static void PopulateNameTable(data_name_table_t& table, const vector<string>& names)
+{
+	uint32_t size = 4;
+	while (size < 2 * names.size())
+	{
+		size <<= 1;
+	}
+	for (;; size <<= 1)
+	{
+		table.mask = size - 1;
+		for (table.seed = 0; table.seed < 64; table.seed++)
+		{
+			table.slots.assign(size, 0);
+			size_t i = 0;
+			for (; i < names.size(); i++)
+			{
+				if (names[i].size() == 0)
+				{
+					continue;
+				}
+				uint16_t& slot = table.slots[NameHash(names[i].data(), names[i].size(), table.seed) & table.mask];
+				if (slot == 0)
+				{
+					slot = (uint16_t)(i + 1);
+				}
+				else if (!NameEqualsNoCase(names[i].data(), names[i].size(), names[slot - 1]))
+				{	// collision, try the next seed
+					break;
+				}
+			}
+			if (i == names.size())
 			{
-				timestamps[id] = (const data_info_t*)&timestampField->second;
 				return;
 			}
 		}
 	}
+}
+
+static void PopulateFieldTable(uint32_t id, vector<data_info_t>* fields, data_name_table_t* fieldNames, map_name_to_info_t mappings[DID_COUNT])
+{
+	const map_name_to_info_t& offsetMap = mappings[id];
+	vector<data_info_t>& f = fields[id];
+	f.clear();
+	f.reserve(offsetMap.size());
+	for (map_name_to_info_t::const_iterator i = offsetMap.begin(); i != offsetMap.end(); i++)
+	{
+		f.push_back(i->second);
+	}
+	stable_sort(f.begin(), f.end(), [](const data_info_t& a, const data_info_t& b) { return a.dataOffset < b.dataOffset; });
 
-	timestamps[id] = NULLPTR; // ensure value is not garbage
+	vector<string> names;
+	names.reserve(f.size());
+	for (size_t i = 0; i < f.size(); i++)
+	{
+		names.push_back(f[i].name);
+	}
+	PopulateNameTable(fieldNames[id], names);
 }
 
 static void PopulateDeviceInfoMappings(map_name_to_info_t mappings[DID_COUNT], uint32_t id)
@@ -2453,95 +2585,150 @@ const char* const cISDataMappings::m_dataIdNames[] =
 
 cISDataMappings::cISDataMappings()
 {
+	// Only the sizes are populated up front, field mappings are populated per data set on first use, see Instance
 	PopulateSizeMappings(m_lookupSize);
-	PopulateDeviceInfoMappings(m_lookupInfo, DID_DEV_INFO);
-	PopulateBitMappings(m_lookupInfo);
-	PopulateSysFaultMappings(m_lookupInfo);
-	PopulateIMU3Mappings(m_lookupInfo, DID_IMU3_UNCAL);
-	PopulateIMU3Mappings(m_lookupInfo, DID_IMU3_RAW);
-	PopulateIMUMappings(m_lookupInfo, DID_IMU_RAW);
-	PopulateIMUMappings(m_lookupInfo, DID_IMU);
-	PopulateIMUDeltaThetaVelocityMappings(m_lookupInfo, DID_PIMU);
-	PopulateMagnetometerMappings(m_lookupInfo, DID_MAGNETOMETER);
-	PopulateMagnetometerMappings(m_lookupInfo, DID_REFERENCE_MAGNETOMETER);
-	PopulateBarometerMappings(m_lookupInfo);
-	PopulateWheelEncoderMappings(m_lookupInfo);
-	PopulateSysParamsMappings(m_lookupInfo);
-	PopulateSysSensorsMappings(m_lookupInfo);
-	PopulateRMCMappings(m_lookupInfo);
-	PopulateINS1Mappings(m_lookupInfo);
-	PopulateINS2Mappings(m_lookupInfo);
-	PopulateINS3Mappings(m_lookupInfo);
-	PopulateINS4Mappings(m_lookupInfo);
-	PopulateGpsPosMappings(m_lookupInfo, DID_GPS1_POS);
-	PopulateGpsPosMappings(m_lookupInfo, DID_GPS1_UBX_POS);
-	PopulateGpsPosMappings(m_lookupInfo, DID_GPS2_POS);
-	PopulateGpsPosMappings(m_lookupInfo, DID_GPS1_RTK_POS);
-	PopulateGpsVelMappings(m_lookupInfo, DID_GPS1_VEL);
-	PopulateGpsVelMappings(m_lookupInfo, DID_GPS2_VEL);
-	//PopulateGPSCNOMappings(m_lookupInfo, DID_GPS1_SAT); // too much data, we don't want to log this
-	//PopulateGPSCNOMappings(m_lookupInfo, DID_GPS2_SAT); // too much data, we don't want to log this
-	PopulateGpsRtkRelMappings(m_lookupInfo, DID_GPS1_RTK_POS_REL);
-	PopulateGpsRtkRelMappings(m_lookupInfo, DID_GPS2_RTK_CMP_REL);
-	PopulateGpsRtkMiscMappings(m_lookupInfo, DID_GPS1_RTK_POS_MISC);
-	PopulateGpsRtkMiscMappings(m_lookupInfo, DID_GPS2_RTK_CMP_MISC);
-	PopulateGpsRawMappings(m_lookupInfo, DID_GPS1_RAW);
-	PopulateGpsRawMappings(m_lookupInfo, DID_GPS2_RAW);
-	PopulateGpsRawMappings(m_lookupInfo, DID_GPS_BASE_RAW);
-	PopulateGroundVehicleMappings(m_lookupInfo);
-	PopulateConfigMappings(m_lookupInfo);
-	PopulateFlashConfigMappings(m_lookupInfo);
-	PopulateDebugArrayMappings(m_lookupInfo, DID_DEBUG_ARRAY);
-	PopulateEvbStatusMappings(m_lookupInfo);
-	PopulateEvbFlashCfgMappings(m_lookupInfo);
-	PopulateDebugArrayMappings(m_lookupInfo, DID_EVB_DEBUG_ARRAY);
-	PopulateDeviceInfoMappings(m_lookupInfo, DID_EVB_DEV_INFO);
-	PopulateIOMappings(m_lookupInfo);
-	PopulateReferenceIMUMappings(m_lookupInfo);
-	PopulateIMUDeltaThetaVelocityMappings(m_lookupInfo, DID_REFERENCE_PIMU);
-	PopulateInfieldCalMappings(m_lookupInfo);
+	for (uint32_t id = 0; id < DID_COUNT; id++)
+	{
+		m_populated[id] = false;
+	}
+	m_dataSetNamesPopulated = false;
+}
+
+
+void cISDataMappings::PopulateMappings(uint32_t dataId)
+{
+	map_name_to_info_t* mappings = m_lookupInfo;
+	switch (dataId)
+	{
+	case DID_DEV_INFO:					PopulateDeviceInfoMappings(mappings, DID_DEV_INFO); break;
+	case DID_BIT:						PopulateBitMappings(mappings); break;
+	case DID_SYS_FAULT:					PopulateSysFaultMappings(mappings); break;
+	case DID_IMU3_UNCAL:				PopulateIMU3Mappings(mappings, DID_IMU3_UNCAL); break;
+	case DID_IMU3_RAW:					PopulateIMU3Mappings(mappings, DID_IMU3_RAW); break;
+	case DID_IMU_RAW:					PopulateIMUMappings(mappings, DID_IMU_RAW); break;
+	case DID_IMU:						PopulateIMUMappings(mappings, DID_IMU); break;
+	case DID_PIMU:						PopulateIMUDeltaThetaVelocityMappings(mappings, DID_PIMU); break;
+	case DID_MAGNETOMETER:				PopulateMagnetometerMappings(mappings, DID_MAGNETOMETER); break;
+	case DID_REFERENCE_MAGNETOMETER:	PopulateMagnetometerMappings(mappings, DID_REFERENCE_MAGNETOMETER); break;
+	case DID_BAROMETER:					PopulateBarometerMappings(mappings); break;
+	case DID_WHEEL_ENCODER:				PopulateWheelEncoderMappings(mappings); break;
+	case DID_SYS_PARAMS:				PopulateSysParamsMappings(mappings); break;
+	case DID_SYS_SENSORS:				PopulateSysSensorsMappings(mappings); break;
+	case DID_RMC:						PopulateRMCMappings(mappings); break;
+	case DID_INS_1:						PopulateINS1Mappings(mappings); break;
+	case DID_INS_2:						PopulateINS2Mappings(mappings); break;
+	case DID_INS_3:						PopulateINS3Mappings(mappings); break;
+	case DID_INS_4:						PopulateINS4Mappings(mappings); break;
+	case DID_GPS1_POS:					PopulateGpsPosMappings(mappings, DID_GPS1_POS); break;
+	case DID_GPS1_UBX_POS:				PopulateGpsPosMappings(mappings, DID_GPS1_UBX_POS); break;
+	case DID_GPS2_POS:					PopulateGpsPosMappings(mappings, DID_GPS2_POS); break;
+	case DID_GPS1_RTK_POS:				PopulateGpsPosMappings(mappings, DID_GPS1_RTK_POS); break;
+	case DID_GPS1_VEL:					PopulateGpsVelMappings(mappings, DID_GPS1_VEL); break;
+	case DID_GPS2_VEL:					PopulateGpsVelMappings(mappings, DID_GPS2_VEL); break;
+	case DID_GPS1_RTK_POS_REL:			PopulateGpsRtkRelMappings(mappings, DID_GPS1_RTK_POS_REL); break;
+	case DID_GPS2_RTK_CMP_REL:			PopulateGpsRtkRelMappings(mappings, DID_GPS2_RTK_CMP_REL); break;
+	case DID_GPS1_RTK_POS_MISC:			PopulateGpsRtkMiscMappings(mappings, DID_GPS1_RTK_POS_MISC); break;
+	case DID_GPS2_RTK_CMP_MISC:			PopulateGpsRtkMiscMappings(mappings, DID_GPS2_RTK_CMP_MISC); break;
+	case DID_GPS1_RAW:					PopulateGpsRawMappings(mappings, DID_GPS1_RAW); break;
+	case DID_GPS2_RAW:					PopulateGpsRawMappings(mappings, DID_GPS2_RAW); break;
+	case DID_GPS_BASE_RAW:				PopulateGpsRawMappings(mappings, DID_GPS_BASE_RAW); break;
+//	case DID_GPS1_SAT:					PopulateGPSCNOMappings(mappings, DID_GPS1_SAT); break; // too much data, we don't want to log this
+//	case DID_GPS2_SAT:					PopulateGPSCNOMappings(mappings, DID_GPS2_SAT); break; // too much data, we don't want to log this
+	case DID_GROUND_VEHICLE:			PopulateGroundVehicleMappings(mappings); break;
+	case DID_SYS_CMD:					PopulateConfigMappings(mappings); break;
+	case DID_FLASH_CONFIG:				PopulateFlashConfigMappings(mappings); break;
+	case DID_DEBUG_ARRAY:				PopulateDebugArrayMappings(mappings, DID_DEBUG_ARRAY); break;
+	case DID_EVB_STATUS:				PopulateEvbStatusMappings(mappings); break;
+	case DID_EVB_FLASH_CFG:				PopulateEvbFlashCfgMappings(mappings); break;
+	case DID_EVB_DEBUG_ARRAY:			PopulateDebugArrayMappings(mappings, DID_EVB_DEBUG_ARRAY); break;
+	case DID_EVB_DEV_INFO:				PopulateDeviceInfoMappings(mappings, DID_EVB_DEV_INFO); break;
+	case DID_IO:						PopulateIOMappings(mappings); break;
+	case DID_REFERENCE_IMU:				PopulateReferenceIMUMappings(mappings); break;
+	case DID_REFERENCE_PIMU:			PopulateIMUDeltaThetaVelocityMappings(mappings, DID_REFERENCE_PIMU); break;
+	case DID_INFIELD_CAL:				PopulateInfieldCalMappings(mappings); break;
 
 #if defined(INCLUDE_LUNA_DATA_SETS)
-	PopulateEvbLunaFlashCfgMappings(m_lookupInfo);
-	PopulateCoyoteStatusMappings(m_lookupInfo);
-	PopulateEvbLunaSensorsMappings(m_lookupInfo);
-	PopulateEvbLunaVelocityControlMappings(m_lookupInfo);
-	PopulateEvbLunaVelocityCommandMappings(m_lookupInfo);
-	PopulateEvbLunaAuxCmdMappings(m_lookupInfo);
+
+	case DID_EVB_LUNA_FLASH_CFG:		PopulateEvbLunaFlashCfgMappings(mappings); break;
+	case DID_EVB_LUNA_STATUS:			PopulateCoyoteStatusMappings(mappings); break;
+	case DID_EVB_LUNA_SENSORS:			PopulateEvbLunaSensorsMappings(mappings); break;
+	case DID_EVB_LUNA_VELOCITY_CONTROL:	PopulateEvbLunaVelocityControlMappings(mappings); break;
+	case DID_EVB_LUNA_VELOCITY_COMMAND:	PopulateEvbLunaVelocityCommandMappings(mappings); break;
+	case DID_EVB_LUNA_AUX_COMMAND:		PopulateEvbLunaAuxCmdMappings(mappings); break;
+
 #endif
 
-	PopulateStrobeInTimeMappings(m_lookupInfo);
-//	PopulateRtosInfoMappings(m_lookupInfo);
-	PopulateDiagMsgMappings(m_lookupInfo);
-	PopulateCanConfigMappings(m_lookupInfo);
+	case DID_STROBE_IN_TIME:			PopulateStrobeInTimeMappings(mappings); break;
+//	case DID_RTOS_INFO:					PopulateRtosInfoMappings(mappings); break;
+	case DID_DIAGNOSTIC_MESSAGE:		PopulateDiagMsgMappings(mappings); break;
+	case DID_CAN_CONFIG:				PopulateCanConfigMappings(mappings); break;
 
 #ifdef USE_IS_INTERNAL
 
-	PopulateSensorsADCMappings(m_lookupInfo);
-	PopulateSensorsISMappings(m_lookupInfo, DID_SENSORS_UCAL);
-	PopulateSensorsISMappings(m_lookupInfo, DID_SENSORS_TCAL);
-	PopulateSensorsISMappings(m_lookupInfo, DID_SENSORS_MCAL);
-	PopulateSensorsTCMappings(m_lookupInfo);
-	PopulateSensorsCompMappings(m_lookupInfo);
-	PopulateUserPage0Mappings(m_lookupInfo);
-	PopulateUserPage1Mappings(m_lookupInfo);
-	PopulateInl2MagObsInfo(m_lookupInfo);
-	PopulateInl2StatesMappings(m_lookupInfo);
-//     PopulateRtkStateMappings(m_lookupInfo);
-//     PopulateRtkResidualMappings(m_lookupInfo, DID_RTK_CODE_RESIDUAL);
-//     PopulateRtkResidualMappings(m_lookupInfo, DID_RTK_PHASE_RESIDUAL);
-	PopulateRtkDebugMappings(m_lookupInfo);
-	// PopulateRtkDebug2Mappings(m_lookupInfo);
-	PopulateIMUDeltaThetaVelocityMagMappings(m_lookupInfo);
-	PopulateIMUMagnetometerMappings(m_lookupInfo);
+	case DID_SENSORS_ADC:				PopulateSensorsADCMappings(mappings); break;
+	case DID_SENSORS_UCAL:				PopulateSensorsISMappings(mappings, DID_SENSORS_UCAL); break;
+	case DID_SENSORS_TCAL:				PopulateSensorsISMappings(mappings, DID_SENSORS_TCAL); break;
+	case DID_SENSORS_MCAL:				PopulateSensorsISMappings(mappings, DID_SENSORS_MCAL); break;
+	case DID_SENSORS_TC_BIAS:			PopulateSensorsTCMappings(mappings); break;
+	case DID_SCOMP:						PopulateSensorsCompMappings(mappings); break;
+	case DID_NVR_USERPAGE_G0:			PopulateUserPage0Mappings(mappings); break;
+	case DID_NVR_USERPAGE_G1:			PopulateUserPage1Mappings(mappings); break;
+	case DID_INL2_MAG_OBS_INFO:			PopulateInl2MagObsInfo(mappings); break;
+	case DID_INL2_STATES:				PopulateInl2StatesMappings(mappings); break;
+//	case DID_RTK_STATE:					PopulateRtkStateMappings(mappings); break;
+//	case DID_RTK_CODE_RESIDUAL:			PopulateRtkResidualMappings(mappings, DID_RTK_CODE_RESIDUAL); break;
+//	case DID_RTK_PHASE_RESIDUAL:		PopulateRtkResidualMappings(mappings, DID_RTK_PHASE_RESIDUAL); break;
+	case DID_RTK_DEBUG:					PopulateRtkDebugMappings(mappings); break;
+//	case DID_RTK_DEBUG_2:				PopulateRtkDebug2Mappings(mappings); break;
+	case DID_PIMU_MAG:					PopulateIMUDeltaThetaVelocityMagMappings(mappings); break;
+	case DID_IMU_MAG:					PopulateIMUMagnetometerMappings(mappings); break;
 
 #endif
 
-	// this mustcome last
-	for (uint32_t id = 0; id < DID_COUNT; id++)
+	default: break;
+	}
+
+	// this must come last
+	PopulateTimestampField(dataId, m_timestampFields, m_timeOfWeekFields, m_lookupInfo);
+	PopulateSerializePlan(dataId, m_serializePlans, m_lookupSize, m_lookupInfo);
+	PopulateFieldTable(dataId, m_fields, m_fieldNames, m_lookupInfo);
+}
+
+
+cISDataMappings& cISDataMappings::Instance(uint32_t dataId)
+{
+
+#if PLATFORM_IS_EMBEDDED
+
+	// on embedded we cannot new up C++ runtime until after free rtos has started
+	if (s_map == NULLPTR)
 	{
-		PopulateTimestampField(id, m_timestampFields, m_lookupInfo);
+		s_map = new cISDataMappings();
 	}
+	cISDataMappings& map = *s_map;
+	if (dataId < DID_COUNT && !map.m_populated[dataId])
+	{
+		map.PopulateMappings(dataId);
+		map.m_populated[dataId] = true;
+	}
+
+#else
+
+	// constructed on first use, which is thread safe and avoids static initialization order issues
+	static cISDataMappings map;
+	if (dataId < DID_COUNT && !map.m_populated[dataId].load(memory_order_acquire))
+	{	// the log converters look up data sets from several threads
+		lock_guard<mutex> lock(map.m_populateMutex);
+		if (!map.m_populated[dataId].load(memory_order_relaxed))
+		{
+			map.PopulateMappings(dataId);
+			map.m_populated[dataId].store(true, memory_order_release);
+		}
+	}
+
+#endif
+
+	return map;
 }
 
 
@@ -2562,74 +2749,86 @@ const char* cISDataMappings::GetDataSetName(uint32_t dataId)
 }
 
 
-uint32_t cISDataMappings::GetDataSetId(string name)
+uint32_t cISDataMappings::GetDataSetId(const char* name, size_t length)
 {
-// 	transform(name.begin(), name.end(), name.begin(), ::toupper);
+	cISDataMappings& map = Instance();
+
+#if PLATFORM_IS_EMBEDDED
 
-	for (eDataIDs id = 0; id < DID_COUNT; id++)
+	if (!map.m_dataSetNamesPopulated)
 	{
-		if (strcmp(name.c_str(), m_dataIdNames[id]) == 0)
-		{	// Found match
-			return id;
+		PopulateNameTable(map.m_dataSetNames, vector<string>(m_dataIdNames, m_dataIdNames + DID_COUNT));
+		map.m_dataSetNamesPopulated = true;
+	}
+
+#else
+
+	if (!map.m_dataSetNamesPopulated.load(memory_order_acquire))
+	{
+		lock_guard<mutex> lock(map.m_populateMutex);
+		if (!map.m_dataSetNamesPopulated.load(memory_order_relaxed))
+		{
+			PopulateNameTable(map.m_dataSetNames, vector<string>(m_dataIdNames, m_dataIdNames + DID_COUNT));
+			map.m_dataSetNamesPopulated.store(true, memory_order_release);
 		}
 	}
 
+#endif
+
+	int id = FindName(map.m_dataSetNames, name, length);
+	if (id >= 0 && strlen(m_dataIdNames[id]) == length && memcmp(name, m_dataIdNames[id], length) == 0)
+	{	// Found match
+		return (uint32_t)id;
+	}
+
 	return 0;
 }
 
 
 const map_name_to_info_t* cISDataMappings::GetMapInfo(uint32_t dataId)
 {
-
-#if PLATFORM_IS_EMBEDDED
-
-	if (s_map == NULLPTR)
+	if (dataId < DID_COUNT)
 	{
-		s_map = new cISDataMappings();
+		return &Instance(dataId).m_lookupInfo[dataId];
 	}
+	return NULLPTR;
+}
 
-#endif
 
-	if (dataId < DID_COUNT)
+const data_info_t* cISDataMappings::GetFieldInfo(uint32_t dataId, const char* name, size_t length)
+{
+	if (dataId >= DID_COUNT)
 	{
+		return NULLPTR;
+	}
 
-#if PLATFORM_IS_EMBEDDED
-
-		return &s_map->m_lookupInfo[dataId];
-
-#else
-
-		return &s_map.m_lookupInfo[dataId];
-
-#endif
-
+	const cISDataMappings& map = Instance(dataId);
+	const vector<data_info_t>& fields = map.m_fields[dataId];
+	int index = FindName(map.m_fieldNames[dataId], name, length);
+	if (index >= 0 && NameEqualsNoCase(name, length, fields[index].name))
+	{
+		return &fields[index];
 	}
 	return NULLPTR;
 }
 
 
-uint32_t cISDataMappings::GetSize(uint32_t dataId)
+data_fields_t cISDataMappings::GetFields(uint32_t dataId)
 {
-
-#if PLATFORM_IS_EMBEDDED
-
-	if (s_map == NULLPTR)
+	data_fields_t fields = { NULLPTR, 0 };
+	if (dataId < DID_COUNT)
 	{
-		s_map = new cISDataMappings();
+		const vector<data_info_t>& f = Instance(dataId).m_fields[dataId];
+		fields.fields = f.data();
+		fields.count = f.size();
 	}
+	return fields;
+}
 
-#endif
-
-#if PLATFORM_IS_EMBEDDED
-
-	return (dataId < DID_MAX_COUNT ? s_map->m_lookupSize[dataId] : 0);
-
-#else
-
-	return (dataId < DID_COUNT ? s_map.m_lookupSize[dataId] : 0);
-
-#endif
 
+uint32_t cISDataMappings::GetSize(uint32_t dataId)
+{
+	return (dataId < DID_COUNT ? Instance().m_lookupSize[dataId] : 0);
 }
 
 
@@ -2742,6 +2941,221 @@ bool cISDataMappings::StringToVariable(const char* stringBuffer, int stringLengt
 }
 
 
+// Parsers for FieldToVariable, the text is not null terminated so end marks the end of the field
+
+static uint64_t ParseInteger(const char* str, const char* end, bool& negative)
+{
+	while (str < end && (*str == ' ' || *str == '\t'))
+	{
+		str++;
+	}
+	negative = false;
+	if (str < end && (*str == '-' || *str == '+'))
+	{
+		negative = (*str++ == '-');
+	}
+
+	uint64_t value = 0;
+	if (end - str > 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
+	{	// hex as written for DataFlagsDisplayHex fields
+		for (str += 2; str < end; str++)
+		{
+			char c = *str;
+			if (c >= '0' && c <= '9')		value = (value << 4) | (uint64_t)(c - '0');
+			else if (c >= 'A' && c <= 'F')	value = (value << 4) | (uint64_t)(c - 'A' + 10);
+			else if (c >= 'a' && c <= 'f')	value = (value << 4) | (uint64_t)(c - 'a' + 10);
+			else							break;
+		}
+	}
+	else
+	{
+		for (; str < end && *str >= '0' && *str <= '9'; str++)
+		{
+			value = value * 10 + (uint64_t)(*str - '0');
+		}
+	}
+	return value;
+}
+
+static int64_t ParseSignedInteger(const char* str, const char* end)
+{
+	bool negative;
+	uint64_t value = ParseInteger(str, end, negative);
+	return (negative ? -(int64_t)value : (int64_t)value);
+}
+
+static uint64_t ParseUnsignedInteger(const char* str, const char* end)
+{
+	bool negative;
+	uint64_t value = ParseInteger(str, end, negative);
+	return (negative ? (uint64_t)0 - value : value);
+}
+
+/**
+* Parse a decimal number of up to 19 significant digits whose power of ten is exact in a double.  One multiply or divide of
+* two exact doubles is correctly rounded, so the result matches strtod (Clinger's fast path).
+* returns false if the number needs strtod
+*/
+static bool ParseDoubleFast(const char* str, const char* end, double& value)
+{
+	static const double pow10[23] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0
+
+	// extended precision intermediates round twice
+	return false;
+
+#endif
+
+	while (str < end && (*str == ' ' || *str == '\t'))
+	{
+		str++;
+	}
+	bool negative = false;
+	if (str < end && (*str == '-' || *str == '+'))
+	{
+		negative = (*str++ == '-');
+	}
+
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool anyDigits = false;
+	for (; str < end && *str >= '0' && *str <= '9'; str++)
+	{
+		anyDigits = true;
+		if (digits == 19)
+		{
+			return false;
+		}
+		mantissa = mantissa * 10 + (uint64_t)(*str - '0');
+		digits += (mantissa != 0);
+	}
+	if (str < end && *str == '.')
+	{
+		for (str++; str < end && *str >= '0' && *str <= '9'; str++)
+		{
+			anyDigits = true;
+			if (digits == 19)
+			{
+				return false;
+			}
+			mantissa = mantissa * 10 + (uint64_t)(*str - '0');
+			digits += (mantissa != 0);
+			exponent--;
+		}
+	}
+	if (!anyDigits)
+	{
+		return false;
+	}
+	if (str < end && (*str == 'e' || *str == 'E'))
+	{
+		str++;
+		bool negativeExponent = false;
+		if (str < end && (*str == '-' || *str == '+'))
+		{
+			negativeExponent = (*str++ == '-');
+		}
+		int e = 0;
+		const char* start = str;
+		for (; str < end && *str >= '0' && *str <= '9' && e < 10000; str++)
+		{
+			e = e * 10 + (*str - '0');
+		}
+		if (str == start)
+		{
+			return false;
+		}
+		exponent += (negativeExponent ? -e : e);
+	}
+	if (str < end && (isalnum((unsigned char)*str) || *str == '.'))
+	{	// nan, inf or not a number
+		return false;
+	}
+
+	double result;
+	if (mantissa == 0)
+	{
+		result = 0.0;
+	}
+	else if (mantissa > (1ULL << 53) || exponent < -22 || exponent > 22)
+	{
+		return false;
+	}
+	else
+	{
+		result = (exponent < 0 ? (double)mantissa / pow10[-exponent] : (double)mantissa * pow10[exponent]);
+	}
+	value = (negative ? -result : result);
+	return true;
+}
+
+static double ParseDouble(const char* str, const char* end)
+{
+	double value;
+	if (ParseDoubleFast(str, end, value))
+	{
+		return value;
+	}
+	char tmp[64];
+	size_t length = _MIN((size_t)(end - str), sizeof(tmp) - 1);
+	memcpy(tmp, str, length);
+	tmp[length] = '\0';
+	return strtod(tmp, NULL);
+}
+
+static float ParseFloat(const char* str, const char* end)
+{
+	double value;
+	if (ParseDoubleFast(str, end, value))
+	{
+		// Rounding the correctly rounded double to float only differs from strtof when the double is exactly halfway
+		// between two floats, or when it is outside of the normal float range
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		double magnitude = fabs(value);
+		if ((bits & 0x1FFFFFFFULL) != 0x10000000ULL && (magnitude == 0.0 || (magnitude >= FLT_MIN && magnitude <= FLT_MAX)))
+		{
+			return (float)value;
+		}
+	}
+	char tmp[64];
+	size_t length = _MIN((size_t)(end - str), sizeof(tmp) - 1);
+	memcpy(tmp, str, length);
+	tmp[length] = '\0';
+	return strtof(tmp, NULL);
+}
+
+
+bool cISDataMappings::FieldToVariable(const char* stringBuffer, int stringLength, uint8_t* dataBuffer, eDataType dataType, uint32_t dataSize, bool json)
+{
+	const char* end = stringBuffer + stringLength;
+	switch (dataType)
+	{
+	case DataTypeInt8:		{ int8_t v = (int8_t)ParseSignedInteger(stringBuffer, end);			memcpy(dataBuffer, &v, sizeof(v)); } break;
+	case DataTypeUInt8:		{ uint8_t v = (uint8_t)ParseUnsignedInteger(stringBuffer, end);		memcpy(dataBuffer, &v, sizeof(v)); } break;
+	case DataTypeInt16:		{ int16_t v = (int16_t)ParseSignedInteger(stringBuffer, end);		memcpy(dataBuffer, &v, sizeof(v)); } break;
+	case DataTypeUInt16:	{ uint16_t v = (uint16_t)ParseUnsignedInteger(stringBuffer, end);	memcpy(dataBuffer, &v, sizeof(v)); } break;
+	case DataTypeInt32:		{ int32_t v = (int32_t)ParseSignedInteger(stringBuffer, end);		memcpy(dataBuffer, &v, sizeof(v)); } break;
+	case DataTypeUInt32:	{ uint32_t v = (uint32_t)ParseUnsignedInteger(stringBuffer, end);	memcpy(dataBuffer, &v, sizeof(v)); } break;
+	case DataTypeInt64:		{ int64_t v = ParseSignedInteger(stringBuffer, end);				memcpy(dataBuffer, &v, sizeof(v)); } break;
+	case DataTypeUInt64:	{ uint64_t v = ParseUnsignedInteger(stringBuffer, end);				memcpy(dataBuffer, &v, sizeof(v)); } break;
+	case DataTypeFloat:		{ float v = ParseFloat(stringBuffer, end);							memcpy(dataBuffer, &v, sizeof(v)); } break;
+	case DataTypeDouble:	{ double v = ParseDouble(stringBuffer, end);						memcpy(dataBuffer, &v, sizeof(v)); } break;
+	default:
+	{
+		string s(stringBuffer, stringLength);
+		return StringToVariable(s.c_str(), stringLength, dataBuffer, dataType, dataSize, 10, json);
+	}
+	}
+	return true;
+}
+
+
 bool cISDataMappings::DataToString(const data_info_t& info, const p_data_hdr_t* hdr, const uint8_t* datasetBuffer, data_mapping_string_t stringBuffer, bool json)
 {
 	const uint8_t* ptr;
@@ -2903,6 +3317,344 @@ bool cISDataMappings::VariableToString(eDataType dataType, eDataFlags dataFlags,
 	return true;
 }
 
+const data_serialize_plan_t* cISDataMappings::GetSerializePlan(uint32_t dataId)
+{
+	if (dataId < DID_COUNT)
+	{
+		return &Instance(dataId).m_serializePlans[dataId];
+	}
+	return NULLPTR;
+}
+
+
+// Formatters for DataSetToString, output matches the printf formats in VariableToString
+
+template <typename T> static inline T ReadField(const uint8_t* ptr)
+{
+	T value;
+	memcpy(&value, ptr, sizeof(T));
+	return value;
+}
+
+static char* FormatUInt(char* out, uint64_t value)
+{
+	char digits[20];
+	int count = 0;
+	do
+	{
+		digits[count++] = (char)('0' + (value % 10));
+		value /= 10;
+	} while (value != 0);
+	while (count > 0)
+	{
+		*out++ = digits[--count];
+	}
+	return out;
+}
+
+static char* FormatInt(char* out, int64_t value)
+{
+	if (value < 0)
+	{
+		*out++ = '-';
+		return FormatUInt(out, (uint64_t)0 - (uint64_t)value);
+	}
+	return FormatUInt(out, (uint64_t)value);
+}
+
+static char* FormatHex(char* out, uint64_t value, int minDigits)
+{
+	static const char hexDigits[] = "0123456789ABCDEF";
+	char digits[16];
+	int count = 0;
+	do
+	{
+		digits[count++] = hexDigits[value & 0x0F];
+		value >>= 4;
+	} while (value != 0);
+	*out++ = '0';
+	*out++ = 'x';
+	for (int i = count; i < minDigits; i++)
+	{
+		*out++ = '0';
+	}
+	while (count > 0)
+	{
+		*out++ = digits[--count];
+	}
+	return out;
+}
+
+#if defined(__SIZEOF_INT128__)
+
+/**
+* Exact %.<precision>g for a finite, non-integral value, same rounding as printf (round half to even on the exact binary value).
+* The value times 10^(precision - 1 - decimal exponent) must fit in 128 bits, which covers magnitudes from about 1e-6 up.
+* returns NULL if the value is out of range
+*/
+static char* FormatRealExact(char* out, double value, int precision)
+{
+	static const uint64_t pow10[20] =
+	{
+		1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+		10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+		10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+	};
+	typedef unsigned __int128 uint128_t;
+
+	// value = mantissa * 2^-shift
+	double magnitude = fabs(value);
+	int exponent;
+	uint64_t mantissa = (uint64_t)ldexp(frexp(magnitude, &exponent), 53);
+	int shift = 53 - exponent;
+	if (shift <= 0 || shift >= 128)
+	{
+		return NULLPTR;
+	}
+
+	// digits = round(value * 10^scale) with precision digits
+	int decimalExponent = (int)floor(log10(magnitude));
+	uint64_t digits = 0;
+	for (int attempt = 0; attempt < 3; attempt++)
+	{
+		int scale = precision - 1 - decimalExponent;
+		if (scale < 0 || scale > 22)
+		{
+			return NULLPTR;
+		}
+		uint128_t scaled = (uint128_t)mantissa * pow10[_MIN(scale, 19)];
+		if (scale > 19)
+		{
+			scaled *= pow10[scale - 19];
+		}
+		uint128_t whole = scaled >> shift;
+		if (whole < pow10[precision - 1])
+		{	// log10 rounded up
+			decimalExponent--;
+			continue;
+		}
+		if (whole >= pow10[precision])
+		{	// log10 rounded down
+			decimalExponent++;
+			continue;
+		}
+		uint128_t remainder = scaled - (whole << shift);
+		uint128_t half = (uint128_t)1 << (shift - 1);
+		digits = (uint64_t)whole;
+		if (remainder > half || (remainder == half && (digits & 1)))
+		{
+			if (++digits == pow10[precision])
+			{
+				digits = pow10[precision - 1];
+				decimalExponent++;
+			}
+		}
+		break;
+	}
+	if (digits == 0)
+	{
+		return NULLPTR;
+	}
+
+	// %g drops trailing zeros
+	char text[20];
+	int count = precision;
+	while (count > 1 && digits % 10 == 0)
+	{
+		digits /= 10;
+		count--;
+	}
+	for (int i = count - 1; i >= 0; i--)
+	{
+		text[i] = (char)('0' + digits % 10);
+		digits /= 10;
+	}
+
+	if (value < 0.0)
+	{
+		*out++ = '-';
+	}
+	if (decimalExponent < -4 || decimalExponent >= precision)
+	{
+		*out++ = text[0];
+		if (count > 1)
+		{
+			*out++ = '.';
+			memcpy(out, text + 1, count - 1);
+			out += count - 1;
+		}
+		*out++ = 'e';
+		*out++ = (decimalExponent < 0 ? '-' : '+');
+		int absExponent = abs(decimalExponent);
+		if (absExponent < 10)
+		{
+			*out++ = '0';
+		}
+		return FormatUInt(out, (uint64_t)absExponent);
+	}
+	if (decimalExponent < 0)
+	{
+		*out++ = '0';
+		*out++ = '.';
+		for (int i = -1; i > decimalExponent; i--)
+		{
+			*out++ = '0';
+		}
+		memcpy(out, text, count);
+		return out + count;
+	}
+	int integerDigits = decimalExponent + 1;
+	if (count <= integerDigits)
+	{	// integral values are handled by FormatReal
+		memcpy(out, text, count);
+		out += count;
+		for (int i = count; i < integerDigits; i++)
+		{
+			*out++ = '0';
+		}
+		return out;
+	}
+	memcpy(out, text, integerDigits);
+	out += integerDigits;
+	*out++ = '.';
+	memcpy(out, text + integerDigits, count - integerDigits);
+	return out + (count - integerDigits);
+}
+
+#endif
+
+// %g prints integral values below 10^precision without a decimal point or exponent, so those skip printf
+static char* FormatReal(char* out, double value, int precision, double integralLimit, const char* format)
+{
+	if (value > -integralLimit && value < integralLimit && value == (double)(int64_t)value)
+	{
+		if (value == 0.0 && signbit(value))
+		{
+			*out++ = '-';
+			*out++ = '0';
+			return out;
+		}
+		return FormatInt(out, (int64_t)value);
+	}
+
+#if defined(__SIZEOF_INT128__)
+
+	if (isfinite(value))
+	{
+		char* end = FormatRealExact(out, value, precision);
+		if (end != NULLPTR)
+		{
+			return end;
+		}
+	}
+
+#endif
+
+	int count = SNPRINTF(out, 32, format, value);
+	return out + _CLAMP(count, 0, 31);
+}
+
+
+int cISDataMappings::DataSetToString(const p_data_hdr_t& hdr, const uint8_t* buf, char* out, bool json)
+{
+	static const uint8_t zeroDataSet[MAX_DATASET_SIZE] = { 0 };
+
+	const data_serialize_plan_t* plan = GetSerializePlan(hdr.id);
+	if (plan == NULLPTR || plan->dataSize > MAX_DATASET_SIZE)
+	{
+		return -1;
+	}
+
+	// Fields outside of a partial packet are zero. The full data set is only assembled when a field straddles the packet edge
+	// or a binary field needs it.
+	uint32_t packetStart = _MIN(hdr.offset, plan->dataSize);
+	uint32_t packetEnd = _MIN(hdr.offset + hdr.size, plan->dataSize);
+	const uint8_t* dataSet = NULLPTR;
+	uint8_t tmpBuffer[MAX_DATASET_SIZE];
+	if (packetStart == 0 && packetEnd == plan->dataSize)
+	{
+		dataSet = buf;
+	}
+
+	char* ptr = out;
+	data_mapping_string_t tmp;
+	for (size_t i = 0; i < plan->ops.size(); i++)
+	{
+		const data_serialize_op_t& op = plan->ops[i];
+		if (json)
+		{
+			memcpy(ptr, op.jsonName.data(), op.jsonName.size());
+			ptr += op.jsonName.size();
+		}
+		else if (i != 0)
+		{
+			*ptr++ = ',';
+		}
+
+		uint32_t fieldEnd = op.dataOffset + op.dataSize;
+		if (fieldEnd > plan->dataSize)
+		{
+			// Same defaults as DataToString for a field it cannot get
+			if (op.dataType == DataTypeString || (json && op.dataType == DataTypeBinary))
+			{
+				*ptr++ = '"';
+				*ptr++ = '"';
+			}
+			else if (op.dataType != DataTypeBinary)
+			{
+				*ptr++ = '0';
+			}
+			continue;
+		}
+
+		const uint8_t* field;
+		if (dataSet == NULLPTR && op.dataType != DataTypeBinary && op.dataOffset >= packetStart && fieldEnd <= packetEnd)
+		{
+			field = buf + (op.dataOffset - hdr.offset);
+		}
+		else if (dataSet == NULLPTR && op.dataType != DataTypeBinary && (fieldEnd <= packetStart || op.dataOffset >= packetEnd))
+		{
+			field = zeroDataSet + op.dataOffset;
+		}
+		else
+		{
+			if (dataSet == NULLPTR)
+			{
+				memset(tmpBuffer, 0, packetStart);
+				memcpy(tmpBuffer + packetStart, buf, packetEnd - packetStart);
+				memset(tmpBuffer + packetEnd, 0, plan->dataSize - packetEnd);
+				dataSet = tmpBuffer;
+			}
+			field = dataSet + op.dataOffset;
+		}
+
+		bool hex = (op.dataFlags == DataFlagsDisplayHex);
+		switch (op.dataType)
+		{
+		case DataTypeInt8:		ptr = (hex ? FormatHex(ptr, (uint32_t)ReadField<int8_t>(field), 2) : FormatInt(ptr, ReadField<int8_t>(field)));		break;
+		case DataTypeUInt8:		ptr = (hex ? FormatHex(ptr, ReadField<uint8_t>(field), 2) : FormatUInt(ptr, ReadField<uint8_t>(field)));				break;
+		case DataTypeInt16:		ptr = (hex ? FormatHex(ptr, (uint32_t)ReadField<int16_t>(field), 4) : FormatInt(ptr, ReadField<int16_t>(field)));		break;
+		case DataTypeUInt16:	ptr = (hex ? FormatHex(ptr, ReadField<uint16_t>(field), 4) : FormatUInt(ptr, ReadField<uint16_t>(field)));			break;
+		case DataTypeInt32:		ptr = (hex ? FormatHex(ptr, (uint32_t)ReadField<int32_t>(field), 8) : FormatInt(ptr, ReadField<int32_t>(field)));		break;
+		case DataTypeUInt32:	ptr = (hex ? FormatHex(ptr, ReadField<uint32_t>(field), 8) : FormatUInt(ptr, ReadField<uint32_t>(field)));			break;
+		case DataTypeInt64:		ptr = (hex ? FormatHex(ptr, ReadField<uint64_t>(field), 16) : FormatInt(ptr, ReadField<int64_t>(field)));				break;
+		case DataTypeUInt64:	ptr = (hex ? FormatHex(ptr, ReadField<uint64_t>(field), 16) : FormatUInt(ptr, ReadField<uint64_t>(field)));			break;
+		case DataTypeFloat:		ptr = FormatReal(ptr, ReadField<float>(field), 9, 1.0e9, "%.9g");		break;
+		case DataTypeDouble:	ptr = FormatReal(ptr, ReadField<double>(field), 17, 1.0e17, "%.17g");	break;
+		default:
+		{
+			VariableToString(op.dataType, op.dataFlags, field, dataSet, op.dataSize, tmp, json);
+			size_t length = strnlen(tmp, _MIN(2 * op.dataSize + 4, IS_DATA_MAPPING_MAX_STRING_LENGTH));
+			memcpy(ptr, tmp, length);
+			ptr += length;
+		} break;
+		}
+	}
+	*ptr = '\0';
+	return (int)(ptr - out);
+}
+
+
 double cISDataMappings::GetTimestamp(const p_data_hdr_t* hdr, const uint8_t* buf)
 {
     if (hdr == NULL || buf == NULL || hdr->id == 0 || hdr->id >= DID_COUNT || hdr->size == 0)
@@ -2922,38 +3674,44 @@ double cISDataMappings::GetTimestamp(const p_data_hdr_t* hdr, const uint8_t* buf
 		return 0.0;
 	}
 
-#if PLATFORM_IS_EMBEDDED
+	return GetFieldSeconds(Instance(hdr->id).m_timestampFields[hdr->id], hdr, buf);
+}
 
-	if (s_map == NULLPTR)
+double cISDataMappings::GetTimeOfWeek(const p_data_hdr_t* hdr, const uint8_t* buf)
+{
+    if (hdr == NULL || buf == NULL || hdr->id == 0 || hdr->id >= DID_COUNT || hdr->size == 0)
 	{
-		s_map = new cISDataMappings();
+		return 0.0;
 	}
 
-#endif
-
-	const data_info_t* timeStampField =
-	
-#if PLATFORM_IS_EMBEDDED
-
-		s_map->m_timestampFields[hdr->id];
-
-#else
-
-		s_map.m_timestampFields[hdr->id];
+    // raw observations are stamped with GPS time since the unix epoch
+    if (hdr->id == DID_GPS1_RAW || hdr->id == DID_GPS2_RAW || hdr->id == DID_GPS_BASE_RAW)
+	{
+		gps_raw_t* raw = (gps_raw_t*)buf;
+		if (raw->dataType == eRawDataType::raw_data_type_observation && raw->obsCount>0)
+		{
+			const obsd_t& obs = raw->data.obs[0];
+			return (double)((obs.time.time - GPS_TO_UNIX_OFFSET) % SECONDS_PER_WEEK) + obs.time.sec;
+		}
+		return 0.0;
+	}
 
-#endif
+	return GetFieldSeconds(Instance(hdr->id).m_timeOfWeekFields[hdr->id], hdr, buf);
+}
 
-	if (timeStampField != NULLPTR)
+double cISDataMappings::GetFieldSeconds(const data_info_t* field, const p_data_hdr_t* hdr, const uint8_t* buf)
+{
+	if (field != NULLPTR)
 	{
 		const uint8_t* ptr;
-		if (CanGetFieldData(*timeStampField, hdr, (uint8_t*)buf, ptr))
+		if (CanGetFieldData(*field, hdr, (uint8_t*)buf, ptr))
 		{
-			if (timeStampField->dataType == DataTypeDouble)
+			if (field->dataType == DataTypeDouble)
 			{
 				// field is seconds, use as is
 				return *(double*)ptr;
 			}
-			else if (timeStampField->dataType == DataTypeUInt32)
+			else if (field->dataType == DataTypeUInt32)
 			{
 				// field is milliseconds, convert to seconds
 				return 0.001 * (*(uint32_t*)ptr);
@@ -15,10 +15,16 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <string>
 #include <map>
+#include <vector>
 #include <inttypes.h>
 #include "com_manager.h"
 #include "DataCSV.h"
 
+#if !PLATFORM_IS_EMBEDDED
+#include <atomic>
+#include <mutex>
+#endif
+
 #ifndef CHAR_BIT
 #define CHAR_BIT 8
 #endif
@@ -137,6 +143,47 @@ struct equal_to<std::string> : public unary_function<std::string, bool>
 typedef std::map<std::string, data_info_t, sCaseInsensitiveCompare> map_name_to_info_t;
 typedef char data_mapping_string_t[IS_DATA_MAPPING_MAX_STRING_LENGTH];
 
+/*
+* A field compiled for serialization
+*/
+typedef struct
+{
+	uint32_t dataOffset;
+	uint32_t dataSize;
+	eDataType dataType;
+	eDataFlags dataFlags;
+	std::string jsonName;			// ,"name":
+} data_serialize_op_t;
+
+/*
+* Fields of a data set in csv column order, built once with the mappings so records are serialized without walking the map
+*/
+typedef struct
+{
+	std::vector<data_serialize_op_t> ops;
+	uint32_t dataSize;				// data set size
+	uint32_t maxStringLength;		// upper bound of chars written by DataSetToString, excluding the null terminator
+} data_serialize_plan_t;
+
+/*
+* Fields of a data set in struct order
+*/
+typedef struct
+{
+	const data_info_t* fields;
+	size_t count;
+} data_fields_t;
+
+/*
+* Collision free hash table of names, built once with the mappings so a lookup hashes the name once and compares it to a single entry
+*/
+typedef struct
+{
+	std::vector<uint16_t> slots;	// index + 1 of the name in each slot, 0 if empty
+	uint32_t mask;					// slot count - 1, slot count is a power of 2
+	uint32_t seed;					// hash seed that places every name in its own slot
+} data_name_table_t;
+
 class cISDataMappings
 {
 public:
@@ -154,10 +201,12 @@ public:
 
 	/**
 	* Get a data set id from name
-	* @param dataId the data id to get a data set name from
-	* @return data set name or NULL if not found
+	* @param name the data set name, i.e. DID_INS_1, case sensitive
+	* @param length the number of chars in name, name does not need to be null terminated
+	* @return data set id or 0 (DID_NULL) if not found
 	*/
-	static uint32_t GetDataSetId(std::string name);
+	static uint32_t GetDataSetId(const char* name, size_t length);
+	static uint32_t GetDataSetId(const std::string& name) { return GetDataSetId(name.data(), name.size()); }
 
 	/**
 	* Get the info for a data id
@@ -165,6 +214,23 @@ public:
 	*/
 	static const map_name_to_info_t* GetMapInfo(uint32_t dataId);
 
+	/**
+	* Get the info for a field of a data set from its name
+	* @param dataId the data id
+	* @param name the field name, case insensitive
+	* @param length the number of chars in name, name does not need to be null terminated
+	* @return the field info, or NULL if not found
+	*/
+	static const data_info_t* GetFieldInfo(uint32_t dataId, const char* name, size_t length);
+	static const data_info_t* GetFieldInfo(uint32_t dataId, const std::string& name) { return GetFieldInfo(dataId, name.data(), name.size()); }
+
+	/**
+	* Get the fields of a data set in struct order.  GetFieldInfo returns pointers into the same array.
+	* @param dataId the data id
+	* @return the fields of the data set, count is 0 if the data id is invalid or has no mappings
+	*/
+	static data_fields_t GetFields(uint32_t dataId);
+
 	/**
 	* Get the size of a given data id
 	* @param dataId the data id
@@ -197,6 +263,18 @@ public:
 	*/
 	static bool StringToVariable(const char* stringBuffer, int stringLength, const uint8_t* dataBuffer, eDataType dataType, uint32_t dataSize, int radix = 10, bool json = false);
 
+	/**
+	* Convert a field of a csv line or json object to a variable, parsing numbers in place.  Used by the log readers.
+	* @param stringBuffer the field text, does not need to be null terminated
+	* @param stringLength the number of chars in stringBuffer
+	* @param dataBuffer data buffer pointer
+	* @param dataType data type
+	* @param dataSize data size
+	* @param json true if json, false if csv
+	* @return true if success, false if error
+	*/
+	static bool FieldToVariable(const char* stringBuffer, int stringLength, uint8_t* dataBuffer, eDataType dataType, uint32_t dataSize, bool json = false);
+
 	/**
 	* Convert dataset field to a string
 	* @param info metadata about the field to convert
@@ -219,6 +297,22 @@ public:
 	*/
 	static bool VariableToString(eDataType dataType, eDataFlags dataFlags, const uint8_t* ptr, const uint8_t* dataBuffer, uint32_t dataSize, data_mapping_string_t stringBuffer, bool json = false);
 
+	/**
+	* Get the serialization plan for a data id
+	* @return the plan for the data id, or NULL if none found
+	*/
+	static const data_serialize_plan_t* GetSerializePlan(uint32_t dataId);
+
+	/**
+	* Convert all fields of a data set to a string using its serialization plan. Output matches DataToString for each field.
+	* @param hdr packet header, fields outside of the packet are written as zero
+	* @param buf packet buffer
+	* @param out receives the string, must hold at least GetSerializePlan(hdr.id)->maxStringLength + 1 chars
+	* @param json true for json ,"name":value pairs, false for comma separated csv values
+	* @return number of chars written, not counting the null terminator, or -1 if no plan found
+	*/
+	static int DataSetToString(const p_data_hdr_t& hdr, const uint8_t* buf, char* out, bool json = false);
+
 	/**
 	* Get a timestamp from data if available
 	* @param hdr data header
@@ -227,6 +321,15 @@ public:
 	*/
     static double GetTimestamp(const p_data_hdr_t* hdr, const uint8_t* buf);
 
+	/**
+	* Get GPS time of week from data that carries it.  Unlike GetTimestamp this is one time base for every data set, so 
+	* times from different data sets can be compared.
+	* @param hdr data header
+	* @param buf data buffer
+	* @return GPS time of week in seconds, or 0.0 if the data has no GPS time (i.e. IMU data stamped with time since boot)
+	*/
+    static double GetTimeOfWeek(const p_data_hdr_t* hdr, const uint8_t* buf);
+
 	/**
 	* Check whether field data can be retrieved given a data packet
 	* @param info metadata for the field to get
@@ -240,20 +343,42 @@ public:
 private:
 	cISDataMappings();
 
+	// Value of a time field in seconds, 0.0 if the field is NULL or not in the packet
+	static double GetFieldSeconds(const data_info_t* field, const p_data_hdr_t* hdr, const uint8_t* buf);
+
+	/**
+	* Get the mappings, created on first use.  The field mappings of a data set are populated the first time it is looked up.
+	* @param dataId the data id to populate field mappings for, DID_COUNT or more populates none
+	* @return the mappings
+	*/
+	static cISDataMappings& Instance(uint32_t dataId = DID_COUNT);
+
+	void PopulateMappings(uint32_t dataId);
+
 	static const char* const m_dataIdNames[];
 
 	uint32_t m_lookupSize[DID_COUNT];
 	const data_info_t* m_timestampFields[DID_COUNT];
+	const data_info_t* m_timeOfWeekFields[DID_COUNT];
 	map_name_to_info_t m_lookupInfo[DID_COUNT];
+	data_serialize_plan_t m_serializePlans[DID_COUNT];
+	std::vector<data_info_t> m_fields[DID_COUNT];
+	data_name_table_t m_fieldNames[DID_COUNT];
+	data_name_table_t m_dataSetNames;
 
 #if PLATFORM_IS_EMBEDDED
 
+	bool m_populated[DID_COUNT];
+	bool m_dataSetNamesPopulated;
+
 	// on embedded we cannot new up C++ runtime until after free rtos has started
 	static cISDataMappings* s_map;
 
 #else
 
-	static cISDataMappings s_map;
+	std::atomic<bool> m_populated[DID_COUNT];
+	std::atomic<bool> m_dataSetNamesPopulated;
+	std::mutex m_populateMutex;
 
 #endif
 
@@ -0,0 +1,272 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISDeviceIngest.h"
+#include "ISDataMappings.h"
+#include "ISUtilities.h"
+
+using namespace std;
+
+// Ring record data, followed by the packet bytes as received
+struct sIngestPacket
+{
+	double time;						// GPS time of week, 0 if the packet has none
+	uint64_t arrivalMs;					// getTickCount when queued
+};
+
+struct sIngestDevice
+{
+	serial_port_t* port;
+	cISLogPacketRing ring;				// reader thread to caller
+	thread reader;
+	atomic<uint64_t> packetCount;
+	atomic<uint64_t> byteCount;
+	atomic<uint32_t> rxErrorCount;
+	atomic<double> lastTime;			// last GPS time of week queued, 0 if none yet
+	uint32_t readOffset;				// caller only, bytes of the front packet already read
+
+	sIngestDevice(serial_port_t* serialPort, uint32_t ringSize) : port(serialPort), ring(ringSize), packetCount(0), byteCount(0), rxErrorCount(0), lastTime(0.0), readOffset(0) {}
+};
+
+
+cISDeviceIngest::cISDeviceIngest() : m_running(false), m_reorderWindowMs(IS_DEVICE_INGEST_DEFAULT_REORDER_MS), m_waiting(false)
+{
+}
+
+cISDeviceIngest::~cISDeviceIngest()
+{
+	Close();
+}
+
+bool cISDeviceIngest::Open(const vector<serial_port_t*>& ports, uint32_t ringSize)
+{
+	if (m_running || ports.empty())
+	{
+		return false;
+	}
+
+	m_devices.clear();
+	for (size_t i = 0; i < ports.size(); i++)
+	{
+		m_devices.push_back(unique_ptr<sIngestDevice>(new sIngestDevice(ports[i], ringSize)));
+	}
+	m_running = true;
+	for (size_t i = 0; i < m_devices.size(); i++)
+	{
+		m_devices[i]->reader = thread(&cISDeviceIngest::ReaderThread, this, m_devices[i].get());
+	}
+	return true;
+}
+
+void cISDeviceIngest::Close()
+{
+	m_running = false;
+	for (size_t i = 0; i < m_devices.size(); i++)
+	{
+		if (m_devices[i]->reader.joinable())
+		{
+			m_devices[i]->reader.join();
+		}
+	}
+	m_devices.clear();
+}
+
+bool cISDeviceIngest::Wait(int timeoutMilliseconds)
+{
+	unique_lock<mutex> lock(m_wakeMutex);
+	m_waiting = true;
+	atomic_thread_fence(memory_order_seq_cst);
+	bool ready = (Next() >= 0);
+	if (!ready && m_running)
+	{
+		m_wakeCond.wait_for(lock, chrono::milliseconds(timeoutMilliseconds));
+		ready = (Next() >= 0);
+	}
+	m_waiting = false;
+	return ready;
+}
+
+int cISDeviceIngest::Next()
+{
+	uint64_t now = getTickCount();
+	int next = -1;
+	const sIngestPacket* nextPacket = NULLPTR;
+	int oldest = -1;
+	const sIngestPacket* oldestPacket = NULLPTR;
+	for (size_t i = 0; i < m_devices.size(); i++)
+	{
+		const uint8_t* data;
+		if (m_devices[i]->readOffset != 0)
+		{	// finish the packet being read
+			return (int)i;
+		}
+		if (m_devices[i]->ring.Front(&data) == NULLPTR)
+		{
+			continue;
+		}
+		const sIngestPacket* packet = (const sIngestPacket*)data;
+		if (packet->time == 0.0)
+		{	// no GPS time to order it by
+			return (int)i;
+		}
+
+		// the oldest arrival held for the reorder window, and the earliest time, the first device wins a tie
+		if (now >= packet->arrivalMs + m_reorderWindowMs && (oldestPacket == NULLPTR || packet->arrivalMs < oldestPacket->arrivalMs))
+		{
+			oldest = (int)i;
+			oldestPacket = packet;
+		}
+		if (nextPacket == NULLPTR || packet->time < nextPacket->time)
+		{
+			next = (int)i;
+			nextPacket = packet;
+		}
+	}
+
+	// packets held for the reorder window go in arrival order, so a device whose times are behind the others can not
+	// keep them waiting longer than that
+	if (oldestPacket != NULLPTR)
+	{
+		return oldest;
+	}
+	if (nextPacket == NULLPTR)
+	{
+		return -1;
+	}
+
+	// hold it while a device with nothing queued may still send an earlier packet
+	for (size_t i = 0; i < m_devices.size(); i++)
+	{
+		double lastTime = m_devices[i]->lastTime.load(memory_order_acquire);
+		if (m_devices[i]->ring.Empty() && lastTime != 0.0 && lastTime < nextPacket->time)
+		{
+			return -1;
+		}
+	}
+	return next;
+}
+
+int cISDeviceIngest::Read(size_t device, uint8_t* buffer, int bufferLength)
+{
+	if (device >= m_devices.size() || bufferLength <= 0)
+	{
+		return 0;
+	}
+	sIngestDevice* d = m_devices[device].get();
+	const uint8_t* data;
+	const p_data_hdr_t* hdr = d->ring.Front(&data);
+	if (hdr == NULLPTR)
+	{
+		return 0;
+	}
+
+	// a packet larger than the buffer is read over several calls
+	uint32_t packetSize = hdr->size - (uint32_t)sizeof(sIngestPacket);
+	int count = (int)_MIN((uint32_t)bufferLength, packetSize - d->readOffset);
+	memcpy(buffer, data + sizeof(sIngestPacket) + d->readOffset, count);
+	d->readOffset += count;
+	if (d->readOffset == packetSize)
+	{
+		d->readOffset = 0;
+		d->ring.Pop();
+	}
+	return count;
+}
+
+cISDeviceIngest::device_stats_t cISDeviceIngest::Stats(size_t device)
+{
+	device_stats_t stats = device_stats_t();
+	if (device < m_devices.size())
+	{
+		sIngestDevice* d = m_devices[device].get();
+		stats.packetCount = d->packetCount;
+		stats.byteCount = d->byteCount;
+		stats.dropCount = d->ring.Stats().dropCount;
+		stats.rxErrorCount = d->rxErrorCount;
+	}
+	return stats;
+}
+
+void cISDeviceIngest::ReaderThread(sIngestDevice* device)
+{
+	is_comm_instance_t comm;
+	vector<uint8_t> buffer(PKT_BUF_SIZE);
+	vector<uint8_t> decodeBuffer(PKT_BUF_SIZE);
+	vector<uint8_t> record(sizeof(sIngestPacket) + PKT_BUF_SIZE);
+	is_comm_init(&comm, buffer.data(), (int)buffer.size());
+	comm.altDecodeBuf = decodeBuffer.data();	// keep the received bytes intact, they are what gets queued
+	while (m_running)
+	{
+		// wait for the first byte, then take whatever else has arrived
+		int free = is_comm_free(&comm);
+		int n = serialPortReadTimeout(device->port, comm.buf.tail, 1, IS_DEVICE_INGEST_READ_TIMEOUT_MS);
+		if (n <= 0)
+		{
+			if (!serialPortIsOpen(device->port))
+			{	// reads of a port that is gone fail right away
+				SLEEP_MS(IS_DEVICE_INGEST_READ_TIMEOUT_MS);
+			}
+			continue;
+		}
+		if (free > 1)
+		{
+			n += serialPortReadTimeout(device->port, comm.buf.tail + 1, free - 1, 0);
+		}
+		comm.buf.tail += n;
+
+		bool queued = false;
+		protocol_type_t ptype;
+		while ((ptype = is_comm_parse(&comm)) != _PTYPE_NONE)
+		{
+			if (ptype == _PTYPE_PARSE_ERROR)
+			{
+				continue;
+			}
+
+			// only GPS time of week is comparable between devices, other timestamps (i.e. IMU time since boot) are not
+			double time = (ptype == _PTYPE_INERTIAL_SENSE_DATA ? cISDataMappings::GetTimeOfWeek(&comm.dataHdr, comm.dataPtr) : 0.0);
+			uint32_t packetSize = (uint32_t)(comm.buf.scan - comm.pktPtr);
+			sIngestPacket* packet = (sIngestPacket*)record.data();
+			packet->time = time;
+			packet->arrivalMs = getTickCount();
+			memcpy(record.data() + sizeof(sIngestPacket), comm.pktPtr, packetSize);
+			p_data_hdr_t hdr = p_data_hdr_t();
+			hdr.size = (uint32_t)sizeof(sIngestPacket) + packetSize;
+			if (!device->ring.Push(&hdr, record.data()))
+			{	// the caller is behind, counted as dropped
+				device->ring.Drop(&hdr);
+				continue;
+			}
+			if (time != 0.0)
+			{
+				device->lastTime.store(time, memory_order_release);
+			}
+			device->packetCount++;
+			device->byteCount += packetSize;
+			queued = true;
+		}
+		device->rxErrorCount = comm.rxErrorCount;
+
+		// order the push before checking for a waiting caller so a wakeup cannot be missed
+		atomic_thread_fence(memory_order_seq_cst);
+		if (queued && m_waiting)
+		{
+			Wake();
+		}
+	}
+}
+
+void cISDeviceIngest::Wake()
+{
+	lock_guard<mutex> lock(m_wakeMutex);
+	m_wakeCond.notify_one();
+}
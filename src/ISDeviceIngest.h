@@ -0,0 +1,142 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _ISDEVICEINGEST__H__
+#define _ISDEVICEINGEST__H__
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ISLogPacketRing.h"
+
+extern "C"
+{
+	#include "serialPort.h"
+}
+
+#define IS_DEVICE_INGEST_RING_SIZE				(512 * 1024)	// bytes of packets queued between a reader thread and the caller
+#define IS_DEVICE_INGEST_DEFAULT_REORDER_MS		10				// how long a packet may be held for packets from other devices that are earlier
+#define IS_DEVICE_INGEST_READ_TIMEOUT_MS		10				// how long a reader thread waits for data before checking for close
+
+struct sIngestDevice;
+
+/**
+* Reads many serial ports at once.  Each port is read and parsed on its own thread, which queues whole packets through
+* a lock-free ring, so a slow or quiet port never holds up the others.  The caller takes packets one at a time: Next
+* picks the device whose queued packet has the earliest GPS time of week and Read hands over its bytes, so packets
+* from all devices come out merged in GPS time order.  A packet is held until every other device that sends GPS time
+* has either queued a packet or already sent one at or after its time, or at most the reorder window.  Packets held
+* for the reorder window go before any others in the order they arrived, which bounds the added latency regardless of
+* the number of devices or their times.  Packets without GPS time (IMU data stamped with time since boot, NMEA, RTCM,
+* acks) are handed over as soon as they reach the front of their own device's queue.
+*/
+class cISDeviceIngest
+{
+public:
+	typedef struct
+	{
+		uint64_t packetCount;		// packets read from the port
+		uint64_t byteCount;			// bytes of packets read from the port
+		uint64_t dropCount;			// packets dropped because the caller fell behind
+		uint32_t rxErrorCount;		// parse and checksum errors
+	} device_stats_t;
+
+	/**
+	* Constructor
+	*/
+	cISDeviceIngest();
+
+	/**
+	* Destructor - closes the ingest
+	*/
+	virtual ~cISDeviceIngest();
+
+	/**
+	* Start a reader thread for each port
+	* @param ports the open serial ports, these must stay valid and not be read by anything else until Close
+	* @param ringSize bytes of packets each device can queue
+	* @return true if success, false if already open or no ports
+	*/
+	bool Open(const std::vector<serial_port_t*>& ports, uint32_t ringSize = IS_DEVICE_INGEST_RING_SIZE);
+
+	/**
+	* Stop the reader threads and drop any queued packets, the ports are left open
+	*/
+	void Close();
+
+	/**
+	* Get whether the reader threads are running
+	* @return true if open, false if not
+	*/
+	bool IsOpen() { return m_running; }
+
+	/**
+	* Get the number of devices
+	* @return number of devices
+	*/
+	size_t DeviceCount() { return m_devices.size(); }
+
+	/**
+	* Set how long a packet may be held waiting for earlier packets from other devices, 0 to hand packets over in the
+	* order they arrive
+	* @param reorderWindowMs max milliseconds a packet is held
+	*/
+	void SetReorderWindow(uint32_t reorderWindowMs) { m_reorderWindowMs = reorderWindowMs; }
+
+	/**
+	* Wait until Next has a device, new packets arrive or the timeout passes
+	* @param timeoutMilliseconds max time to wait
+	* @return true if Next has a device
+	*/
+	bool Wait(int timeoutMilliseconds);
+
+	/**
+	* Get the device whose packet goes next
+	* @return the device index, or -1 if no packet is ready
+	*/
+	int Next();
+
+	/**
+	* Copy out the front packet of a device, the packet is removed once all its bytes have been read
+	* @param device the device index
+	* @param buffer receives packet bytes
+	* @param bufferLength max bytes to copy
+	* @return number of bytes copied, 0 if none are queued
+	*/
+	int Read(size_t device, uint8_t* buffer, int bufferLength);
+
+	/**
+	* Get device counters, safe to call from any thread
+	* @param device the device index
+	* @return the device counters
+	*/
+	device_stats_t Stats(size_t device);
+
+private:
+	cISDeviceIngest(const cISDeviceIngest& copy); // Disable copy constructor
+
+	void ReaderThread(sIngestDevice* device);
+	void Wake();
+
+	std::vector<std::unique_ptr<sIngestDevice>> m_devices;
+	std::atomic<bool> m_running;
+	uint32_t m_reorderWindowMs;
+
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wakeCond;
+	std::atomic<bool> m_waiting;
+};
+
+#endif // _ISDEVICEINGEST__H__
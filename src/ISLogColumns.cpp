@@ -0,0 +1,172 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <string.h>
+
+#include "ISLogColumns.h"
+#include "ISLogger.h"
+
+using namespace std;
+
+
+cISLogColumns::cISLogColumns()
+{
+	m_dataId = DID_NULL;
+}
+
+
+bool cISLogColumns::Init(uint32_t dataId, const vector<string>& fieldNames)
+{
+	m_dataId = DID_NULL;
+	m_columns.clear();
+	m_timestamps.clear();
+
+	data_fields_t fields = cISDataMappings::GetFields(dataId);
+	if (fields.count == 0)
+	{
+		return false;
+	}
+
+	if (fieldNames.size() == 0)
+	{
+		for (size_t i = 0; i < fields.count; i++)
+		{
+			sLogColumn column;
+			column.info = fields.fields[i];
+			m_columns.push_back(column);
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < fieldNames.size(); i++)
+		{
+			const data_info_t* info = cISDataMappings::GetFieldInfo(dataId, fieldNames[i]);
+			if (info == NULLPTR)
+			{
+				m_columns.clear();
+				return false;
+			}
+			sLogColumn column;
+			column.info = *info;
+			m_columns.push_back(column);
+		}
+	}
+
+	m_dataId = dataId;
+	return true;
+}
+
+
+void cISLogColumns::Clear()
+{
+	for (size_t i = 0; i < m_columns.size(); i++)
+	{
+		m_columns[i].data.clear();
+	}
+	m_timestamps.clear();
+}
+
+
+void cISLogColumns::Reserve(size_t rowCount)
+{
+	for (size_t i = 0; i < m_columns.size(); i++)
+	{
+		m_columns[i].data.reserve(rowCount * m_columns[i].info.dataSize);
+	}
+	m_timestamps.reserve(rowCount);
+}
+
+
+bool cISLogColumns::Add(const p_data_hdr_t& hdr, const uint8_t* buf, double timestamp)
+{
+	if (hdr.id != m_dataId || m_dataId == DID_NULL)
+	{
+		return false;
+	}
+
+	uint32_t packetStart = hdr.offset;
+	uint32_t packetEnd = hdr.offset + hdr.size;
+	for (size_t i = 0; i < m_columns.size(); i++)
+	{
+		sLogColumn& column = m_columns[i];
+		const data_info_t& info = column.info;
+		size_t end = column.data.size();
+		column.data.resize(end + info.dataSize);
+		if (info.dataOffset >= packetStart && info.dataOffset + info.dataSize <= packetEnd)
+		{
+			memcpy(column.data.data() + end, buf + (info.dataOffset - packetStart), info.dataSize);
+		}
+		else
+		{	// field is not in this packet
+			memset(column.data.data() + end, 0, info.dataSize);
+		}
+	}
+	m_timestamps.push_back(timestamp);
+	return true;
+}
+
+
+size_t cISLogColumns::Read(cISLogger& logger, unsigned int device, const vector<cISLogColumns*>& sets, double startTime, double endTime)
+{
+	bool timeRange = (startTime > -DBL_MAX || endTime < DBL_MAX);
+	if (startTime > -DBL_MAX)
+	{	// skip to the time index entry, if any
+		logger.SeekToTime(device, startTime);
+	}
+
+	size_t rows = 0;
+	p_data_t* data;
+	while ((data = (timeRange ? logger.ReadDataInTimeRange(device, startTime, endTime) : logger.ReadData(device))) != NULLPTR)
+	{
+		bool haveTimestamp = false;
+		double timestamp = 0.0;
+		for (size_t i = 0; i < sets.size(); i++)
+		{
+			if (sets[i]->m_dataId != data->hdr.id)
+			{
+				continue;
+			}
+			if (!haveTimestamp)
+			{
+				timestamp = cISDataMappings::GetTimestamp(&data->hdr, data->buf);
+				haveTimestamp = true;
+			}
+			rows += sets[i]->Add(data->hdr, data->buf, timestamp);
+		}
+	}
+	return rows;
+}
+
+
+size_t cISLogColumns::Read(cISLogger& logger, unsigned int device, double startTime, double endTime)
+{
+	return Read(logger, device, vector<cISLogColumns*>(1, this), startTime, endTime);
+}
+
+
+const sLogColumn* cISLogColumns::Column(const string& fieldName) const
+{
+	const data_info_t* info = cISDataMappings::GetFieldInfo(m_dataId, fieldName);
+	if (info == NULLPTR)
+	{
+		return NULLPTR;
+	}
+	for (size_t i = 0; i < m_columns.size(); i++)
+	{
+		if (m_columns[i].info.dataOffset == info->dataOffset && m_columns[i].info.name == info->name)
+		{
+			return &m_columns[i];
+		}
+	}
+	return NULLPTR;
+}
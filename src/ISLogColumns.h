@@ -0,0 +1,117 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef IS_LOG_COLUMNS_H
+#define IS_LOG_COLUMNS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cfloat>
+
+#include "ISDataMappings.h"
+
+class cISLogger;
+
+/**
+* Values of one field of a data set, contiguous and in the field's native type
+*/
+struct sLogColumn
+{
+	data_info_t info;				// field mapping, dataSize bytes per value
+	std::vector<uint8_t> data;		// rowCount * info.dataSize bytes
+
+	size_t Count() const { return (info.dataSize == 0 ? 0 : data.size() / info.dataSize); }
+
+	/**
+	* Values as an array of T.  T must match info.dataType, i.e. double for DataTypeDouble.
+	*/
+	template<typename T> const T* Values() const { return (const T*)data.data(); }
+};
+
+/**
+* Struct-of-arrays extraction of selected fields of a data set.  Each row copies only the selected fields out 
+* of the packet, the data set struct is never materialized.
+*/
+class cISLogColumns
+{
+public:
+	cISLogColumns();
+
+	/**
+	* Select the data set and fields to extract, clears any rows
+	* @param dataId data set id
+	* @param fieldNames field names, case insensitive.  Empty selects all fields in struct order.
+	* @return false if the data set has no mappings or a field name is unknown
+	*/
+	bool Init(uint32_t dataId, const std::vector<std::string>& fieldNames = std::vector<std::string>());
+
+	/**
+	* Remove all rows, keeping the selected fields
+	*/
+	void Clear();
+
+	/**
+	* Reserve memory for a number of rows
+	*/
+	void Reserve(size_t rowCount);
+
+	/**
+	* Add a row from a packet.  Selected fields outside of a partial packet are zero.
+	* @param hdr packet header
+	* @param buf packet data
+	* @param timestamp packet timestamp, from cISDataMappings::GetTimestamp
+	* @return true if the packet is of this data set and was added
+	*/
+	bool Add(const p_data_hdr_t& hdr, const uint8_t* buf, double timestamp);
+
+	/**
+	* Read a device log once, adding every packet of each column set's data set.  Packets of other data sets are skipped.
+	* @param logger logger loaded with LoadFromDirectory, reading continues from its current position
+	* @param device device index
+	* @param sets column sets to fill
+	* @param startTime GPS time of week, packets before this are skipped, the read starts at the time index if the log has one
+	* @param endTime GPS time of week, reading stops at the first packet after this (see cISLogger::ReadDataInTimeRange)
+	* @return number of rows added
+	*/
+	static size_t Read(cISLogger& logger, unsigned int device, const std::vector<cISLogColumns*>& sets, double startTime = -DBL_MAX, double endTime = DBL_MAX);
+	size_t Read(cISLogger& logger, unsigned int device, double startTime = -DBL_MAX, double endTime = DBL_MAX);
+
+	uint32_t DataId() const { return m_dataId; }
+	size_t RowCount() const { return m_timestamps.size(); }
+
+	/**
+	* Timestamp of each row in seconds, 0 if the data set has no timestamp
+	*/
+	const std::vector<double>& Timestamps() const { return m_timestamps; }
+	std::vector<double>& Timestamps() { return m_timestamps; }
+
+	/**
+	* Columns in the order of the field names passed to Init
+	*/
+	const std::vector<sLogColumn>& Columns() const { return m_columns; }
+	std::vector<sLogColumn>& Columns() { return m_columns; }
+
+	/**
+	* Find a column by field name, case insensitive
+	* @return the column or NULL if the field was not selected
+	*/
+	const sLogColumn* Column(const std::string& fieldName) const;
+
+private:
+	uint32_t m_dataId;
+	std::vector<sLogColumn> m_columns;
+	std::vector<double> m_timestamps;
+};
+
+#endif // IS_LOG_COLUMNS_H
@@ -0,0 +1,438 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISLogFileAsync.h"
+#include "ISConstants.h"
+
+#if PLATFORM_IS_LINUX
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace std;
+
+// File state shared between the writing thread and the I/O thread
+struct sAsyncLogFile
+{
+    int fd;
+    uint32_t syncPeriodMs;
+    std::atomic<bool> error;
+    int buffersInFlight;                    // guarded by the writer mutex
+    std::vector<std::vector<uint8_t>> freeBuffers;  // guarded by the writer mutex
+    bool preallocated;                      // space was reserved past the end of the file
+    bool dirty;                             // I/O thread only
+    chrono::steady_clock::time_point lastSync;  // I/O thread only
+};
+
+struct sAsyncLogJob
+{
+    shared_ptr<sAsyncLogFile> file;
+    vector<uint8_t> data;
+    uint64_t offset;
+    bool close;
+};
+
+// Process wide I/O thread servicing all async log files in submit order
+class cAsyncLogWriter
+{
+public:
+    cAsyncLogWriter() : m_stop(false), m_pending(0)
+    {
+        m_thread = thread(&cAsyncLogWriter::Run, this);
+    }
+
+    ~cAsyncLogWriter()
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_jobCond.notify_one();
+        m_thread.join();
+    }
+
+    void AddFile(const shared_ptr<sAsyncLogFile>& file)
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_files.push_back(file);
+    }
+
+    // Hand a buffer to the I/O thread, waits only if the file already has its max buffers queued
+    void Submit(sAsyncLogJob& job, vector<uint8_t>& nextBuf)
+    {
+        {
+            unique_lock<mutex> lock(m_mutex);
+            sAsyncLogFile* file = job.file.get();
+            m_doneCond.wait(lock, [file] { return file->buffersInFlight < ASYNC_LOG_FILE_MAX_IN_FLIGHT; });
+            file->buffersInFlight++;
+            m_pending++;
+            m_jobs.push_back(std::move(job));
+            if (!file->freeBuffers.empty())
+            {
+                nextBuf.swap(file->freeBuffers.back());
+                file->freeBuffers.pop_back();
+            }
+        }
+        m_jobCond.notify_one();
+    }
+
+    void WaitForIdle()
+    {
+        unique_lock<mutex> lock(m_mutex);
+        m_doneCond.wait(lock, [this] { return m_pending == 0; });
+    }
+
+private:
+    void Run()
+    {
+        unique_lock<mutex> lock(m_mutex);
+        while (true)
+        {
+            m_jobCond.wait_for(lock, chrono::milliseconds(100), [this] { return m_stop || !m_jobs.empty(); });
+            if (m_jobs.empty())
+            {
+                if (m_stop)
+                {
+                    break;
+                }
+
+                // Idle, sync files that have unsynced data
+                vector<shared_ptr<sAsyncLogFile>> files = m_files;
+                lock.unlock();
+                for (size_t i = 0; i < files.size(); i++)
+                {
+                    SyncIfDue(*files[i], false);
+                }
+                lock.lock();
+                continue;
+            }
+
+            sAsyncLogJob job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            lock.unlock();
+
+            sAsyncLogFile& file = *job.file;
+            WriteAll(file, job.data.data(), job.data.size(), job.offset);
+            if (job.close)
+            {
+                if (file.preallocated && !file.error)
+                {   // Release reserved space past the end, directory space limits only see the file size
+                    if (ftruncate(file.fd, (off_t)(job.offset + job.data.size())) != 0)
+                    {
+                        file.error = true;
+                    }
+                }
+                SyncIfDue(file, true);
+                ::close(file.fd);
+                file.fd = -1;
+            }
+            else
+            {
+                SyncIfDue(file, false);
+            }
+
+            lock.lock();
+            job.data.clear();
+            if (job.data.capacity())
+            {
+                file.freeBuffers.push_back(std::move(job.data));
+            }
+            file.buffersInFlight--;
+            if (job.close)
+            {
+                for (size_t i = 0; i < m_files.size(); i++)
+                {
+                    if (m_files[i] == job.file)
+                    {
+                        m_files.erase(m_files.begin() + i);
+                        break;
+                    }
+                }
+            }
+            m_pending--;
+            m_doneCond.notify_all();
+        }
+    }
+
+    static void WriteAll(sAsyncLogFile& file, const uint8_t* data, size_t len, uint64_t offset)
+    {
+        while (len > 0 && file.fd >= 0)
+        {
+            ssize_t n = pwrite(file.fd, data, len, (off_t)offset);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                file.error = true;
+                return;
+            }
+            data += n;
+            len -= (size_t)n;
+            offset += (uint64_t)n;
+            file.dirty = true;
+        }
+    }
+
+    static void SyncIfDue(sAsyncLogFile& file, bool closing)
+    {
+        if (!file.dirty || file.syncPeriodMs == 0 || file.fd < 0)
+        {
+            return;
+        }
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        if (closing || now - file.lastSync >= chrono::milliseconds(file.syncPeriodMs))
+        {
+            fdatasync(file.fd);
+            file.lastSync = now;
+            file.dirty = false;
+        }
+    }
+
+    mutex m_mutex;
+    condition_variable m_jobCond;
+    condition_variable m_doneCond;
+    deque<sAsyncLogJob> m_jobs;
+    vector<shared_ptr<sAsyncLogFile>> m_files;
+    bool m_stop;
+    int m_pending;
+    thread m_thread;
+};
+
+static cAsyncLogWriter& AsyncLogWriter()
+{
+    // Never destroyed so files closed from static destructors are still serviced, cISLogger::CloseAllFiles waits for writes
+    static cAsyncLogWriter* writer = new cAsyncLogWriter();
+    return *writer;
+}
+
+
+cISLogFileAsync::cISLogFileAsync(uint32_t preallocateSize, uint32_t syncPeriodMs) : m_offset(0), m_preallocateSize(preallocateSize), m_syncPeriodMs(syncPeriodMs)
+{
+}
+
+cISLogFileAsync::cISLogFileAsync(const std::string& filePath, const char* mode, uint32_t preallocateSize, uint32_t syncPeriodMs) : cISLogFileAsync(preallocateSize, syncPeriodMs)
+{
+    open(filePath.c_str(), mode);
+}
+
+cISLogFileAsync::~cISLogFileAsync()
+{
+    close();
+}
+
+bool cISLogFileAsync::open(const char* filePath, const char* mode)
+{
+    close();
+
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
+    if (strchr(mode, 'r') != NULLPTR || strchr(mode, '+') != NULLPTR)
+    {   // Write only
+        return false;
+    }
+    flags |= (strchr(mode, 'a') != NULLPTR ? 0 : O_TRUNC);
+
+    int fd = ::open(filePath, flags, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    m_offset = (uint64_t)lseek(fd, 0, SEEK_END);
+    bool preallocated = false;
+#ifdef FALLOC_FL_KEEP_SIZE
+    if (m_preallocateSize)
+    {   // Reserve space without changing the file size, unsupported file systems just skip this
+        preallocated = (fallocate(fd, FALLOC_FL_KEEP_SIZE, (off_t)m_offset, (off_t)m_preallocateSize) == 0);
+    }
+#endif
+
+    m_file = make_shared<sAsyncLogFile>();
+    m_file->fd = fd;
+    m_file->preallocated = preallocated;
+    m_file->syncPeriodMs = m_syncPeriodMs;
+    m_file->error = false;
+    m_file->buffersInFlight = 0;
+    m_file->dirty = false;
+    m_file->lastSync = chrono::steady_clock::now();
+    AsyncLogWriter().AddFile(m_file);
+    m_buf.reserve(ASYNC_LOG_FILE_BUFFER_SIZE);
+    return true;
+}
+
+bool cISLogFileAsync::Submit(bool closeFile)
+{
+    if (!m_file)
+    {
+        return false;
+    }
+    if (m_buf.empty() && !closeFile)
+    {
+        return true;
+    }
+
+    sAsyncLogJob job;
+    job.file = m_file;
+    job.data.swap(m_buf);
+    job.offset = m_offset - job.data.size();
+    job.close = closeFile;
+    AsyncLogWriter().Submit(job, m_buf);
+    if (!closeFile)
+    {
+        m_buf.reserve(ASYNC_LOG_FILE_BUFFER_SIZE);
+    }
+    return true;
+}
+
+bool cISLogFileAsync::close()
+{
+    if (!m_file)
+    {
+        return false;
+    }
+
+    // The I/O thread writes what is left, syncs and closes the descriptor
+    Submit(true);
+    m_file.reset();
+    m_buf = vector<uint8_t>();
+    return true;
+}
+
+bool cISLogFileAsync::flush()
+{
+    return Submit(false) && good();
+}
+
+bool cISLogFileAsync::good()
+{
+    return m_file && !m_file->error;
+}
+
+bool cISLogFileAsync::isOpened()
+{
+    return (bool)m_file;
+}
+
+int cISLogFileAsync::putch(char ch)
+{
+    return (write(&ch, 1) == 1 ? (unsigned char)ch : EOF);
+}
+
+int cISLogFileAsync::puts(const char* str)
+{
+    return (write(str, strlen(str)) == strlen(str) ? 0 : EOF);
+}
+
+std::size_t cISLogFileAsync::write(const void* bytes, std::size_t len)
+{
+    if (!m_file || m_file->error)
+    {
+        return 0;
+    }
+
+    const uint8_t* ptr = (const uint8_t*)bytes;
+    size_t remaining = len;
+    while (remaining)
+    {
+        size_t n = _MIN(remaining, ASYNC_LOG_FILE_BUFFER_SIZE - m_buf.size());
+        m_buf.insert(m_buf.end(), ptr, ptr + n);
+        m_offset += n;
+        ptr += n;
+        remaining -= n;
+        if (m_buf.size() >= ASYNC_LOG_FILE_BUFFER_SIZE)
+        {
+            Submit(false);
+        }
+    }
+    return len;
+}
+
+int cISLogFileAsync::lprintf(const char* format, ...)
+{
+    int result;
+    va_list args;
+    va_start(args, format);
+    result = vprintf(format, args);
+    va_end(args);
+    return result;
+}
+
+int cISLogFileAsync::vprintf(const char* format, va_list args)
+{
+    char buf[1024];
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    int n = vsnprintf(buf, sizeof(buf), format, argsCopy);
+    va_end(argsCopy);
+    if (n < 0)
+    {
+        return -1;
+    }
+    if ((size_t)n < sizeof(buf))
+    {
+        return (int)write(buf, (size_t)n);
+    }
+
+    vector<char> big((size_t)n + 1);
+    vsnprintf(big.data(), big.size(), format, args);
+    return (int)write(big.data(), (size_t)n);
+}
+
+int cISLogFileAsync::getch()
+{
+    return EOF;
+}
+
+std::size_t cISLogFileAsync::read(void* bytes, std::size_t len)
+{
+    (void)bytes;
+    (void)len;
+    return 0;
+}
+
+int cISLogFileAsync::seek(long int offset, int origin)
+{
+    // Append only
+    if ((origin == SEEK_CUR && offset == 0) || (origin != SEEK_CUR && (uint64_t)offset == m_offset))
+    {
+        return 0;
+    }
+    return -1;
+}
+
+long int cISLogFileAsync::tell()
+{
+    return (long int)m_offset;
+}
+
+int cISLogFileAsync::eof()
+{
+    return 0;
+}
+
+void cISLogFileAsync::WaitForWrites()
+{
+    AsyncLogWriter().WaitForIdle();
+}
+
+#endif // PLATFORM_IS_LINUX
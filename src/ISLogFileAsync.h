@@ -0,0 +1,70 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef _IS_SDK_IS_LOG_FILE_ASYNC_H_
+#define _IS_SDK_IS_LOG_FILE_ASYNC_H_
+
+#include "ISLogFileBase.h"
+#include <memory>
+#include <vector>
+
+#define ASYNC_LOG_FILE_BUFFER_SIZE		(256 * 1024)	// bytes gathered before a write is queued
+#define ASYNC_LOG_FILE_MAX_IN_FLIGHT	2				// queued buffers per file, plus the one being filled
+
+struct sAsyncLogFile;
+
+/**
+* Write-behind log file (Linux).  Writes are gathered into buffers which a shared I/O thread writes with pwrite, so
+* write, flush and close never wait on the disk unless ASYNC_LOG_FILE_MAX_IN_FLIGHT buffers are already queued for the
+* file.  Space is preallocated up front and fdatasync is batched on a configurable period.  Write only, reads fail.
+*/
+class cISLogFileAsync : public cISLogFileBase
+{
+public:
+    cISLogFileAsync(uint32_t preallocateSize = 0, uint32_t syncPeriodMs = 1000);
+    cISLogFileAsync(const std::string& filePath, const char* mode, uint32_t preallocateSize = 0, uint32_t syncPeriodMs = 1000);
+    ~cISLogFileAsync();
+
+    bool open(const char* filePath, const char* mode) OVERRIDE;
+    bool close() OVERRIDE;
+    bool flush() OVERRIDE;
+    bool good() OVERRIDE;
+    bool isOpened() OVERRIDE;
+
+    int putch(char ch) OVERRIDE;
+    int puts(const char* str) OVERRIDE;
+    std::size_t write(const void* bytes, std::size_t len) OVERRIDE;
+    int lprintf(const char* format, ...) OVERRIDE;
+    int vprintf(const char* format, va_list args) OVERRIDE;
+
+    int getch() OVERRIDE;
+    std::size_t read(void* bytes, std::size_t len) OVERRIDE;
+    int seek(long int offset, int origin = SEEK_CUR) OVERRIDE;
+    long int tell() OVERRIDE;
+    int eof() OVERRIDE;
+
+    // Block until every queued write and close, for all async files, has completed
+    static void WaitForWrites();
+
+private:
+    bool Submit(bool closeFile);
+
+    std::shared_ptr<sAsyncLogFile> m_file;      // shared with the I/O thread until the file is closed
+    std::vector<uint8_t> m_buf;
+    uint64_t m_offset;
+    uint32_t m_preallocateSize;
+    uint32_t m_syncPeriodMs;
+};
+
+
+#endif //_IS_SDK_IS_LOG_FILE_ASYNC_H_
@@ -16,6 +16,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "ISConstants.h"
 #include <cstddef>
 #include <cstdarg>
+#include <cstdint>
 #include <string>
 
 #define LOG_DEBUG_FILE_WRITE	0		// Enable file debug printout
@@ -48,6 +49,9 @@ public:
     virtual long int tell() = 0;
     virtual int eof() = 0;		// returns non-zero at end of file
 
+    // Memory mapped files return the whole file contents, others return NULL
+    virtual const uint8_t* mappedData(std::size_t& size) { size = 0; return NULLPTR; }
+
 };
 
 
@@ -21,6 +21,14 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "ISLogFile.h"
 #endif
 
+#if PLATFORM_IS_LINUX
+#include "ISLogFileAsync.h"
+#endif
+
+#if PLATFORM_IS_LINUX || PLATFORM_IS_APPLE
+#include "ISLogFileMapped.h"
+#endif
+
 
 inline cISLogFileBase* CreateISLogFile()
 {
@@ -49,6 +57,36 @@ inline cISLogFileBase* CreateISLogFile(const std::string& filePath, const char*
 #endif
 }
 
+// Write-behind file for saving logs where supported, otherwise a regular file
+inline cISLogFileBase* CreateISLogFileAsync(const std::string& filePath, const char* mode, uint32_t preallocateSize, uint32_t syncPeriodMs)
+{
+#if PLATFORM_IS_LINUX
+    return new cISLogFileAsync(filePath, mode, preallocateSize, syncPeriodMs);
+#else
+    (void)preallocateSize;
+    (void)syncPeriodMs;
+    return CreateISLogFile(filePath, mode);
+#endif
+}
+
+// Memory mapped file for reading logs where supported, otherwise a regular file
+inline cISLogFileBase* CreateISLogFileMapped(const std::string& filePath)
+{
+#if PLATFORM_IS_LINUX || PLATFORM_IS_APPLE
+    return new cISLogFileMapped(filePath, "rb");
+#else
+    return CreateISLogFile(filePath, "rb");
+#endif
+}
+
+// Wait for write-behind files to finish writing and closing
+inline void WaitForISLogFileWrites()
+{
+#if PLATFORM_IS_LINUX
+    cISLogFileAsync::WaitForWrites();
+#endif
+}
+
 inline void CloseISLogFile(cISLogFileBase*& logFile)
 {
     if (logFile != NULLPTR)
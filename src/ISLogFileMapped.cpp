@@ -0,0 +1,227 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISLogFileMapped.h"
+#include "ISConstants.h"
+
+#if PLATFORM_IS_LINUX || PLATFORM_IS_APPLE
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+cISLogFileMapped::cISLogFileMapped() : m_data(NULLPTR), m_size(0), m_pos(0), m_readAheadPos(0), m_opened(false), m_eof(false)
+{
+}
+
+cISLogFileMapped::cISLogFileMapped(const std::string& filePath, const char* mode) : cISLogFileMapped()
+{
+    open(filePath.c_str(), mode);
+}
+
+cISLogFileMapped::~cISLogFileMapped()
+{
+    close();
+}
+
+bool cISLogFileMapped::open(const char* filePath, const char* mode)
+{
+    close();
+
+    if (strchr(mode, 'w') != NULLPTR || strchr(mode, 'a') != NULLPTR || strchr(mode, '+') != NULLPTR)
+    {   // Read only
+        return false;
+    }
+
+    int fd = ::open(filePath, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    m_size = (std::size_t)st.st_size;
+    if (m_size != 0)
+    {
+        void* ptr = mmap(NULLPTR, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED)
+        {
+            ::close(fd);
+            m_size = 0;
+            return false;
+        }
+        m_data = (uint8_t*)ptr;
+        madvise(m_data, m_size, MADV_SEQUENTIAL);
+    }
+
+    // The mapping holds its own reference to the file
+    ::close(fd);
+
+    m_pos = 0;
+    m_readAheadPos = 0;
+    m_opened = true;
+    m_eof = false;
+    ReadAhead();
+    return true;
+}
+
+bool cISLogFileMapped::close()
+{
+    if (!m_opened)
+    {
+        return false;
+    }
+    if (m_data)
+    {
+        munmap(m_data, m_size);
+    }
+    m_data = NULLPTR;
+    m_size = 0;
+    m_pos = 0;
+    m_opened = false;
+    return true;
+}
+
+void cISLogFileMapped::ReadAhead()
+{
+    // Request the next window once the reader is half way through the current one
+    if (m_data == NULLPTR || m_pos + MAPPED_LOG_FILE_READAHEAD / 2 < m_readAheadPos || m_readAheadPos >= m_size)
+    {
+        return;
+    }
+    std::size_t pageSize = (std::size_t)sysconf(_SC_PAGESIZE);
+    std::size_t start = _MAX(m_pos, m_readAheadPos) & ~(pageSize - 1);
+    std::size_t end = _MIN(m_pos + MAPPED_LOG_FILE_READAHEAD, m_size);
+    if (end > start)
+    {
+        madvise(m_data + start, end - start, MADV_WILLNEED);
+    }
+    m_readAheadPos = end;
+}
+
+bool cISLogFileMapped::flush()
+{
+    return m_opened;
+}
+
+bool cISLogFileMapped::good()
+{
+    return m_opened;
+}
+
+bool cISLogFileMapped::isOpened()
+{
+    return m_opened;
+}
+
+int cISLogFileMapped::putch(char ch)
+{
+    (void)ch;
+    return EOF;
+}
+
+int cISLogFileMapped::puts(const char* str)
+{
+    (void)str;
+    return EOF;
+}
+
+std::size_t cISLogFileMapped::write(const void* bytes, std::size_t len)
+{
+    (void)bytes;
+    (void)len;
+    return 0;
+}
+
+int cISLogFileMapped::lprintf(const char* format, ...)
+{
+    (void)format;
+    return -1;
+}
+
+int cISLogFileMapped::vprintf(const char* format, va_list args)
+{
+    (void)format;
+    (void)args;
+    return -1;
+}
+
+int cISLogFileMapped::getch()
+{
+    if (m_pos >= m_size)
+    {
+        m_eof = true;
+        return EOF;
+    }
+    return m_data[m_pos++];
+}
+
+std::size_t cISLogFileMapped::read(void* bytes, std::size_t len)
+{
+    std::size_t n = (m_pos < m_size ? _MIN(len, m_size - m_pos) : 0);
+    if (n < len)
+    {
+        m_eof = true;
+    }
+    if (n)
+    {
+        memcpy(bytes, m_data + m_pos, n);
+        m_pos += n;
+        ReadAhead();
+    }
+    return n;
+}
+
+// Sets the position indicator, origin: SEEK_SET = beginning of file, SEEK_CUR = current position, SEEK_END = end of file
+int cISLogFileMapped::seek(long int offset, int origin)
+{
+    long int base = (origin == SEEK_SET ? 0 : (origin == SEEK_END ? (long int)m_size : (long int)m_pos));
+    if (!m_opened || base + offset < 0)
+    {
+        return -1;
+    }
+    m_pos = (std::size_t)(base + offset);
+    m_eof = false;
+    if (m_pos < m_readAheadPos - _MIN(m_readAheadPos, (std::size_t)MAPPED_LOG_FILE_READAHEAD))
+    {   // Moved back, hint again from here
+        m_readAheadPos = m_pos;
+    }
+    ReadAhead();
+    return 0;
+}
+
+long int cISLogFileMapped::tell()
+{
+    return (long int)m_pos;
+}
+
+int cISLogFileMapped::eof()
+{
+    return m_eof;
+}
+
+const uint8_t* cISLogFileMapped::mappedData(std::size_t& size)
+{
+    size = m_size;
+    return m_data;
+}
+
+#endif // PLATFORM_IS_LINUX || PLATFORM_IS_APPLE
@@ -0,0 +1,65 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef _IS_SDK_IS_LOG_FILE_MAPPED_H_
+#define _IS_SDK_IS_LOG_FILE_MAPPED_H_
+
+#include "ISLogFileBase.h"
+
+#define MAPPED_LOG_FILE_READAHEAD	(4 * 1024 * 1024)	// bytes hinted ahead of the read position
+
+/**
+* Read-only memory mapped log file (Linux / Apple).  The mapping is private copy-on-write so data handed out from 
+* mappedData() may be modified without touching the file.  Access is hinted sequential and the pages ahead of each 
+* read / seek position are requested from the OS in advance.
+*/
+class cISLogFileMapped : public cISLogFileBase
+{
+public:
+    cISLogFileMapped();
+    cISLogFileMapped(const std::string& filePath, const char* mode);
+    ~cISLogFileMapped();
+
+    bool open(const char* filePath, const char* mode) OVERRIDE;
+    bool close() OVERRIDE;
+    bool flush() OVERRIDE;
+    bool good() OVERRIDE;
+    bool isOpened() OVERRIDE;
+
+    int putch(char ch) OVERRIDE;
+    int puts(const char* str) OVERRIDE;
+    std::size_t write(const void* bytes, std::size_t len) OVERRIDE;
+    int lprintf(const char* format, ...) OVERRIDE;
+    int vprintf(const char* format, va_list args) OVERRIDE;
+
+    int getch() OVERRIDE;
+    std::size_t read(void* bytes, std::size_t len) OVERRIDE;
+    int seek(long int offset, int origin = SEEK_CUR) OVERRIDE;
+    long int tell() OVERRIDE;
+    int eof() OVERRIDE;
+
+    const uint8_t* mappedData(std::size_t& size) OVERRIDE;
+
+private:
+    void ReadAhead();
+
+    uint8_t* m_data;
+    std::size_t m_size;
+    std::size_t m_pos;
+    std::size_t m_readAheadPos;     // end of the range already hinted
+    bool m_opened;
+    bool m_eof;
+};
+
+
+#endif //_IS_SDK_IS_LOG_FILE_MAPPED_H_
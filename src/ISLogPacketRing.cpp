@@ -0,0 +1,306 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <string.h>
+#include <chrono>
+
+#include "ISLogPacketRing.h"
+
+// Header id written when a record does not fit before the end of the buffer, the consumer skips to the start
+#define WRAP_MARKER_ID	0xFFFFFFFF
+
+cISLogPacketRing::cISLogPacketRing(uint32_t capacity)
+{
+	uint32_t size = CapacityFor(capacity);
+	m_buf.resize(size);
+	m_mask = size - 1;
+	m_head = 0;
+	m_tail = 0;
+	m_pushCount = 0;
+	m_popCount = 0;
+	m_dropCount = 0;
+	m_peakBytes = 0;
+	for (uint32_t i = 0; i < DID_COUNT; i++)
+	{
+		m_dataIdDropCount[i] = 0;
+	}
+	m_dropCountTaken = 0;
+	m_waitTimedOut = false;
+	m_waitTimedOutPopCount = 0;
+}
+
+uint32_t cISLogPacketRing::CapacityFor(uint32_t capacity)
+{
+	uint32_t size = 1024;
+	while (size <= capacity / 2 && size < 0x80000000)
+	{
+		size <<= 1;
+	}
+	return size;
+}
+
+bool cISLogPacketRing::Push(const p_data_hdr_t* hdr, const uint8_t* buf)
+{
+	uint32_t capacity = m_mask + 1;
+	uint32_t recordSize = RecordSize(hdr->size);
+	uint32_t head = m_head.load(std::memory_order_relaxed);
+	uint32_t tail = m_tail.load(std::memory_order_acquire);
+	uint32_t pos = head & m_mask;
+	uint32_t contiguous = capacity - pos;
+
+	// Records never straddle the end of the buffer
+	uint32_t pad = (contiguous < recordSize ? contiguous : 0);
+	uint32_t used = head - tail;
+	if (recordSize > capacity / 2 || used + pad + recordSize > capacity)
+	{
+		return false;
+	}
+
+	if (pad)
+	{
+		if (pad >= sizeof(p_data_hdr_t))
+		{
+			((p_data_hdr_t*)&m_buf[pos])->id = WRAP_MARKER_ID;
+		}
+		pos = 0;
+	}
+
+	memcpy(&m_buf[pos], hdr, sizeof(p_data_hdr_t));
+	memcpy(&m_buf[pos + sizeof(p_data_hdr_t)], buf, hdr->size);
+
+	used += pad + recordSize;
+	if (used > m_peakBytes.load(std::memory_order_relaxed))
+	{
+		m_peakBytes.store(used, std::memory_order_relaxed);
+	}
+	m_pushCount.fetch_add(1, std::memory_order_relaxed);
+
+	// Publish the record
+	m_head.store(head + pad + recordSize, std::memory_order_release);
+	return true;
+}
+
+bool cISLogPacketRing::PushWait(const p_data_hdr_t* hdr, const uint8_t* buf, uint32_t maxWaitMs, const std::function<bool()>& wait)
+{
+	if (Push(hdr, buf))
+	{
+		return true;
+	}
+	if (RecordSize(hdr->size) > (m_mask + 1) / 2)
+	{
+		return false;
+	}
+	if (m_waitTimedOut && m_popCount.load(std::memory_order_relaxed) == m_waitTimedOutPopCount)
+	{	// consumer is still stuck
+		return false;
+	}
+	m_waitTimedOut = false;
+
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(maxWaitMs);
+	while (wait())
+	{
+		if (Push(hdr, buf))
+		{
+			return true;
+		}
+		if (std::chrono::steady_clock::now() >= deadline)
+		{
+			m_waitTimedOut = true;
+			m_waitTimedOutPopCount = m_popCount.load(std::memory_order_relaxed);
+			return false;
+		}
+	}
+	return false;
+}
+
+bool cISLogPacketRing::PushDropOldest(const p_data_hdr_t* hdr, const uint8_t* buf)
+{
+	uint32_t capacity = m_mask + 1;
+	if (RecordSize(hdr->size) > capacity / 2)
+	{
+		return false;
+	}
+
+	while (!Push(hdr, buf))
+	{
+		// Only the producer writes the buffer, so the oldest header can be read here even while the consumer copies it
+		uint32_t tail = m_tail.load(std::memory_order_acquire);
+		if (tail == m_head.load(std::memory_order_relaxed))
+		{	// the consumer emptied the ring meanwhile
+			continue;
+		}
+		uint32_t pos = tail & m_mask;
+		uint32_t contiguous = capacity - pos;
+		const p_data_hdr_t* oldest = (const p_data_hdr_t*)&m_buf[pos];
+		bool pad = (contiguous < sizeof(p_data_hdr_t) || oldest->id == WRAP_MARKER_ID);
+		uint32_t id = (pad ? WRAP_MARKER_ID : oldest->id);
+		uint32_t size = (pad ? contiguous : RecordSize(oldest->size));
+
+		// Fails if the consumer took the record first
+		if (m_tail.compare_exchange_strong(tail, tail + size, std::memory_order_acq_rel) && !pad)
+		{
+			if (id < DID_COUNT)
+			{
+				m_dataIdDropCount[id].fetch_add(1, std::memory_order_relaxed);
+			}
+			m_dropCount.fetch_add(1, std::memory_order_relaxed);
+			m_popCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	return true;
+}
+
+bool cISLogPacketRing::Take(p_data_hdr_t* hdr, uint8_t* buf, uint32_t bufSize)
+{
+	uint32_t capacity = m_mask + 1;
+	for (;;)
+	{
+		uint32_t tail = m_tail.load(std::memory_order_acquire);
+		if (tail == m_head.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		// The producer may remove and overwrite the record while it is copied, the copy is only used if the tail has 
+		// not moved.  The tail only moves forward, so an unchanged tail means the record was never touched.
+		uint32_t pos = tail & m_mask;
+		uint32_t contiguous = capacity - pos;
+		p_data_hdr_t rec = p_data_hdr_t();
+		uint32_t size = contiguous;
+		bool pad = true;
+		if (contiguous >= sizeof(p_data_hdr_t))
+		{
+			memcpy(&rec, &m_buf[pos], sizeof(p_data_hdr_t));
+			pad = (rec.id == WRAP_MARKER_ID);
+			if (!pad)
+			{
+				size = RecordSize(rec.size);
+				if (size > contiguous)
+				{	// header overwritten while it was copied
+					continue;
+				}
+				if (rec.size <= bufSize)
+				{
+					memcpy(buf, &m_buf[pos + sizeof(p_data_hdr_t)], rec.size);
+				}
+			}
+		}
+		if (!m_tail.compare_exchange_strong(tail, tail + size, std::memory_order_acq_rel))
+		{	// removed by the producer
+			continue;
+		}
+		if (pad)
+		{	// padding at the end of the buffer
+			continue;
+		}
+
+		m_popCount.fetch_add(1, std::memory_order_relaxed);
+		if (rec.size > bufSize)
+		{
+			Drop(&rec);
+			continue;
+		}
+		*hdr = rec;
+		return true;
+	}
+}
+
+const p_data_hdr_t* cISLogPacketRing::Front(const uint8_t** buf)
+{
+	uint32_t capacity = m_mask + 1;
+	uint32_t head = m_head.load(std::memory_order_acquire);
+	uint32_t tail = m_tail.load(std::memory_order_relaxed);
+
+	while (tail != head)
+	{
+		uint32_t pos = tail & m_mask;
+		uint32_t contiguous = capacity - pos;
+		const p_data_hdr_t* hdr = (const p_data_hdr_t*)&m_buf[pos];
+		if (contiguous < sizeof(p_data_hdr_t) || hdr->id == WRAP_MARKER_ID)
+		{
+			// Skip padding at the end of the buffer
+			tail += contiguous;
+			m_tail.store(tail, std::memory_order_release);
+			continue;
+		}
+
+		*buf = &m_buf[pos + sizeof(p_data_hdr_t)];
+		return hdr;
+	}
+
+	return NULL;
+}
+
+void cISLogPacketRing::Pop()
+{
+	uint32_t tail = m_tail.load(std::memory_order_relaxed);
+	if (tail == m_head.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	const p_data_hdr_t* hdr = (const p_data_hdr_t*)&m_buf[tail & m_mask];
+	m_popCount.fetch_add(1, std::memory_order_relaxed);
+	m_tail.store(tail + RecordSize(hdr->size), std::memory_order_release);
+}
+
+void cISLogPacketRing::Discard()
+{
+	const uint8_t* buf;
+	const p_data_hdr_t* hdr = Front(&buf);
+	if (hdr == NULL)
+	{
+		return;
+	}
+	if (hdr->id < DID_COUNT)
+	{
+		m_dataIdDropCount[hdr->id].fetch_add(1, std::memory_order_relaxed);
+	}
+	m_dropCount.fetch_add(1, std::memory_order_relaxed);
+	Pop();
+}
+
+void cISLogPacketRing::Drop(const p_data_hdr_t* hdr)
+{
+	if (hdr->id < DID_COUNT)
+	{
+		m_dataIdDropCount[hdr->id].fetch_add(1, std::memory_order_relaxed);
+	}
+	m_dropCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool cISLogPacketRing::DropsPending()
+{
+	uint64_t dropCount = m_dropCount.load(std::memory_order_relaxed);
+	if (dropCount == m_dropCountTaken)
+	{
+		return false;
+	}
+	m_dropCountTaken = dropCount;
+	return true;
+}
+
+cISLogPacketRing::stats_t cISLogPacketRing::Stats() const
+{
+	stats_t stats;
+	uint32_t tail = m_tail.load(std::memory_order_acquire);
+	uint32_t head = m_head.load(std::memory_order_acquire);
+	uint64_t popCount = m_popCount.load(std::memory_order_relaxed);
+	stats.capacity = m_mask + 1;
+	stats.bytes = head - tail;
+	stats.peakBytes = m_peakBytes.load(std::memory_order_relaxed);
+	stats.pushCount = m_pushCount.load(std::memory_order_relaxed);
+	stats.dropCount = m_dropCount.load(std::memory_order_relaxed);
+	stats.depth = (stats.pushCount > popCount ? (uint32_t)(stats.pushCount - popCount) : 0);
+	return stats;
+}
@@ -0,0 +1,167 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef IS_LOG_PACKET_RING_H
+#define IS_LOG_PACKET_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "ISComm.h"
+
+/**
+* Lock-free single producer / single consumer ring of variable length log records.  Each record is a p_data_hdr_t 
+* followed by hdr.size bytes of data, padded to 4 bytes.  Push / PushDropOldest are called only from the receive thread 
+* and Front / Pop / Discard / Take / TakeDataIdDrops only from the logger thread.  The producer never blocks, what to do 
+* when Push fails is left to the caller.  PushDropOldest frees space by removing the oldest records itself, so while it 
+* is used the consumer must read with Take, which copies a record out before removing it, instead of Front / Pop / Discard.
+*/
+class cISLogPacketRing
+{
+public:
+	struct stats_t
+	{
+		uint32_t capacity;		// ring size in bytes
+		uint32_t bytes;			// bytes currently queued
+		uint32_t depth;			// records currently queued
+		uint32_t peakBytes;		// most bytes ever queued
+		uint64_t pushCount;		// records queued
+		uint64_t dropCount;		// records dropped or discarded
+	};
+
+	/**
+	* Constructor
+	* @param capacity max ring size in bytes, rounded down to a power of 2 (min 1024)
+	*/
+	cISLogPacketRing(uint32_t capacity = DEFAULT_CAPACITY);
+
+	/**
+	* Producer - copy a record into the ring
+	* @return true if queued, false if the ring is full
+	*/
+	bool Push(const p_data_hdr_t* hdr, const uint8_t* buf);
+
+	/**
+	* Producer - copy a record into the ring, removing the oldest records and counting them as dropped until it fits
+	* @return true if queued, false if the record is larger than half the ring
+	*/
+	bool PushDropOldest(const p_data_hdr_t* hdr, const uint8_t* buf);
+
+	/**
+	* Producer - copy a record into the ring, waiting up to maxWaitMs for the consumer to make room.  After a wait times 
+	* out later records are not waited for until the consumer removes a record, so a consumer that is stuck holds up 
+	* the producer once and not for every record.
+	* @param maxWaitMs max time to wait
+	* @param wait called each time the record does not fit, i.e. to wake the consumer and sleep, returns false to stop waiting
+	* @return true if queued, false if not
+	*/
+	bool PushWait(const p_data_hdr_t* hdr, const uint8_t* buf, uint32_t maxWaitMs, const std::function<bool()>& wait);
+
+	/**
+	* Count a record that was not queued or not logged, safe from either thread
+	*/
+	void Drop(const p_data_hdr_t* hdr);
+
+	/**
+	* Consumer - get the oldest record without removing it
+	* @param buf receives a pointer to hdr.size bytes of data, valid until Pop is called
+	* @return the record header or NULL if the ring is empty
+	*/
+	const p_data_hdr_t* Front(const uint8_t** buf);
+
+	/**
+	* Consumer - remove the record returned by Front
+	*/
+	void Pop();
+
+	/**
+	* Consumer - remove the record returned by Front and count it as dropped
+	*/
+	void Discard();
+
+	/**
+	* Consumer - copy out and remove the oldest record, safe while the producer uses PushDropOldest.  Records larger 
+	* than bufSize are removed and counted as dropped.
+	* @param hdr receives the record header
+	* @param buf receives hdr.size bytes of data
+	* @param bufSize size of buf
+	* @return true if a record was taken, false if the ring is empty
+	*/
+	bool Take(p_data_hdr_t* hdr, uint8_t* buf, uint32_t bufSize);
+
+	/**
+	* Consumer - get and clear the number of dropped records for a data id
+	*/
+	uint32_t TakeDataIdDrops(uint32_t dataId) { return (dataId < DID_COUNT ? m_dataIdDropCount[dataId].exchange(0, std::memory_order_relaxed) : 0); }
+
+	/**
+	* Consumer - check if records were dropped since the last call
+	*/
+	bool DropsPending();
+
+	/**
+	* Check if the ring is empty, safe from either thread
+	*/
+	bool Empty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+
+	/**
+	* Bytes currently queued, safe from either thread
+	*/
+	uint32_t Bytes() const { return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire); }
+
+	/**
+	* Ring size in bytes
+	*/
+	uint32_t Capacity() const { return m_mask + 1; }
+
+	/**
+	* Ring size in bytes the constructor uses for a requested capacity
+	*/
+	static uint32_t CapacityFor(uint32_t capacity);
+
+	/**
+	* Bytes a record with dataSize bytes of data uses in the ring
+	*/
+	static uint32_t RecordSize(uint32_t dataSize) { return (uint32_t)sizeof(p_data_hdr_t) + ((dataSize + 3) & ~3u); }
+
+	/**
+	* Get depth and drop counters, safe from either thread
+	*/
+	stats_t Stats() const;
+
+	static const uint32_t DEFAULT_CAPACITY = 4 * 1024 * 1024;
+
+private:
+	cISLogPacketRing(const cISLogPacketRing&);
+	cISLogPacketRing& operator=(const cISLogPacketRing&);
+
+	std::vector<uint8_t> m_buf;
+	uint32_t m_mask;
+
+	// Free running byte positions, written only by the producer (head) or consumer (tail)
+	std::atomic<uint32_t> m_head;
+	std::atomic<uint32_t> m_tail;
+
+	std::atomic<uint64_t> m_pushCount;
+	std::atomic<uint64_t> m_popCount;
+	std::atomic<uint64_t> m_dropCount;
+	std::atomic<uint32_t> m_peakBytes;
+	std::atomic<uint32_t> m_dataIdDropCount[DID_COUNT];
+	uint64_t m_dropCountTaken;		// consumer only
+	bool m_waitTimedOut;			// producer only, PushWait gave up on the consumer
+	uint64_t m_waitTimedOutPopCount;	// producer only, consumer pop count when PushWait gave up
+};
+
+#endif // IS_LOG_PACKET_RING_H
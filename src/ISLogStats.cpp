@@ -32,6 +32,18 @@ cLogStatDataId::cLogStatDataId()
     minTimestampDelta = 1.0E6;
     timestampDeltaCount = 0;
     timestampDropCount = 0;
+    dropCount = 0;
+#if !PLATFORM_IS_EMBEDDED
+    timestampCount = 0;
+    duplicateCount = 0;
+    outOfOrderCount = 0;
+    gapCount = 0;
+    gapTime = 0.0;
+    minTimestamp = 0.0;
+    maxTimestamp = 0.0;
+    analysisLastDelta = 0.0;
+    analysisOutOfOrder = false;
+#endif
 }
 
 void cLogStatDataId::LogTimestamp(double timestamp)
@@ -41,7 +53,12 @@ void cLogStatDataId::LogTimestamp(double timestamp)
     {
         return;
     }
-    else if (lastTimestamp > 0.0)
+
+#if !PLATFORM_IS_EMBEDDED
+    AnalyzeTimestamp(timestamp);
+#endif
+
+    if (lastTimestamp > 0.0)
     {
         double delta = fabs(timestamp - lastTimestamp);
         minTimestampDelta = _MIN(delta, minTimestampDelta);
@@ -57,6 +74,246 @@ void cLogStatDataId::LogTimestamp(double timestamp)
     lastTimestamp = timestamp;
 }
 
+#if !PLATFORM_IS_EMBEDDED
+
+cLogStatHistogram::cLogStatHistogram()
+{
+    total = 0;
+    modeBucket = 0;
+}
+
+int cLogStatHistogram::Bucket(double value)
+{
+    if (!(value >= ldexp(1.0, LOG_STATS_HISTOGRAM_MIN_EXPONENT)))
+    {
+        return 0;
+    }
+    int exponent;
+    double mantissa = frexp(value, &exponent);   // value = mantissa * 2^exponent, mantissa in [0.5, 1)
+    int octave = exponent - 1 - LOG_STATS_HISTOGRAM_MIN_EXPONENT;
+    if (octave >= LOG_STATS_HISTOGRAM_OCTAVES)
+    {
+        return LOG_STATS_HISTOGRAM_SIZE - 1;
+    }
+    int sub = (int)((mantissa * 2.0 - 1.0) * LOG_STATS_HISTOGRAM_SUB_BUCKETS);
+    return 1 + octave * LOG_STATS_HISTOGRAM_SUB_BUCKETS + _MIN(sub, LOG_STATS_HISTOGRAM_SUB_BUCKETS - 1);
+}
+
+double cLogStatHistogram::BucketStart(int bucket)
+{
+    if (bucket <= 0)
+    {
+        return 0.0;
+    }
+    bucket--;
+    int octave = bucket / LOG_STATS_HISTOGRAM_SUB_BUCKETS;
+    int sub = bucket % LOG_STATS_HISTOGRAM_SUB_BUCKETS;
+    return ldexp(1.0 + (double)sub / LOG_STATS_HISTOGRAM_SUB_BUCKETS, octave + LOG_STATS_HISTOGRAM_MIN_EXPONENT);
+}
+
+void cLogStatHistogram::Add(double value)
+{
+    if (counts.empty())
+    {
+        counts.resize(LOG_STATS_HISTOGRAM_SIZE);
+    }
+    int bucket = Bucket(value);
+    if (++counts[bucket] > counts[modeBucket])
+    {
+        modeBucket = bucket;
+    }
+    total++;
+}
+
+void cLogStatHistogram::Merge(const cLogStatHistogram& other)
+{
+    if (other.total == 0)
+    {
+        return;
+    }
+    if (counts.empty())
+    {
+        counts.resize(LOG_STATS_HISTOGRAM_SIZE);
+    }
+    for (int i = 0; i < LOG_STATS_HISTOGRAM_SIZE; i++)
+    {
+        counts[i] += other.counts[i];
+        if (counts[i] > counts[modeBucket])
+        {
+            modeBucket = i;
+        }
+    }
+    total += other.total;
+}
+
+double cLogStatHistogram::Percentile(double fraction) const
+{
+    if (total == 0)
+    {
+        return 0.0;
+    }
+    uint64_t target = (uint64_t)ceil(fraction * (double)total);
+    uint64_t sum = 0;
+    for (int i = 0; i < LOG_STATS_HISTOGRAM_SIZE - 1; i++)
+    {
+        sum += counts[i];
+        if (sum >= target && sum != 0)
+        {   // values below the first bucket read as 0
+            return (i == 0 ? 0.0 : BucketStart(i + 1));
+        }
+    }
+    return BucketStart(LOG_STATS_HISTOGRAM_SIZE - 1);
+}
+
+double cLogStatHistogram::Mode() const
+{
+    if (total == 0)
+    {
+        return 0.0;
+    }
+    return 0.5 * (BucketStart(modeBucket) + BucketStart(modeBucket + 1));
+}
+
+void cLogStatDataId::AnalyzeTimestamp(double timestamp)
+{
+    if (timestampCount++ == 0)
+    {
+        minTimestamp = maxTimestamp = timestamp;
+        return;
+    }
+    minTimestamp = _MIN(timestamp, minTimestamp);
+    maxTimestamp = _MAX(timestamp, maxTimestamp);
+
+    double delta = timestamp - lastTimestamp;
+    if (delta == 0.0)
+    {
+        duplicateCount++;
+        return;
+    }
+    else if (delta < 0.0)
+    {
+        outOfOrderCount++;
+        analysisOutOfOrder = true;
+        return;
+    }
+    else if (analysisOutOfOrder)
+    {   // Delta from an out of order timestamp says nothing about the data rate
+        analysisOutOfOrder = false;
+        return;
+    }
+
+    double period = deltaHistogram.Mode();
+    if (period > 0.0 && delta > LOG_STATS_GAP_FACTOR * period)
+    {
+        gapCount++;
+        gapTime += delta - period;
+        if (gaps.size() < LOG_STATS_MAX_GAPS)
+        {
+            sLogStatGap gap = { lastTimestamp, delta };
+            gaps.push_back(gap);
+        }
+    }
+    deltaHistogram.Add(delta);
+    if (analysisLastDelta > 0.0)
+    {
+        jitterHistogram.Add(fabs(delta - analysisLastDelta));
+    }
+    analysisLastDelta = delta;
+}
+
+double cLogStatDataId::EffectiveRate() const
+{
+    double span = maxTimestamp - minTimestamp;
+    return (timestampCount > 1 && span > 0.0 ? (double)(timestampCount - 1) / span : 0.0);
+}
+
+void cLogStatDataId::WriteJson(cISLogFileBase* file, uint32_t id) const
+{
+    const char* name = cISDataMappings::GetDataSetName(id);
+    file->lprintf("\t\t{\n");
+    file->lprintf("\t\t\t\"id\": %u,\n", id);
+    file->lprintf("\t\t\t\"name\": \"%s\",\n", (name != NULL ? name : ""));
+    file->lprintf("\t\t\t\"count\": %llu,\n", (unsigned long long)count);
+    file->lprintf("\t\t\t\"errors\": %llu,\n", (unsigned long long)errorCount);
+    file->lprintf("\t\t\t\"dropped\": %llu,\n", (unsigned long long)dropCount);
+    file->lprintf("\t\t\t\"timestamps\": %llu,\n", (unsigned long long)timestampCount);
+    file->lprintf("\t\t\t\"duplicates\": %llu,\n", (unsigned long long)duplicateCount);
+    file->lprintf("\t\t\t\"outOfOrder\": %llu,\n", (unsigned long long)outOfOrderCount);
+    file->lprintf("\t\t\t\"firstTimestamp\": %.6f,\n", minTimestamp);
+    file->lprintf("\t\t\t\"lastTimestamp\": %.6f,\n", maxTimestamp);
+    file->lprintf("\t\t\t\"rateHz\": %.9g,\n", EffectiveRate());
+    file->lprintf("\t\t\t\"delta\": { \"min\": %.9g, \"mean\": %.9g, \"max\": %.9g, \"p50\": %.9g, \"p99\": %.9g, \"p999\": %.9g },\n",
+        (deltaHistogram.total != 0 ? minTimestampDelta : 0.0), averageTimeDelta, maxTimestampDelta, 
+        deltaHistogram.Percentile(0.5), deltaHistogram.Percentile(0.99), deltaHistogram.Percentile(0.999));
+    file->lprintf("\t\t\t\"jitter\": { \"p50\": %.9g, \"p99\": %.9g, \"p999\": %.9g },\n",
+        jitterHistogram.Percentile(0.5), jitterHistogram.Percentile(0.99), jitterHistogram.Percentile(0.999));
+    file->lprintf("\t\t\t\"gapCount\": %llu,\n", (unsigned long long)gapCount);
+    file->lprintf("\t\t\t\"gapTime\": %.9g,\n", gapTime);
+    file->lprintf("\t\t\t\"gaps\": [");
+    for (size_t i = 0; i < gaps.size(); i++)
+    {
+        file->lprintf("%s[%.6f, %.9g]", (i == 0 ? "" : ", "), gaps[i].timestamp, gaps[i].duration);
+    }
+    file->lprintf("],\n");
+
+    // Non empty buckets as [start, end, count]
+    file->lprintf("\t\t\t\"histogram\": [");
+    bool first = true;
+    for (size_t i = 0; i < deltaHistogram.counts.size(); i++)
+    {
+        if (deltaHistogram.counts[i] != 0)
+        {
+            file->lprintf("%s[%.9g, %.9g, %llu]", (first ? "" : ", "), cLogStatHistogram::BucketStart((int)i), 
+                cLogStatHistogram::BucketStart((int)i + 1), (unsigned long long)deltaHistogram.counts[i]);
+            first = false;
+        }
+    }
+    file->lprintf("]\n");
+    file->lprintf("\t\t}");
+}
+
+#endif
+
+void cLogStatDataId::Merge(const cLogStatDataId& other)
+{
+    count += other.count;
+    errorCount += other.errorCount;
+    dropCount += other.dropCount;
+    if (other.timestampDeltaCount != 0)
+    {
+        minTimestampDelta = _MIN(other.minTimestampDelta, minTimestampDelta);
+        maxTimestampDelta = _MAX(other.maxTimestampDelta, maxTimestampDelta);
+        totalTimeDelta += other.totalTimeDelta;
+        timestampDeltaCount += other.timestampDeltaCount;
+        averageTimeDelta = (totalTimeDelta / (double)timestampDeltaCount);
+        timestampDropCount += other.timestampDropCount;
+        lastTimestampDelta = other.lastTimestampDelta;
+    }
+    if (other.lastTimestamp > 0.0)
+    {
+        lastTimestamp = other.lastTimestamp;
+    }
+
+#if !PLATFORM_IS_EMBEDDED
+    if (other.timestampCount != 0)
+    {
+        minTimestamp = (timestampCount != 0 ? _MIN(other.minTimestamp, minTimestamp) : other.minTimestamp);
+        maxTimestamp = (timestampCount != 0 ? _MAX(other.maxTimestamp, maxTimestamp) : other.maxTimestamp);
+    }
+    timestampCount += other.timestampCount;
+    duplicateCount += other.duplicateCount;
+    outOfOrderCount += other.outOfOrderCount;
+    gapCount += other.gapCount;
+    gapTime += other.gapTime;
+    deltaHistogram.Merge(other.deltaHistogram);
+    jitterHistogram.Merge(other.jitterHistogram);
+    for (size_t i = 0; i < other.gaps.size() && gaps.size() < LOG_STATS_MAX_GAPS; i++)
+    {
+        gaps.push_back(other.gaps[i]);
+    }
+#endif
+}
+
 void cLogStatDataId::Printf()
 {
 
@@ -65,6 +322,10 @@ void cLogStatDataId::Printf()
     printf(" Count: %llu,   Errors: %llu\r\n", (unsigned long long)count, (unsigned long long)errorCount);
     printf(" Time delta: (ave, min, max) %f, %f, %f\r\n", averageTimeDelta, minTimestampDelta, maxTimestampDelta);
     printf(" Time delta drop: %llu\r\n", (unsigned long long)timestampDropCount);
+    if (dropCount != 0)
+    {
+        printf(" Dropped: %llu\r\n", (unsigned long long)dropCount);
+    }
 
 #endif
 
@@ -83,6 +344,7 @@ void cLogStats::Clear()
         dataIdStats[id].minTimestampDelta = 1.0E6;
     }
     errorCount = 0;
+    dropCount = 0;
     count = 0;
 }
 
@@ -96,6 +358,16 @@ void cLogStats::LogError(const p_data_hdr_t* hdr)
     }
 }
 
+void cLogStats::LogDrop(uint32_t dataId, uint64_t dropped)
+{
+    dropCount += dropped;
+    if (dataId < DID_COUNT)
+    {
+        cLogStatDataId& d = dataIdStats[dataId];
+        d.dropCount += dropped;
+    }
+}
+
 void cLogStats::LogData(uint32_t dataId)
 {
     if (dataId < DID_COUNT)
@@ -120,6 +392,17 @@ void cLogStats::LogDataAndTimestamp(uint32_t dataId, double timestamp)
     }
 }
 
+void cLogStats::Merge(const cLogStats& other)
+{
+    for (uint32_t id = 0; id < DID_COUNT; id++)
+    {
+        dataIdStats[id].Merge(other.dataIdStats[id]);
+    }
+    count += other.count;
+    errorCount += other.errorCount;
+    dropCount += other.dropCount;
+}
+
 void cLogStats::Printf()
 {
 
@@ -127,10 +410,10 @@ void cLogStats::Printf()
 
     printf("LOG STATS\r\n");
     printf("----------");
-    printf("Count: %llu,   Errors: %llu\r\n", (unsigned long long)count, (unsigned long long)errorCount);
+    printf("Count: %llu,   Errors: %llu,   Dropped: %llu\r\n", (unsigned long long)count, (unsigned long long)errorCount, (unsigned long long)dropCount);
     for (uint32_t id = 0; id < DID_COUNT; id++)
     {
-        if (dataIdStats[id].count != 0)
+        if (dataIdStats[id].count != 0 || dataIdStats[id].dropCount != 0)
         {
             printf(" DID: %d\r\n", id);
             dataIdStats[id].Printf();
@@ -144,16 +427,20 @@ void cLogStats::Printf()
 
 void cLogStats::WriteToFile(const string& file_name)
 {
-    if (count != 0)
+    if (count != 0 || dropCount != 0)
     {
         // flush log stats to disk
 #if 1
         cISLogFileBase* statsFile = CreateISLogFile(file_name, "wb");
         statsFile->lprintf("Total count: %d,   Total errors: \r\n\r\n", count, errorCount);
+        if (dropCount != 0)
+        {
+            statsFile->lprintf("Total dropped: %llu\r\n\r\n", (unsigned long long)dropCount);
+        }
         for (uint32_t id = 0; id < DID_COUNT; id++)
         {
             cLogStatDataId& stat = dataIdStats[id];
-            if (stat.count == 0 && stat.errorCount == 0)
+            if (stat.count == 0 && stat.errorCount == 0 && stat.dropCount == 0)
             {   // Exclude zero count stats
                 continue;
             }
@@ -162,6 +449,10 @@ void cLogStats::WriteToFile(const string& file_name)
             statsFile->lprintf("Count: %d,   Errors: %d\r\n", stat.count, stat.errorCount);
             statsFile->lprintf("Timestamp Delta (ave, min, max): %.4f, %.4f, %.4f\r\n", stat.averageTimeDelta, stat.minTimestampDelta, stat.maxTimestampDelta);
             statsFile->lprintf("Timestamp Drops: %d\r\n", stat.timestampDropCount);
+            if (stat.dropCount != 0)
+            {
+                statsFile->lprintf("Dropped: %llu\r\n", (unsigned long long)stat.dropCount);
+            }
             statsFile->lprintf("\r\n");
         }
         CloseISLogFile(statsFile);
@@ -191,3 +482,38 @@ void cLogStats::WriteToFile(const string& file_name)
 #endif
     }
 }
+
+#if !PLATFORM_IS_EMBEDDED
+
+void cLogStats::WriteJson(cISLogFileBase* file) const
+{
+    file->lprintf("{\n");
+    file->lprintf("\t\"count\": %llu,\n", (unsigned long long)count);
+    file->lprintf("\t\"errors\": %llu,\n", (unsigned long long)errorCount);
+    file->lprintf("\t\"dropped\": %llu,\n", (unsigned long long)dropCount);
+    file->lprintf("\t\"dataIds\": [");
+    bool first = true;
+    for (uint32_t id = 0; id < DID_COUNT; id++)
+    {
+        const cLogStatDataId& stat = dataIdStats[id];
+        if (stat.count == 0 && stat.errorCount == 0 && stat.dropCount == 0)
+        {   // Exclude zero count stats
+            continue;
+        }
+        file->lprintf(first ? "\n" : ",\n");
+        stat.WriteJson(file, id);
+        first = false;
+    }
+    file->lprintf(first ? "]\n" : "\n\t]\n");
+    file->lprintf("}");
+}
+
+void cLogStats::WriteJsonToFile(const string& fileName) const
+{
+    cISLogFileBase* file = CreateISLogFile(fileName, "wb");
+    WriteJson(file);
+    file->lprintf("\n");
+    CloseISLogFile(file);
+}
+
+#endif
@@ -15,10 +15,47 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <string>
 #include <cstdint>
+#include <vector>
 
 #include "data_sets.h"
 #include "ISComm.h"
 
+class cISLogFileBase;
+
+#if !PLATFORM_IS_EMBEDDED
+
+#define LOG_STATS_HISTOGRAM_MIN_EXPONENT	(-20)	// first bucket above bucket 0 starts at 2^-20 s (~1 us)
+#define LOG_STATS_HISTOGRAM_OCTAVES			40		// last bucket starts at 2^20 s
+#define LOG_STATS_HISTOGRAM_SUB_BUCKETS		16		// buckets per power of two, 6% wide at most
+#define LOG_STATS_HISTOGRAM_SIZE			(1 + LOG_STATS_HISTOGRAM_OCTAVES * LOG_STATS_HISTOGRAM_SUB_BUCKETS)
+#define LOG_STATS_GAP_FACTOR				2.0		// time delta over this times the usual period is a gap
+#define LOG_STATS_MAX_GAPS					1000	// gaps listed per data id, all gaps are counted
+
+// Time values counted on a log scale, bucket 0 holds values below 2^LOG_STATS_HISTOGRAM_MIN_EXPONENT
+class cLogStatHistogram
+{
+public:
+	std::vector<uint64_t> counts;	// LOG_STATS_HISTOGRAM_SIZE once a value is added
+	uint64_t total;
+	int modeBucket;					// bucket with the highest count
+
+	cLogStatHistogram();
+	void Add(double value);
+	void Merge(const cLogStatHistogram& other);
+	double Percentile(double fraction) const; // upper edge of the bucket holding the percentile, 0 if empty or in bucket 0
+	double Mode() const; // center of the most common bucket, 0 if empty
+	static int Bucket(double value);
+	static double BucketStart(int bucket);
+};
+
+struct sLogStatGap
+{
+	double timestamp;	// last timestamp before the gap
+	double duration;	// time delta across the gap
+};
+
+#endif
+
 
 
 class cLogStatDataId
@@ -34,10 +71,36 @@ public:
 	double maxTimestampDelta;
 	uint64_t timestampDeltaCount;
 	uint64_t timestampDropCount; // count of delta timestamps > 50% different from previous delta timestamp
+	uint64_t dropCount; // count of data dropped before it was logged, i.e. logger queue full
+
+#if !PLATFORM_IS_EMBEDDED
+	// Streaming analysis, one pass over the data
+	uint64_t timestampCount; // valid timestamps
+	uint64_t duplicateCount; // timestamp equal to the previous one
+	uint64_t outOfOrderCount; // timestamp before the previous one
+	uint64_t gapCount; // time deltas over LOG_STATS_GAP_FACTOR times the usual period
+	double gapTime; // time missing in gaps, beyond the usual period
+	double minTimestamp;
+	double maxTimestamp;
+	double analysisLastDelta; // previous in order time delta, 0 if none
+	bool analysisOutOfOrder; // previous timestamp was out of order
+	cLogStatHistogram deltaHistogram; // time between data
+	cLogStatHistogram jitterHistogram; // change in time between data, |delta - previous delta|
+	std::vector<sLogStatGap> gaps; // first LOG_STATS_MAX_GAPS gaps
+
+	double EffectiveRate() const; // Hz over the logged time span
+	void WriteJson(cISLogFileBase* file, uint32_t id) const;
+#endif
 
 	cLogStatDataId();
 	void LogTimestamp(double timestamp);
+	void Merge(const cLogStatDataId& other);
 	void Printf();
+
+private:
+#if !PLATFORM_IS_EMBEDDED
+	void AnalyzeTimestamp(double timestamp);
+#endif
 };
 
 class cLogStats
@@ -46,14 +109,25 @@ public:
 	cLogStatDataId dataIdStats[DID_COUNT];
 	uint64_t count; // count of all data ids
 	uint64_t errorCount; // total error count
+	uint64_t dropCount; // total dropped count
 
 	cLogStats();
 	void Clear();
 	void LogError(const p_data_hdr_t* hdr);
+	void LogDrop(uint32_t dataId, uint64_t dropped = 1);
 	void LogData(uint32_t dataId);
 	void LogDataAndTimestamp(uint32_t dataId, double timestamp);
+	void Merge(const cLogStats& other); // add stats gathered separately, i.e. on another thread
 	void Printf();
 	void WriteToFile(const std::string& fileName);
+#if !PLATFORM_IS_EMBEDDED
+	/**
+	* Write the stats and streaming analysis of each data id as a json object: counts, effective rate, time delta and 
+	* jitter percentiles, gaps, duplicate and out of order timestamps and the time delta histogram
+	*/
+	void WriteJson(cISLogFileBase* file) const;
+	void WriteJsonToFile(const std::string& fileName) const;
+#endif
 };
 
 
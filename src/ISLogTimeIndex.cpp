@@ -0,0 +1,164 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <algorithm>
+
+#include "ISLogTimeIndex.h"
+#include "ISLogFileFactory.h"
+
+using namespace std;
+
+
+cISLogTimeIndex::cISLogTimeIndex()
+{
+	m_pFile = NULLPTR;
+	m_periodSec = 0.0;
+	m_lastTime = 0.0;
+}
+
+
+cISLogTimeIndex::~cISLogTimeIndex()
+{
+	Close();
+}
+
+
+bool cISLogTimeIndex::OpenForWriting(const string& fileName, uint32_t periodMs)
+{
+	Close();
+	m_entries.clear();
+	m_runStarts.clear();
+	m_periodSec = 0.001 * periodMs;
+
+	m_pFile = CreateISLogFile(fileName, "wb");
+	if (m_pFile == NULLPTR || !m_pFile->isOpened())
+	{
+		Close();
+		return false;
+	}
+
+	sTimeIndexHeader hdr = { LOG_TIME_INDEX_MARKER, LOG_TIME_INDEX_VERSION, periodMs, 0 };
+	return m_pFile->write(&hdr, sizeof(hdr)) == sizeof(hdr);
+}
+
+
+bool cISLogTimeIndex::Add(double time, uint32_t fileNumber, uint32_t offset)
+{
+	if (m_pFile == NULLPTR || time <= 0.0)
+	{
+		return false;
+	}
+
+	// Time going backwards (i.e. GPS week rollover or a different time source) always gets an entry
+	if (!m_entries.empty() && time >= m_lastTime && time < m_lastTime + m_periodSec)
+	{
+		return false;
+	}
+
+	sTimeIndexEntry entry;
+	entry.time = time;
+	entry.fileNumber = fileNumber;
+	entry.offset = offset;
+	AddEntry(entry);
+	m_lastTime = time;
+
+	return m_pFile->write(&entry, sizeof(entry)) == sizeof(entry);
+}
+
+
+void cISLogTimeIndex::Flush()
+{
+	if (m_pFile != NULLPTR)
+	{
+		m_pFile->flush();
+	}
+}
+
+
+void cISLogTimeIndex::Close()
+{
+	CloseISLogFile(m_pFile);
+}
+
+
+bool cISLogTimeIndex::Load(const string& fileName)
+{
+	Close();
+	m_entries.clear();
+	m_runStarts.clear();
+
+	cISLogFileBase* pFile = CreateISLogFile(fileName, "rb");
+	sTimeIndexHeader hdr;
+	if (pFile != NULLPTR && pFile->isOpened() &&
+		pFile->read(&hdr, sizeof(hdr)) == sizeof(hdr) &&
+		hdr.marker == LOG_TIME_INDEX_MARKER && hdr.version == LOG_TIME_INDEX_VERSION)
+	{
+		m_periodSec = 0.001 * hdr.periodMs;
+
+		sTimeIndexEntry entry;
+		while (pFile->read(&entry, sizeof(entry)) == sizeof(entry))
+		{
+			AddEntry(entry);
+		}
+	}
+	CloseISLogFile(pFile);
+
+	return !m_entries.empty();
+}
+
+
+void cISLogTimeIndex::AddEntry(const sTimeIndexEntry& entry)
+{
+	if (m_entries.empty() || entry.time < m_entries.back().time)
+	{	// time went backwards, i.e. GPS week rollover
+		m_runStarts.push_back(m_entries.size());
+	}
+	m_entries.push_back(entry);
+}
+
+
+static bool entryTimeLess(double time, const sTimeIndexEntry& entry)
+{
+	return time < entry.time;
+}
+
+
+const sTimeIndexEntry* cISLogTimeIndex::Find(double time) const
+{
+	if (m_entries.empty())
+	{
+		return NULLPTR;
+	}
+
+	// Entries are sorted within each run
+	const sTimeIndexEntry* closest = NULLPTR;
+	for (size_t r = 0; r < m_runStarts.size(); r++)
+	{
+		vector<sTimeIndexEntry>::const_iterator first = m_entries.begin() + m_runStarts[r];
+		vector<sTimeIndexEntry>::const_iterator last = (r + 1 < m_runStarts.size() ? m_entries.begin() + m_runStarts[r + 1] : m_entries.end());
+		if (time < first->time)
+		{
+			continue;
+		}
+		vector<sTimeIndexEntry>::const_iterator it = upper_bound(first, last, time, entryTimeLess) - 1;
+		if (it + 1 != last)
+		{	// spans the time
+			return &(*it);
+		}
+		if (closest == NULLPTR || it->time > closest->time)
+		{
+			closest = &(*it);
+		}
+	}
+	return (closest != NULLPTR ? closest : &m_entries.front());
+}
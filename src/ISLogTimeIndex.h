@@ -0,0 +1,97 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef IS_LOG_TIME_INDEX_H
+#define IS_LOG_TIME_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "ISLogFileBase.h"
+
+#define LOG_TIME_INDEX_MARKER		0x58444954		// "TIDX"
+#define LOG_TIME_INDEX_VERSION		2
+#define LOG_TIME_INDEX_EXTENSION	".idx"
+
+struct sTimeIndexHeader
+{
+	uint32_t marker;		//!< LOG_TIME_INDEX_MARKER
+	uint32_t version;		//!< LOG_TIME_INDEX_VERSION
+	uint32_t periodMs;		//!< Minimum time between index entries
+	uint32_t reserved;
+};
+
+struct sTimeIndexEntry
+{
+	double time;			//!< First GPS time of week in the chunk (seconds, cISDataMappings::GetTimeOfWeek)
+	uint32_t fileNumber;	//!< Log file number, as in the log file name
+	uint32_t offset;		//!< Byte offset of the chunk header in the log file
+};
+
+/**
+* Time index sidecar for a device log.  Maps GPS time of week to log file chunk positions so reading can start 
+* anywhere in the log without scanning from the first file.
+*/
+class cISLogTimeIndex
+{
+public:
+	cISLogTimeIndex();
+	~cISLogTimeIndex();
+
+	/**
+	* Create the index file, replacing any existing file
+	* @param fileName index file path
+	* @param periodMs minimum time between entries, entries closer together than this are skipped
+	* @return true if the file was created
+	*/
+	bool OpenForWriting(const std::string& fileName, uint32_t periodMs);
+
+	/**
+	* Add an entry if it is at least the index period after the previous entry
+	* @return true if the entry was written
+	*/
+	bool Add(double time, uint32_t fileNumber, uint32_t offset);
+
+	void Flush();
+	void Close();
+	bool IsOpened() const { return m_pFile != NULLPTR; }
+
+	/**
+	* Load an index file written by OpenForWriting / Add
+	* @return true if the file was loaded and has at least one entry
+	*/
+	bool Load(const std::string& fileName);
+
+	/**
+	* Find the last entry at or before the time of week.  Time of week restarts at the GPS week rollover and can jump 
+	* back when the fix is reacquired, so entries are searched as runs of increasing time in log order.  The first run 
+	* whose entries span the time is used, otherwise the run whose last entry is closest before the time, otherwise the 
+	* first entry of the log.
+	* @return the entry or NULLPTR if the index is empty
+	*/
+	const sTimeIndexEntry* Find(double time) const;
+
+	const std::vector<sTimeIndexEntry>& Entries() const { return m_entries; }
+
+private:
+	void AddEntry(const sTimeIndexEntry& entry);
+
+	cISLogFileBase* m_pFile;
+	double m_periodSec;
+	double m_lastTime;
+	std::vector<sTimeIndexEntry> m_entries;
+	std::vector<size_t> m_runStarts;		// index of the first entry of each run of increasing time
+};
+
+#endif // IS_LOG_TIME_INDEX_H
@@ -24,6 +24,10 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <set>
 #include <sstream>
 #include <mutex>
+#if !PLATFORM_IS_EVB_2
+#include <atomic>
+#include <thread>
+#endif
 
 #include "ISFileManager.h"
 #include "ISLogger.h"
@@ -82,6 +86,15 @@ cISLogger::cISLogger()
 	m_logStats.Clear();
 	m_lastCommTime = 0;
 	m_timeoutFlushSeconds = 0;
+	m_asyncFileWrite = false;
+	m_syncPeriodMs = 1000;
+	m_mappedRead = false;
+	m_timeIndexPeriodMs = 0;
+	m_kmlDecimation = 0.0;
+	m_kmlCompress = false;
+	m_compressionLevel = 0;
+	m_compressionFilter = false;
+	m_copyThreads = 0;
 }
 
 
@@ -98,6 +111,7 @@ void cISLogger::Cleanup()
 	const std::lock_guard<std::mutex> lock(g_devices_mutex);
 #endif
 	m_devices.clear();
+	m_readTimeOfWeek.clear();
 	m_logStats.Clear();
 }
 
@@ -248,9 +262,14 @@ bool cISLogger::InitDevicesForWriting(int numDevices)
 			case LOGTYPE_CSV:	m_devices.push_back(make_shared<cDeviceLogCSV>());		break;
 			case LOGTYPE_JSON:	m_devices.push_back(make_shared<cDeviceLogJSON>());		break;
 			case LOGTYPE_KML:	m_devices.push_back(make_shared<cDeviceLogKML>());		break;
+			case LOGTYPE_COLUMNAR:	m_devices.push_back(make_shared<cDeviceLogColumnar>());	break;
 #endif
 			}
 
+			m_devices[i]->SetAsyncFileWrite(m_asyncFileWrite, m_syncPeriodMs);
+			m_devices[i]->SetTimeIndex(m_timeIndexPeriodMs);
+			m_devices[i]->SetKmlOutput(m_kmlDecimation, m_kmlCompress);
+			m_devices[i]->SetCompression(m_compressionLevel, m_compressionFilter);
 			m_devices[i]->InitDeviceForWriting(i, m_timeStamp, m_directory, m_maxDiskSpace, m_maxFileSize);
 		}
 	}
@@ -276,6 +295,7 @@ bool cISLogger::LoadFromDirectory(const string& directory, eLogType logType, vec
 	case cISLogger::LOGTYPE_SDAT: fileExtensionRegex = "\\.sdat$"; break;
 	case cISLogger::LOGTYPE_CSV: fileExtensionRegex = "\\.csv$"; break;
 	case cISLogger::LOGTYPE_JSON: fileExtensionRegex = "\\.json$"; break;
+	case cISLogger::LOGTYPE_COLUMNAR: fileExtensionRegex = "\\.icol$"; break;
 	case cISLogger::LOGTYPE_KML: return false; // fileExtensionRegex = "\\.kml$"; break; // kml read not supported
 	}
 
@@ -337,9 +357,11 @@ bool cISLogger::LoadFromDirectory(const string& directory, eLogType logType, vec
 							case cISLogger::LOGTYPE_SDAT:   m_devices.push_back(make_shared<cDeviceLogSorted>()); break;
 							case cISLogger::LOGTYPE_CSV:    m_devices.push_back(make_shared<cDeviceLogCSV>()); break;
 							case cISLogger::LOGTYPE_JSON:   m_devices.push_back(make_shared<cDeviceLogJSON>()); break;
+							case cISLogger::LOGTYPE_COLUMNAR:   m_devices.push_back(make_shared<cDeviceLogColumnar>()); break;
 #endif
 							}
                         }
+                        m_devices.back()->SetMappedRead(m_mappedRead);
                         m_devices.back()->SetupReadInfo(directory, serialNumber, m_timeStamp);
 
 #if (LOG_DEBUG_GEN == 2)
@@ -364,7 +386,12 @@ bool cISLogger::LoadFromDirectory(const string& directory, eLogType logType, vec
 bool cISLogger::LogData(unsigned int device, p_data_hdr_t* dataHdr, const uint8_t* dataBuf)
 {
 	m_lastCommTime = GetTime();
+	return LogDeviceData(device, dataHdr, dataBuf, m_logStats);
+}
 
+
+bool cISLogger::LogDeviceData(unsigned int device, p_data_hdr_t* dataHdr, const uint8_t* dataBuf, cLogStats& stats)
+{
 	if (!m_enabled)
 	{
         m_errorFile.lprintf("Logger is not enabled\r\n");
@@ -378,18 +405,18 @@ bool cISLogger::LogData(unsigned int device, p_data_hdr_t* dataHdr, const uint8_
 	else if (LogHeaderIsCorrupt(dataHdr))
 	{
         m_errorFile.lprintf("Corrupt log header, id: %lu, offset: %lu, size: %lu\r\n", (unsigned long)dataHdr->id, (unsigned long)dataHdr->offset, (unsigned long)dataHdr->size);
-		m_logStats.LogError(dataHdr);
+		stats.LogError(dataHdr);
 	}
     else if (!m_devices[device]->SaveData(dataHdr, dataBuf))
     {
         m_errorFile.lprintf("Underlying log implementation failed to save\r\n");
-        m_logStats.LogError(dataHdr);
+        stats.LogError(dataHdr);
     }
 #if 1
     else
     {
         double timestamp = cISDataMappings::GetTimestamp(dataHdr, dataBuf);
-        m_logStats.LogDataAndTimestamp(dataHdr->id, timestamp);
+        stats.LogDataAndTimestamp(dataHdr->id, timestamp);
 
         if (dataHdr->id == DID_DIAGNOSTIC_MESSAGE)
         {
@@ -416,6 +443,12 @@ bool cISLogger::LogData(unsigned int device, p_data_hdr_t* dataHdr, const uint8_
 
 
 p_data_t* cISLogger::ReadData(unsigned int device)
+{
+	return ReadDeviceData(device, m_logStats);
+}
+
+
+p_data_t* cISLogger::ReadDeviceData(unsigned int device, cLogStats& stats)
 {
 	if (device >= m_devices.size())
 	{
@@ -426,18 +459,60 @@ p_data_t* cISLogger::ReadData(unsigned int device)
 	while (LogDataIsCorrupt(data = m_devices[device]->ReadData()))
 	{
 	    m_errorFile.lprintf("Corrupt log header, id: %lu, offset: %lu, size: %lu\r\n", (unsigned long)data->hdr.id, (unsigned long)data->hdr.offset, (unsigned long)data->hdr.size);
-		m_logStats.LogError(&data->hdr);
+		stats.LogError(&data->hdr);
 		data = NULL;
 	}
 	if (data != NULL)
 	{
         double timestamp = cISDataMappings::GetTimestamp(&data->hdr, data->buf);
-		m_logStats.LogDataAndTimestamp(data->hdr.id, timestamp);
+		stats.LogDataAndTimestamp(data->hdr.id, timestamp);
 	}
 	return data;
 }
 
 
+bool cISLogger::SeekToTime(unsigned int device, double time)
+{
+	if (device >= m_devices.size())
+	{
+		return false;
+	}
+	if (device < m_readTimeOfWeek.size())
+	{
+		m_readTimeOfWeek[device] = 0.0;
+	}
+	return m_devices[device]->SeekToTime(time);
+}
+
+
+p_data_t* cISLogger::ReadDataInTimeRange(unsigned int device, double startTime, double endTime)
+{
+	if (m_readTimeOfWeek.size() != m_devices.size())
+	{
+		m_readTimeOfWeek.resize(m_devices.size(), 0.0);
+	}
+
+	p_data_t* data;
+	while ((data = ReadData(device)) != NULL)
+	{
+		double timeOfWeek = cISDataMappings::GetTimeOfWeek(&data->hdr, data->buf);
+		if (timeOfWeek != 0.0)
+		{
+			m_readTimeOfWeek[device] = timeOfWeek;
+		}
+		if (m_readTimeOfWeek[device] > endTime)
+		{
+			return NULL;
+		}
+		if (m_readTimeOfWeek[device] >= startTime)
+		{
+			return data;
+		}
+	}
+	return NULL;
+}
+
+
 p_data_t* cISLogger::ReadNextData(unsigned int& device)
 {
 	while (device < m_devices.size())
@@ -463,7 +538,14 @@ void cISLogger::CloseAllFiles()
 		m_devices[i]->CloseAllFiles();
 	}
 
+	// Files are complete on disk when this returns
+	WaitForISLogFileWrites();
+
     m_logStats.WriteToFile(m_directory + "/stats.txt");
+	if (!m_directory.empty() && (m_logStats.count != 0 || m_logStats.dropCount != 0))
+	{
+		WriteStatsJson(m_directory + "/stats.json");
+	}
 	m_errorFile.close();
 }
 
@@ -577,8 +659,55 @@ const dev_info_t* cISLogger::GetDeviceInfo( unsigned int device )
 	return m_devices[device]->GetDeviceInfo();
 }
 
-int g_copyReadCount;
-int g_copyReadDid;
+const cLogStats* cISLogger::GetDeviceStats(unsigned int device)
+{
+	if (device >= m_devices.size())
+	{
+		return NULL;
+	}
+
+	return &m_devices[device]->GetStats();
+}
+
+bool cISLogger::WriteStatsJson(const string& fileName)
+{
+#if PLATFORM_IS_EMBEDDED
+	return false;
+#else
+	cISLogFileBase* file = CreateISLogFile(fileName, "wb");
+	if (file == NULL || !file->isOpened())
+	{
+		CloseISLogFile(file);
+		return false;
+	}
+
+	// Totals include data dropped before it was logged, time analysis is per device
+	file->lprintf("{\n");
+	file->lprintf("\t\"timestamp\": \"%s\",\n", m_timeStamp.c_str());
+	file->lprintf("\t\"count\": %llu,\n", (unsigned long long)m_logStats.count);
+	file->lprintf("\t\"errors\": %llu,\n", (unsigned long long)m_logStats.errorCount);
+	file->lprintf("\t\"dropped\": %llu,\n", (unsigned long long)m_logStats.dropCount);
+	file->lprintf("\t\"devices\": [");
+	for (unsigned int dev = 0; dev < m_devices.size(); dev++)
+	{
+		file->lprintf("%s\n{ \"serialNumber\": %u, \"stats\": ", (dev == 0 ? "" : ","), m_devices[dev]->GetDeviceInfo()->serialNumber);
+		m_devices[dev]->GetStats().WriteJson(file);
+		file->lprintf(" }");
+	}
+	file->lprintf("\n]\n}\n");
+	CloseISLogFile(file);
+	return true;
+#endif
+}
+
+uint32_t cISLogger::CopyThreadCount()
+{
+#if PLATFORM_IS_EVB_2
+	return 1;
+#else
+	return (m_copyThreads != 0 ? m_copyThreads : _MAX(std::thread::hardware_concurrency(), 1u));
+#endif
+}
 
 bool cISLogger::CopyLog(cISLogger& log, const string& timestamp, const string &outputDir, eLogType logType, float maxLogSpacePercent, uint32_t maxFileSize, bool useSubFolderTimestamp, bool enableCsvIns2ToIns1Conversion)
 {
@@ -588,61 +717,112 @@ bool cISLogger::CopyLog(cISLogger& log, const string& timestamp, const string &o
 		return false;
 	}
 	EnableLogging(true);
-	p_data_t* data = NULL;
-	for (unsigned int dev = 0; dev < log.GetDeviceCount(); dev++)
+
+	// Devices are copied in parallel.  Threads left over format the csv data sets of each device in parallel.
+	unsigned int deviceCount = log.GetDeviceCount();
+	uint32_t threads = CopyThreadCount();
+	uint32_t deviceThreads = _MAX(_MIN(threads, deviceCount), 1u);
+	for (unsigned int dev = 0; dev < deviceCount; dev++)
 	{
 		// Copy device info
-		const dev_info_t* devInfo = log.GetDeviceInfo(dev);
-		SetDeviceInfo(devInfo, dev);
-
-#if LOG_DEBUG_GEN == 2
-		// Don't print status here
-#elif LOG_DEBUG_GEN || DEBUG_PRINT
-		printf("cISLogger::CopyLog SN%d type %d, (%d of %d)\n", devInfo->serialNumber, logType, dev+1, log.GetDeviceCount());
-#endif
+		SetDeviceInfo(log.GetDeviceInfo(dev), dev);
 
 		// Set KML configuration
 		m_devices[dev]->SetKmlConfig(m_gpsData, m_showPath, m_showSample, m_showTimeStamp, m_iconUpdatePeriodSec, m_altClampToGround);
+		if (logType == eLogType::LOGTYPE_CSV)
+		{
+			m_devices[dev]->SetWriteThreads(threads / deviceThreads);
+		}
+	}
 
-		// Copy data		
-		for (g_copyReadCount = 0; (data = log.ReadData(dev)); g_copyReadCount++)
+#if !PLATFORM_IS_EVB_2
+	if (deviceThreads > 1)
+	{
+		// Each thread gathers stats on its own, merged when done
+		std::atomic<unsigned int> nextDevice(0);
+		std::mutex statsMutex;
+		std::vector<std::thread> workers;
+		for (uint32_t i = 0; i < deviceThreads; i++)
 		{
+			workers.push_back(std::thread([&, i]()
+			{
+				std::unique_ptr<cLogStats> readStats(new cLogStats());
+				std::unique_ptr<cLogStats> writeStats(new cLogStats());
+				for (unsigned int dev; (dev = nextDevice++) < deviceCount; )
+				{
+					CopyDeviceLog(log, dev, logType, enableCsvIns2ToIns1Conversion, *readStats, *writeStats, i == 0);
+				}
+				const std::lock_guard<std::mutex> lock(statsMutex);
+				log.m_logStats.Merge(*readStats);
+				m_logStats.Merge(*writeStats);
+			}));
+		}
+		for (size_t i = 0; i < workers.size(); i++)
+		{
+			workers[i].join();
+		}
+	}
+	else
+#endif
+	{
+		for (unsigned int dev = 0; dev < deviceCount; dev++)
+		{
+			CopyDeviceLog(log, dev, logType, enableCsvIns2ToIns1Conversion, log.m_logStats, m_logStats, true);
+		}
+	}
+	CloseAllFiles();
+	return true;
+}
+
+void cISLogger::CopyDeviceLog(cISLogger& log, unsigned int dev, eLogType logType, bool enableCsvIns2ToIns1Conversion, cLogStats& readStats, cLogStats& writeStats, bool showProgress)
+{
+#if LOG_DEBUG_GEN == 2
+	// Don't print status here
+#elif LOG_DEBUG_GEN || DEBUG_PRINT
+	printf("cISLogger::CopyLog SN%d type %d, (%d of %d)\n", log.GetDeviceInfo(dev)->serialNumber, logType, dev+1, log.GetDeviceCount());
+#endif
+
+	// Copy data
+	p_data_t* data = NULL;
+	for (int readCount = 0; (data = log.ReadDeviceData(dev, readStats)); readCount++)
+	{
 
 #if LOG_DEBUG_PRINT_READ
-			double timestamp = cISDataMappings::GetTimestamp(&(data->hdr), data->buf);
-			printf("read: %d DID: %3d time: %.4lf\n", g_copyReadCount, data->hdr.id, timestamp);
-			g_copyReadDid = data->hdr.id;
+		double timestamp = cISDataMappings::GetTimestamp(&(data->hdr), data->buf);
+		printf("read: %d DID: %3d time: %.4lf\n", readCount, data->hdr.id, timestamp);
 #endif
 
 #if LOG_DEBUG_GEN == 2
+		if (showProgress)
+		{	// one thread only, the cursor is not thread safe
 			advance_cursor();
+		}
+#else
+		(void)showProgress;
 #endif
 
-			// CSV special cases 
-			if (logType == eLogType::LOGTYPE_CSV && enableCsvIns2ToIns1Conversion)
-			{
-				if (data->hdr.id == DID_INS_2)
-				{	// Convert INS2 to INS1 when creating .csv logs
-					ins_1_t ins1;
-					ins_2_t ins2;
-
-					copyDataPToStructP(&ins2, data, sizeof(ins_2_t));
-					convertIns2ToIns1(&ins2, &ins1);
-
-					p_data_hdr_t hdr;
-					hdr.id = DID_INS_1;
-					hdr.size = sizeof(ins_1_t);
-					hdr.offset = 0;
-					LogData(dev, &hdr, (uint8_t*)&ins1);
-				}
+		// CSV special cases 
+		if (logType == eLogType::LOGTYPE_CSV && enableCsvIns2ToIns1Conversion)
+		{
+			if (data->hdr.id == DID_INS_2)
+			{	// Convert INS2 to INS1 when creating .csv logs
+				ins_1_t ins1;
+				ins_2_t ins2;
+
+				copyDataPToStructP(&ins2, data, sizeof(ins_2_t));
+				convertIns2ToIns1(&ins2, &ins1);
+
+				p_data_hdr_t hdr;
+				hdr.id = DID_INS_1;
+				hdr.size = sizeof(ins_1_t);
+				hdr.offset = 0;
+				LogDeviceData(dev, &hdr, (uint8_t*)&ins1, writeStats);
 			}
-
-			// Save data
-            LogData(dev, &data->hdr, data->buf);
 		}
+
+		// Save data
+		LogDeviceData(dev, &data->hdr, data->buf, writeStats);
 	}
-	CloseAllFiles();
-	return true;
 }
 
 bool cISLogger::ReadAllLogDataIntoMemory(const string& directory, map<uint32_t, vector<vector<uint8_t>>>& data)
@@ -28,6 +28,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "DeviceLogCSV.h"
 #include "DeviceLogJSON.h"
 #include "DeviceLogKML.h"
+#include "DeviceLogColumnar.h"
 #endif
 
 #if PLATFORM_IS_EVB_2
@@ -54,11 +55,24 @@ public:
 		LOGTYPE_SDAT,
 		LOGTYPE_CSV,
 		LOGTYPE_KML,
-		LOGTYPE_JSON
+		LOGTYPE_JSON,
+		LOGTYPE_COLUMNAR
+	};
+
+	// What happens to received data when the logger falls behind and its queue is full
+	enum eBackpressure
+	{
+		BACKPRESSURE_DROP_NEWEST = 0,	// new data is dropped while the queue is full
+		BACKPRESSURE_DROP_OLDEST,		// queued data is discarded oldest first once the queue is 3/4 full, and by receive to fit new data when full
+		BACKPRESSURE_BLOCK,				// receive waits for the logger up to BACKPRESSURE_BLOCK_MAX_MS, data is dropped only while the logger is stuck longer
+		BACKPRESSURE_PRIORITY			// low priority data ids are dropped once the queue is 3/4 full
 	};
 
 	static const std::string g_emptyString;
 
+	// Longest time receive waits for the logger under BACKPRESSURE_BLOCK
+	static const uint32_t BACKPRESSURE_BLOCK_MAX_MS = 100;
+
 	cISLogger();
 	virtual ~cISLogger();
 
@@ -101,6 +115,15 @@ public:
 		bool useSubFolderTimestamp = true,
 		bool enableCsvIns2ToIns1Conversion = true);
 	const cLogStats& GetStats() { return m_logStats; }
+	const cLogStats* GetDeviceStats(unsigned int device = 0);
+
+	/**
+	* Write the stats of the data logged or read so far to a json file, including the streaming analysis of each device 
+	* (see cLogStats::WriteJson).  CloseAllFiles writes this to stats.json in the log directory.
+	* @return true if the file was written
+	*/
+	bool WriteStatsJson(const std::string& fileName);
+	void LogDataDropped(uint32_t dataId, uint64_t dropped) { m_logStats.LogDrop(dataId, dropped); }
 	eLogType GetType() { return m_logType; }
 
 	/**
@@ -115,6 +138,63 @@ public:
 	*/
 	void SetTimeoutFlushSeconds(time_t timeoutFlushSeconds) { m_timeoutFlushSeconds = timeoutFlushSeconds; }
 
+	/**
+	* Write log files from a background I/O thread (Linux), takes effect on the next InitSave
+	* @param enable true to write behind, false for blocking writes
+	* @param syncPeriodMs period to fdatasync written data, 0 to leave it to the OS
+	*/
+	void SetAsyncFileWrite(bool enable, uint32_t syncPeriodMs = 1000) { m_asyncFileWrite = enable; m_syncPeriodMs = syncPeriodMs; }
+
+	/**
+	* Read .dat / .sdat logs through a memory mapping (Linux / Apple), takes effect on the next LoadFromDirectory.  
+	* .dat data returned by ReadData points directly into the mapping, except for compressed chunks.
+	* @param enable true to memory map log files, false to read them with file I/O
+	*/
+	void SetMappedRead(bool enable) { m_mappedRead = enable; }
+
+	/**
+	* Write a .idx time index next to each device log (.dat only), takes effect on the next InitSave
+	* @param enable true to write the time index
+	* @param periodMs minimum time between index entries
+	*/
+	void SetTimeIndex(bool enable, uint32_t periodMs = 1000) { m_timeIndexPeriodMs = (enable ? _MAX(periodMs, 1) : 0); }
+
+	/**
+	* Compress .dat / .sdat chunks on the logging thread, takes effect on the next InitSave.  Compressed logs are read back transparently.
+	* @param level CHUNK_COMPRESSION_NONE, CHUNK_COMPRESSION_FAST or CHUNK_COMPRESSION_DENSE (zlib level 0-9, requires USE_ZLIB)
+	* @param deltaFilter store each data set as the difference from the previous one of the same DID before compressing, helps high rate data
+	*/
+	void SetCompression(int level, bool deltaFilter = true) { m_compressionLevel = _CLAMP(level, 0, 9); m_compressionFilter = deltaFilter; }
+
+	/**
+	* Threads used by CopyLog.  Devices are copied in parallel and threads left over format csv data sets in parallel.
+	* @param threads thread count, 0 for one per CPU core, 1 to copy on the calling thread
+	*/
+	void SetCopyThreads(uint32_t threads) { m_copyThreads = threads; }
+
+	/**
+	* KML track decimation and compression, takes effect on the next InitSave
+	* @param decimationToleranceM Douglas-Peucker tolerance in meters for track coordinates, 0 to write every sample
+	* @param kmz true to write zip compressed .kmz files (requires USE_ZLIB, otherwise .kml is written)
+	*/
+	void SetKmlOutput(double decimationToleranceM, bool kmz = false) { m_kmlDecimation = _MAX(decimationToleranceM, 0.0); m_kmlCompress = kmz; }
+
+	/**
+	* Move the read position of a device to the indexed chunk at or before a time, using the .idx time index
+	* @param device device index
+	* @param time GPS time of week in seconds, as returned by cISDataMappings::GetTimeOfWeek
+	* @return true if the read position moved, false if the log has no time index or does not support seeking
+	*/
+	bool SeekToTime(unsigned int device, double time);
+
+	/**
+	* Read data within a GPS time of week range.  Data without GPS time (i.e. IMU data stamped with time since boot) 
+	* takes the time of the last GPS time read before it, so it is returned with the GPS data around it.  Data before 
+	* startTime is skipped and NULL is returned at the first GPS time after endTime.  Call SeekToTime(device, startTime) 
+	* first to avoid reading from the start of the log.
+	*/
+	p_data_t* ReadDataInTimeRange(unsigned int device, double startTime, double endTime);
+
     // check if a data header is corrupt
     static bool LogHeaderIsCorrupt(const p_data_hdr_t* hdr);
 
@@ -139,7 +219,7 @@ public:
 
 		for (unsigned int dev = 0; dev < GetDeviceCount(); dev++)
 		{
-			m_devices[dev]->SetKmlConfig(m_showPath, m_showSample, m_showTimeStamp, m_iconUpdatePeriodSec, m_altClampToGround);
+			m_devices[dev]->SetKmlConfig(m_gpsData, m_showPath, m_showSample, m_showTimeStamp, m_iconUpdatePeriodSec, m_altClampToGround);
 		}
 	}
 
@@ -161,6 +241,10 @@ public:
 		{
 			return cISLogger::eLogType::LOGTYPE_JSON;
 		}
+		else if (logTypeString == "icol")
+		{
+			return cISLogger::eLogType::LOGTYPE_COLUMNAR;
+		}
 		return cISLogger::eLogType::LOGTYPE_DAT;
 	}
 
@@ -174,6 +258,10 @@ private:
 	bool InitSaveCommon(eLogType logType, const std::string& directory, const std::string& subDirectory, int numDevices, float maxDiskSpacePercent, uint32_t maxFileSize, bool useSubFolderTimestamp);
 	bool InitDevicesForWriting(int numDevices = 1);
 	void Cleanup();
+	bool LogDeviceData(unsigned int device, p_data_hdr_t* dataHdr, const uint8_t* dataBuf, cLogStats& stats);
+	p_data_t* ReadDeviceData(unsigned int device, cLogStats& stats);
+	uint32_t CopyThreadCount();
+	void CopyDeviceLog(cISLogger& log, unsigned int dev, eLogType logType, bool enableCsvIns2ToIns1Conversion, cLogStats& readStats, cLogStats& writeStats, bool showProgress);
 
 	static time_t GetTime()
     {
@@ -189,6 +277,7 @@ private:
 	std::string				m_directory;
 	std::string				m_timeStamp;
 	std::vector<std::shared_ptr<cDeviceLog>> m_devices;
+	std::vector<double>		m_readTimeOfWeek;		// last GPS time of week read by ReadDataInTimeRange, per device
 
 	uint64_t				m_maxDiskSpace;
 	uint32_t				m_maxFileSize;
@@ -205,8 +294,17 @@ private:
 	bool					m_showPath;
 	bool					m_showTimeStamp;
 	double					m_iconUpdatePeriodSec;
+	double					m_kmlDecimation;
+	int						m_compressionLevel;
+	bool					m_compressionFilter;
+	bool					m_kmlCompress;
 	time_t					m_lastCommTime;
 	time_t					m_timeoutFlushSeconds;
+	bool					m_asyncFileWrite;
+	uint32_t				m_syncPeriodMs;
+	bool					m_mappedRead;
+	uint32_t				m_timeIndexPeriodMs;
+	uint32_t				m_copyThreads;
 
 };
 
@@ -0,0 +1,309 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISNtripCaster.h"
+#include "ISUtilities.h"
+
+using namespace std;
+
+struct sNtripMountpoint
+{
+	string name;
+	string sourceTableEntry;
+	unique_ptr<cISStream> stream;
+	cISLogPacketRing ring;				// reader thread to network thread
+	thread reader;
+	atomic<uint64_t> packetCount;
+	atomic<uint64_t> byteCount;
+	atomic<uint32_t> clientCount;
+	vector<socket_t> clients;			// network thread only
+
+	sNtripMountpoint() : ring(IS_NTRIP_CASTER_RING_SIZE), packetCount(0), byteCount(0), clientCount(0) {}
+};
+
+
+cISNtripCaster::cISNtripCaster() : m_server(this), m_running(false), m_clientCount(0)
+{
+}
+
+cISNtripCaster::~cISNtripCaster()
+{
+	Close();
+}
+
+bool cISNtripCaster::AddMountpoint(const string& name, cISStream* stream, const string& sourceTableEntry)
+{
+	if (m_running || stream == NULLPTR || name.empty() || name.find_first_of("/;: \r\n") != string::npos)
+	{
+		return false;
+	}
+	for (size_t i = 0; i < m_mountpoints.size(); i++)
+	{
+		if (m_mountpoints[i]->name == name)
+		{
+			return false;
+		}
+	}
+
+	sNtripMountpoint* mountpoint = new sNtripMountpoint();
+	mountpoint->name = name;
+	mountpoint->stream.reset(stream);
+	if (sourceTableEntry.empty())
+	{	// identifier;format;format-details;carrier;nav-system;network;country;latitude;longitude;nmea;solution;generator;compr-encryp;authentication;fee;bitrate;misc
+		mountpoint->sourceTableEntry = name + ";RTCM 3;;2;GPS+GLO+GAL+BDS;;;0.00;0.00;0;0;Inertial Sense;none;N;N;0;";
+	}
+	else
+	{
+		mountpoint->sourceTableEntry = sourceTableEntry;
+	}
+	m_mountpoints.push_back(unique_ptr<sNtripMountpoint>(mountpoint));
+	return true;
+}
+
+int cISNtripCaster::Open(const string& ipAddress, int port)
+{
+	if (m_running)
+	{
+		return -1;
+	}
+
+	int status = m_server.Open(ipAddress, port);
+	if (status != 0)
+	{
+		return status;
+	}
+
+	m_running = true;
+	for (size_t i = 0; i < m_mountpoints.size(); i++)
+	{
+		sNtripMountpoint* mountpoint = m_mountpoints[i].get();
+		mountpoint->reader = thread(&cISNtripCaster::ReaderThread, this, mountpoint);
+	}
+	m_networkThread = thread(&cISNtripCaster::NetworkThread, this);
+	return 0;
+}
+
+void cISNtripCaster::Close()
+{
+	m_running = false;
+	if (m_networkThread.joinable())
+	{
+		m_networkThread.join();
+	}
+	for (size_t i = 0; i < m_mountpoints.size(); i++)
+	{
+		if (m_mountpoints[i]->reader.joinable())
+		{
+			m_mountpoints[i]->reader.join();
+		}
+	}
+
+	m_server.Close();
+	m_mountpoints.clear();
+	m_requests.clear();
+	m_subscriptions.clear();
+	m_clientCount = 0;
+}
+
+string cISNtripCaster::MountpointName(size_t index)
+{
+	return (index < m_mountpoints.size() ? m_mountpoints[index]->name : string());
+}
+
+cISNtripCaster::mountpoint_stats_t cISNtripCaster::MountpointStats(size_t index)
+{
+	mountpoint_stats_t stats = mountpoint_stats_t();
+	if (index < m_mountpoints.size())
+	{
+		sNtripMountpoint* mountpoint = m_mountpoints[index].get();
+		stats.packetCount = mountpoint->packetCount;
+		stats.byteCount = mountpoint->byteCount;
+		stats.dropCount = mountpoint->ring.Stats().dropCount;
+		stats.clientCount = mountpoint->clientCount;
+	}
+	return stats;
+}
+
+string cISNtripCaster::SourceTable()
+{
+	string table;
+	for (size_t i = 0; i < m_mountpoints.size(); i++)
+	{
+		table += "STR;" + m_mountpoints[i]->name + ";" + m_mountpoints[i]->sourceTableEntry + "\r\n";
+	}
+	table += "ENDSOURCETABLE\r\n";
+	return table;
+}
+
+void cISNtripCaster::ReaderThread(sNtripMountpoint* mountpoint)
+{
+	is_comm_instance_t comm;
+	vector<uint8_t> buffer(PKT_BUF_SIZE);
+	is_comm_init(&comm, buffer.data(), (int)buffer.size());
+
+	while (m_running)
+	{
+		int n = mountpoint->stream->Read(comm.buf.tail, is_comm_free(&comm));
+		if (n <= 0)
+		{
+			if (n < 0)
+			{	// stream error, wait for it to recover
+				SLEEP_MS(10);
+			}
+			continue;
+		}
+		comm.buf.tail += n;
+
+		protocol_type_t ptype;
+		while ((ptype = is_comm_parse(&comm)) != _PTYPE_NONE)
+		{
+			if (ptype != _PTYPE_RTCM3 && ptype != _PTYPE_UBLOX)
+			{
+				continue;
+			}
+
+			p_data_hdr_t hdr = p_data_hdr_t();
+			hdr.size = comm.dataHdr.size;
+			if (!mountpoint->ring.Push(&hdr, comm.dataPtr))
+			{	// the network thread is behind, counted as dropped
+				mountpoint->ring.Drop(&hdr);
+				continue;
+			}
+			mountpoint->packetCount++;
+			mountpoint->byteCount += hdr.size;
+		}
+	}
+}
+
+void cISNtripCaster::NetworkThread()
+{
+	while (m_running)
+	{
+		// only wait on the sockets when no corrections were sent, the rings are checked again after the wait
+		m_server.Update(SendCorrections() ? 0 : 1);
+	}
+}
+
+bool cISNtripCaster::SendCorrections()
+{
+	bool sent = false;
+	for (size_t i = 0; i < m_mountpoints.size(); i++)
+	{
+		// gather everything queued so each client gets one send
+		sNtripMountpoint* mountpoint = m_mountpoints[i].get();
+		m_batch.clear();
+		const uint8_t* buf;
+		const p_data_hdr_t* hdr;
+		while ((hdr = mountpoint->ring.Front(&buf)) != NULLPTR)
+		{
+			m_batch.insert(m_batch.end(), buf, buf + hdr->size);
+			mountpoint->ring.Pop();
+		}
+
+		if (m_batch.empty())
+		{
+			continue;
+		}
+		sent = true;
+		if (!mountpoint->clients.empty())
+		{	// clients that disconnect during the write are removed from the mountpoint, so write from a copy
+			m_batchClients = mountpoint->clients;
+			m_server.Write(m_batchClients.data(), m_batchClients.size(), m_batch.data(), (int)m_batch.size());
+		}
+	}
+	return sent;
+}
+
+void cISNtripCaster::OnClientConnected(cISTcpServer* server, socket_t socket)
+{
+	m_requests[socket].clear();
+	m_clientCount++;
+}
+
+void cISNtripCaster::OnClientDataReceived(cISTcpServer* server, socket_t socket, uint8_t* data, int dataLength)
+{
+	unordered_map<socket_t, string>::iterator it = m_requests.find(socket);
+	if (it == m_requests.end())
+	{	// data from a client receiving a mountpoint, i.e. GGA from a VRS rover, is not used
+		return;
+	}
+
+	it->second.append((const char*)data, dataLength);
+	size_t end = it->second.find("\r\n\r\n");
+	if (end != string::npos || it->second.size() > IS_NTRIP_CASTER_MAX_REQUEST_SIZE)
+	{
+		string request = it->second.substr(0, end);
+		m_requests.erase(it);
+		HandleRequest(socket, request);
+	}
+}
+
+void cISNtripCaster::OnClientDisconnected(cISTcpServer* server, socket_t socket)
+{
+	m_requests.erase(socket);
+
+	unordered_map<socket_t, sNtripMountpoint*>::iterator it = m_subscriptions.find(socket);
+	if (it != m_subscriptions.end())
+	{
+		vector<socket_t>& clients = it->second->clients;
+		for (size_t i = 0; i < clients.size(); i++)
+		{
+			if (clients[i] == socket)
+			{
+				clients[i] = clients.back();
+				clients.pop_back();
+				break;
+			}
+		}
+		it->second->clientCount--;
+		m_subscriptions.erase(it);
+	}
+	m_clientCount--;
+}
+
+void cISNtripCaster::HandleRequest(socket_t socket, const string& request)
+{
+	string response;
+	if (request.compare(0, 5, "GET /") == 0)
+	{
+		size_t end = request.find_first_of(" \r\n", 5);
+		string name = request.substr(5, (end == string::npos ? string::npos : end - 5));
+		for (size_t i = 0; i < m_mountpoints.size(); i++)
+		{
+			sNtripMountpoint* mountpoint = m_mountpoints[i].get();
+			if (mountpoint->name == name)
+			{	// subscribe first so the client is removed again if the write fails
+				mountpoint->clients.push_back(socket);
+				mountpoint->clientCount++;
+				m_subscriptions[socket] = mountpoint;
+				response = "ICY 200 OK\r\n\r\n";
+				m_server.Write(&socket, 1, (const uint8_t*)response.data(), (int)response.size());
+				return;
+			}
+		}
+
+		// unknown mountpoint or no mountpoint, send the source table
+		string table = SourceTable();
+		response = "SOURCETABLE 200 OK\r\n"
+			"Server: NTRIP Inertial Sense Caster\r\n"
+			"Content-Type: text/plain\r\n"
+			"Content-Length: " + to_string(table.size()) + "\r\n\r\n" + table;
+	}
+	else
+	{
+		response = "HTTP/1.0 400 Bad Request\r\n\r\n";
+	}
+
+	m_server.Write(&socket, 1, (const uint8_t*)response.data(), (int)response.size());
+	m_server.CloseClient(socket);
+}
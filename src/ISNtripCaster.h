@@ -0,0 +1,146 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2023 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef _ISNTRIPCASTER__H__
+#define _ISNTRIPCASTER__H__
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ISTcpServer.h"
+#include "ISLogPacketRing.h"
+
+#define IS_NTRIP_CASTER_RING_SIZE			(256 * 1024)	// bytes of corrections queued between a reader thread and the network thread
+#define IS_NTRIP_CASTER_MAX_REQUEST_SIZE	4096			// max bytes of a client request header
+
+struct sNtripMountpoint;
+
+/**
+* NTRIP caster. Each mountpoint is fed by its own stream (usually a serial port to a base station), read and parsed 
+* on its own thread. RTCM3 and UBX packets go through a lock-free ring to a single network thread, which runs a 
+* cISTcpServer event loop and sends each packet to the clients of that mountpoint. A client asking for an unknown 
+* mountpoint, or for "/", gets the source table.
+*/
+class cISNtripCaster : public iISTcpServerDelegate
+{
+public:
+	typedef struct
+	{
+		uint64_t packetCount;		// packets read from the mountpoint stream
+		uint64_t byteCount;			// bytes of packets read from the mountpoint stream
+		uint64_t dropCount;			// packets dropped because the network thread fell behind
+		uint32_t clientCount;		// clients connected to the mountpoint
+	} mountpoint_stats_t;
+
+	/**
+	* Constructor
+	*/
+	cISNtripCaster();
+
+	/**
+	* Destructor - closes the caster
+	*/
+	virtual ~cISNtripCaster();
+
+	/**
+	* Add a mountpoint, must be called before Open
+	* @param name the mountpoint name clients request
+	* @param stream the stream to read corrections from, the caster takes ownership if the mountpoint is added. Read 
+	* should wait a short time for data instead of returning 0 right away.
+	* @param sourceTableEntry the source table STR line without "STR;[name];", empty for a default RTCM 3 entry
+	* @return true if added, false if the name is already used, invalid, or the caster is open
+	*/
+	bool AddMountpoint(const std::string& name, cISStream* stream, const std::string& sourceTableEntry = "");
+
+	/**
+	* Open the caster and start the reader and network threads
+	* @param ipAddress the ip address to bind to, empty for auto
+	* @param port the port to bind to
+	* @return 0 if success, otherwise an error code
+	*/
+	int Open(const std::string& ipAddress, int port);
+
+	/**
+	* Stop the threads, close all connections and delete the mountpoints
+	*/
+	void Close();
+
+	/**
+	* Get whether the caster is open
+	* @return true if open, false if not
+	*/
+	bool IsOpen() { return m_running; }
+
+	/**
+	* Get the number of mountpoints
+	* @return number of mountpoints
+	*/
+	size_t MountpointCount() { return m_mountpoints.size(); }
+
+	/**
+	* Get a mountpoint name
+	* @param index the mountpoint index
+	* @return the mountpoint name
+	*/
+	std::string MountpointName(size_t index);
+
+	/**
+	* Get mountpoint counters, safe to call from any thread
+	* @param index the mountpoint index
+	* @return the mountpoint counters
+	*/
+	mountpoint_stats_t MountpointStats(size_t index);
+
+	/**
+	* Get the number of connected clients, including clients that have not requested a mountpoint yet
+	* @return number of connected clients
+	*/
+	uint32_t ClientCount() { return m_clientCount; }
+
+	/**
+	* Get the source table response body, one STR line per mountpoint followed by ENDSOURCETABLE
+	* @return the source table
+	*/
+	std::string SourceTable();
+
+protected:
+	void OnClientConnected(cISTcpServer* server, socket_t socket) OVERRIDE;
+	void OnClientDataReceived(cISTcpServer* server, socket_t socket, uint8_t* data, int dataLength) OVERRIDE;
+	void OnClientDisconnected(cISTcpServer* server, socket_t socket) OVERRIDE;
+
+private:
+	cISNtripCaster(const cISNtripCaster& copy); // Disable copy constructor
+
+	void ReaderThread(sNtripMountpoint* mountpoint);
+	void NetworkThread();
+	bool SendCorrections();
+	void HandleRequest(socket_t socket, const std::string& request);
+
+	cISTcpServer m_server;
+	std::vector<std::unique_ptr<sNtripMountpoint>> m_mountpoints;
+	std::thread m_networkThread;
+	std::atomic<bool> m_running;
+	std::atomic<uint32_t> m_clientCount;
+
+	// network thread only
+	std::unordered_map<socket_t, std::string> m_requests;				// clients that have not requested a mountpoint yet
+	std::unordered_map<socket_t, sNtripMountpoint*> m_subscriptions;	// clients receiving a mountpoint
+	std::vector<uint8_t> m_batch;
+	std::vector<socket_t> m_batchClients;
+};
+
+#endif
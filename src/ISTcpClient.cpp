@@ -22,6 +22,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <unistd.h> /* Needed for close() */
 #include <fcntl.h>
 #include <errno.h>
+#include <poll.h>
 
 #endif
 
@@ -75,23 +76,34 @@ void ISSocketFrameworkShutdown()
 
 }
 
+// poll instead of select, select can not wait on sockets numbered FD_SETSIZE (1024) or higher
+static int ISSocketPoll(socket_t socket, short events, int timeoutMilliseconds)
+{
+	pollfd fd = pollfd();
+	fd.fd = socket;
+	fd.events = events;
+
+#if PLATFORM_IS_WINDOWS
+
+	return WSAPoll(&fd, 1, timeoutMilliseconds);
+
+#else
+
+	return poll(&fd, 1, timeoutMilliseconds);
+
+#endif
+
+}
+
 int ISSocketCanWrite(socket_t socket, int timeoutMilliseconds)
 {
-    struct timeval tv = { timeoutMilliseconds / 1000, (timeoutMilliseconds % 1000) * 1000 };
-    fd_set ws;
-    FD_ZERO(&ws);
-    FD_SET(socket, &ws);
-    int numberOfSocketsThatCanWrite = select((int)(socket + 1), NULL, &ws, NULL, &tv);
+    int numberOfSocketsThatCanWrite = ISSocketPoll(socket, POLLOUT, timeoutMilliseconds);
     return (numberOfSocketsThatCanWrite > 0);
 }
 
 int ISSocketCanRead(socket_t socket, int timeoutMilliseconds)
 {
-	struct timeval tv = { timeoutMilliseconds / 1000, (timeoutMilliseconds % 1000) * 1000 };
-	fd_set rs;
-	FD_ZERO(&rs);
-	FD_SET(socket, &rs);
-    int numberOfSocketsThatCanRead = select((int)(socket + 1), &rs, NULL, NULL, &tv);
+    int numberOfSocketsThatCanRead = ISSocketPoll(socket, POLLIN, timeoutMilliseconds);
 	return (numberOfSocketsThatCanRead > 0);
 }
 
@@ -198,19 +210,14 @@ int ISSocketClose(socket_t& socket)
 
 #if PLATFORM_IS_WINDOWS
 
-		status = shutdown(socket, SD_BOTH);
-		if (status == 0)
-		{
-			status = closesocket(socket);
-		}
+		// shutdown fails if the peer already reset the connection, the socket must be closed regardless
+		shutdown(socket, SD_BOTH);
+		status = closesocket(socket);
 
 #else
 
-		status = shutdown(socket, SHUT_RDWR);
-		if (status == 0)
-		{
-			status = close(socket);
-		}
+		shutdown(socket, SHUT_RDWR);
+		status = close(socket);
 
 #endif
 
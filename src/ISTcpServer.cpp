@@ -22,9 +22,28 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <unistd.h> /* Needed for close() */
 #include <fcntl.h>
 #include <errno.h>
+#include <poll.h>
+#include <sys/uio.h>
 
 #endif
 
+#if PLATFORM_IS_LINUX
+
+#include <sys/epoll.h>
+
+#define IS_TCP_SERVER_MAX_EVENTS	64
+
+#endif
+
+#define IS_TCP_SERVER_READ_SIZE		8192
+#define IS_TCP_SERVER_MAX_SEND_BUFFERS	64
+
+#if PLATFORM_IS_LINUX || PLATFORM_IS_APPLE
+#define IS_TCP_SERVER_SEND_FLAGS	MSG_NOSIGNAL
+#else
+#define IS_TCP_SERVER_SEND_FLAGS	0
+#endif
+
 #include "ISTcpServer.h"
 #include "ISUtilities.h"
 
@@ -37,6 +56,10 @@ cISTcpServer::cISTcpServer(iISTcpServerDelegate* delegate)
 	m_delegate = delegate;
 	m_socket = 0;
 	m_port = 0;
+	m_epoll = -1;
+	m_slowClientPolicy = TCP_SERVER_SLOW_CLIENT_DROP_OLDEST;
+	m_maxQueueSize = IS_TCP_SERVER_DEFAULT_MAX_QUEUE_SIZE;
+	m_maxBehindMs = IS_TCP_SERVER_DEFAULT_MAX_BEHIND_MS;
 }
 
 cISTcpServer::~cISTcpServer()
@@ -109,6 +132,25 @@ int cISTcpServer::Open(const string& ipAddress, int port)
 		return -1;
 	}
 
+	// accept without blocking, Update accepts until no connection is pending
+	ISSocketSetBlocking(m_socket, false);
+
+#if PLATFORM_IS_LINUX
+
+	// the server socket is level triggered, connections left pending when accept fails (i.e. out of file descriptors)
+	// are picked up again by the next update
+	m_epoll = epoll_create1(EPOLL_CLOEXEC);
+	epoll_event ev = epoll_event();
+	ev.events = EPOLLIN;
+	ev.data.fd = m_socket;
+	if (m_epoll < 0 || epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_socket, &ev) != 0)
+	{
+		Close();
+		return -1;
+	}
+
+#endif
+
 	return status;
 }
 
@@ -117,91 +159,461 @@ int cISTcpServer::Close()
 	int status = ISSocketClose(m_socket);
 	for (size_t i = 0; i < m_clients.size(); i++)
 	{
-		status |= ISSocketClose(m_clients[i]);
+		status |= ISSocketClose(m_clients[i].socket);
 	}
 	m_clients.clear();
+	m_clientIndex.clear();
+
+#if PLATFORM_IS_LINUX
+
+	if (m_epoll >= 0)
+	{
+		close(m_epoll);
+		m_epoll = -1;
+	}
+
+#endif
+
 	return status;
 }
 
-void cISTcpServer::Update()
+static bool SocketWouldBlock()
+{
+
+#if PLATFORM_IS_WINDOWS
+
+	return (WSAGetLastError() == WSAEWOULDBLOCK);
+
+#else
+
+	return (errno == EAGAIN || errno == EWOULDBLOCK);
+
+#endif
+
+}
+
+static bool SocketInterrupted()
+{
+
+#if PLATFORM_IS_WINDOWS
+
+	return (WSAGetLastError() == WSAEINTR);
+
+#else
+
+	return (errno == EINTR);
+
+#endif
+
+}
+
+// accept failed for this connection only, the others still pending can be accepted
+static bool AcceptAborted()
 {
-	uint8_t readBuff[8192];
 
-	// accept new sockets
-    while (ISSocketCanRead(m_socket, 1))
+#if PLATFORM_IS_WINDOWS
+
+	int error = WSAGetLastError();
+	return (error == WSAECONNRESET || error == WSAEINTR);
+
+#else
+
+	return (errno == ECONNABORTED || errno == EPROTO || errno == EINTR);
+
+#endif
+
+}
+
+void cISTcpServer::Update(int timeoutMilliseconds)
+{
+	if (m_socket == 0)
 	{
+		return;
+	}
+
+#if PLATFORM_IS_LINUX
+
+	// one wait for the server and every client, client sockets are edge triggered so each ready socket is read until 
+	// empty and each writable socket is sent its queue until full
+	epoll_event events[IS_TCP_SERVER_MAX_EVENTS];
+	int count = epoll_wait(m_epoll, events, IS_TCP_SERVER_MAX_EVENTS, timeoutMilliseconds);
+	for (int i = 0; i < count; i++)
+	{
+		socket_t socket = events[i].data.fd;
+		if (socket == m_socket)
+		{
+			AcceptClients();
+			continue;
+		}
+
+		bool connected = true;
+		if (events[i].events & ~EPOLLOUT)
+		{
+			connected = ReadClient(socket);
+		}
+		if (connected && (events[i].events & EPOLLOUT))
+		{
+			sClient* client = FindClient(socket);
+			connected = (client == NULLPTR || FlushClient(*client));
+		}
+		if (!connected)
+		{
+			RemoveClient(socket);
+		}
+	}
+
+#else
+
+	vector<pollfd> fds(m_clients.size() + 1);
+	fds[0].fd = m_socket;
+	fds[0].events = POLLIN;
+	for (size_t i = 0; i < m_clients.size(); i++)
+	{
+		fds[i + 1].fd = m_clients[i].socket;
+		fds[i + 1].events = (short)(POLLIN | (m_clients[i].queue.empty() ? 0 : POLLOUT));
+	}
+
+#if PLATFORM_IS_WINDOWS
+
+	int count = WSAPoll(fds.data(), (ULONG)fds.size(), timeoutMilliseconds);
+
+#else
+
+	int count = poll(fds.data(), (nfds_t)fds.size(), timeoutMilliseconds);
+
+#endif
+
+	for (size_t i = 1; i < fds.size() && count > 0; i++)
+	{
+		bool connected = true;
+		if (fds[i].revents & ~POLLOUT)
+		{
+			connected = ReadClient(fds[i].fd);
+		}
+		if (connected && (fds[i].revents & POLLOUT))
+		{
+			sClient* client = FindClient(fds[i].fd);
+			connected = (client == NULLPTR || FlushClient(*client));
+		}
+		if (!connected)
+		{
+			RemoveClient(fds[i].fd);
+		}
+	}
+	if (count > 0 && fds[0].revents != 0)
+	{
+		AcceptClients();
+	}
+
+#endif
+
+	if (m_slowClientPolicy == TCP_SERVER_SLOW_CLIENT_DISCONNECT && m_maxBehindMs != 0)
+	{
+		uint64_t now = getTickCount();
+		for (size_t i = 0; i < m_clients.size(); i++)
+		{
+			if (!m_clients[i].queue.empty() && now - m_clients[i].queue.front().queuedMs > m_maxBehindMs)
+			{	// the last client moves into this slot
+				RemoveClient(m_clients[i--].socket);
+			}
+		}
+	}
+}
+
+void cISTcpServer::AcceptClients()
+{
+	for (;;)
+	{
+		socket_t socket = accept(m_socket, NULLPTR, NULLPTR);
+		if (socket == (socket_t)-1 && SocketWouldBlock())
+		{	// no more pending connections
+			return;
+		}
+		bool aborted = (socket == (socket_t)-1 && AcceptAborted());
+
 		if (m_delegate != NULLPTR)
 		{
 			m_delegate->OnClientConnecting(this);
 		}
-		socket_t socket = accept(m_socket, NULLPTR, NULLPTR);
-		if (socket != 0)
+		if (socket == (socket_t)-1 || socket == 0)
+		{
+			if (m_delegate != NULLPTR)
+			{
+				m_delegate->OnClientConnectFailed(this);
+			}
+			if (aborted)
+			{
+				continue;
+			}
+			return;
+		}
+
+		ISSocketSetBlocking(socket, false);
+
+#if PLATFORM_IS_LINUX
+
+		epoll_event ev = epoll_event();
+		ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+		ev.data.fd = socket;
+		if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &ev) != 0)
 		{
-			ISSocketSetBlocking(socket, false);
-			m_clients.push_back(socket);
+			ISSocketClose(socket);
 			if (m_delegate != NULLPTR)
 			{
-				m_delegate->OnClientConnected(this, socket);
+				m_delegate->OnClientConnectFailed(this);
 			}
+			continue;
 		}
-		else if (m_delegate != NULLPTR)
+
+#endif
+
+		sClient client;
+		client.socket = socket;
+		client.queueOffset = 0;
+		client.queueSize = 0;
+		m_clientIndex[socket] = m_clients.size();
+		m_clients.push_back(client);
+		if (m_delegate != NULLPTR)
 		{
-			m_delegate->OnClientConnectFailed(this);
+			m_delegate->OnClientConnected(this, socket);
 		}
 	}
+}
 
-	for (size_t i = 0; i < m_clients.size(); i++)
+bool cISTcpServer::ReadClient(socket_t socket)
+{
+	uint8_t readBuff[IS_TCP_SERVER_READ_SIZE];
+	for (;;)
 	{
-        if (ISSocketCanRead(m_clients[i], 1))
+		int count = recv(socket, (char*)readBuff, sizeof(readBuff), 0);
+		if (count > 0)
 		{
-			int count;
-			if ((count = ISSocketRead(m_clients[i], readBuff, sizeof(readBuff))) < 0)
+			if (m_delegate != NULLPTR)
 			{
-				// remove the client
-				if (m_delegate != NULLPTR)
-				{
-					m_delegate->OnClientDisconnected(this, m_clients[i]);
+				m_delegate->OnClientDataReceived(this, socket, readBuff, count);
+				if (FindClient(socket) == NULLPTR)
+				{	// closed by the delegate
+					return true;
 				}
-				ISSocketClose(m_clients[i]);
-				m_clients.erase(m_clients.begin() + i--);
 			}
-			else if (count > 0 && m_delegate != NULLPTR)
+		}
+		else if (count == 0)
+		{	// closed by the client
+			return false;
+		}
+		else if (!SocketInterrupted())
+		{	// read until empty, a close arriving with the last data raises no further event
+			return SocketWouldBlock();
+		}
+	}
+}
+
+bool cISTcpServer::FlushClient(sClient& client)
+{
+	while (!client.queue.empty())
+	{
+		// gather the queued writes into one send
+
+#if PLATFORM_IS_WINDOWS
+
+		WSABUF buffers[IS_TCP_SERVER_MAX_SEND_BUFFERS];
+
+#else
+
+		iovec buffers[IS_TCP_SERVER_MAX_SEND_BUFFERS];
+
+#endif
+
+		size_t bufferCount = 0;
+		size_t size = 0;
+		for (; bufferCount < client.queue.size() && bufferCount < IS_TCP_SERVER_MAX_SEND_BUFFERS; bufferCount++)
+		{
+			const vector<uint8_t>& buffer = *client.queue[bufferCount].buffer;
+			size_t offset = (bufferCount == 0 ? client.queueOffset : 0);
+
+#if PLATFORM_IS_WINDOWS
+
+			buffers[bufferCount].buf = (CHAR*)(buffer.data() + offset);
+			buffers[bufferCount].len = (ULONG)(buffer.size() - offset);
+
+#else
+
+			buffers[bufferCount].iov_base = (void*)(buffer.data() + offset);
+			buffers[bufferCount].iov_len = buffer.size() - offset;
+
+#endif
+
+			size += buffer.size() - offset;
+		}
+
+#if PLATFORM_IS_WINDOWS
+
+		DWORD sentBytes = 0;
+		long sent = (WSASend(client.socket, buffers, (DWORD)bufferCount, &sentBytes, 0, NULLPTR, NULLPTR) == 0 ? (long)sentBytes : -1);
+
+#else
+
+		msghdr msg = msghdr();
+		msg.msg_iov = buffers;
+		msg.msg_iovlen = bufferCount;
+		long sent = (long)sendmsg(client.socket, &msg, IS_TCP_SERVER_SEND_FLAGS);
+
+#endif
+
+		if (sent < 0)
+		{
+			return SocketWouldBlock();
+		}
+
+		client.queueSize -= sent;
+		size_t remaining = sent;
+		while (remaining > 0)
+		{
+			size_t frontSize = client.queue.front().buffer->size() - client.queueOffset;
+			if (remaining < frontSize)
 			{
-				m_delegate->OnClientDataReceived(this, m_clients[i], readBuff, count);
+				client.queueOffset += remaining;
+				break;
 			}
+			remaining -= frontSize;
+			client.queue.pop_front();
+			client.queueOffset = 0;
+		}
+
+		if ((size_t)sent < size)
+		{	// socket is full, the rest is sent on the next writable event
+			return true;
 		}
 	}
+	return true;
+}
+
+bool cISTcpServer::QueueClient(sClient& client, const buffer_t& buffer, size_t offset)
+{
+	size_t size = buffer->size() - offset;
+	if (client.queueSize + size > m_maxQueueSize)
+	{
+		if (m_slowClientPolicy == TCP_SERVER_SLOW_CLIENT_DISCONNECT)
+		{
+			return false;
+		}
+
+		// drop the oldest whole writes, a write that is partly sent must be finished to keep the stream intact
+		size_t first = (client.queueOffset != 0 ? 1 : 0);
+		while (client.queue.size() > first && client.queueSize + size > m_maxQueueSize)
+		{
+			client.queueSize -= client.queue[first].buffer->size();
+			client.queue.erase(client.queue.begin() + first);
+		}
+		if (client.queueSize + size > m_maxQueueSize && offset == 0)
+		{	// the write does not fit on its own, drop it
+			return true;
+		}
+	}
+
+	if (client.queue.empty())
+	{
+		client.queueOffset = offset;
+	}
+	sQueuedWrite write = { buffer, getTickCount() };
+	client.queue.push_back(write);
+	client.queueSize += size;
+	return true;
+}
+
+cISTcpServer::sClient* cISTcpServer::FindClient(socket_t socket)
+{
+	unordered_map<socket_t, size_t>::iterator it = m_clientIndex.find(socket);
+	return (it == m_clientIndex.end() ? NULLPTR : &m_clients[it->second]);
+}
+
+void cISTcpServer::RemoveClient(socket_t socket)
+{
+	unordered_map<socket_t, size_t>::iterator it = m_clientIndex.find(socket);
+	if (it == m_clientIndex.end())
+	{
+		return;
+	}
+	size_t index = it->second;
+	m_clientIndex.erase(it);
+
+	if (m_delegate != NULLPTR)
+	{
+		m_delegate->OnClientDisconnected(this, socket);
+	}
+
+	// closing the socket also removes it from the epoll instance
+	ISSocketClose(m_clients[index].socket);
+
+	// move the last client into the empty slot
+	if (index + 1 != m_clients.size())
+	{
+		m_clients[index] = m_clients.back();
+		m_clientIndex[m_clients[index].socket] = index;
+	}
+	m_clients.pop_back();
+}
+
+bool cISTcpServer::WriteClient(sClient& client, const uint8_t* data, int dataLength, buffer_t& buffer)
+{
+	size_t sent = 0;
+	if (client.queue.empty())
+	{
+		int count = send(client.socket, (const char*)data, dataLength, IS_TCP_SERVER_SEND_FLAGS);
+		if (count < 0 && !SocketWouldBlock())
+		{
+			return false;
+		}
+		sent = (count < 0 ? 0 : count);
+	}
+
+	if (sent < (size_t)dataLength)
+	{
+		if (!buffer)
+		{	// copied once on the first client that can not take it all, then shared by every client queue
+			buffer = make_shared<const vector<uint8_t>>(data, data + dataLength);
+		}
+		return QueueClient(client, buffer, sent);
+	}
+	return true;
 }
 
 int cISTcpServer::Write(const uint8_t* data, int dataLength)
 {
+	buffer_t buffer;
 	for (size_t i = 0; i < m_clients.size(); i++)
 	{
-		int written = 0;
-		int count;
-		while (written < dataLength)
+		if (!WriteClient(m_clients[i], data, dataLength, buffer))
+		{	// the last client moves into this slot
+			RemoveClient(m_clients[i--].socket);
+		}
+	}
+	return dataLength;
+}
+
+int cISTcpServer::Write(const socket_t* sockets, size_t socketCount, const uint8_t* data, int dataLength)
+{
+	buffer_t buffer;
+	for (size_t i = 0; i < socketCount; i++)
+	{
+		sClient* client = FindClient(sockets[i]);
+		if (client != NULLPTR && !WriteClient(*client, data, dataLength, buffer))
 		{
-			count = ISSocketWrite(m_clients[i], data + written, dataLength - written);
-			if (count < 1)
-			{
-				// remove the client
-				if (m_delegate != NULLPTR)
-				{
-					m_delegate->OnClientDisconnected(this, m_clients[i]);
-				}
-				ISSocketClose(m_clients[i]);
-				m_clients.erase(m_clients.begin() + i--);
-				break;
-			}
-			else
-			{
-				written += count;
-				if (written == dataLength)
-				{
-					break;
-				}
-			}
+			RemoveClient(sockets[i]);
 		}
 	}
-	return dataLength; // TODO: Maybe be smarter about detecting difference in bytes written for each client
+	return dataLength;
+}
+
+void cISTcpServer::SetSlowClientPolicy(eTcpServerSlowClientPolicy policy, size_t maxQueueSize, uint32_t maxBehindMs)
+{
+	m_slowClientPolicy = policy;
+	m_maxQueueSize = maxQueueSize;
+	m_maxBehindMs = maxBehindMs;
+}
+
+size_t cISTcpServer::QueuedSize(socket_t socket)
+{
+	sClient* client = FindClient(socket);
+	return (client == NULLPTR ? 0 : client->queueSize);
 }
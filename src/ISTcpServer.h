@@ -16,9 +16,25 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <string>
 #include <inttypes.h>
 #include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
 
 #include "ISTcpClient.h"
 
+#define IS_TCP_SERVER_DEFAULT_MAX_QUEUE_SIZE	(256 * 1024)
+#define IS_TCP_SERVER_DEFAULT_MAX_BEHIND_MS		5000
+
+/** What to do with a client that is not reading data as fast as it is written */
+typedef enum
+{
+	/** Drop the oldest whole writes waiting to go to the client until the new write fits in its queue */
+	TCP_SERVER_SLOW_CLIENT_DROP_OLDEST = 0,
+
+	/** Disconnect the client when its queue overflows or it has been behind for longer than the max behind time */
+	TCP_SERVER_SLOW_CLIENT_DISCONNECT,
+} eTcpServerSlowClientPolicy;
+
 class cISTcpServer;
 
 class iISTcpServerDelegate
@@ -111,17 +127,53 @@ public:
 
 	/**
 	* Update the server, receive connections, etc. Any clients that are disconnected will be closed and removed.
+	* The server and all clients are waited on with a single epoll (Linux) or poll call, so an update takes the same 
+	* time regardless of the number of clients.
+	* @param timeoutMilliseconds the max time to wait when no connection or data is ready
 	*/
-	void Update();
+	void Update(int timeoutMilliseconds = 1);
 
 	/**
-	* Write data to all connected clients - any clients that are disconnected will be closed and removed
+	* Write data to all connected clients without blocking - any clients that are disconnected will be closed and removed.
+	* The data is copied once into a buffer shared by all clients. What a client cannot take right away is queued and 
+	* sent by Update when the client is writable, and slow clients are handled by the slow client policy.
 	* @param data the data to write
 	* @param dataLength the number of bytes in data
-	* @return the number of bytes written
+	* @return the number of bytes written or queued
 	*/
 	int Write(const uint8_t* data, int dataLength);
 
+	/**
+	* Write data to some of the connected clients, the same way as writing to all clients
+	* @param sockets the client sockets to write to, sockets that are not connected clients are skipped
+	* @param socketCount the number of sockets
+	* @param data the data to write
+	* @param dataLength the number of bytes in data
+	* @return the number of bytes written or queued
+	*/
+	int Write(const socket_t* sockets, size_t socketCount, const uint8_t* data, int dataLength);
+
+	/**
+	* Close and remove a client, any data still queued for it is discarded
+	* @param socket the client socket
+	*/
+	void CloseClient(socket_t socket) { RemoveClient(socket); }
+
+	/**
+	* Set how clients that fall behind are handled
+	* @param policy drop the oldest queued writes or disconnect the client
+	* @param maxQueueSize the max bytes queued for one client
+	* @param maxBehindMs for TCP_SERVER_SLOW_CLIENT_DISCONNECT, the max time the oldest write may wait in a client queue, 0 for no limit
+	*/
+	void SetSlowClientPolicy(eTcpServerSlowClientPolicy policy, size_t maxQueueSize = IS_TCP_SERVER_DEFAULT_MAX_QUEUE_SIZE, uint32_t maxBehindMs = IS_TCP_SERVER_DEFAULT_MAX_BEHIND_MS);
+
+	/**
+	* Get the number of bytes waiting to be sent to a client
+	* @param socket the client socket
+	* @return number of bytes queued for the client
+	*/
+	size_t QueuedSize(socket_t socket);
+
 	/**
 	* Get whether the server is open
 	* @return true if server open, false if not
@@ -140,11 +192,46 @@ public:
 	*/
 	int32_t Port() { return m_port; }
 
+	/**
+	* Get the number of connected clients
+	* @return number of connected clients
+	*/
+	size_t ClientCount() { return m_clients.size(); }
+
 private:
 	cISTcpServer(const cISTcpServer& copy); // Disable copy constructor
 
+	typedef std::shared_ptr<const std::vector<uint8_t>> buffer_t;
+
+	struct sQueuedWrite
+	{
+		buffer_t buffer;				// shared with the other clients
+		uint64_t queuedMs;				// tick count when the write was queued
+	};
+
+	struct sClient
+	{
+		socket_t socket;
+		std::deque<sQueuedWrite> queue;	// writes waiting to be sent, oldest first
+		size_t queueOffset;				// bytes of the first write already sent
+		size_t queueSize;				// bytes waiting to be sent
+	};
+
+	void AcceptClients();
+	bool ReadClient(socket_t socket);
+	bool WriteClient(sClient& client, const uint8_t* data, int dataLength, buffer_t& buffer);
+	bool FlushClient(sClient& client);
+	bool QueueClient(sClient& client, const buffer_t& buffer, size_t offset);
+	sClient* FindClient(socket_t socket);
+	void RemoveClient(socket_t socket);
+
 	socket_t m_socket;
-	std::vector<socket_t> m_clients;
+	int m_epoll;					// epoll instance watching the server and client sockets, Linux only
+	std::vector<sClient> m_clients;
+	std::unordered_map<socket_t, size_t> m_clientIndex;	// client socket to index in m_clients
+	eTcpServerSlowClientPolicy m_slowClientPolicy;
+	size_t m_maxQueueSize;
+	uint32_t m_maxBehindMs;
 	std::string m_ipAddress;
 	int32_t m_port;
 	iISTcpServerDelegate* m_delegate;
@@ -45,6 +45,10 @@ static int staticReadPacket(CMHANDLE cmHandle, int pHandle, unsigned char* buf,
 	{
 		return 0;
 	}
+	if (s->ingest->IsOpen())
+	{	// already read and parsed into whole packets by the device reader thread
+		return s->ingest->Read(pHandle, buf, len);
+	}
 	return serialPortReadTimeout(&s->devices[pHandle].serialPort, buf, len, 1);
 }
 
@@ -59,8 +63,13 @@ static void staticProcessRxData(CMHANDLE cmHandle, int pHandle, p_data_t* data)
 		return;
 	}
 
+	// Borrowed view of the receive buffer, valid until we return
+	p_data_view_t view;
+	view.hdr = data->hdr;
+	view.ptr = data->buf;
+
 	pfnHandleBinaryData handler = s->binaryCallback[data->hdr.id];
-	s->stepLogFunction(s->inertialSenseInterface, data, pHandle);
+	s->stepLogFunction(s->inertialSenseInterface, &view, pHandle);
 
 	if ((size_t)pHandle > s->devices.size())
 	{
@@ -79,6 +88,13 @@ static void staticProcessRxData(CMHANDLE cmHandle, int pHandle, p_data_t* data)
 		handlerGlobal(s->inertialSenseInterface, data, pHandle);
 	}
 
+	pfnHandleBinaryDataView handlerView = s->binaryViewCallbackGlobal;
+	if (handlerView != NULLPTR)
+	{
+		// Called for all DID's, no copy
+		handlerView(s->inertialSenseInterface, &view, pHandle);
+	}
+
 	s->inertialSenseInterface->ProcessRxData(data, pHandle);
 
 	switch (data->hdr.id)
@@ -101,6 +117,15 @@ static void staticProcessRxData(CMHANDLE cmHandle, int pHandle, p_data_t* data)
 InertialSense::InertialSense(pfnHandleBinaryData callback) : m_tcpServer(this)
 {
 	m_logThread = NULLPTR;
+	m_logThreadWaiting = false;
+	m_logBackpressure = cISLogger::BACKPRESSURE_DROP_NEWEST;
+	memset(m_logDataIdLowPriority, 0, sizeof(m_logDataIdLowPriority));
+	m_logDataIdLowPriority[DID_DEBUG_STRING] = true;
+	m_logDataIdLowPriority[DID_DEBUG_ARRAY] = true;
+	m_logDataIdLowPriority[DID_RTK_DEBUG] = true;
+	m_logDataIdLowPriority[DID_RTK_DEBUG_2] = true;
+	m_logDataIdLowPriority[DID_EVB_DEBUG_ARRAY] = true;
+	m_logDataIdLowPriority[DID_RTOS_INFO] = true;
 	m_lastLogReInit = time(0);
 	m_clientStream = NULLPTR;
 	m_clientBufferBytesToSend = 0;
@@ -111,11 +136,13 @@ InertialSense::InertialSense(pfnHandleBinaryData callback) : m_tcpServer(this)
 		m_comManagerState.binaryCallback[i] = {};
 	}
 	m_comManagerState.binaryCallbackGlobal = callback;
+	m_comManagerState.binaryViewCallbackGlobal = NULLPTR;
 	m_comManagerState.stepLogFunction = &InertialSense::StepLogger;
 	m_comManagerState.inertialSenseInterface = this;
 	m_comManagerState.clientBuffer = m_clientBuffer;
 	m_comManagerState.clientBufferSize = sizeof(m_clientBuffer);
 	m_comManagerState.clientBytesToSend = &m_clientBufferBytesToSend;
+	m_comManagerState.ingest = &m_ingest;
 	comManagerAssignUserPointer(comManagerGetGlobal(), &m_comManagerState);
 	memset(&m_cmInit, 0, sizeof(m_cmInit));
 	m_cmPorts = NULLPTR;
@@ -126,15 +153,40 @@ InertialSense::~InertialSense()
 {
 	Close();
 	CloseServerConnection();	
+	for (size_t i = 0; i < m_logRings.size(); i++)
+	{
+		delete m_logRings[i];
+	}
 }
 
-bool InertialSense::EnableLogging(const string& path, cISLogger::eLogType logType, float maxDiskSpacePercent, uint32_t maxFileSize, const string& subFolder)
+bool InertialSense::EnableLogging(const string& path, cISLogger::eLogType logType, float maxDiskSpacePercent, uint32_t maxFileSize, const string& subFolder, cISLogger::eBackpressure backpressure, uint32_t maxQueueBytes)
 {
 	cMutexLocker logMutexLocker(&m_logMutex);
+
+	// Each device queue must hold two of the largest records, Push refuses records over half the ring
+	uint32_t deviceQueueBytes = maxQueueBytes / (uint32_t)(m_comManagerState.devices.size() ? m_comManagerState.devices.size() : 1);
+	if (cISLogPacketRing::CapacityFor(deviceQueueBytes) < 2 * cISLogPacketRing::RecordSize(MAX_DATASET_SIZE))
+	{
+		return false;
+	}
+
 	if (!m_logger.InitSaveTimestamp(subFolder, path, cISLogger::g_emptyString, (int)m_comManagerState.devices.size(), logType, maxDiskSpacePercent, maxFileSize, subFolder.length() != 0))
 	{
 		return false;
 	}
+
+	// Fresh queues, the logger thread is not running and receive only pushes while the logger is enabled
+	for (size_t i = 0; i < m_logRings.size(); i++)
+	{
+		delete m_logRings[i];
+	}
+	m_logRings.resize(m_comManagerState.devices.size());
+	for (size_t i = 0; i < m_logRings.size(); i++)
+	{
+		m_logRings[i] = new cISLogPacketRing(deviceQueueBytes);
+	}
+	m_logBackpressure = backpressure;
+
 	m_logger.EnableLogging(true);
 	for (size_t i = 0; i < m_comManagerState.devices.size(); i++)
 	{
@@ -151,6 +203,7 @@ void InertialSense::DisableLogging()
 {
 	// just sets a bool no need to lock
 	m_logger.EnableLogging(false);
+	WakeLoggerThread();
 	threadJoinAndFree(m_logThread);
 	m_logThread = NULLPTR;
 	m_logger.CloseAllFiles();
@@ -196,6 +249,7 @@ void InertialSense::RemoveDevice(size_t index)
 		return;
 	}
 
+	m_ingest.Close();
 	serialPortClose(&m_comManagerState.devices[index].serialPort);
 	m_comManagerState.devices.erase(m_comManagerState.devices.begin() + index);
 }
@@ -205,62 +259,200 @@ void InertialSense::LoggerThread(void* info)
 	bool running = true;
 	InertialSense* inertialSense = (InertialSense*)info;
 
-	// gather up packets in memory
-	map<int, vector<p_data_t>> packets;
-
 	while (running)
 	{
-		SLEEP_MS(20);
 		{
-			// lock so we can read and clear m_logPackets
-			cMutexLocker logMutexLocker(&inertialSense->m_logMutex);
-			for (map<int, vector<p_data_t>>::iterator i = inertialSense->m_logPackets.begin(); i != inertialSense->m_logPackets.end(); i++)
+			// Sleep until StepLogger queues data.  The timeout keeps m_logger.Update() running while idle.
+			std::unique_lock<std::mutex> lock(inertialSense->m_logWakeMutex);
+			inertialSense->m_logThreadWaiting = true;
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!inertialSense->HasLogData() && inertialSense->m_logger.Enabled())
 			{
-				packets[i->first] = i->second;
+				inertialSense->m_logWakeCond.wait_for(lock, std::chrono::milliseconds(20));
 			}
-
-			// clear shared memory
-			inertialSense->m_logPackets.clear();
-
-			// update running state
-			running = inertialSense->m_logger.Enabled();
+			inertialSense->m_logThreadWaiting = false;
 		}
 
+		// update running state
+		running = inertialSense->m_logger.Enabled();
+
 		if (running)
 		{
 			// log the packets
-			for (map<int, vector<p_data_t>>::iterator i = packets.begin(); i != packets.end(); i++)
+			for (size_t i = 0; i < inertialSense->m_logRings.size(); i++)
+			{
+				inertialSense->DrainLogRing((unsigned int)i, inertialSense->m_logRings[i]);
+			}
+		}
+
+		inertialSense->m_logger.Update();
+	}
+
+	printf("\n...Logger thread terminated...\n");
+}
+
+void InertialSense::DrainLogRing(unsigned int device, cISLogPacketRing* ring)
+{
+	// Shed queued data between 3/4 and 1/2 full so the log catches up to live data
+	uint32_t highWater = ring->Capacity() / 4 * 3;
+	uint32_t lowWater = ring->Capacity() / 2;
+	bool shedding = false;
+
+	if (m_logBackpressure == cISLogger::BACKPRESSURE_DROP_OLDEST)
+	{
+		// Receive removes the oldest records itself when the ring is full, even while LogData is stuck on a slow disk, so
+		// each record is copied out before it is logged
+		p_data_hdr_t dataHdr;
+		while (ring->Take(&dataHdr, m_logRecord, sizeof(m_logRecord)))
+		{
+			uint32_t bytes = ring->Bytes();
+			shedding = (shedding ? bytes > lowWater : bytes > highWater);
+			if (shedding || !m_logger.LogData(device, &dataHdr, m_logRecord))
 			{
-				for (size_t j = 0; j < i->second.size(); j++)
+				ring->Drop(&dataHdr);
+			}
+		}
+	}
+	else
+	{
+		const p_data_hdr_t* hdr;
+		const uint8_t* buf;
+		while ((hdr = ring->Front(&buf)) != NULLPTR)
+		{
+			if (m_logBackpressure == cISLogger::BACKPRESSURE_PRIORITY)
+			{
+				uint32_t bytes = ring->Bytes();
+				shedding = (shedding ? bytes > lowWater : bytes > highWater);
+				if (shedding && hdr->id < DID_COUNT && m_logDataIdLowPriority[hdr->id])
 				{
-					if (!inertialSense->m_logger.LogData(i->first, &i->second[j].hdr, i->second[j].buf))
-					{
-						// Failed to write to log
-						SLEEP_MS(20);
-					}
+					ring->Discard();
+					continue;
 				}
+			}
 
-				// clear all log data for this pHandle
-				i->second.clear();
+			p_data_hdr_t dataHdr = *hdr;
+			if (m_logger.LogData(device, &dataHdr, buf))
+			{
+				ring->Pop();
+			}
+			else if (m_logBackpressure == cISLogger::BACKPRESSURE_BLOCK)
+			{
+				// Failed to write to log, keep the record and try again on the next pass
+				SLEEP_MS(20);
+				break;
+			}
+			else
+			{
+				// Failed to write to log
+				ring->Discard();
 			}
 		}
+	}
 
-		inertialSense->m_logger.Update();
+	// Move drop counters from the receive thread into the log stats
+	if (ring->DropsPending())
+	{
+		for (uint32_t id = 0; id < DID_COUNT; id++)
+		{
+			uint32_t dropped = ring->TakeDataIdDrops(id);
+			if (dropped)
+			{
+				m_logger.LogDataDropped(id, dropped);
+			}
+		}
 	}
+}
 
-	printf("\n...Logger thread terminated...\n");
+bool InertialSense::HasLogData()
+{
+	for (size_t i = 0; i < m_logRings.size(); i++)
+	{
+		if (!m_logRings[i]->Empty())
+		{
+			return true;
+		}
+	}
+	return false;
 }
 
-void InertialSense::StepLogger(InertialSense* i, const p_data_t* data, int pHandle)
+void InertialSense::WakeLoggerThread()
 {
-	cMutexLocker logMutexLocker(&i->m_logMutex);
-	if (i->m_logger.Enabled())
+	std::lock_guard<std::mutex> lock(m_logWakeMutex);
+	m_logWakeCond.notify_one();
+}
+
+void InertialSense::StepLogger(InertialSense* i, const p_data_view_t* view, int pHandle)
+{
+	if (i->m_logger.Enabled() && (size_t)pHandle < i->m_logRings.size())
 	{
-		vector<p_data_t>& vec = i->m_logPackets[pHandle];
-		vec.push_back(*data);
+		// Lock-free, only hdr.size bytes are copied
+		cISLogPacketRing* ring = i->m_logRings[pHandle];
+		if (i->m_logBackpressure == cISLogger::BACKPRESSURE_PRIORITY && view->hdr.id < DID_COUNT && i->m_logDataIdLowPriority[view->hdr.id] &&
+			ring->Bytes() + cISLogPacketRing::RecordSize(view->hdr.size) > ring->Capacity() / 4 * 3)
+		{
+			// Keep the remaining space for high priority data
+			ring->Drop(&view->hdr);
+		}
+		else if (i->m_logBackpressure == cISLogger::BACKPRESSURE_DROP_OLDEST)
+		{
+			// Make room by removing the oldest queued records
+			if (!ring->PushDropOldest(&view->hdr, view->ptr))
+			{
+				ring->Drop(&view->hdr);
+			}
+		}
+		else if (i->m_logBackpressure == cISLogger::BACKPRESSURE_BLOCK)
+		{
+			// Wait for the logger to make room, bounded so acks, commands and callbacks keep going when the log cannot 
+			// be written (i.e. disk full or card removed)
+			if (!ring->PushWait(&view->hdr, view->ptr, cISLogger::BACKPRESSURE_BLOCK_MAX_MS, [i]()
+				{
+					if (!i->m_logger.Enabled())
+					{
+						return false;
+					}
+					i->WakeLoggerThread();
+					SLEEP_MS(1);
+					return true;
+				}))
+			{
+				ring->Drop(&view->hdr);
+			}
+		}
+		else if (!ring->Push(&view->hdr, view->ptr))
+		{
+			ring->Drop(&view->hdr);
+		}
+
+		// Order the push before checking for a sleeping logger so a wakeup cannot be missed
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (i->m_logThreadWaiting)
+		{
+			i->WakeLoggerThread();
+		}
 	}
 }
 
+bool InertialSense::GetDeviceIngestStats(int pHandle, cISDeviceIngest::device_stats_t& stats)
+{
+	if (!m_ingest.IsOpen() || (size_t)pHandle >= m_ingest.DeviceCount())
+	{
+		return false;
+	}
+	stats = m_ingest.Stats(pHandle);
+	return true;
+}
+
+bool InertialSense::GetLoggerQueueStats(int pHandle, cISLogPacketRing::stats_t& stats)
+{
+	if ((size_t)pHandle >= m_logRings.size())
+	{
+		return false;
+	}
+	stats = m_logRings[pHandle]->Stats();
+	return true;
+}
+
 bool InertialSense::SetLoggerEnabled(
     bool enable, 
     const string& path, 
@@ -269,7 +461,9 @@ bool InertialSense::SetLoggerEnabled(
     uint32_t rmcOptions,
     float maxDiskSpacePercent, 
     uint32_t maxFileSize, 
-    const string& subFolder)
+    const string& subFolder,
+    cISLogger::eBackpressure backpressure,
+    uint32_t maxQueueBytes)
 {
 	if (enable)
 	{
@@ -283,7 +477,7 @@ bool InertialSense::SetLoggerEnabled(
 		{ 
 			BroadcastBinaryDataRmcPreset(rmcPreset, rmcOptions);
 		}
-		return EnableLogging(path, logType, maxDiskSpacePercent, maxFileSize, subFolder);
+		return EnableLogging(path, logType, maxDiskSpacePercent, maxFileSize, subFolder, backpressure, maxQueueBytes);
 	}
 
 	// !enable, shutdown logger gracefully
@@ -343,6 +537,9 @@ bool InertialSense::CreateHost(const string& connectionString)
 
 	StopBroadcasts();
 
+	// UpdateServer reads the serial port directly
+	m_ingest.Close();
+
 	return (m_tcpServer.Open(host, atoi(port.c_str())) == 0);
 }
 
@@ -364,7 +561,11 @@ bool InertialSense::Update()
 		// [C COMM INSTRUCTION]  2.) Update Com Manager at regular interval to send and receive data.  
 		// Normally called within a while loop.  Include a thread "sleep" if running on a multi-thread/
 		// task system with serial port read function that does NOT incorporate a timeout.   
-		if (m_comManagerState.devices.size() != 0)
+		if (m_ingest.IsOpen())
+		{
+			StepDeviceIngest();
+		}
+		else if (m_comManagerState.devices.size() != 0)
 		{
 			comManagerStep();
 		}
@@ -593,6 +794,7 @@ void InertialSense::Close()
 		StopBroadcasts();
 		SLEEP_MS(100);
 	}
+	m_ingest.Close();
 	for (size_t i = 0; i < m_comManagerState.devices.size(); i++)
 	{
 		serialPortClose(&m_comManagerState.devices[i].serialPort);
@@ -1023,6 +1225,10 @@ bool InertialSense::OpenSerialPorts(const char* port, int baudRate)
 		}
 		else
 		{
+			if (m_serialReadThreads)
+			{	// falls back to polling the port where not supported
+				serialPortStartReadThread(&serial, m_serialReadThreadVmin, m_serialReadThreadVtime, m_serialReadThreadLowLatency);
+			}
 			is_device_t device = {};
 			device.serialPort = serial;
 			m_comManagerState.devices.push_back(device);
@@ -1101,11 +1307,38 @@ bool InertialSense::OpenSerialPorts(const char* port, int baudRate)
 		}
 	}
 
+	if (m_deviceIngest && m_comManagerState.devices.size() != 0)
+	{
+		vector<serial_port_t*> serialPorts;
+		for (size_t i = 0; i < m_comManagerState.devices.size(); i++)
+		{
+			serialPorts.push_back(&m_comManagerState.devices[i].serialPort);
+		}
+		m_ingest.Open(serialPorts);
+	}
+
     return m_comManagerState.devices.size() != 0;
 }
 
+void InertialSense::StepDeviceIngest()
+{
+	// wait up to 1 ms like the port reads of comManagerStep, but only until a packet is ready, then handle packets
+	// from all devices in the order Next picks
+	CMHANDLE cm = comManagerGetGlobal();
+	if (m_ingest.Wait(1))
+	{
+		int device;
+		while ((device = m_ingest.Next()) >= 0)
+		{
+			comManagerStepRxPortInstance(cm, device);
+		}
+	}
+	comManagerStepTxInstance(cm);
+}
+
 void InertialSense::CloseSerialPorts()
 {
+	m_ingest.Close();
 	for (size_t i = 0; i < m_comManagerState.devices.size(); i++)
 	{
 		serialPortClose(&m_comManagerState.devices[i].serialPort);
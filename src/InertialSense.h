@@ -21,11 +21,16 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 #include "ISConstants.h" 
 #include "ISTcpClient.h"
 #include "ISTcpServer.h"
 #include "ISLogger.h"
+#include "ISLogPacketRing.h"
+#include "ISDeviceIngest.h"
 #include "ISDisplay.h"
 #include "ISUtilities.h"
 #include "ISSerialPort.h"
@@ -49,7 +54,8 @@ extern "C"
 class InertialSense;
 
 typedef std::function<void(InertialSense* i, p_data_t* data, int pHandle)> pfnHandleBinaryData;
-typedef void(*pfnStepLogFunction)(InertialSense* i, const p_data_t* data, int pHandle);
+typedef std::function<void(InertialSense* i, const p_data_view_t* view, int pHandle)> pfnHandleBinaryDataView;
+typedef void(*pfnStepLogFunction)(InertialSense* i, const p_data_view_t* view, int pHandle);
 
 
 /**
@@ -78,11 +84,13 @@ public:
 		pfnHandleBinaryData binaryCallbackGlobal;
 #define SIZE_BINARY_CALLBACK	256
 		pfnHandleBinaryData binaryCallback[SIZE_BINARY_CALLBACK];
+		pfnHandleBinaryDataView binaryViewCallbackGlobal;
 		pfnStepLogFunction stepLogFunction;
 		InertialSense* inertialSenseInterface;
 		char* clientBuffer;
 		int clientBufferSize;
 		int* clientBytesToSend;
+		cISDeviceIngest* ingest;
 	};
 
 	typedef struct
@@ -111,6 +119,13 @@ public:
 		pfnComManagerGenMsgHandler handlerUblox=NULLPTR, 
 		pfnComManagerGenMsgHandler handlerRtcm3=NULLPTR);
 
+	/**
+	* Set a zero-copy binary data callback, called for all received data.  The view points into the receive buffer and is only valid 
+	* until the callback returns, copy out (i.e. comManagerRetainData) anything that must be kept.
+	* @param callback view callback, NULL to disable
+	*/
+	void SetBinaryDataViewCallback(pfnHandleBinaryDataView callback) { m_comManagerState.binaryViewCallbackGlobal = callback; }
+
 	/**
 	* Closes any open connection and then opens the device
 	* @param port the port to open
@@ -157,6 +172,8 @@ public:
 	* @param maxFileSize the max file size for each log file in bytes
 	* @param chunkSize the max data to keep in RAM before flushing to disk in bytes
 	* @param subFolder timestamp sub folder or empty for none
+	* @param backpressure what to do with received data when the logger falls behind and its queue fills
+	* @param maxQueueBytes hard cap on memory used to queue data for the logger, split evenly between devices.  Fails if a device gets less than 4 KB.
 	* @return true if success, false if failure
 	*/
 	bool SetLoggerEnabled(
@@ -167,7 +184,9 @@ public:
         uint32_t rmcOptions = RMC_OPTIONS_PRESERVE_CTRL,
         float maxDiskSpacePercent = 0.5f, 
         uint32_t maxFileSize = 1024 * 1024 * 5, 
-        const std::string& subFolder = cISLogger::g_emptyString);
+        const std::string& subFolder = cISLogger::g_emptyString,
+        cISLogger::eBackpressure backpressure = cISLogger::BACKPRESSURE_DROP_NEWEST,
+        uint32_t maxQueueBytes = 1024 * 1024 * 16);
 
 	/**
 	* Gets whether logging is enabled
@@ -175,6 +194,29 @@ public:
 	*/
 	bool LoggerEnabled() { return m_logger.Enabled(); }
 
+	/**
+	* Get queue depth and drop counters for data waiting to be written by the logger thread
+	* @param pHandle the device to get counters for
+	* @param stats receives the counters
+	* @return true if success, false if logging has not been enabled for the device
+	*/
+	bool GetLoggerQueueStats(int pHandle, cISLogPacketRing::stats_t& stats);
+
+	/**
+	* Get packet and drop counters of a device reader thread
+	* @param pHandle the device to get counters for
+	* @param stats receives the counters
+	* @return true if success, false if device ingest is not running
+	*/
+	bool GetDeviceIngestStats(int pHandle, cISDeviceIngest::device_stats_t& stats);
+
+	/**
+	* Set whether a data id is dropped first under the BACKPRESSURE_PRIORITY logger policy.  Debug data ids are low priority by default.
+	* @param dataId the data id
+	* @param lowPriority true to drop this data id first when the logger queue is filling up
+	*/
+	void SetLoggerDataIdLowPriority(uint32_t dataId, bool lowPriority) { if (dataId < DID_COUNT) { m_logDataIdLowPriority[dataId] = lowPriority; } }
+
 	/**
 	* Connect to a server and send the data from that server to the uINS. Open must be called first to connect to the uINS unit.
 	* @param connectionString the server to connect, this is the data type (RTCM3,IS,UBLOX) followed by a colon followed by connection info (ip:port or serial:baud). This can also be followed by an optional url, user and password, i.e. RTCM3:192.168.1.100:7777:RTCM3_Mount:user:password
@@ -360,12 +402,69 @@ public:
 	*/
 	void SetTimeoutFlushLoggerSeconds(time_t timeoutFlushLoggerSeconds) { m_logger.SetTimeoutFlushSeconds(timeoutFlushLoggerSeconds); }
 
+	/**
+	* Write log files from a background I/O thread so file writes and rollover never stall the logger.  Set before SetLoggerEnabled.
+	* @param enable true to write behind
+	* @param syncPeriodMs period to fdatasync written data, 0 to leave it to the OS
+	*/
+	void SetLoggerAsyncFileWrite(bool enable, uint32_t syncPeriodMs = 1000) { m_logger.SetAsyncFileWrite(enable, syncPeriodMs); }
+
+	/**
+	* Write a .idx time index next to .dat logs so they can be read from any time with cISLogger::SeekToTime.  Set before SetLoggerEnabled.
+	* @param enable true to write the time index
+	* @param periodMs minimum time between index entries
+	*/
+	void SetLoggerTimeIndex(bool enable, uint32_t periodMs = 1000) { m_logger.SetTimeIndex(enable, periodMs); }
+
+	/**
+	* Compress .dat / .sdat log chunks.  Set before SetLoggerEnabled.
+	* @param level CHUNK_COMPRESSION_NONE, CHUNK_COMPRESSION_FAST or CHUNK_COMPRESSION_DENSE
+	* @param deltaFilter store each data set as the difference from the previous one of the same DID before compressing
+	*/
+	void SetLoggerCompression(int level, bool deltaFilter = true) { m_logger.SetCompression(level, deltaFilter); }
+
+	/**
+	* Decimate KML tracks and write .kmz instead of .kml.  Set before SetLoggerEnabled.
+	* @param decimationToleranceM Douglas-Peucker tolerance in meters for track coordinates, 0 to write every sample
+	* @param kmz true to write zip compressed .kmz files
+	*/
+	void SetLoggerKmlOutput(double decimationToleranceM, bool kmz = false) { m_logger.SetKmlOutput(decimationToleranceM, kmz); }
+
 	/**
 	* Enable the device validate used to verify device response when Open() is called.
 	* @param enable device validation
 	*/
 	void EnableDeviceValidation(bool enable) { m_enableDeviceValidation = enable; }
 
+	/**
+	* Read each serial port from its own thread blocking on the tty, so received data is handed over as soon as it arrives
+	* instead of when the port is next polled.  Set before Open.  Not supported on Windows, where ports are polled as before.
+	* @param enable true to read serial ports from a reader thread
+	* @param vmin minimum bytes per tty read (0-255)
+	* @param vtimeDeciseconds tty inter-byte timeout once a read has started, in tenths of a second (0-255)
+	* @param lowLatency set the tty low latency flag so USB serial adapters do not hold received data
+	*/
+	void EnableSerialReadThreads(bool enable, int vmin = 1, int vtimeDeciseconds = 0, bool lowLatency = true)
+	{
+		m_serialReadThreads = enable;
+		m_serialReadThreadVmin = vmin;
+		m_serialReadThreadVtime = vtimeDeciseconds;
+		m_serialReadThreadLowLatency = lowLatency;
+	}
+
+	/**
+	* Read and parse each device on its own thread, and have Update handle received packets from all devices in GPS
+	* time order instead of reading the ports one after another.  Set before Open.  Callbacks are still called from
+	* Update.  Not used with CreateHost.
+	* @param enable true to read devices from cISDeviceIngest threads
+	* @param reorderWindowMs max milliseconds a packet is held waiting for an earlier packet from another device
+	*/
+	void EnableDeviceIngest(bool enable, uint32_t reorderWindowMs = IS_DEVICE_INGEST_DEFAULT_REORDER_MS)
+	{
+		m_deviceIngest = enable;
+		m_ingest.SetReorderWindow(reorderWindowMs);
+	}
+
 	/**
 	* Bootload a file - if the bootloader fails, the device stays in bootloader mode and you must call BootloadFile again until it succeeds. If the bootloader gets stuck or has any issues, power cycle the device.
 	* Please ensure that all other connections to the com port are closed before calling this function.
@@ -425,7 +524,13 @@ private:
 	cISLogger m_logger;
 	void* m_logThread;
 	cMutex m_logMutex;
-	std::map<int, std::vector<p_data_t>> m_logPackets;
+	std::vector<cISLogPacketRing*> m_logRings;	// per pHandle, receive thread to logger thread
+	std::mutex m_logWakeMutex;
+	std::condition_variable m_logWakeCond;
+	std::atomic<bool> m_logThreadWaiting;
+	cISLogger::eBackpressure m_logBackpressure;
+	bool m_logDataIdLowPriority[DID_COUNT];
+	uint8_t m_logRecord[MAX_DATASET_SIZE];	// logger thread, record copied out of a ring under BACKPRESSURE_DROP_OLDEST
 	time_t m_lastLogReInit;
 
 	char m_clientBuffer[512];
@@ -441,6 +546,12 @@ private:
 	mul_msg_stats_t m_clientMessageStats = {};
 
 	bool m_enableDeviceValidation = true;
+	bool m_serialReadThreads = false;
+	int m_serialReadThreadVmin = 1;
+	int m_serialReadThreadVtime = 0;
+	bool m_serialReadThreadLowLatency = true;
+	bool m_deviceIngest = false;
+	cISDeviceIngest m_ingest;
 	bool m_disableBroadcastsOnClose;
 	com_manager_init_t m_cmInit;
 	com_manager_port_t *m_cmPorts;
@@ -451,15 +562,19 @@ private:
 	// returns false if logger failed to open
 	bool UpdateServer();
 	bool UpdateClient();
-	bool EnableLogging(const std::string& path, cISLogger::eLogType logType, float maxDiskSpacePercent, uint32_t maxFileSize, const std::string& subFolder);
+	bool EnableLogging(const std::string& path, cISLogger::eLogType logType, float maxDiskSpacePercent, uint32_t maxFileSize, const std::string& subFolder, cISLogger::eBackpressure backpressure, uint32_t maxQueueBytes);
 	void DisableLogging();
 	bool HasReceivedResponseFromDevice(size_t index);
 	bool HasReceivedResponseFromAllDevices();
 	void RemoveDevice(size_t index);
 	bool OpenSerialPorts(const char* port, int baudRate);
 	void CloseSerialPorts();
+	void StepDeviceIngest();
 	static void LoggerThread(void* info);
-	static void StepLogger(InertialSense* i, const p_data_t* data, int pHandle);
+	bool HasLogData();
+	void DrainLogRing(unsigned int device, cISLogPacketRing* ring);
+	void WakeLoggerThread();
+	static void StepLogger(InertialSense* i, const p_data_view_t* view, int pHandle);
 	static void BootloadStatusUpdate(void* obj, const char* str);
 	void UpdateFlashConfigSyncState(uint32_t rxChecksum, int pHandle);
 };
@@ -136,12 +136,16 @@ bool cltool_parseCommandLine(int argc, char* argv[])
 	g_commandLineOptions.logSubFolder = cISLogger::CreateCurrentTimestamp();
 	g_commandLineOptions.maxLogFileSize = CL_DEFAULT_MAX_LOG_FILE_SIZE;
 	g_commandLineOptions.maxLogSpacePercent = CL_DEFAULT_MAX_LOG_SPACE_PERCENT;
+	g_commandLineOptions.convertThreads = 0;
+	g_commandLineOptions.logStats = false;
 	g_commandLineOptions.replaySpeed = CL_DEFAULT_REPLAY_SPEED;
 	g_commandLineOptions.bootloaderVerify = CL_DEFAULT_BOOTLOAD_VERIFY;
 	g_commandLineOptions.timeoutFlushLoggerSeconds = 3;
 	g_commandLineOptions.asciiMessages = "";
 	g_commandLineOptions.updateBootloaderFilename = "";
 	g_commandLineOptions.forceBootloaderUpdate = false;
+	g_commandLineOptions.lowLatency = false;
+	g_commandLineOptions.deviceIngest = false;
 
     g_commandLineOptions.surveyIn.state = 0;
     g_commandLineOptions.surveyIn.maxDurationSec = 15 * 60; // default survey of 15 minutes
@@ -268,6 +272,20 @@ bool cltool_parseCommandLine(int argc, char* argv[])
 			cltool_outputUsage();
 			return false;
 		}
+		else if (startsWith(a, "-ingest"))
+		{
+			g_commandLineOptions.deviceIngest = true;
+		}
+		else if (startsWith(a, "-lc="))
+		{
+			g_commandLineOptions.replayDataLog = true;
+			g_commandLineOptions.convertLogType = &a[4];
+		}
+		else if (startsWith(a, "-lstats"))
+		{
+			g_commandLineOptions.replayDataLog = true;
+			g_commandLineOptions.logStats = true;
+		}
 		else if (startsWith(a, "-lms="))
 		{
 			g_commandLineOptions.maxLogSpacePercent = (float)atof(&a[5]);
@@ -308,12 +326,20 @@ bool cltool_parseCommandLine(int argc, char* argv[])
 		{
 			g_commandLineOptions.enableLogging = true;
 		}
+		else if (startsWith(a, "-lowLatency"))
+		{
+			g_commandLineOptions.lowLatency = true;
+		}
 		else if (startsWith(a, "-magRecal"))
 		{
 			g_commandLineOptions.rmcPreset = 0;
 			g_commandLineOptions.magRecal = true;
 			g_commandLineOptions.magRecalMode = strtol(a + 9, NULL, 10);
 		}
+		else if (startsWith(a, "-mount="))
+		{
+			g_commandLineOptions.mountpoints.push_back(&a[7]);
+		}
 		else if (startsWith(a, "-presetPPD"))
 		{
 			g_commandLineOptions.rmcPreset = RMC_PRESET_PPD_GROUND_VEHICLE;
@@ -383,6 +409,10 @@ bool cltool_parseCommandLine(int argc, char* argv[])
 		{
 			g_commandLineOptions.displayMode = cInertialSenseDisplay::DMODE_SCROLL;
 		}
+		else if (startsWith(a, "-threads="))
+		{
+			g_commandLineOptions.convertThreads = (uint32_t)strtoul(&a[9], NULL, 10);
+		}
 		else if (startsWith(a, "-ub") && (i + 1) < argc)
 		{
 			g_commandLineOptions.updateBootloaderFilename = argv[++i];	// use next argument
@@ -455,6 +485,55 @@ bool cltool_replayDataLog()
 	return true;
 }
 
+bool cltool_convertDataLog()
+{
+	cISLogger logger;
+	if (!logger.LoadFromDirectory(g_commandLineOptions.logPath, cISLogger::ParseLogType(g_commandLineOptions.logType), { "ALL" }))
+	{
+		cout << "Failed to load log files: " << g_commandLineOptions.logPath << endl;
+		return false;
+	}
+
+	// Written to a sub folder of the log named after the new type
+	string outputDir = g_commandLineOptions.logPath + "/" + g_commandLineOptions.convertLogType;
+	cout << "Converting log files: " << g_commandLineOptions.logPath << " to " << outputDir << endl;
+	cISLogger copy;
+	copy.SetCopyThreads(g_commandLineOptions.convertThreads);
+	if (!copy.CopyLog(logger, logger.TimeStamp(), outputDir, cISLogger::ParseLogType(g_commandLineOptions.convertLogType),
+		g_commandLineOptions.maxLogSpacePercent, g_commandLineOptions.maxLogFileSize, false))
+	{
+		cout << "Failed to convert log files: " << g_commandLineOptions.logPath << endl;
+		return false;
+	}
+
+	cout << "Done converting log files: " << outputDir << endl;
+	return true;
+}
+
+bool cltool_logStats()
+{
+	cISLogger logger;
+	if (!logger.LoadFromDirectory(g_commandLineOptions.logPath, cISLogger::ParseLogType(g_commandLineOptions.logType), { "ALL" }))
+	{
+		cout << "Failed to load log files: " << g_commandLineOptions.logPath << endl;
+		return false;
+	}
+
+	// Stats are gathered as the data is read
+	cout << "Reading log files: " << g_commandLineOptions.logPath << endl;
+	unsigned int device = 0;
+	while (logger.ReadNextData(device) != NULL) {}
+	string fileName = g_commandLineOptions.logPath + "/stats.json";
+	if (!logger.WriteStatsJson(fileName))
+	{
+		cout << "Failed to write: " << fileName << endl;
+		return false;
+	}
+
+	cout << "Done writing log stats: " << fileName << endl;
+	return true;
+}
+
 void cltool_outputUsage()
 {
 	cout << boldOff;
@@ -473,6 +552,8 @@ void cltool_outputUsage()
 	cout << "    " << APP_NAME << APP_EXT << " -c "  <<     EXAMPLE_PORT << " -baud=115200 -did 5 13=10 " << boldOff << " # stream at 115200 bps, GPS streamed at 10x startupGPSDtMs" << endlbOn;
 	cout << "    " << APP_NAME << APP_EXT << " -c "  <<     EXAMPLE_PORT << " -rover=RTCM3:192.168.1.100:7777:mount:user:password" << boldOff << " # Connect to RTK NTRIP base" << endlbOn;
 	cout << "    " << APP_NAME << APP_EXT << " -rp " <<     EXAMPLE_LOG_DIR                                              << boldOff << " # replay log files from a folder" << endlbOn;
+	cout << "    " << APP_NAME << APP_EXT << " -rp " <<     EXAMPLE_LOG_DIR << " -lc=csv"                                << boldOff << endlbOn;
+	cout << "                                                   " << boldOff << " # convert .dat log files to csv, written to the csv sub folder" << endlbOn;
 	cout << "    " << APP_NAME << APP_EXT << " -c "  <<     EXAMPLE_PORT << " -uf " << EXAMPLE_FIRMWARE_FILE << " -ub " << EXAMPLE_BOOTLOADER_FILE << " -uv" << boldOff << endlbOn;
 	cout << "                                                   " << boldOff << " # update application firmware and bootloader" << endlbOn;
 	cout << "    " << APP_NAME << APP_EXT << " -c * -baud=921600              "                    << EXAMPLE_SPACE_2 << boldOff << " # 921600 bps baudrate on all serial ports" << endlbOn;
@@ -482,6 +563,8 @@ void cltool_outputUsage()
 	cout << "    -c " << boldOff << "COM_PORT     Select the serial port. Set COM_PORT to \"*\" for all ports and \"*4\" to use" << endlbOn;
 	cout << "       " << boldOff << "             only the first four ports. " <<  endlbOn;
 	cout << "    -baud=" << boldOff << "BAUDRATE  Set serial port baudrate.  Options: " << IS_BAUDRATE_115200 << ", " << IS_BAUDRATE_230400 << ", " << IS_BAUDRATE_460800 << ", " << IS_BAUDRATE_921600 << " (default)" << endlbOn;
+	cout << "    -ingest" << boldOff << "         Read each device on its own thread and handle data from all devices in GPS time order" << endlbOn;
+	cout << "    -lowLatency" << boldOff << "     Read serial ports from a reader thread as data arrives (Linux and macOS)" << endlbOn;
 	cout << "    -magRecal[n]" << boldOff << "    Recalibrate magnetometers: 0=multi-axis, 1=single-axis" << endlbOn;
     cout << "    -q" << boldOff << "              Quiet mode, no display" << endlbOn;
     cout << "    -reset         " << boldOff << " Issue software reset." << endlbOn;
@@ -513,7 +596,7 @@ void cltool_outputUsage()
     cout << endlbOn;
 	cout << "OPTIONS (Logging to file, disabled by default)" << endl;
 	cout << "    -lon" << boldOff << "            Enable logging" << endlbOn;
-	cout << "    -lt=" << boldOff << "TYPE        Log type: dat (default), sdat, kml or csv" << endlbOn;
+	cout << "    -lt=" << boldOff << "TYPE        Log type: dat (default), sdat, kml, csv or icol (columnar)" << endlbOn;
 	cout << "    -lp " << boldOff << "PATH        Log data to path (default: ./" << CL_DEFAULT_LOGS_DIRECTORY << ")" << endlbOn;
 	cout << "    -lms=" << boldOff << "PERCENT    Log max space in percent of free space (default: " << CL_DEFAULT_MAX_LOG_SPACE_PERCENT << ")" << endlbOn;
 	cout << "    -lmf=" << boldOff << "BYTES      Log max file size in bytes (default: " << CL_DEFAULT_MAX_LOG_FILE_SIZE << ")" << endlbOn;
@@ -521,6 +604,9 @@ void cltool_outputUsage()
 	cout << "    -r" << boldOff << "              Replay data log from default path" << endlbOn;
 	cout << "    -rp " << boldOff << "PATH        Replay data log from PATH" << endlbOn;
 	cout << "    -rs=" << boldOff << "SPEED       Replay data log at x SPEED. SPEED=0 runs as fast as possible." << endlbOn;
+	cout << "    -lc=" << boldOff << "TYPE        Convert the replay log (read as -lt TYPE) to TYPE, written to a TYPE sub folder of the log" << endlbOn;
+	cout << "    -threads=" << boldOff << "N      Threads used by -lc, 0 for one per CPU core (default)" << endlbOn;
+	cout << "    -lstats" << boldOff << "         Read the replay log in one pass and write per data set timing stats to stats.json in the log folder" << endlbOn;
 	cout << endlbOn;
 	cout << "OPTIONS (Read or write flash configuration from command line)" << endl;
 	cout << "    -flashCfg" << boldOff << "       List all IMX \"keys\" and \"values\"" << endlbOn;
@@ -543,6 +629,10 @@ void cltool_outputUsage()
 	cout << "            -base=TCP::7777                            (IP is optional)" << endl;
 	cout << "            -base=TCP:192.168.1.43:7777" << endl;
 	cout << "            -base=SERIAL:" << EXAMPLE_PORT << ":921600" << endl;
+	cout << "            -base=NTRIP::2101                          (NTRIP caster, one thread per mountpoint device)" << endl;
+	cout << "    -mount=" << boldOff << "[name]:[port]:[baud]   Add an NTRIP caster mountpoint fed by the RTCM3 / UBX output of a" << endl;
+	cout << "            device, repeat for more mountpoints.  Without -mount, mountpoint BASE is fed by -c." << endl;
+	cout << "            -mount=BASE1:" << EXAMPLE_PORT << ":921600" << endl;
 
 	cout << boldOff;   // Last line.  Leave bold text off on exit.
 }
@@ -582,17 +672,17 @@ bool cltool_updateFlashCfg(InertialSense& inertialSenseInterface, string flashCf
 			splitString(keyValues[i], '=', keyAndValue);
 			if (keyAndValue.size() == 2)
 			{
-				if (flashMap.find(keyAndValue[0]) == flashMap.end())
+				const data_info_t* info = cISDataMappings::GetFieldInfo(DID_FLASH_CONFIG, keyAndValue[0]);
+				if (info == NULLPTR)
 				{
 					cout << "Unrecognized flash config key '" << keyAndValue[0] << "' specified, ignoring." << endl;
 				}
 				else
 				{
-					const data_info_t& info = flashMap.at(keyAndValue[0]);
 					int radix = (keyAndValue[1].compare(0, 2, "0x") == 0 ? 16 : 10);
 					int substrIndex = 2 * (radix == 16); // skip 0x for hex
 					const string& str = keyAndValue[1].substr(substrIndex);
-					cISDataMappings::StringToData(str.c_str(), (int)str.length(), NULL, (uint8_t*)&flashCfg, info, radix);
+					cISDataMappings::StringToData(str.c_str(), (int)str.length(), NULL, (uint8_t*)&flashCfg, *info, radix);
 					cout << "Updated flash config key '" << keyAndValue[0] << "' to '" << keyAndValue[1].c_str() << "'" << endl;
 				}
 			}
@@ -633,17 +723,17 @@ bool cltool_updateEvbFlashCfg(InertialSense& inertialSenseInterface, string flas
 			splitString(keyValues[i], '=', keyAndValue);
 			if (keyAndValue.size() == 2)
 			{
-				if (flashMap.find(keyAndValue[0]) == flashMap.end())
+				const data_info_t* info = cISDataMappings::GetFieldInfo(DID_EVB_FLASH_CFG, keyAndValue[0]);
+				if (info == NULLPTR)
 				{
 					cout << "Unrecognized EVB flash config key '" << keyAndValue[0] << "' specified, ignoring." << endl;
 				}
 				else
 				{
-					const data_info_t& info = flashMap.at(keyAndValue[0]);
 					int radix = (keyAndValue[1].compare(0, 2, "0x") == 0 ? 16 : 10);
 					int substrIndex = 2 * (radix == 16); // skip 0x for hex
 					const string& str = keyAndValue[1].substr(substrIndex);
-					cISDataMappings::StringToData(str.c_str(), (int)str.length(), NULL, (uint8_t*)&evbFlashCfg, info, radix);
+					cISDataMappings::StringToData(str.c_str(), (int)str.length(), NULL, (uint8_t*)&evbFlashCfg, *info, radix);
 					cout << "Updated EVB flash config key '" << keyAndValue[0] << "' to '" << keyAndValue[1].c_str() << "'" << endl;
 				}
 			}
@@ -78,11 +78,17 @@ typedef struct
 	float maxLogSpacePercent; 				// -lms=max_space_mb
 	uint32_t maxLogFileSize; 				// -lmf=max_file_size
 	std::string logSubFolder; 				// -lts=1
+	std::string convertLogType;				// -lc=csv
+	uint32_t convertThreads;				// -threads=0
+	bool logStats;							// -lstats
 	int baudRate; 							// -baud=3000000
 	bool disableBroadcastsOnClose;	
+	bool lowLatency;						// -lowLatency
+	bool deviceIngest;						// -ingest
 	
 	std::string roverConnection; 			// -rover=type:IP/URL:port:mountpoint:user:password   (server)
 	std::string baseConnection; 			// -base=IP:port    (client)	
+	std::vector<std::string> mountpoints;	// -mount=name:port:baud   (NTRIP caster)
 	
 	std::string flashCfg;
 	std::string evbFlashCfg;	
@@ -105,6 +111,8 @@ int cltool_serialPortSendComManager(CMHANDLE cmHandle, int pHandle, buffer_t* bu
 bool cltool_setupLogger(InertialSense& inertialSenseInterface);
 bool cltool_parseCommandLine(int argc, char* argv[]);
 bool cltool_replayDataLog();
+bool cltool_convertDataLog();
+bool cltool_logStats();
 void cltool_outputUsage();
 void cltool_outputHelp();
 void cltool_firmwareUpdateWaiter();
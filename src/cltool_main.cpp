@@ -34,6 +34,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 // Contains command line parsing and utility functions.  Include this in your project to use these utility functions.
 #include "cltool.h"
+#include "ISNtripCaster.h"
 
 #include <signal.h>
 
@@ -457,8 +458,97 @@ void cltool_firmwareUpdateWaiter()
 	printProgress();
 }
 
+// -base=NTRIP:[IP]:[port], mountpoints from -mount=[name]:[port]:[baud]
+static int cltool_createCaster()
+{
+	vector<string> pieces;
+	splitString(g_commandLineOptions.baseConnection, ':', pieces);
+	if (pieces.size() < 3)
+	{
+		cout << "Invalid caster " << g_commandLineOptions.baseConnection << endl;
+		return -1;
+	}
+
+	vector<string> mountpoints = g_commandLineOptions.mountpoints;
+	if (mountpoints.empty())
+	{
+		mountpoints.push_back("BASE:" + g_commandLineOptions.comPort + ":" + to_string(g_commandLineOptions.baudRate));
+	}
+
+	cISNtripCaster caster;
+	for (size_t i = 0; i < mountpoints.size(); i++)
+	{
+		vector<string> mount;
+		splitString(mountpoints[i], ':', mount);
+		if (mount.size() < 2)
+		{
+			cout << "Invalid mountpoint " << mountpoints[i] << endl;
+			return -1;
+		}
+
+		// short read timeout so the reader thread can stop promptly
+		cISSerialPort* serial = new cISSerialPort();
+		int baudRate = (mount.size() > 2 ? atoi(mount[2].c_str()) : BAUDRATE_921600);
+		if (!serial->Open(mount[1], baudRate, 10))
+		{
+			cout << "Failed to open serial port at " << mount[1] << endl;
+			delete serial;
+			return -1;
+		}
+		if (!caster.AddMountpoint(mount[0], serial))
+		{
+			cout << "Invalid or duplicate mountpoint " << mount[0] << endl;
+			delete serial;
+			return -1;
+		}
+	}
+
+	if (caster.Open(pieces[1], atoi(pieces[2].c_str())) != 0)
+	{
+		cout << "Failed to create caster at " << g_commandLineOptions.baseConnection << endl;
+		return -1;
+	}
+
+	unsigned int timeSinceClearMs = 0, curTimeMs;
+	while (!g_inertialSenseDisplay.ExitProgram())
+	{
+		SLEEP_MS(100);
+		if (g_inertialSenseDisplay.GetDisplayMode() == cInertialSenseDisplay::DMODE_QUIET)
+		{
+			continue;
+		}
+
+		curTimeMs = current_timeMs();
+		if (curTimeMs - timeSinceClearMs > 2000 || curTimeMs < timeSinceClearMs)
+		{	// Clear terminal
+			g_inertialSenseDisplay.Clear();
+			timeSinceClearMs = curTimeMs;
+		}
+		g_inertialSenseDisplay.Home();
+		cout << g_inertialSenseDisplay.Hello();
+		cout << "\nCaster: " << pieces[1] << ":" << pieces[2] << "     Connections: " << caster.ClientCount() << "    \n";
+		for (size_t i = 0; i < caster.MountpointCount(); i++)
+		{
+			cISNtripCaster::mountpoint_stats_t stats = caster.MountpointStats(i);
+			cout << "  " << setw(12) << left << caster.MountpointName(i) << right << " clients " << setw(5) << stats.clientCount << 
+				"   packets " << setw(8) << (long long)stats.packetCount << "   bytes " << setw(10) << (long long)stats.byteCount << 
+				"   dropped " << (long long)stats.dropCount << "    \n";
+		}
+		cout << flush;
+	}
+	cout << "Shutting down..." << endl;
+	caster.Close();
+
+	return 0;
+}
+
 static int cltool_createHost()
 {
+	if (g_commandLineOptions.baseConnection.compare(0, 6, "NTRIP:") == 0)
+	{
+		return cltool_createCaster();
+	}
+
 	InertialSense inertialSenseInterface;
 	if (!inertialSenseInterface.Open(g_commandLineOptions.comPort.c_str(), g_commandLineOptions.baudRate))
 	{
@@ -525,6 +615,15 @@ static int inertialSenseMain()
 	// if replay data log specified on command line, do that now and return
 	if (g_commandLineOptions.replayDataLog)
 	{	
+		if (g_commandLineOptions.convertLogType.length() != 0)
+		{
+			return !cltool_convertDataLog();
+		}
+		else if (g_commandLineOptions.logStats)
+		{
+			return !cltool_logStats();
+		}
+
 		// [REPLAY INSTRUCTION] 1.) Replay data log
 		return !cltool_replayDataLog();
 	}
@@ -569,6 +668,8 @@ static int inertialSenseMain()
 		// [C++ COMM INSTRUCTION] STEP 1: Instantiate InertialSense Class  
 		// Create InertialSense object, passing in data callback function pointer.
 		InertialSense inertialSenseInterface(cltool_dataCallback);
+		inertialSenseInterface.EnableSerialReadThreads(g_commandLineOptions.lowLatency);
+		inertialSenseInterface.EnableDeviceIngest(g_commandLineOptions.deviceIngest);
 
 		// [C++ COMM INSTRUCTION] STEP 2: Open serial port
 		if (!inertialSenseInterface.Open(g_commandLineOptions.comPort.c_str(), g_commandLineOptions.baudRate, g_commandLineOptions.disableBroadcastsOnClose))
@@ -61,6 +61,7 @@ int findAsciiMessage(const void * a, const void * b);
 //  Packet processing
 // com manager only...
 int encodeBinaryPacket(com_manager_t* cmInstance, int pHandle, buffer_t *pkt, packet_t *dPkt, uint8_t additionalPktFlags);
+int encodeBinaryPacketSg(com_manager_t* cmInstance, int pHandle, buffer_t *pkt, packet_hdr_t *hdr, const bufPtr_t *bodyBufs, int bodyBufCount, uint8_t additionalPktFlags);
 // 1 if valid
 int asciiMessageCompare(const void* elem1, const void* elem2);
 
@@ -179,6 +180,7 @@ int initComManagerInstanceInternal
 	cmInstance->sendPacketCallback = sendFnc;
 	cmInstance->txFreeCallback = txFreeFnc;
 	cmInstance->pstRxFnc = pstRxFnc;
+	cmInstance->pstRxViewFnc = NULL;
 	cmInstance->pstAckFnc = pstAckFnc;
 	cmInstance->disableBcastFnc = disableBcastFnc;
 	cmInstance->numHandles = numHandles;
@@ -302,96 +304,102 @@ void comManagerStepRxInstance(CMHANDLE cmInstance_)
 	com_manager_t* cmInstance = (com_manager_t*)cmInstance_;
 	int32_t pHandle;
 	
-	if (!cmInstance->readCallback)
+	for (pHandle = 0; pHandle < cmInstance->numHandles; pHandle++)
 	{
-		return;
+		comManagerStepRxPortInstance(cmInstance, pHandle);
 	}
-		
-		
-	for (pHandle = 0; pHandle < cmInstance->numHandles; pHandle++)
+}
+
+void comManagerStepRxPortInstance(CMHANDLE cmInstance_, int pHandle)
+{
+	com_manager_t* cmInstance = (com_manager_t*)cmInstance_;
+	
+	if (!cmInstance->readCallback || pHandle < 0 || pHandle >= cmInstance->numHandles)
 	{
-		com_manager_port_t *port = &(cmInstance->ports[pHandle]);
-		is_comm_instance_t *comm = &(port->comm);
-		protocol_type_t ptype;
+		return;
+	}
+
+	com_manager_port_t *port = &(cmInstance->ports[pHandle]);
+	is_comm_instance_t *comm = &(port->comm);
+	protocol_type_t ptype;
 
 #if 0	// Read one byte (simple method)
-		uint8_t c;
+	uint8_t c;
 
-		// Read from serial buffer until empty
-		while (cmInstance->readCallback(cmInstance, pHandle, &c, 1))
+	// Read from serial buffer until empty
+	while (cmInstance->readCallback(cmInstance, pHandle, &c, 1))
+	{
+		if ((ptype = is_comm_parse_byte(comm, c)) != _PTYPE_NONE)
 		{
-			if ((ptype = is_comm_parse_byte(comm, c)) != _PTYPE_NONE)
-			{
 
 #else	// Read a set of bytes (fast method)
 
-		// Get available size of comm buffer
-		int n = is_comm_free(comm);
+	// Get available size of comm buffer
+	int n = is_comm_free(comm);
 
-		// Read data directly into comm buffer
-		if ((n = cmInstance->readCallback(cmInstance, pHandle, comm->buf.tail, n)))
-		{
-			// Update comm buffer tail pointer
-			comm->buf.tail += n;
+	// Read data directly into comm buffer
+	if ((n = cmInstance->readCallback(cmInstance, pHandle, comm->buf.tail, n)))
+	{
+		// Update comm buffer tail pointer
+		comm->buf.tail += n;
 
-			// Search comm buffer for valid packets
-			while ((ptype = is_comm_parse(comm)) != _PTYPE_NONE)
-			{
+		// Search comm buffer for valid packets
+		while ((ptype = is_comm_parse(comm)) != _PTYPE_NONE)
+		{
 #endif					
-				uint8_t error = 0;
-				uint8_t *dataPtr = comm->dataPtr + comm->dataHdr.offset;
-				uint32_t dataSize = comm->dataHdr.size;
+			uint8_t error = 0;
+			uint8_t *dataPtr = comm->dataPtr + comm->dataHdr.offset;
+			uint32_t dataSize = comm->dataHdr.size;
 
-				switch (ptype)
-				{
-				case _PTYPE_PARSE_ERROR:
-					error = 1;
-					break;
-
-				case _PTYPE_INERTIAL_SENSE_DATA:
-				case _PTYPE_INERTIAL_SENSE_CMD:
-					error = (uint8_t)processBinaryRxPacket(cmInstance, pHandle, &(comm->pkt));
-					break;
+			switch (ptype)
+			{
+			case _PTYPE_PARSE_ERROR:
+				error = 1;
+				break;
 
-				case _PTYPE_UBLOX:
-					if (cmInstance->cmMsgHandlerUblox)
-					{
-						error = (uint8_t)cmInstance->cmMsgHandlerUblox(cmInstance, pHandle, dataPtr, dataSize);
-					}
-					break;
+			case _PTYPE_INERTIAL_SENSE_DATA:
+			case _PTYPE_INERTIAL_SENSE_CMD:
+				error = (uint8_t)processBinaryRxPacket(cmInstance, pHandle, &(comm->pkt));
+				break;
 
-				case _PTYPE_RTCM3:
-					if (cmInstance->cmMsgHandlerRtcm3)
-					{
-						error = (uint8_t)cmInstance->cmMsgHandlerRtcm3(cmInstance, pHandle, dataPtr, dataSize);
-					}
-					break;
+			case _PTYPE_UBLOX:
+				if (cmInstance->cmMsgHandlerUblox)
+				{
+					error = (uint8_t)cmInstance->cmMsgHandlerUblox(cmInstance, pHandle, dataPtr, dataSize);
+				}
+				break;
 
-				case _PTYPE_ASCII_NMEA:
-					if (cmInstance->cmMsgHandlerAscii)
-					{
-						error = (uint8_t)cmInstance->cmMsgHandlerAscii(cmInstance, pHandle, dataPtr, dataSize);
-					}
-					break;
-					
-				default:
-					break;
+			case _PTYPE_RTCM3:
+				if (cmInstance->cmMsgHandlerRtcm3)
+				{
+					error = (uint8_t)cmInstance->cmMsgHandlerRtcm3(cmInstance, pHandle, dataPtr, dataSize);
 				}
+				break;
 
-				if (error)
-				{	// Error parsing packet
-					port->status.readCounter += 32;
-					port->status.rxError = (uint32_t)-1;
-					port->status.communicationErrorCount++;
+			case _PTYPE_ASCII_NMEA:
+				if (cmInstance->cmMsgHandlerAscii)
+				{
+					error = (uint8_t)cmInstance->cmMsgHandlerAscii(cmInstance, pHandle, dataPtr, dataSize);
 				}
+				break;
+				
+			default:
+				break;
+			}
+
+			if (error)
+			{	// Error parsing packet
+				port->status.readCounter += 32;
+				port->status.rxError = (uint32_t)-1;
+				port->status.communicationErrorCount++;
 			}
-		}
-			
-		if ((port->status.flags & CM_PKT_FLAGS_RX_VALID_DATA) && port->status.readCounter > 128)
-		{	// communication problem, clear communication received bit
-			port->status.flags &= (~CM_PKT_FLAGS_RX_VALID_DATA);
 		}
 	}
+		
+	if ((port->status.flags & CM_PKT_FLAGS_RX_VALID_DATA) && port->status.readCounter > 128)
+	{	// communication problem, clear communication received bit
+		port->status.flags &= (~CM_PKT_FLAGS_RX_VALID_DATA);
+	}
 }
 
 void comManagerStepTxInstance(CMHANDLE cmInstance_)
@@ -474,6 +482,24 @@ void comManagerSetCallbacksInstance(CMHANDLE cmInstance,
 	}
 }
 
+void comManagerSetRxViewCallback(pfnComManagerPostReadView rxViewHandler)
+{
+	comManagerSetRxViewCallbackInstance(&g_cm, rxViewHandler);
+}
+
+void comManagerSetRxViewCallbackInstance(CMHANDLE cmInstance, pfnComManagerPostReadView rxViewHandler)
+{
+	if (cmInstance != 0)
+	{
+		((com_manager_t*)cmInstance)->pstRxViewFnc = rxViewHandler;
+	}
+}
+
+char comManagerRetainData(void* sptr, const p_data_view_t* view, unsigned int maxsize)
+{
+	return copyDataPToStructP2(sptr, &view->hdr, view->ptr, maxsize);
+}
+
 void comManagerAssignUserPointer(CMHANDLE cmInstance, void* userPointer)
 {
 	((com_manager_t*)cmInstance)->userPointer = userPointer;
@@ -790,8 +816,8 @@ int processBinaryRxPacket(com_manager_t* cmInstance, int pHandle, packet_t *pkt)
 
 		if (regd)
 		{
-			// Write to data structure if it was registered
-			if (regd->dataSet.rxPtr)
+			// Write to data structure if it was registered.  Zero-copy receivers retain data themselves.
+			if (regd->dataSet.rxPtr && cmInstance->pstRxViewFnc == NULL)
 			{
 				copyDataPToStructP(regd->dataSet.rxPtr, data, regd->dataSet.size);
 			}
@@ -804,7 +830,14 @@ int processBinaryRxPacket(com_manager_t* cmInstance, int pHandle, packet_t *pkt)
 		}
 
 		// Call general/global callback
-		if (cmInstance->pstRxFnc)
+		if (cmInstance->pstRxViewFnc)
+		{
+			p_data_view_t view;
+			view.hdr = data->hdr;
+			view.ptr = data->buf;
+			cmInstance->pstRxViewFnc(cmInstance, pHandle, &view);
+		}
+		else if (cmInstance->pstRxFnc)
 		{
 			cmInstance->pstRxFnc(cmInstance, pHandle, data);
 		}
@@ -1148,14 +1181,15 @@ int sendDataPacket(com_manager_t* cmInstance, int pHandle, pkt_info_t* msg)
 				return -1;
 			}
 			
-			// Setup packet and encoding state
-			buffer_t bufToEncode;
+			// Setup packet and encoding state.  Data header and data are encoded from separate buffers.
+			bufPtr_t body[2];
 			p_data_hdr_t hdr = *(p_data_hdr_t*)msg->bodyHdr.ptr;
-			p_data_hdr_t* hdrToSend = (p_data_hdr_t*)bufToEncode.buf;
+			p_data_hdr_t hdrToSend;
 			uint32_t size = hdr.size;
 			uint32_t offset = 0;
 			uint32_t id = hdr.id;
-			pkt.body.ptr = bufToEncode.buf;
+			body[0].ptr = (uint8_t*)&hdrToSend;
+			body[0].size = sizeof(p_data_hdr_t);
 
 #if ENABLE_PACKET_CONTINUATION
 
@@ -1165,20 +1199,21 @@ int sendDataPacket(com_manager_t* cmInstance, int pHandle, pkt_info_t* msg)
 #endif
 				
 				// Assign data header values
-				hdrToSend->size = _MIN(size, MAX_P_DATA_BODY_SIZE);
-				hdrToSend->offset = hdr.offset + offset;
-				hdrToSend->id = id;
+				hdrToSend.size = _MIN(size, MAX_P_DATA_BODY_SIZE);
+				hdrToSend.offset = hdr.offset + offset;
+				hdrToSend.id = id;
 
-				// copy the data to send to bufToEncode, skipping the data header - since we had to create that data header, we now have to append the actual data
-				memcpy(bufToEncode.buf + sizeof(p_data_hdr_t), msg->txData.ptr + offset, hdrToSend->size);
+				// point at the data to send, following the data header we had to create
+				body[1].ptr = msg->txData.ptr + offset;
+				body[1].size = hdrToSend.size;
 				
 				// reduce size by the amount sent - if packet continuation is off, this must become 0 otherwise we fail
-				size -= hdrToSend->size;
+				size -= hdrToSend.size;
 				
 #if ENABLE_PACKET_CONTINUATION
 
 				// increment offset for the next packet
-				offset += hdrToSend->size;
+				offset += hdrToSend.size;
 				
 #else
 
@@ -1190,11 +1225,8 @@ int sendDataPacket(com_manager_t* cmInstance, int pHandle, pkt_info_t* msg)
 				
 #endif
 
-				// Set data body size
-				pkt.body.size = sizeof(p_data_hdr_t) + hdrToSend->size;
-
 				// Encode the packet, handling special characters, etc.
-				if (encodeBinaryPacket(cmInstance, pHandle, &bufToSend, &pkt, CM_PKT_FLAGS_MORE_DATA_AVAILABLE * (size != 0)))
+				if (encodeBinaryPacketSg(cmInstance, pHandle, &bufToSend, &pkt.hdr, body, 2, CM_PKT_FLAGS_MORE_DATA_AVAILABLE * (size != 0)))
 				{
 					return -1;
 				}
@@ -1279,17 +1311,24 @@ void sendAck(com_manager_t* cmInstance, int pHandle, packet_t *pkt, unsigned cha
 *	@return 0 on success, -1 on failure.
 */
 int encodeBinaryPacket(com_manager_t* cmInstance, int pHandle, buffer_t *pkt, packet_t *dPkt, uint8_t additionalPktFlags)
+{
+	return encodeBinaryPacketSg(cmInstance, pHandle, pkt, &dPkt->hdr, &dPkt->body, (dPkt->body.size > 0), additionalPktFlags);
+}
+
+/**
+*  @brief Same as encodeBinaryPacket() except the packet body is gathered from bodyBufCount buffers.
+*
+*	@return 0 on success, -1 on failure.
+*/
+int encodeBinaryPacketSg(com_manager_t* cmInstance, int pHandle, buffer_t *pkt, packet_hdr_t *hdr, const bufPtr_t *bodyBufs, int bodyBufCount, uint8_t additionalPktFlags)
 {
 	com_manager_port_t *port = &(cmInstance->ports[pHandle]);
 	
-	void* srcBuffer = dPkt->body.ptr;
-	int srcBufferLength = dPkt->body.size;
 	void* encodedPacket = pkt->buf;
 	int encodedPacketLength = PKT_BUF_SIZE - 1;
-	packet_hdr_t* hdr = &dPkt->hdr;
 	hdr->counter = (uint8_t)(port->comm.txPktCount++);
 
-	pkt->size = is_encode_binary_packet(srcBuffer, srcBufferLength, hdr, additionalPktFlags | port->status.flags, encodedPacket, encodedPacketLength);
+	pkt->size = is_encode_binary_packet_sg(bodyBufs, bodyBufCount, hdr, additionalPktFlags | port->status.flags, encodedPacket, encodedPacketLength);
 	return (-1 * ((int)pkt->size < 8));
 }
 
@@ -131,6 +131,19 @@ typedef int(*pfnComManagerSendBufferAvailableBytes)(CMHANDLE cmHandle, int pHand
 // pstRxFnc optional, called after data is sent to the serial port represented by pHandle
 typedef void(*pfnComManagerPostRead)(CMHANDLE cmHandle, int pHandle, p_data_t* dataRead);
 
+/* Borrowed view of received data.  ptr points into the com manager receive buffer and is only valid until the callback returns. */
+typedef struct
+{
+	/* Data id, offset and size of the received data */
+	p_data_hdr_t hdr;
+
+	/* hdr.size bytes of received data, owned by the com manager */
+	const uint8_t* ptr;
+} p_data_view_t;
+
+// pstRxViewFnc optional, zero-copy alternative to pstRxFnc.  Use comManagerRetainData() to keep the data beyond the callback.
+typedef void(*pfnComManagerPostReadView)(CMHANDLE cmHandle, int pHandle, const p_data_view_t* view);
+
 // pstAckFnc optional, called after an ACK is received by the serial port represented by pHandle
 typedef void(*pfnComManagerPostAck)(CMHANDLE cmHandle, int pHandle, p_ack_t* ack, unsigned char packetIdentifier);
 
@@ -202,6 +215,9 @@ typedef struct
 	// Callback function pointer, used to respond to data input
 	pfnComManagerPostRead pstRxFnc;
 
+	// Callback function pointer, zero-copy data input.  When set, registered rx data structures are not written to.
+	pfnComManagerPostReadView pstRxViewFnc;
+
 	// Callback function pointer, used to respond to ack
 	pfnComManagerPostAck pstAckFnc;
 
@@ -317,6 +333,11 @@ Performs one round of sending and receiving message. This should be called as of
 void comManagerStep(void);
 void comManagerStepInstance(CMHANDLE cmInstance_);
 void comManagerStepRxInstance(CMHANDLE cmInstance);
+
+/**
+Receive and handle data from one port, the same as one port of comManagerStepRxInstance.  Lets the caller choose the order ports are serviced in.
+*/
+void comManagerStepRxPortInstance(CMHANDLE cmInstance, int pHandle);
 void comManagerStepTxInstance(CMHANDLE cmInstance);
 
 /**
@@ -538,6 +559,27 @@ void comManagerSetCallbacksInstance(CMHANDLE cmInstance,
 	pfnComManagerGenMsgHandler ubloxHandler,
 	pfnComManagerGenMsgHandler rtcm3Handler);
 
+/**
+Enable the zero-copy receive path.  When set, received data is passed to rxViewHandler as a borrowed view into the receive 
+buffer instead of being copied into the registered rx data structures, and rxViewHandler is called in place of the global pstRxFnc.
+Data specific pstRxFnc callbacks are still called.  Pass in NULL to restore the copying receive path.
+
+@param rxViewHandler handler called with a view of each received data set, valid only until the handler returns
+*/
+void comManagerSetRxViewCallback(pfnComManagerPostReadView rxViewHandler);
+void comManagerSetRxViewCallbackInstance(CMHANDLE cmInstance, pfnComManagerPostReadView rxViewHandler);
+
+/**
+Copy data from a borrowed view into a data structure, i.e. the registered rx data structure.  Call this from the view 
+handler for data that must outlive the callback.
+
+@param sptr data structure to copy into
+@param view the view passed to the view handler
+@param maxsize size of the data structure at sptr
+@return 0 on success, -1 if the data does not fit in the structure
+*/
+char comManagerRetainData(void* sptr, const p_data_view_t* view, unsigned int maxsize);
+
 /**
 Attach user defined data to a com manager instance
 */
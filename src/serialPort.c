@@ -81,6 +81,15 @@ int serialPortFlush(serial_port_t* serialPort)
 	return serialPort->pfnFlush(serialPort);
 }
 
+int serialPortStartReadThread(serial_port_t* serialPort, int vmin, int vtimeDeciseconds, int lowLatency)
+{
+	if (serialPort == 0 || serialPort->handle == 0 || serialPort->pfnStartReadThread == 0)
+	{
+		return 0;
+	}
+	return serialPort->pfnStartReadThread(serialPort, vmin, vtimeDeciseconds, lowLatency);
+}
+
 int serialPortRead(serial_port_t* serialPort, unsigned char* buffer, int readCount)
 {
 	return serialPortReadTimeout(serialPort, buffer, readCount, -1);
@@ -59,6 +59,7 @@ typedef int(*pfnSerialPortFlush)(serial_port_t* serialPort);
 typedef int(*pfnSerialPortGetByteCountAvailableToRead)(serial_port_t* serialPort);
 typedef int(*pfnSerialPortGetByteCountAvailableToWrite)(serial_port_t* serialPort);
 typedef int(*pfnSerialPortSleep)(int sleepMilliseconds);
+typedef int(*pfnSerialPortStartReadThread)(serial_port_t* serialPort, int vmin, int vtimeDeciseconds, int lowLatency);
 
 // Allows communicating over a serial port
 struct serial_port_t
@@ -104,6 +105,9 @@ struct serial_port_t
 
 	// sleep for a specified number of milliseconds
 	pfnSerialPortSleep pfnSleep;
+
+	// start a reader thread, optional
+	pfnSerialPortStartReadThread pfnStartReadThread;
 };
 
 // set the port name for a serial port, in case you are opening it later
@@ -142,6 +146,15 @@ int serialPortRead(serial_port_t* serialPort, unsigned char* buffer, int readCou
 // read up to thue number of bytes requested, returns number of bytes read which is less than or equal to readCount
 int serialPortReadTimeout(serial_port_t* serialPort, unsigned char* buffer, int readCount, int timeoutMilliseconds);
 
+// start a thread that reads the serial port and queues what it reads, optional and not supported on all platforms.
+// the thread blocks in read using the tty VMIN / VTIME settings so a whole burst of data is delivered at once without
+// polling, and serialPortReadTimeout then returns as soon as any data is queued instead of waiting to fill readCount.
+// vmin: min bytes per read (0-255), vtimeDeciseconds: inter-byte timeout once data has started (0-255, forced to at
+// least 1 when vmin > 1), lowLatency: set ASYNC_LOW_LATENCY on the tty (FTDI / CDC-ACM, ignored if not supported).
+// the port is switched to blocking writes. the thread stops when the port is closed.
+// returns 1 if success, 0 if failure or not supported
+int serialPortStartReadThread(serial_port_t* serialPort, int vmin, int vtimeDeciseconds, int lowLatency);
+
 // start an async read - not all platforms will support an async read and may call the callback function immediately
 // reads up to readCount bytes into buffer
 // buffer must exist until callback is executed, if it needs to be freed, free it in the callback or later
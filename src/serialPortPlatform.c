@@ -29,6 +29,11 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <termios.h>
 #include <unistd.h>
 #include <poll.h>
+#include <pthread.h>
+
+#if PLATFORM_IS_LINUX
+#include <linux/serial.h>
+#endif
 
 // cygwin defines FIONREAD in socket.h instead of ioctl.h
 #ifndef FIONREAD
@@ -49,6 +54,23 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #define error_message printf
 #endif
 
+#define SERIAL_PORT_READ_THREAD_RING_SIZE	65536	// power of 2
+#define SERIAL_PORT_READ_THREAD_CHUNK_SIZE	4096
+
+// reader thread state, see serialPortStartReadThread
+typedef struct
+{
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t dataReady;
+    pthread_cond_t spaceReady;
+    int wakePipe[2];        // written on close to wake the thread from poll
+    int stop;
+    unsigned int head;      // free running ring positions, guarded by mutex
+    unsigned int tail;
+    unsigned char ring[SERIAL_PORT_READ_THREAD_RING_SIZE];
+} serialPortReader;
+
 #ifndef B460800
 #define B460800 460800
 #endif
@@ -83,6 +105,7 @@ typedef struct
 #else
 
     int fd;
+    serialPortReader* reader;
 
 #endif
 
@@ -399,6 +422,25 @@ static int serialPortClosePlatform(serial_port_t* serialPort)
 
 #else
 
+    if (handle->reader != 0)
+    {
+        serialPortReader* reader = handle->reader;
+        pthread_mutex_lock(&reader->mutex);
+        reader->stop = 1;
+        pthread_cond_broadcast(&reader->spaceReady);
+        pthread_mutex_unlock(&reader->mutex);
+        char wake = 0;
+        ssize_t written = write(reader->wakePipe[1], &wake, 1);
+        (void)written;
+        pthread_join(reader->thread, 0);
+        close(reader->wakePipe[0]);
+        close(reader->wakePipe[1]);
+        pthread_cond_destroy(&reader->dataReady);
+        pthread_cond_destroy(&reader->spaceReady);
+        pthread_mutex_destroy(&reader->mutex);
+        free(reader);
+        handle->reader = 0;
+    }
     close(handle->fd);
     handle->fd = 0;
 
@@ -424,6 +466,13 @@ static int serialPortFlushPlatform(serial_port_t* serialPort)
 #else
 
     tcflush(handle->fd, TCIOFLUSH);
+    if (handle->reader != 0)
+    {
+        pthread_mutex_lock(&handle->reader->mutex);
+        handle->reader->tail = handle->reader->head;
+        pthread_cond_broadcast(&handle->reader->spaceReady);
+        pthread_mutex_unlock(&handle->reader->mutex);
+    }
 
 #endif
 
@@ -496,6 +545,44 @@ static int serialPortReadTimeoutPlatformWindows(serialPortHandle* handle, unsign
 
 #else
 
+static int serialPortReadThreadQueue(serialPortReader* reader, unsigned char* buffer, int readCount, int timeoutMilliseconds)
+{
+    pthread_mutex_lock(&reader->mutex);
+    if (reader->head == reader->tail && timeoutMilliseconds > 0)
+    {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeoutMilliseconds / 1000;
+        deadline.tv_nsec += (timeoutMilliseconds % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (reader->head == reader->tail && !reader->stop)
+        {
+            if (pthread_cond_timedwait(&reader->dataReady, &reader->mutex, &deadline) != 0)
+            {
+                break;
+            }
+        }
+    }
+
+    // everything queued up to readCount, copied in up to two pieces where the ring wraps
+    unsigned int count = _MIN((unsigned int)readCount, reader->head - reader->tail);
+    unsigned int start = reader->tail & (SERIAL_PORT_READ_THREAD_RING_SIZE - 1);
+    unsigned int first = _MIN(count, SERIAL_PORT_READ_THREAD_RING_SIZE - start);
+    memcpy(buffer, reader->ring + start, first);
+    memcpy(buffer + first, reader->ring, count - first);
+    reader->tail += count;
+    if (count != 0)
+    {
+        pthread_cond_signal(&reader->spaceReady);
+    }
+    pthread_mutex_unlock(&reader->mutex);
+    return (int)count;
+}
+
 static int serialPortReadTimeoutPlatformLinux(serialPortHandle* handle, unsigned char* buffer, int readCount, int timeoutMilliseconds)
 {
     int totalRead = 0;
@@ -566,6 +653,10 @@ static int serialPortReadTimeoutPlatform(serial_port_t* serialPort, unsigned cha
 
 #else
 
+    if (handle->reader != 0)
+    {
+        return serialPortReadThreadQueue(handle->reader, buffer, readCount, timeoutMilliseconds);
+    }
     return serialPortReadTimeoutPlatformLinux(handle, buffer, readCount, timeoutMilliseconds);
 
 #endif
@@ -674,6 +765,12 @@ static int serialPortGetByteCountAvailableToReadPlatform(serial_port_t* serialPo
 
     int bytesAvailable;
     ioctl(handle->fd, FIONREAD, &bytesAvailable);
+    if (handle->reader != 0)
+    {
+        pthread_mutex_lock(&handle->reader->mutex);
+        bytesAvailable += (int)(handle->reader->head - handle->reader->tail);
+        pthread_mutex_unlock(&handle->reader->mutex);
+    }
     return bytesAvailable;
 
 #endif
@@ -697,6 +794,160 @@ static int serialPortGetByteCountAvailableToWritePlatform(serial_port_t* serialP
     */
 }
 
+#if !PLATFORM_IS_WINDOWS
+
+static void* serialPortReadThread(void* info)
+{
+    serialPortHandle* handle = (serialPortHandle*)info;
+    serialPortReader* reader = handle->reader;
+    unsigned char buffer[SERIAL_PORT_READ_THREAD_CHUNK_SIZE];
+
+    while (1)
+    {
+        // wait for the first byte, or for close, then read blocks per VMIN / VTIME to gather the rest of the burst
+        struct pollfd fds[2];
+        fds[0].fd = handle->fd;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = reader->wakePipe[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        int pollrc = poll(fds, 2, -1);
+        if (pollrc < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (pollrc < 0 || fds[1].revents != 0 || (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)))
+        {   // closing, or the device is gone
+            break;
+        }
+
+        int n = (int)read(handle->fd, buffer, sizeof(buffer));
+        if (n < 0 && (errno == EINTR || errno == EAGAIN))
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+
+        // queue it, waiting while the ring is full so data is never dropped
+        int queued = 0;
+        pthread_mutex_lock(&reader->mutex);
+        while (queued < n && !reader->stop)
+        {
+            unsigned int space = SERIAL_PORT_READ_THREAD_RING_SIZE - (reader->head - reader->tail);
+            if (space == 0)
+            {
+                pthread_cond_wait(&reader->spaceReady, &reader->mutex);
+                continue;
+            }
+            unsigned int start = reader->head & (SERIAL_PORT_READ_THREAD_RING_SIZE - 1);
+            unsigned int count = _MIN(_MIN(space, (unsigned int)(n - queued)), SERIAL_PORT_READ_THREAD_RING_SIZE - start);
+            memcpy(reader->ring + start, buffer + queued, count);
+            reader->head += count;
+            queued += count;
+            pthread_cond_signal(&reader->dataReady);
+        }
+        int stop = reader->stop;
+        pthread_mutex_unlock(&reader->mutex);
+        if (stop)
+        {
+            break;
+        }
+    }
+
+    // wake any reader waiting on data that will not come
+    pthread_mutex_lock(&reader->mutex);
+    reader->stop = 1;
+    pthread_cond_broadcast(&reader->dataReady);
+    pthread_mutex_unlock(&reader->mutex);
+    return 0;
+}
+
+static int serialPortStartReadThreadPlatform(serial_port_t* serialPort, int vmin, int vtimeDeciseconds, int lowLatency)
+{
+    serialPortHandle* handle = (serialPortHandle*)serialPort->handle;
+    if (handle->reader != 0)
+    {   // already running
+        return 1;
+    }
+
+    vmin = _CLAMP(vmin, 0, 255);
+    vtimeDeciseconds = _CLAMP(vtimeDeciseconds, 0, 255);
+    if (vmin > 1 && vtimeDeciseconds == 0)
+    {   // read could otherwise wait forever for vmin bytes
+        vtimeDeciseconds = 1;
+    }
+
+    struct termios tty;
+    if (tcgetattr(handle->fd, &tty) != 0)
+    {
+        return 0;
+    }
+    tty.c_cc[VMIN] = (cc_t)vmin;
+    tty.c_cc[VTIME] = (cc_t)vtimeDeciseconds;
+    if (tcsetattr(handle->fd, TCSANOW, &tty) != 0)
+    {
+        return 0;
+    }
+
+#if PLATFORM_IS_LINUX
+
+    if (lowLatency)
+    {   // FTDI and CDC-ACM drivers otherwise hold received data for their latency timer, not supported by every tty
+        struct serial_struct serinfo;
+        if (ioctl(handle->fd, TIOCGSERIAL, &serinfo) == 0)
+        {
+            serinfo.flags |= ASYNC_LOW_LATENCY;
+            ioctl(handle->fd, TIOCSSERIAL, &serinfo);
+        }
+    }
+
+#else
+
+    (void)lowLatency;
+
+#endif
+
+    // VMIN / VTIME only apply to blocking reads
+    int flags = fcntl(handle->fd, F_GETFL);
+    if (flags < 0 || fcntl(handle->fd, F_SETFL, flags & ~O_NONBLOCK) != 0)
+    {
+        return 0;
+    }
+
+    serialPortReader* reader = (serialPortReader*)calloc(1, sizeof(serialPortReader));
+    if (reader == 0)
+    {
+        return 0;
+    }
+    if (pipe(reader->wakePipe) != 0)
+    {
+        free(reader);
+        return 0;
+    }
+    pthread_mutex_init(&reader->mutex, 0);
+    pthread_cond_init(&reader->dataReady, 0);
+    pthread_cond_init(&reader->spaceReady, 0);
+    handle->reader = reader;
+    if (pthread_create(&reader->thread, 0, serialPortReadThread, handle) != 0)
+    {
+        handle->reader = 0;
+        close(reader->wakePipe[0]);
+        close(reader->wakePipe[1]);
+        pthread_cond_destroy(&reader->dataReady);
+        pthread_cond_destroy(&reader->spaceReady);
+        pthread_mutex_destroy(&reader->mutex);
+        free(reader);
+        return 0;
+    }
+    return 1;
+}
+
+#endif
+
 static int serialPortSleepPlatform(int sleepMilliseconds)
 {
 #if PLATFORM_IS_WINDOWS
@@ -727,5 +978,12 @@ int serialPortPlatformInit(serial_port_t* serialPort)
     serialPort->pfnGetByteCountAvailableToRead = serialPortGetByteCountAvailableToReadPlatform;
     serialPort->pfnGetByteCountAvailableToWrite = serialPortGetByteCountAvailableToWritePlatform;
     serialPort->pfnSleep = serialPortSleepPlatform;
+
+#if !PLATFORM_IS_WINDOWS
+
+    serialPort->pfnStartReadThread = serialPortStartReadThreadPlatform;
+
+#endif
+
     return 0;
 }
@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include "../ISLogger.h"
+#include "../ISFileManager.h"
+
+#define CHUNK_TEST_DIRECTORY	"test_chunk_log"
+
+// 1 kHz PIMU with 200 Hz INS_2 and 5 Hz GPS, slowly changing values like a real IMU log
+static std::vector<p_data_t> chunkTestData(int ms)
+{
+	std::vector<p_data_t> records;
+	for (int i = 0; i < ms; i++)
+	{
+		p_data_t data = {};
+		pimu_t& imu = *(pimu_t*)data.buf;
+		imu.time = 1000.0 + i * 0.001;
+		imu.dt = 0.001f;
+		imu.status = 0x1234;
+		imu.theta[0] = 1.0e-5f * sinf(i * 0.01f);
+		imu.theta[2] = 2.0e-6f;
+		imu.vel[2] = -9.80665e-3f + 1.0e-6f * (i % 7);
+		data.hdr.id = DID_PIMU;
+		data.hdr.size = sizeof(pimu_t);
+		records.push_back(data);
+
+		if (i % 5 == 0)
+		{
+			memset(&data, 0, sizeof(data));
+			ins_2_t& ins = *(ins_2_t*)data.buf;
+			ins.timeOfWeek = 1000.0 + i * 0.001;
+			ins.week = 2250;
+			ins.insStatus = 0x300;
+			ins.qn2b[0] = 0.7071f;
+			ins.qn2b[3] = -0.7071f + 1.0e-6f * i;
+			ins.lla[0] = 40.0557114 + i * 1.0e-9;
+			ins.lla[1] = -111.6585476;
+			ins.lla[2] = 1426.77 + i * 0.001;
+			data.hdr.id = DID_INS_2;
+			data.hdr.size = sizeof(ins_2_t);
+			records.push_back(data);
+		}
+
+		if (i % 200 == 0)
+		{
+			memset(&data, 0, sizeof(data));
+			gps_pos_t& gps = *(gps_pos_t*)data.buf;
+			gps.timeOfWeekMs = 1000000 + i;
+			gps.week = 2250;
+			gps.status = 0x2310;
+			gps.lla[0] = 40.0557114;
+			gps.hMSL = 1440.5f;
+			data.hdr.id = DID_GPS1_POS;
+			data.hdr.size = sizeof(gps_pos_t);
+			records.push_back(data);
+		}
+	}
+	return records;
+}
+
+// Write the records, read them back and return the log size in bytes
+static uint64_t chunkRoundTrip(const std::vector<p_data_t>& records, cISLogger::eLogType logType, int level, bool deltaFilter, bool mappedRead = false)
+{
+	ISFileManager::DeleteDirectory(CHUNK_TEST_DIRECTORY);
+	{
+		cISLogger logger;
+		logger.SetCompression(level, deltaFilter);
+		EXPECT_TRUE(logger.InitSaveTimestamp("20230101_000000", CHUNK_TEST_DIRECTORY, "", 1, logType, 0.5f, 1024 * 1024, false));
+		dev_info_t info = {};
+		info.serialNumber = 12345;
+		logger.SetDeviceInfo(&info);
+		logger.EnableLogging(true);
+		for (size_t i = 0; i < records.size(); i++)
+		{
+			EXPECT_TRUE(logger.LogData(0, (p_data_hdr_t*)&records[i].hdr, records[i].buf));
+		}
+		logger.CloseAllFiles();
+	}
+
+	std::vector<ISFileManager::file_info_t> files;
+	uint64_t size = ISFileManager::GetDirectorySpaceUsed(CHUNK_TEST_DIRECTORY, "\\.s?dat$", files, false, true);
+
+	cISLogger logger;
+	logger.SetMappedRead(mappedRead);
+	EXPECT_TRUE(logger.LoadFromDirectory(CHUNK_TEST_DIRECTORY, logType));
+	size_t count = 0;
+	p_data_t* data;
+	while ((data = logger.ReadData(0)) != NULL)
+	{
+		if (data->hdr.id == DID_DEV_INFO)
+		{
+			continue;
+		}
+		EXPECT_LT(count, records.size());
+		if (count >= records.size())
+		{
+			break;
+		}
+		EXPECT_EQ(records[count].hdr.id, data->hdr.id);
+		EXPECT_EQ(records[count].hdr.size, data->hdr.size);
+		EXPECT_EQ(0, memcmp(records[count].buf, data->buf, data->hdr.size)) << "record " << count;
+		count++;
+	}
+	EXPECT_EQ(records.size(), count);
+
+	ISFileManager::DeleteDirectory(CHUNK_TEST_DIRECTORY);
+	return size;
+}
+
+TEST(DataChunk, CompressedDatTest)
+{
+	std::vector<p_data_t> records = chunkTestData(20000);
+	uint64_t rawSize = chunkRoundTrip(records, cISLogger::eLogType::LOGTYPE_DAT, CHUNK_COMPRESSION_NONE, false);
+	if (!cDataChunk::CompressionSupported())
+	{
+		return;
+	}
+
+	uint64_t fastSize = chunkRoundTrip(records, cISLogger::eLogType::LOGTYPE_DAT, CHUNK_COMPRESSION_FAST, false);
+	uint64_t deltaSize = chunkRoundTrip(records, cISLogger::eLogType::LOGTYPE_DAT, CHUNK_COMPRESSION_FAST, true);
+	uint64_t denseSize = chunkRoundTrip(records, cISLogger::eLogType::LOGTYPE_DAT, CHUNK_COMPRESSION_DENSE, true);
+	chunkRoundTrip(records, cISLogger::eLogType::LOGTYPE_DAT, CHUNK_COMPRESSION_FAST, true, true);
+
+	EXPECT_LT(fastSize, rawSize / 2);
+	EXPECT_LT(deltaSize, fastSize);
+	EXPECT_LT(denseSize, rawSize / 3);
+}
+
+TEST(DataChunk, CompressedSdatTest)
+{
+	std::vector<p_data_t> records = chunkTestData(20000);
+	uint64_t rawSize = chunkRoundTrip(records, cISLogger::eLogType::LOGTYPE_SDAT, CHUNK_COMPRESSION_NONE, false);
+	if (!cDataChunk::CompressionSupported())
+	{
+		return;
+	}
+
+	uint64_t deltaSize = chunkRoundTrip(records, cISLogger::eLogType::LOGTYPE_SDAT, CHUNK_COMPRESSION_FAST, true);
+	EXPECT_LT(deltaSize, rawSize / 3);
+}
+
+// Chunks the fread reader rejects end the file for the mapped reader too, even with valid chunks after them
+TEST(DataChunk, MappedReadRejectsBadChunksTest)
+{
+	std::vector<p_data_t> records = chunkTestData(2000);
+	for (int bad = 0; bad < 2; bad++)
+	{
+		ISFileManager::DeleteDirectory(CHUNK_TEST_DIRECTORY);
+		{
+			cISLogger logger;
+			ASSERT_TRUE(logger.InitSaveTimestamp("20230101_000000", CHUNK_TEST_DIRECTORY, "", 1, cISLogger::eLogType::LOGTYPE_DAT, 0.5f, 100 * 1024 * 1024, false));
+			dev_info_t info = {};
+			info.serialNumber = 12345;
+			logger.SetDeviceInfo(&info);
+			logger.EnableLogging(true);
+			for (size_t i = 0; i < records.size(); i++)
+			{
+				ASSERT_TRUE(logger.LogData(0, (p_data_hdr_t*)&records[i].hdr, records[i].buf));
+			}
+			logger.CloseAllFiles();
+		}
+
+		std::vector<ISFileManager::file_info_t> files;
+		ISFileManager::GetDirectorySpaceUsed(CHUNK_TEST_DIRECTORY, "\\.dat$", files, false, true);
+		ASSERT_EQ(1u, files.size());
+		std::vector<uint8_t> log(files[0].size);
+		FILE* file = fopen(files[0].name.c_str(), "rb");
+		ASSERT_TRUE(file != NULL);
+		ASSERT_EQ(log.size(), fread(log.data(), 1, log.size(), file));
+		fclose(file);
+
+		// A bad chunk followed by a copy of the first chunk
+		sChunkHeader hdr;
+		memcpy(&hdr, log.data(), sizeof(hdr));
+		std::vector<uint8_t> firstChunk(log.begin(), log.begin() + sizeof(hdr) + hdr.dataSize);
+		std::vector<uint8_t> badChunk;
+		if (bad == 0)
+		{	// wrong marker
+			hdr.marker = ~DATA_CHUNK_MARKER;
+			badChunk.assign((uint8_t*)&hdr, (uint8_t*)&hdr + sizeof(hdr));
+			badChunk.insert(badChunk.end(), firstChunk.begin() + sizeof(hdr), firstChunk.end());
+		}
+		else
+		{	// compressed chunk larger than the chunk buffer
+			hdr.version = DATA_CHUNK_VERSION_COMPRESSED;
+			hdr.dataSize = DEFAULT_CHUNK_DATA_SIZE + 16;
+			hdr.invDataSize = ~hdr.dataSize;
+			badChunk.assign((uint8_t*)&hdr, (uint8_t*)&hdr + sizeof(hdr));
+			badChunk.resize(sizeof(hdr) + hdr.dataSize);
+		}
+		file = fopen(files[0].name.c_str(), "ab");
+		ASSERT_TRUE(file != NULL);
+		fwrite(badChunk.data(), 1, badChunk.size(), file);
+		fwrite(firstChunk.data(), 1, firstChunk.size(), file);
+		fclose(file);
+
+		size_t counts[2];
+		for (int mapped = 0; mapped < 2; mapped++)
+		{
+			cISLogger logger;
+			logger.SetMappedRead(mapped != 0);
+			ASSERT_TRUE(logger.LoadFromDirectory(CHUNK_TEST_DIRECTORY));
+			counts[mapped] = 0;
+			p_data_t* data;
+			while ((data = logger.ReadData(0)) != NULL)
+			{
+				counts[mapped] += (data->hdr.id != DID_DEV_INFO);
+			}
+		}
+		EXPECT_EQ(records.size(), counts[0]) << "bad chunk " << bad;
+		EXPECT_EQ(records.size(), counts[1]) << "bad chunk " << bad;
+	}
+	ISFileManager::DeleteDirectory(CHUNK_TEST_DIRECTORY);
+}
+
+TEST(DataChunk, FilterRoundTripTest)
+{
+	// Data sets of the same DID with a different size or offset are not filtered against each other
+	class cTestChunk : public cDataChunk
+	{
+	public:
+		void Filter(const uint8_t* src, uint8_t* dst, int32_t size, bool encode) { FilterData(src, dst, size, encode); }
+	} chunk;
+
+	std::vector<uint8_t> raw;
+	for (int i = 0; i < 200; i++)
+	{
+		p_data_hdr_t hdr = { DID_PIMU, (uint32_t)(i % 50 == 49 ? 8 : sizeof(pimu_t)), (uint32_t)(i % 50 == 49 ? 4 : 0) };
+		raw.insert(raw.end(), (uint8_t*)&hdr, (uint8_t*)&hdr + sizeof(hdr));
+		for (uint32_t j = 0; j < hdr.size; j++)
+		{
+			raw.push_back((uint8_t)(i * 3 + j));
+		}
+	}
+	raw.push_back(0xAB);	// Partial trailing header is copied as is
+
+	std::vector<uint8_t> filtered(raw.size());
+	chunk.Filter(raw.data(), filtered.data(), (int32_t)raw.size(), true);
+	EXPECT_NE(raw, filtered);
+	EXPECT_EQ(0, memcmp(raw.data(), filtered.data(), sizeof(p_data_hdr_t) + sizeof(pimu_t)));
+	chunk.Filter(filtered.data(), filtered.data(), (int32_t)filtered.size(), false);
+	EXPECT_EQ(raw, filtered);
+}
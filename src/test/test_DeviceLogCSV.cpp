@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../ISLogger.h"
+#include "../ISFileManager.h"
+
+#define CSV_TEST_DIRECTORY	"test_csv_log"
+
+// Writes INS and GPS data across several files, reads it back and compares every record
+static void testTextLogRoundTrip(cISLogger::eLogType logType)
+{
+	ISFileManager::DeleteDirectory(CSV_TEST_DIRECTORY);
+
+	std::vector<p_data_t> written;
+	{
+		cISLogger logger;
+		ASSERT_TRUE(logger.InitSaveTimestamp("20230101_000000", CSV_TEST_DIRECTORY, "", 1, logType, 0.5f, 300000, false));
+		dev_info_t info = {};
+		info.serialNumber = 12345;
+		logger.SetDeviceInfo(&info);
+		logger.EnableLogging(true);
+
+		for (int i = 0; i < 10000; i++)
+		{
+			p_data_t data = {};
+			if (i % 5 == 4)
+			{
+				gps_pos_t& gps = *(gps_pos_t*)data.buf;
+				gps.timeOfWeekMs = 200 * i;
+				gps.week = 2250;
+				gps.status = 0x80000000 | i;		// written as hex
+				gps.lla[0] = 40.0557114 + i * 1.0e-9;
+				gps.lla[1] = -111.6585476;
+				gps.hMSL = 1400.0f + i * 0.01f;
+				gps.pDop = 1.0e-7f * i;
+				data.hdr.id = DID_GPS1_POS;
+				data.hdr.size = sizeof(gps_pos_t);
+			}
+			else
+			{
+				ins_2_t& ins = *(ins_2_t*)data.buf;
+				ins.timeOfWeek = 1000.0 + 0.004 * i;
+				ins.week = 2250;
+				ins.insStatus = i;
+				ins.qn2b[0] = 0.7071f;
+				ins.qn2b[1] = -i * 0.001f;
+				ins.uvw[2] = 1.0e30f;
+				ins.lla[2] = 1400.0 + i / 3.0;
+				data.hdr.id = DID_INS_2;
+				data.hdr.size = sizeof(ins_2_t);
+			}
+			ASSERT_TRUE(logger.LogData(0, &data.hdr, data.buf));
+			written.push_back(data);
+		}
+		logger.CloseAllFiles();
+	}
+	std::vector<ISFileManager::file_info_t> files;
+	ISFileManager::GetDirectorySpaceUsed(CSV_TEST_DIRECTORY, "\\.(csv|json)$", files, false, true);
+	EXPECT_GT(files.size(), 3u);
+
+	cISLogger logger;
+	ASSERT_TRUE(logger.LoadFromDirectory(CSV_TEST_DIRECTORY, logType));
+	size_t count = 0;
+	p_data_t* data;
+	while ((data = logger.ReadData(0)) != NULL)
+	{
+		if (data->hdr.id == DID_DEV_INFO)
+		{
+			continue;
+		}
+		ASSERT_LT(count, written.size());
+		ASSERT_EQ(written[count].hdr.id, data->hdr.id);
+		ASSERT_EQ(written[count].hdr.size, data->hdr.size);
+		ASSERT_EQ(0, memcmp(written[count].buf, data->buf, data->hdr.size)) << "record " << count;
+		count++;
+	}
+	EXPECT_EQ(written.size(), count);
+
+	ISFileManager::DeleteDirectory(CSV_TEST_DIRECTORY);
+}
+
+TEST(DeviceLogCSV, WriteReadTest)
+{
+	testTextLogRoundTrip(cISLogger::LOGTYPE_CSV);
+}
+
+TEST(DeviceLogJSON, WriteReadTest)
+{
+	testTextLogRoundTrip(cISLogger::LOGTYPE_JSON);
+}
+
+static std::map<std::string, std::string> readLogFiles(const char* directory)
+{
+	std::map<std::string, std::string> contents;
+	std::vector<ISFileManager::file_info_t> files;
+	ISFileManager::GetDirectorySpaceUsed(directory, "\\.csv$", files, false, true);
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		std::ifstream file(files[i].name.c_str(), std::ios::binary);
+		std::ostringstream stream;
+		stream << file.rdbuf();
+		contents[files[i].name.substr(files[i].name.find_last_of("/\\") + 1)] = stream.str();
+	}
+	return contents;
+}
+
+TEST(DeviceLogCSV, ThreadedCopyTest)
+{
+	// Three devices of high rate data converted on one thread and on several must give the same files
+	ISFileManager::DeleteDirectory(CSV_TEST_DIRECTORY);
+	{
+		cISLogger logger;
+		ASSERT_TRUE(logger.InitSaveTimestamp("20230101_000000", CSV_TEST_DIRECTORY, "", 3, cISLogger::LOGTYPE_DAT, 0.5f, 1024 * 1024, false));
+		for (unsigned int dev = 0; dev < 3; dev++)
+		{
+			dev_info_t info = {};
+			info.serialNumber = 1000 + dev;
+			logger.SetDeviceInfo(&info, dev);
+		}
+		logger.EnableLogging(true);
+		for (int i = 0; i < 20000; i++)
+		{
+			for (unsigned int dev = 0; dev < 3; dev++)
+			{
+				pimu_t imu = {};
+				imu.time = 1000.0 + i * 0.001;
+				imu.theta[0] = dev + i * 1.0e-5f;
+				p_data_hdr_t hdr = { DID_PIMU, sizeof(pimu_t), 0 };
+				ASSERT_TRUE(logger.LogData(dev, &hdr, (uint8_t*)&imu));
+				if (i % 5 == 0)
+				{
+					ins_2_t ins = {};
+					ins.timeOfWeek = 1000.0 + i * 0.001;
+					ins.lla[0] = 40.0 + dev + i * 1.0e-7;
+					hdr = { DID_INS_2, sizeof(ins_2_t), 0 };
+					ASSERT_TRUE(logger.LogData(dev, &hdr, (uint8_t*)&ins));
+				}
+				if (i % 200 == 0)
+				{
+					gps_pos_t gps = {};
+					gps.timeOfWeekMs = 1000000 + i;
+					hdr = { DID_GPS1_POS, sizeof(gps_pos_t), 0 };
+					ASSERT_TRUE(logger.LogData(dev, &hdr, (uint8_t*)&gps));
+				}
+			}
+		}
+		logger.CloseAllFiles();
+	}
+
+	const char* directories[2] = { CSV_TEST_DIRECTORY "_1", CSV_TEST_DIRECTORY "_4" };
+	const uint32_t threads[2] = { 1, 4 };
+	uint64_t counts[2];
+	for (int i = 0; i < 2; i++)
+	{
+		ISFileManager::DeleteDirectory(directories[i]);
+		cISLogger log;
+		ASSERT_TRUE(log.LoadFromDirectory(CSV_TEST_DIRECTORY));
+		ASSERT_EQ(3u, log.GetDeviceCount());
+		cISLogger copy;
+		copy.SetCopyThreads(threads[i]);
+		ASSERT_TRUE(copy.CopyLog(log, "20230101_000000", directories[i], cISLogger::LOGTYPE_CSV, 0.5f, 300000, false));
+		counts[i] = copy.GetStats().count;
+	}
+	EXPECT_EQ(counts[0], counts[1]);
+	EXPECT_EQ(3u * (20000 + 4000 * 2 + 100), counts[0]);		// INS_2 is also written as INS_1
+
+	std::map<std::string, std::string> single = readLogFiles(directories[0]);
+	std::map<std::string, std::string> threaded = readLogFiles(directories[1]);
+	EXPECT_GT(single.size(), 3u * 4);
+	EXPECT_EQ(single.size(), threaded.size());
+	EXPECT_TRUE(single == threaded);
+
+	ISFileManager::DeleteDirectory(CSV_TEST_DIRECTORY);
+	ISFileManager::DeleteDirectory(directories[0]);
+	ISFileManager::DeleteDirectory(directories[1]);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "../DeviceLogColumnar.h"
+#include "../ISFileManager.h"
+
+#define COLUMNAR_TEST_DIRECTORY	"test_columnar_log"
+#define COLUMNAR_TEST_SERIAL	12345
+
+TEST(DeviceLogColumnar, WriteReadTest)
+{
+	ISFileManager::DeleteDirectory(COLUMNAR_TEST_DIRECTORY);
+
+	// Interleaved INS and GPS data, small files so each data set rolls over several times
+	std::vector<p_data_t> written;
+	{
+		cDeviceLogColumnar log;
+		log.InitDeviceForWriting(0, "20230101_000000", COLUMNAR_TEST_DIRECTORY, 100 * 1024 * 1024, 300000);
+		log.SetSerialNumber(COLUMNAR_TEST_SERIAL);
+
+		for (int i = 0; i < 20000; i++)
+		{
+			p_data_t data = {};
+			if (i % 5 == 4)
+			{
+				gps_pos_t& gps = *(gps_pos_t*)data.buf;
+				gps.timeOfWeekMs = 200 * i;
+				gps.week = 2250;
+				gps.status = i;
+				gps.lla[0] = 40.0 + i * 1.0e-7;
+				gps.hMSL = 1400.0f + i * 0.01f;
+				data.hdr.id = DID_GPS1_POS;
+				data.hdr.size = sizeof(gps_pos_t);
+			}
+			else
+			{
+				ins_2_t& ins = *(ins_2_t*)data.buf;
+				ins.timeOfWeek = 0.01 * i;
+				ins.week = 2250;
+				ins.insStatus = i;
+				ins.qn2b[1] = i * 0.001f;
+				ins.lla[2] = 1400.0 + i;
+				data.hdr.id = DID_INS_2;
+				data.hdr.size = sizeof(ins_2_t);
+			}
+			ASSERT_TRUE(log.SaveData(&data.hdr, data.buf));
+			written.push_back(data);
+		}
+		log.CloseAllFiles();
+	}
+
+	std::vector<ISFileManager::file_info_t> files;
+	ISFileManager::GetDirectorySpaceUsed(COLUMNAR_TEST_DIRECTORY, "_DID_INS_2\\.icol$", files, false, false);
+	EXPECT_GT(files.size(), 2u);
+
+	// Data sets are merged back in write order
+	cDeviceLogColumnar log;
+	log.SetupReadInfo(COLUMNAR_TEST_DIRECTORY, std::to_string(COLUMNAR_TEST_SERIAL), "20230101_000000");
+	log.InitDeviceForReading();
+	size_t count = 0;
+	p_data_t* data;
+	while ((data = log.ReadData()) != NULL && count < written.size())
+	{
+		ASSERT_EQ(written[count].hdr.id, data->hdr.id);
+		ASSERT_EQ(written[count].hdr.size, data->hdr.size);
+		ASSERT_EQ(0, memcmp(written[count].buf, data->buf, data->hdr.size)) << "record " << count;
+		count++;
+	}
+	EXPECT_EQ(written.size(), count);
+	log.CloseAllFiles();
+
+	ISFileManager::DeleteDirectory(COLUMNAR_TEST_DIRECTORY);
+}
+
+TEST(DeviceLogColumnar, PartialDataSetTest)
+{
+	ISFileManager::DeleteDirectory(COLUMNAR_TEST_DIRECTORY);
+	{
+		cDeviceLogColumnar log;
+		log.InitDeviceForWriting(0, "20230101_000000", COLUMNAR_TEST_DIRECTORY, 100 * 1024 * 1024, 300000);
+		log.SetSerialNumber(COLUMNAR_TEST_SERIAL);
+		uint32_t week = 2250;
+		p_data_hdr_t hdr = { DID_INS_2, sizeof(week), offsetof(ins_2_t, week) };
+		ASSERT_TRUE(log.SaveData(&hdr, (uint8_t*)&week));
+		log.CloseAllFiles();
+	}
+
+	cDeviceLogColumnar log;
+	log.SetupReadInfo(COLUMNAR_TEST_DIRECTORY, std::to_string(COLUMNAR_TEST_SERIAL), "20230101_000000");
+	log.InitDeviceForReading();
+	p_data_t* data = log.ReadData();
+	ASSERT_TRUE(data != NULL);
+	EXPECT_EQ((uint32_t)DID_INS_2, data->hdr.id);
+	EXPECT_EQ(sizeof(ins_2_t), data->hdr.size);
+	EXPECT_EQ(2250u, ((ins_2_t*)data->buf)->week);
+	EXPECT_EQ(0.0, ((ins_2_t*)data->buf)->timeOfWeek);
+	EXPECT_TRUE(log.ReadData() == NULL);
+	log.CloseAllFiles();
+
+	ISFileManager::DeleteDirectory(COLUMNAR_TEST_DIRECTORY);
+}
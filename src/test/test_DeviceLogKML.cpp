@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../DeviceLogKML.h"
+#include "../ISFileManager.h"
+#include "../tinyxml.h"
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+#define KML_TEST_DIRECTORY	"test_kml_log"
+
+// INS samples along a straight line with one 5 m offset at sample 500, dead reckoning every third 1000 samples
+static void writeKmlLog(const char* directory, int count, uint32_t maxFileSize, double decimation, bool kmz)
+{
+	ISFileManager::DeleteDirectory(directory);
+
+	cDeviceLogKML log;
+	log.InitDeviceForWriting(0, "20230101_000000", directory, 100 * 1024 * 1024, maxFileSize);
+	log.SetSerialNumber(12345);
+	log.SetKmlConfig(false, true, true, true, 1.0, false);
+	log.SetKmlOutput(decimation, kmz);
+
+	for (int i = 0; i < count; i++)
+	{
+		ins_2_t ins = {};
+		ins.timeOfWeek = 1000.0 + 0.01 * i;
+		ins.week = 2250;
+		ins.insStatus = ((i / 1000) % 3 == 2) ? 0 : INS_STATUS_GPS_AIDING_POS;
+		ins.qn2b[0] = 0.7071f;
+		ins.qn2b[3] = (i % 200 < 100) ? 0.0f : 0.7071f;
+		ins.lla[0] = 40.0 + 1.0e-7 * i;
+		ins.lla[1] = -111.0 + (i == 500 ? 5.0 / (C_DEG2RAD * C_WGS84_a * cos(40.0 * C_DEG2RAD)) : 0.0);
+		ins.lla[2] = 1400.0;
+		p_data_hdr_t hdr = { DID_INS_2, sizeof(ins_2_t), 0 };
+		EXPECT_TRUE(log.SaveData(&hdr, (uint8_t*)&ins));
+	}
+	log.CloseAllFiles();
+}
+
+static std::vector<std::string> kmlFiles(const char* directory, const char* extension)
+{
+	std::vector<ISFileManager::file_info_t> files;
+	ISFileManager::GetDirectorySpaceUsed(directory, std::string("\\") + extension + "$", files, false, true);
+	std::vector<std::string> names;
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		names.push_back(files[i].name);
+	}
+	std::sort(names.begin(), names.end());
+	return names;
+}
+
+#ifdef USE_ZLIB
+static std::string readFile(const std::string& fileName)
+{
+	std::ifstream file(fileName.c_str(), std::ios::binary);
+	std::ostringstream stream;
+	stream << file.rdbuf();
+	return stream.str();
+}
+#endif
+
+// Count point placemarks and track coordinates in a KML document
+static void countKml(TiXmlDocument& doc, int& points, int& coordinates, int& tracks)
+{
+	TiXmlElement* document = doc.FirstChildElement("kml")->FirstChildElement("Document");
+	ASSERT_TRUE(document != NULL);
+	for (TiXmlElement* placemark = document->FirstChildElement("Placemark"); placemark; placemark = placemark->NextSiblingElement("Placemark"))
+	{
+		if (placemark->FirstChildElement("Point"))
+		{
+			points++;
+			continue;
+		}
+		TiXmlElement* lineString = placemark->FirstChildElement("LineString");
+		ASSERT_TRUE(lineString != NULL);
+		std::istringstream stream(lineString->FirstChildElement("coordinates")->GetText());
+		std::string coordinate;
+		while (stream >> coordinate)
+		{
+			coordinates++;
+		}
+		tracks++;
+	}
+}
+
+TEST(DeviceLogKML, StreamingWriteTest)
+{
+	const int count = 10000;
+	writeKmlLog(KML_TEST_DIRECTORY, count, 300000, 0.0, false);
+
+	// Files roll over at the max file size and the staged track files are removed
+	std::vector<std::string> files = kmlFiles(KML_TEST_DIRECTORY, ".kml");
+	EXPECT_GT(files.size(), 3u);
+	EXPECT_EQ(0u, kmlFiles(KML_TEST_DIRECTORY, ".tracks").size());
+
+	int points = 0, coordinates = 0, tracks = 0;
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		TiXmlDocument doc;
+		ASSERT_TRUE(doc.LoadFile(files[i].c_str())) << files[i];
+		countKml(doc, points, coordinates, tracks);
+	}
+	EXPECT_EQ(count, coordinates);
+	EXPECT_GE(points, count / 100);
+	EXPECT_LE(points, count / 100 + (int)files.size());
+	EXPECT_GE(tracks, 10);
+
+	ISFileManager::DeleteDirectory(KML_TEST_DIRECTORY);
+}
+
+TEST(DeviceLogKML, DecimationTest)
+{
+	const int count = 3000;
+	writeKmlLog(KML_TEST_DIRECTORY, count, 100 * 1024 * 1024, 0.5, false);
+
+	std::vector<std::string> files = kmlFiles(KML_TEST_DIRECTORY, ".kml");
+	ASSERT_EQ(1u, files.size());
+	TiXmlDocument doc;
+	ASSERT_TRUE(doc.LoadFile(files[0].c_str()));
+	int points = 0, coordinates = 0, tracks = 0;
+	countKml(doc, points, coordinates, tracks);
+	EXPECT_EQ(count / 100, points);
+	EXPECT_EQ(2, tracks);
+
+	// Straight segments keep their end points, the offset sample and its neighbors are kept
+	EXPECT_GE(coordinates, 2 * tracks + 3);
+	EXPECT_LE(coordinates, 2 * tracks + 3 + 2 * (count / KML_DECIMATION_WINDOW));
+	char offset[100];
+	snprintf(offset, sizeof(offset), "%.8lf,%.8lf", -111.0 + 5.0 / (C_DEG2RAD * C_WGS84_a * cos(40.0 * C_DEG2RAD)), 40.0 + 1.0e-7 * 500);
+	TiXmlPrinter printer;
+	doc.Accept(&printer);
+	EXPECT_NE(std::string::npos, std::string(printer.CStr()).find(offset));
+
+	ISFileManager::DeleteDirectory(KML_TEST_DIRECTORY);
+}
+
+#ifdef USE_ZLIB
+TEST(DeviceLogKML, KmzTest)
+{
+	const int count = 5000;
+	writeKmlLog(KML_TEST_DIRECTORY "_kml", count, 100 * 1024 * 1024, 0.0, false);
+	writeKmlLog(KML_TEST_DIRECTORY, count, 100 * 1024 * 1024, 0.0, true);
+
+	std::vector<std::string> kml = kmlFiles(KML_TEST_DIRECTORY "_kml", ".kml");
+	std::vector<std::string> kmz = kmlFiles(KML_TEST_DIRECTORY, ".kmz");
+	ASSERT_EQ(1u, kml.size());
+	ASSERT_EQ(1u, kmz.size());
+	EXPECT_EQ(0u, kmlFiles(KML_TEST_DIRECTORY, ".kml").size());
+
+	std::string expected = readFile(kml[0]);
+	std::string zip = readFile(kmz[0]);
+	EXPECT_LT(zip.size(), expected.size() / 4);
+
+	// Single deflated entry followed by the central directory
+	const uint8_t* p = (const uint8_t*)zip.data();
+	ASSERT_GT(zip.size(), 30u + 22u);
+	EXPECT_EQ(0x04034b50u, *(uint32_t*)p);
+	EXPECT_EQ(Z_DEFLATED, *(uint16_t*)(p + 8));
+	uint32_t crc = *(uint32_t*)(p + 14);
+	uint32_t compressedSize = *(uint32_t*)(p + 18);
+	uint32_t size = *(uint32_t*)(p + 22);
+	uint16_t nameSize = *(uint16_t*)(p + 26);
+	EXPECT_EQ(std::string(KMZ_DOC_NAME), std::string((const char*)p + 30, nameSize));
+	EXPECT_EQ(expected.size(), size);
+	EXPECT_EQ(0x06054b50u, *(uint32_t*)(p + zip.size() - 22));
+
+	std::string doc(size, '\0');
+	z_stream zs = {};
+	ASSERT_EQ(Z_OK, inflateInit2(&zs, -MAX_WBITS));
+	zs.next_in = (Bytef*)p + 30 + nameSize;
+	zs.avail_in = compressedSize;
+	zs.next_out = (Bytef*)&doc[0];
+	zs.avail_out = size;
+	EXPECT_EQ(Z_STREAM_END, inflate(&zs, Z_FINISH));
+	inflateEnd(&zs);
+	EXPECT_EQ(crc, (uint32_t)crc32(0, (const Bytef*)doc.data(), size));
+	EXPECT_TRUE(expected == doc);
+
+	ISFileManager::DeleteDirectory(KML_TEST_DIRECTORY "_kml");
+	ISFileManager::DeleteDirectory(KML_TEST_DIRECTORY);
+}
+#endif
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "../DeviceLogSorted.h"
+#include "../ISFileManager.h"
+
+#define SORTED_TEST_DIRECTORY	"test_sorted_log"
+#define SORTED_TEST_SERIAL		12345
+
+// Writes a synthetic .sdat log with 40 interleaved DIDs and returns the written DID sequence
+static std::vector<uint32_t> writeSortedLog(int recordCount, uint32_t maxFileSize)
+{
+	std::vector<uint32_t> ids;
+	ISFileManager::DeleteDirectory(SORTED_TEST_DIRECTORY);
+
+	cDeviceLogSorted log;
+	log.InitDeviceForWriting(0, "20230101_000000", SORTED_TEST_DIRECTORY, 100 * 1024 * 1024, maxFileSize);
+	log.SetSerialNumber(SORTED_TEST_SERIAL);
+
+	uint32_t seed = 1;
+	uint8_t buf[64] = {};
+	for (int i = 0; i < recordCount; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		p_data_hdr_t hdr;
+		hdr.id = 2 + (seed >> 16) % 40;
+		hdr.size = 16 + 4 * (hdr.id % 8);
+		hdr.offset = 0;
+		memcpy(buf, &i, sizeof(i));
+		EXPECT_TRUE(log.SaveData(&hdr, buf));
+		ids.push_back(hdr.id);
+	}
+	log.CloseAllFiles();
+	return ids;
+}
+
+// Reads the log back and checks records come out in the order they were written
+static double readSortedLog(const std::vector<uint32_t>& ids)
+{
+	cDeviceLogSorted log;
+	log.SetupReadInfo(SORTED_TEST_DIRECTORY, std::to_string(SORTED_TEST_SERIAL), "20230101_000000");
+	log.InitDeviceForReading();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	size_t count = 0;
+	p_data_t* data;
+	while ((data = log.ReadData()) != NULL)
+	{
+		if (count < ids.size())
+		{
+			int index;
+			memcpy(&index, data->buf, sizeof(index));
+			EXPECT_EQ(ids[count], data->hdr.id);
+			EXPECT_EQ((int)count, index);
+		}
+		count++;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	EXPECT_EQ(ids.size(), count);
+	log.CloseAllFiles();
+	return seconds;
+}
+
+TEST(DeviceLogSorted, ReadOrderMatchesWriteOrderTest)
+{
+	// Small files so the DID chunks are spread across several files
+	std::vector<uint32_t> ids = writeSortedLog(50000, 200000);
+	readSortedLog(ids);
+	ISFileManager::DeleteDirectory(SORTED_TEST_DIRECTORY);
+}
+
+// Benchmark, not part of the default run, use --gtest_also_run_disabled_tests --gtest_filter=*Benchmark
+TEST(DeviceLogSorted, DISABLED_ReadBenchmark)
+{
+	const int recordCount = 1000000;
+	std::vector<uint32_t> ids = writeSortedLog(recordCount, 50 * 1024 * 1024);
+	double seconds = readSortedLog(ids);
+	printf("Sorted log read, 40 DIDs: %d records in %.3f s, %.2f M records/s\n", recordCount, seconds, recordCount / seconds * 1.0e-6);
+	ISFileManager::DeleteDirectory(SORTED_TEST_DIRECTORY);
+}
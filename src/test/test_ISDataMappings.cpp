@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <deque>
+#include <algorithm>
+#include <thread>
 #include "../ISDataMappings.h"
 
 using namespace std;
@@ -53,3 +55,195 @@ TEST(ISDataMappings, StringToDataToString)
 	}
 }
 
+
+
+// DataSetToString must match DataToString field by field, including partial packets
+TEST(ISDataMappings, DataSetToStringMatchesDataToString)
+{
+	uint32_t seed = 1;
+	vector<char> out;
+	for (uint32_t id = DID_NULL + 1; id < DID_COUNT; id++)
+	{
+		const data_serialize_plan_t* plan = cISDataMappings::GetSerializePlan(id);
+		const map_name_to_info_t& offsetMap = *cISDataMappings::GetMapInfo(id);
+		uint32_t size = cISDataMappings::GetSize(id);
+		ASSERT_TRUE(plan != NULL);
+		ASSERT_EQ(offsetMap.size(), plan->ops.size());
+		bool hasBinary = false;
+		for (size_t i = 0; i < plan->ops.size(); i++)
+		{
+			hasBinary |= (plan->ops[i].dataType == DataTypeBinary);
+		}
+		if (size == 0 || size > MAX_DATASET_SIZE || hasBinary)
+		{	// binary fields print from the start of the data set, see VariableToString
+			continue;
+		}
+
+		for (int k = 0; k < 20; k++)
+		{
+			uint8_t buf[MAX_DATASET_SIZE];
+			for (uint32_t i = 0; i < size; i++)
+			{
+				seed = seed * 1103515245 + 12345;
+				buf[i] = (uint8_t)(k % 3 == 0 ? (seed >> 16) % 4 : seed >> 16);
+			}
+			p_data_hdr_t hdr = { id, size, 0 };
+			if (k >= 10 && size >= 8)
+			{
+				hdr.offset = 4 * (k % (size / 8));
+				hdr.size = size - hdr.offset - 4 * (k % 2);
+			}
+
+			// Expected output from the map, with missing fields zero
+			uint8_t dataSet[MAX_DATASET_SIZE] = {};
+			memcpy(dataSet + hdr.offset, buf, hdr.size);
+			for (int json = 0; json < 2; json++)
+			{
+				string expected;
+				data_mapping_string_t tmp;
+				for (map_name_to_info_t::const_iterator i = offsetMap.begin(); i != offsetMap.end(); i++)
+				{
+					cISDataMappings::DataToString(i->second, NULL, dataSet, tmp, json != 0);
+					if (json)
+					{
+						expected += ",\"" + i->second.name + "\":";
+					}
+					else if (i != offsetMap.begin())
+					{
+						expected += ",";
+					}
+					expected += tmp;
+				}
+
+				out.resize(plan->maxStringLength + 1);
+				int length = cISDataMappings::DataSetToString(hdr, buf, out.data(), json != 0);
+				ASSERT_EQ((int)strlen(out.data()), length);
+				EXPECT_EQ(expected, string(out.data(), length)) << cISDataMappings::GetDataSetName(id);
+			}
+		}
+	}
+}
+
+
+TEST(ISDataMappings, FieldToVariable)
+{
+	// Fields are not null terminated
+	const char* line = "-42,0x1F,3.25e2,0.1,nan,\"text\"";
+	int8_t i8;
+	uint32_t u32;
+	double d;
+	float f;
+	char text[8];
+	EXPECT_TRUE(cISDataMappings::FieldToVariable(line, 3, (uint8_t*)&i8, DataTypeInt8, sizeof(i8)));
+	EXPECT_EQ(-42, i8);
+	EXPECT_TRUE(cISDataMappings::FieldToVariable(line + 4, 4, (uint8_t*)&u32, DataTypeUInt32, sizeof(u32)));
+	EXPECT_EQ(0x1Fu, u32);
+	EXPECT_TRUE(cISDataMappings::FieldToVariable(line + 9, 6, (uint8_t*)&d, DataTypeDouble, sizeof(d)));
+	EXPECT_EQ(325.0, d);
+	EXPECT_TRUE(cISDataMappings::FieldToVariable(line + 16, 3, (uint8_t*)&f, DataTypeFloat, sizeof(f)));
+	EXPECT_EQ(0.1f, f);
+	EXPECT_TRUE(cISDataMappings::FieldToVariable(line + 20, 3, (uint8_t*)&d, DataTypeDouble, sizeof(d)));
+	EXPECT_TRUE(d != d);
+	EXPECT_TRUE(cISDataMappings::FieldToVariable(line + 25, 4, (uint8_t*)text, DataTypeString, sizeof(text)));
+	EXPECT_STREQ("text", text);
+
+	// Numbers match strtod and strtof as written by DataToString
+	uint32_t seed = 1;
+	for (int i = 0; i < 100000; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		double value = ((int32_t)seed) * pow(10.0, (int)(seed % 41) - 25);
+		char str[64];
+		int length = SNPRINTF(str, sizeof(str), (i & 1 ? "%.17g," : "%.9g,"), value);
+		EXPECT_TRUE(cISDataMappings::FieldToVariable(str, length - 1, (uint8_t*)&d, DataTypeDouble, sizeof(d)));
+		EXPECT_EQ(strtod(str, NULL), d) << str;
+		EXPECT_TRUE(cISDataMappings::FieldToVariable(str, length - 1, (uint8_t*)&f, DataTypeFloat, sizeof(f)));
+		EXPECT_EQ(strtof(str, NULL), f) << str;
+	}
+}
+
+
+// Name lookups match the map, which compares field names without case
+TEST(ISDataMappings, FieldAndDataSetLookup)
+{
+	for (uint32_t id = DID_NULL + 1; id < DID_COUNT; id++)
+	{
+		const char* name = cISDataMappings::GetDataSetName(id);
+		if (name[0] != '\0')
+		{
+			EXPECT_EQ(id, cISDataMappings::GetDataSetId(name)) << name;
+		}
+
+		const map_name_to_info_t& offsetMap = *cISDataMappings::GetMapInfo(id);
+		data_fields_t fields = cISDataMappings::GetFields(id);
+		ASSERT_EQ(offsetMap.size(), fields.count) << name;
+		for (size_t i = 1; i < fields.count; i++)
+		{	// struct order
+			EXPECT_LE(fields.fields[i - 1].dataOffset, fields.fields[i].dataOffset) << name;
+		}
+		for (map_name_to_info_t::const_iterator i = offsetMap.begin(); i != offsetMap.end(); i++)
+		{
+			const data_info_t* info = cISDataMappings::GetFieldInfo(id, i->first);
+			ASSERT_TRUE(info != NULL) << name << " " << i->first;
+			EXPECT_TRUE(info >= fields.fields && info < fields.fields + fields.count);
+			EXPECT_EQ(i->second.name, info->name);
+			EXPECT_EQ(i->second.dataOffset, info->dataOffset);
+
+			string upper = i->first;
+			transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+			EXPECT_EQ(info, cISDataMappings::GetFieldInfo(id, upper));
+
+			// not null terminated
+			string longer = i->first + "x";
+			EXPECT_EQ(info, cISDataMappings::GetFieldInfo(id, longer.data(), i->first.size()));
+			EXPECT_TRUE(cISDataMappings::GetFieldInfo(id, longer) == NULL);
+		}
+	}
+
+	EXPECT_EQ((uint32_t)DID_INS_1, cISDataMappings::GetDataSetId(string("DID_INS_1")));
+	EXPECT_EQ(0u, cISDataMappings::GetDataSetId(string("did_ins_1")));
+	EXPECT_EQ(0u, cISDataMappings::GetDataSetId(string("DID_INS_")));
+	EXPECT_EQ(0u, cISDataMappings::GetDataSetId(string("")));
+	EXPECT_TRUE(cISDataMappings::GetFieldInfo(DID_INS_1, string("notAField")) == NULL);
+	EXPECT_TRUE(cISDataMappings::GetFieldInfo(DID_COUNT, string("timeOfWeek")) == NULL);
+	EXPECT_EQ(0u, cISDataMappings::GetFields(DID_COUNT).count);
+
+	const data_info_t* info = cISDataMappings::GetFieldInfo(DID_INS_1, string("timeofweek"));
+	ASSERT_TRUE(info != NULL);
+	EXPECT_EQ(offsetof(ins_1_t, timeOfWeek), info->dataOffset);
+}
+
+
+// Mappings are populated per data set on first use, which may happen on several threads at once
+TEST(ISDataMappings, ConcurrentFirstUse)
+{
+	const int threadCount = 4;
+	vector<const data_info_t*> found[threadCount];
+	vector<thread> threads;
+	for (int t = 0; t < threadCount; t++)
+	{
+		threads.push_back(thread([t, &found]()
+		{
+			for (uint32_t i = 0; i < DID_COUNT; i++)
+			{
+				uint32_t id = (i + t * 7) % DID_COUNT;	// start at different data sets
+				data_fields_t fields = cISDataMappings::GetFields(id);
+				for (size_t f = 0; f < fields.count; f++)
+				{
+					found[t].push_back(cISDataMappings::GetFieldInfo(id, fields.fields[f].name));
+				}
+			}
+		}));
+	}
+	for (size_t t = 0; t < threads.size(); t++)
+	{
+		threads[t].join();
+	}
+	ASSERT_NE(0u, found[0].size());
+	for (int t = 1; t < threadCount; t++)
+	{
+		ASSERT_EQ(found[0].size(), found[t].size());
+		EXPECT_TRUE(std::is_permutation(found[0].begin(), found[0].end(), found[t].begin()));
+	}
+	EXPECT_TRUE(std::find(found[0].begin(), found[0].end(), (const data_info_t*)NULL) == found[0].end());
+}
@@ -0,0 +1,449 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include "../com_manager.h"
+#include "../ISDeviceIngest.h"
+#include "../ISUtilities.h"
+#include "../serialPortPlatform.h"
+
+#if PLATFORM_IS_LINUX
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace std;
+
+static double NowSeconds()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Pseudo terminal standing in for a device, the device writes the master and the serial port opens the slave end
+struct sPtyDevice
+{
+	int master = -1;
+	serial_port_t port;
+
+	bool Open()
+	{
+		master = posix_openpt(O_RDWR | O_NOCTTY);
+		if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+		{
+			return false;
+		}
+		serialPortPlatformInit(&port);
+		return serialPortOpen(&port, ptsname(master), 921600, 0) == 1;
+	}
+
+	~sPtyDevice()
+	{
+		serialPortClose(&port);
+		if (master >= 0)
+		{
+			close(master);
+		}
+	}
+
+	void WriteData(uint32_t dataId, uint32_t size, void* data)
+	{
+		uint8_t buf[PKT_BUF_SIZE];
+		is_comm_instance_t comm;
+		is_comm_init(&comm, buf, sizeof(buf));
+		int n = is_comm_data(&comm, dataId, 0, size, data);
+		ASSERT_EQ(n, (int)write(master, buf, n));
+	}
+
+	// DID_INS_1 with a GPS time of week, and the host time it was sent in lla[0]
+	void WriteIns1(uint32_t sequence, double timeOfWeek)
+	{
+		ins_1_t ins1 = {};
+		ins1.week = sequence;
+		ins1.timeOfWeek = timeOfWeek;
+		ins1.lla[0] = NowSeconds();
+		WriteData(DID_INS_1, sizeof(ins_1_t), &ins1);
+	}
+
+	// DID_PIMU stamped with the host time it was sent, standing in for time since boot
+	void WritePimu()
+	{
+		pimu_t pimu = {};
+		pimu.time = NowSeconds();
+		WriteData(DID_PIMU, sizeof(pimu_t), &pimu);
+	}
+};
+
+struct sReceived
+{
+	int device;
+	uint32_t sequence;
+	double timeOfWeek;
+	double latencyUs;
+};
+
+// Com manager fed by the ingest, the same as InertialSense::StepDeviceIngest
+static cISDeviceIngest* s_ingest;
+static vector<sReceived> s_received;
+
+static int ingestRead(CMHANDLE cmHandle, int pHandle, uint8_t* buffer, int numberOfBytes)
+{
+	return s_ingest->Read(pHandle, buffer, numberOfBytes);
+}
+
+static void ingestPostRxRead(CMHANDLE cmHandle, int pHandle, p_data_t* data)
+{
+	if (data->hdr.id == DID_INS_1)
+	{
+		ins_1_t* ins1 = (ins_1_t*)data->buf;
+		s_received.push_back({ pHandle, ins1->week, ins1->timeOfWeek, (NowSeconds() - ins1->lla[0]) * 1.0e6 });
+	}
+	else if (data->hdr.id == DID_PIMU)
+	{
+		pimu_t* pimu = (pimu_t*)data->buf;
+		s_received.push_back({ pHandle, 0, 0.0, (NowSeconds() - pimu->time) * 1.0e6 });
+	}
+}
+
+struct sIngestComManager
+{
+	com_manager_t cm;
+	broadcast_msg_t broadcastMsg[MAX_NUM_BCAST_MSGS];
+	vector<com_manager_port_t> ports;
+
+	bool Init(cISDeviceIngest& ingest, int deviceCount)
+	{
+		s_ingest = &ingest;
+		s_received.clear();
+		ports.resize(deviceCount);
+		com_manager_init_t cmInit = {};
+		cmInit.broadcastMsg = broadcastMsg;
+		cmInit.broadcastMsgSize = sizeof(broadcastMsg);
+		return comManagerInitInstance(&cm, deviceCount, 0, 1, 0, ingestRead, 0, 0, ingestPostRxRead, 0, 0, &cmInit, ports.data()) == 0;
+	}
+
+	void Step()
+	{
+		if (s_ingest->Wait(1))
+		{
+			int device;
+			while ((device = s_ingest->Next()) >= 0)
+			{
+				comManagerStepRxPortInstance(&cm, device);
+			}
+		}
+	}
+};
+
+static bool OpenDevices(vector<unique_ptr<sPtyDevice>>& devices, size_t count, vector<serial_port_t*>& ports)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		devices.push_back(unique_ptr<sPtyDevice>(new sPtyDevice()));
+		if (!devices.back()->Open())
+		{
+			return false;
+		}
+		ports.push_back(&devices.back()->port);
+	}
+	return true;
+}
+
+static bool WaitNext(cISDeviceIngest& ingest, int timeoutMs)
+{
+	double timeout = NowSeconds() + timeoutMs * 0.001;
+	while (!ingest.Wait(1))
+	{
+		if (NowSeconds() > timeout)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST(DeviceIngest, MergesDevicesInTimestampOrder)
+{
+	const int deviceCount = 4;
+	const uint32_t epochCount = 200;
+	vector<unique_ptr<sPtyDevice>> devices;
+	vector<serial_port_t*> ports;
+	ASSERT_TRUE(OpenDevices(devices, deviceCount, ports));
+	cISDeviceIngest ingest;
+	ingest.SetReorderWindow(100);
+	ASSERT_TRUE(ingest.Open(ports));
+	sIngestComManager cm;
+	ASSERT_TRUE(cm.Init(ingest, deviceCount));
+
+	// every device sends each epoch, at a different point in each 5 ms so they arrive in a different order every time
+	vector<thread> writers;
+	for (int d = 0; d < deviceCount; d++)
+	{
+		writers.push_back(thread([&, d]()
+		{
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			for (uint32_t k = 0; k < epochCount; k++)
+			{
+				this_thread::sleep_until(start + chrono::microseconds(k * 5000 + ((k * 7 + d * 3) % 4) * 1000));
+				devices[d]->WriteIns1(k, 1000.0 + k * 0.005);
+			}
+		}));
+	}
+	double timeout = NowSeconds() + 10.0;
+	while (s_received.size() < deviceCount * epochCount && NowSeconds() < timeout)
+	{
+		cm.Step();
+	}
+	for (size_t i = 0; i < writers.size(); i++)
+	{
+		writers[i].join();
+	}
+
+	ASSERT_EQ(deviceCount * epochCount, s_received.size());
+	vector<uint32_t> nextSequence(deviceCount, 0);
+	for (size_t i = 0; i < s_received.size(); i++)
+	{
+		if (i != 0)
+		{
+			ASSERT_LE(s_received[i - 1].timeOfWeek, s_received[i].timeOfWeek) << "packet " << i;
+		}
+		ASSERT_EQ(nextSequence[s_received[i].device]++, s_received[i].sequence);
+	}
+	for (int d = 0; d < deviceCount; d++)
+	{
+		cISDeviceIngest::device_stats_t stats = ingest.Stats(d);
+		EXPECT_EQ(epochCount, stats.packetCount);
+		EXPECT_EQ(0u, stats.dropCount);
+		EXPECT_EQ(0u, stats.rxErrorCount);
+	}
+	ingest.Close();
+}
+
+// A device that sends nothing holds the others back no longer than the reorder window
+TEST(DeviceIngest, QuietDeviceHeldAtMostReorderWindow)
+{
+	vector<unique_ptr<sPtyDevice>> devices;
+	vector<serial_port_t*> ports;
+	ASSERT_TRUE(OpenDevices(devices, 2, ports));
+	cISDeviceIngest ingest;
+	const uint32_t reorderWindowMs = 50;
+	ingest.SetReorderWindow(reorderWindowMs);
+	ASSERT_TRUE(ingest.Open(ports));
+
+	// a device that has not sent GPS time yet is not waited for
+	uint8_t buf[PKT_BUF_SIZE];
+	double start = NowSeconds();
+	devices[0]->WriteIns1(0, 999.0);
+	ASSERT_TRUE(WaitNext(ingest, 5000));
+	EXPECT_LT((NowSeconds() - start) * 1000.0, (double)reorderWindowMs);
+	ASSERT_EQ(0, ingest.Next());
+	ASSERT_GT(ingest.Read(0, buf, sizeof(buf)), 0);
+	devices[1]->WriteIns1(0, 999.0);
+	ASSERT_TRUE(WaitNext(ingest, 5000));
+	ASSERT_EQ(1, ingest.Next());
+	ASSERT_GT(ingest.Read(1, buf, sizeof(buf)), 0);
+
+	start = NowSeconds();
+	devices[0]->WriteIns1(1, 1000.0);
+	ASSERT_TRUE(WaitNext(ingest, 5000));
+	double heldMs = (NowSeconds() - start) * 1000.0;
+	ASSERT_EQ(0, ingest.Next());
+	EXPECT_GE(heldMs, reorderWindowMs - 1.0);
+	EXPECT_LT(heldMs, 1000.0);
+	ASSERT_GT(ingest.Read(0, buf, sizeof(buf)), 0);
+
+	// a device that has already sent a later packet is not waited for
+	devices[1]->WriteIns1(1, 1000.3);
+	ASSERT_TRUE(WaitNext(ingest, 5000));
+	ASSERT_EQ(1, ingest.Next());
+	ASSERT_GT(ingest.Read(1, buf, sizeof(buf)), 0);
+	start = NowSeconds();
+	devices[0]->WriteIns1(2, 1000.2);
+	ASSERT_TRUE(WaitNext(ingest, 5000));
+	EXPECT_LT((NowSeconds() - start) * 1000.0, (double)reorderWindowMs);
+	EXPECT_EQ(0, ingest.Next());
+	ingest.Close();
+}
+
+// IMU data stamped with time since boot is not ordered against GPS time of week from another device, so neither is held
+TEST(DeviceIngest, DifferentTimeBasesNotHeld)
+{
+	vector<unique_ptr<sPtyDevice>> devices;
+	vector<serial_port_t*> ports;
+	ASSERT_TRUE(OpenDevices(devices, 2, ports));
+	cISDeviceIngest ingest;
+	const uint32_t reorderWindowMs = 100;
+	ingest.SetReorderWindow(reorderWindowMs);
+	ASSERT_TRUE(ingest.Open(ports));
+	sIngestComManager cm;
+	ASSERT_TRUE(cm.Init(ingest, 2));
+
+	const uint32_t epochCount = 100;
+	thread writer([&]()
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		for (uint32_t k = 0; k < epochCount; k++)
+		{
+			this_thread::sleep_until(start + chrono::milliseconds(k * 10));
+			devices[0]->WritePimu();
+			devices[1]->WriteIns1(k, 1000.0 + k * 0.01);
+		}
+	});
+	double timeout = NowSeconds() + 10.0;
+	while (s_received.size() < 2 * epochCount && NowSeconds() < timeout)
+	{
+		cm.Step();
+	}
+	writer.join();
+
+	ASSERT_EQ(2 * epochCount, s_received.size());
+	vector<double> latenciesUs[2];
+	for (size_t i = 0; i < s_received.size(); i++)
+	{
+		latenciesUs[s_received[i].device].push_back(s_received[i].latencyUs);
+	}
+	for (int d = 0; d < 2; d++)
+	{
+		ASSERT_EQ(epochCount, latenciesUs[d].size());
+		sort(latenciesUs[d].begin(), latenciesUs[d].end());
+		EXPECT_LT(latenciesUs[d][epochCount / 2], reorderWindowMs * 1000.0 / 2) << "device " << d;
+	}
+	ingest.Close();
+}
+
+// A device whose GPS times are behind the others does not keep their packets waiting longer than the reorder window
+TEST(DeviceIngest, HeldPacketsGoInArrivalOrder)
+{
+	vector<unique_ptr<sPtyDevice>> devices;
+	vector<serial_port_t*> ports;
+	ASSERT_TRUE(OpenDevices(devices, 2, ports));
+	cISDeviceIngest ingest;
+	const uint32_t reorderWindowMs = 20;
+	ingest.SetReorderWindow(reorderWindowMs);
+	ASSERT_TRUE(ingest.Open(ports));
+
+	// device 0 is a week behind device 1, its packets all have earlier times
+	const uint32_t burstCount = 200;
+	for (uint32_t k = 0; k < burstCount; k++)
+	{
+		devices[0]->WriteIns1(k, 100.0 + k * 0.01);
+	}
+	SLEEP_MS(30);
+	devices[1]->WriteIns1(0, 1000.0);
+	SLEEP_MS(5);
+	for (uint32_t k = burstCount; k < 2 * burstCount; k++)
+	{
+		devices[0]->WriteIns1(k, 100.0 + k * 0.01);
+	}
+	for (int i = 0; i < 5000 && ingest.Stats(0).packetCount + ingest.Stats(1).packetCount < 2 * burstCount + 1; i++)
+	{
+		SLEEP_MS(1);
+	}
+	SLEEP_MS(2 * reorderWindowMs);
+
+	vector<int> order;
+	uint8_t buf[PKT_BUF_SIZE];
+	int device;
+	while ((device = ingest.Next()) >= 0)
+	{
+		ASSERT_GT(ingest.Read(device, buf, sizeof(buf)), 0);
+		order.push_back(device);
+	}
+	ASSERT_EQ(2 * burstCount + 1, order.size());
+	EXPECT_EQ(1, order[burstCount]);
+	EXPECT_EQ(0u, ingest.Stats(0).dropCount);
+	ingest.Close();
+}
+
+// Time from a device sending a packet to it being handled, reading the ports one after another with a 1 ms timeout as
+// comManagerStep does, compared to the ingest, as the number of devices grows.  Benchmark, not part of the default run,
+// use --gtest_also_run_disabled_tests --gtest_filter=*Benchmark
+TEST(DeviceIngest, DISABLED_LatencyBenchmark)
+{
+	const size_t deviceCounts[] = { 1, 4, 16 };
+	const uint32_t epochCount = 200;
+	double p50Us[2][3];
+	for (int ingestMode = 0; ingestMode < 2; ingestMode++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			size_t deviceCount = deviceCounts[c];
+			vector<unique_ptr<sPtyDevice>> devices;
+			vector<serial_port_t*> ports;
+			ASSERT_TRUE(OpenDevices(devices, deviceCount, ports));
+			cISDeviceIngest ingest;
+			if (ingestMode)
+			{
+				ASSERT_TRUE(ingest.Open(ports));
+			}
+			sIngestComManager cm;
+			ASSERT_TRUE(cm.Init(ingest, (int)deviceCount));
+			vector<is_comm_instance_t> comms(deviceCount);
+			vector<vector<uint8_t>> commBuffers(deviceCount, vector<uint8_t>(PKT_BUF_SIZE));
+			for (size_t d = 0; d < deviceCount; d++)
+			{
+				is_comm_init(&comms[d], commBuffers[d].data(), PKT_BUF_SIZE);
+			}
+
+			// devices send the same 100 Hz epochs together, as GPS synchronized devices do
+			vector<thread> writers;
+			for (size_t d = 0; d < deviceCount; d++)
+			{
+				writers.push_back(thread([&, d]()
+				{
+					chrono::steady_clock::time_point start = chrono::steady_clock::now();
+					for (uint32_t k = 0; k < epochCount; k++)
+					{
+						this_thread::sleep_until(start + chrono::milliseconds(k * 10));
+						devices[d]->WriteIns1(k, 1000.0 + k * 0.01);
+					}
+				}));
+			}
+			double timeout = NowSeconds() + 20.0;
+			while (s_received.size() < deviceCount * epochCount && NowSeconds() < timeout)
+			{
+				if (ingestMode)
+				{
+					cm.Step();
+					continue;
+				}
+				for (size_t d = 0; d < deviceCount; d++)
+				{
+					is_comm_instance_t* comm = &comms[d];
+					int n = serialPortReadTimeout(ports[d], comm->buf.tail, is_comm_free(comm), 1);
+					comm->buf.tail += n;
+					double now = NowSeconds();
+					while (n > 0 && is_comm_parse(comm) != _PTYPE_NONE)
+					{
+						ins_1_t* ins1 = (ins_1_t*)comm->dataPtr;
+						s_received.push_back({ (int)d, ins1->week, ins1->timeOfWeek, (now - ins1->lla[0]) * 1.0e6 });
+					}
+				}
+			}
+			for (size_t i = 0; i < writers.size(); i++)
+			{
+				writers[i].join();
+			}
+			ingest.Close();
+
+			ASSERT_EQ(deviceCount * epochCount, s_received.size());
+			vector<double> latenciesUs;
+			for (size_t i = 0; i < s_received.size(); i++)
+			{
+				latenciesUs.push_back(s_received[i].latencyUs);
+			}
+			sort(latenciesUs.begin(), latenciesUs.end());
+			p50Us[ingestMode][c] = latenciesUs[latenciesUs.size() / 2];
+			printf("%s %2d devices: latency p50 %8.1f us, p90 %8.1f us, p99 %8.1f us, max %8.1f us\n", (ingestMode ? "ingest" : "polled"), (int)deviceCount,
+				p50Us[ingestMode][c], latenciesUs[latenciesUs.size() * 9 / 10], latenciesUs[latenciesUs.size() * 99 / 100], latenciesUs.back());
+		}
+	}
+
+	// polling waits out the read timeout of every quiet port in turn
+	EXPECT_LT(p50Us[1][2], p50Us[0][2]);
+}
+
+#endif
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "../ISLogColumns.h"
+#include "../ISLogger.h"
+#include "../ISFileManager.h"
+
+#define LOG_COLUMNS_TEST_DIRECTORY	"test_log_columns"
+
+TEST(LogColumns, AddTest)
+{
+	cISLogColumns columns;
+	EXPECT_FALSE(columns.Init(DID_INS_1, { "timeOfWeek", "notAField" }));
+	EXPECT_FALSE(columns.Init(DID_COUNT));
+	ASSERT_TRUE(columns.Init(DID_INS_1, { "LLA[2]", "timeofweek", "insStatus" }));
+	ASSERT_EQ(3u, columns.Columns().size());
+	EXPECT_EQ("timeOfWeek", columns.Columns()[1].info.name);
+
+	ins_1_t ins = {};
+	ins.timeOfWeek = 10.5;
+	ins.lla[2] = 1234.5;
+	ins.insStatus = 0x12345678;
+	p_data_hdr_t hdr = { DID_INS_1, sizeof(ins_1_t), 0 };
+	EXPECT_TRUE(columns.Add(hdr, (uint8_t*)&ins, ins.timeOfWeek));
+
+	// Partial packet without the lla, missing fields are zero
+	hdr.size = offsetof(ins_1_t, lla);
+	EXPECT_TRUE(columns.Add(hdr, (uint8_t*)&ins, ins.timeOfWeek));
+
+	hdr.id = DID_INS_2;
+	EXPECT_FALSE(columns.Add(hdr, (uint8_t*)&ins, 0.0));
+
+	ASSERT_EQ(2u, columns.RowCount());
+	const sLogColumn* lla = columns.Column("lla[2]");
+	ASSERT_TRUE(lla != NULL);
+	ASSERT_EQ(2u, lla->Count());
+	EXPECT_EQ(1234.5, lla->Values<double>()[0]);
+	EXPECT_EQ(0.0, lla->Values<double>()[1]);
+	EXPECT_EQ(0x12345678u, columns.Column("insStatus")->Values<uint32_t>()[1]);
+	EXPECT_EQ(10.5, columns.Timestamps()[1]);
+	EXPECT_TRUE(columns.Column("theta[0]") == NULL);
+
+	// All fields in struct order
+	ASSERT_TRUE(columns.Init(DID_INS_1));
+	EXPECT_EQ(cISDataMappings::GetFields(DID_INS_1).count, columns.Columns().size());
+	EXPECT_EQ(0u, columns.RowCount());
+}
+
+TEST(LogColumns, ReadTest)
+{
+	ISFileManager::DeleteDirectory(LOG_COLUMNS_TEST_DIRECTORY);
+
+	// 100 Hz PIMU and 10 Hz INS over 60 seconds
+	{
+		cISLogger logger;
+		logger.SetTimeIndex(true, 1000);
+		ASSERT_TRUE(logger.InitSaveTimestamp("20230101_000000", LOG_COLUMNS_TEST_DIRECTORY, "", 1, cISLogger::LOGTYPE_DAT, 0.5f, 100000, false));
+		dev_info_t info = {};
+		info.serialNumber = 12345;
+		logger.SetDeviceInfo(&info);
+		logger.EnableLogging(true);
+
+		for (int i = 1; i <= 6000; i++)
+		{
+			pimu_t pimu = {};
+			pimu.time = 0.01 * i;
+			pimu.theta[1] = (float)i;
+			p_data_hdr_t hdr = { DID_PIMU, sizeof(pimu_t), 0 };
+			ASSERT_TRUE(logger.LogData(0, &hdr, (uint8_t*)&pimu));
+			if (i % 10 == 0)
+			{
+				ins_1_t ins = {};
+				ins.timeOfWeek = 0.01 * i;
+				ins.lla[0] = i;
+				hdr = { DID_INS_1, sizeof(ins_1_t), 0 };
+				ASSERT_TRUE(logger.LogData(0, &hdr, (uint8_t*)&ins));
+			}
+		}
+		logger.CloseAllFiles();
+	}
+
+	{
+		cISLogger logger;
+		ASSERT_TRUE(logger.LoadFromDirectory(LOG_COLUMNS_TEST_DIRECTORY));
+		cISLogColumns pimu, ins;
+		ASSERT_TRUE(pimu.Init(DID_PIMU, { "theta[1]" }));
+		ASSERT_TRUE(ins.Init(DID_INS_1, { "timeOfWeek", "lla[0]" }));
+		EXPECT_EQ(6600u, cISLogColumns::Read(logger, 0, { &pimu, &ins }));
+		ASSERT_EQ(6000u, pimu.RowCount());
+		ASSERT_EQ(600u, ins.RowCount());
+		const float* theta = pimu.Columns()[0].Values<float>();
+		for (int i = 0; i < 6000; i++)
+		{
+			ASSERT_EQ((float)(i + 1), theta[i]);
+			ASSERT_NEAR(0.01 * (i + 1), pimu.Timestamps()[i], 1.0e-9);
+		}
+		const double* lla = ins.Column("lla[0]")->Values<double>();
+		const double* tow = ins.Column("timeOfWeek")->Values<double>();
+		for (int i = 0; i < 600; i++)
+		{
+			ASSERT_EQ(10.0 * (i + 1), lla[i]);
+			ASSERT_EQ(ins.Timestamps()[i], tow[i]);
+		}
+	}
+
+	{	// time range, seeking with the time index
+		cISLogger logger;
+		ASSERT_TRUE(logger.LoadFromDirectory(LOG_COLUMNS_TEST_DIRECTORY));
+		cISLogColumns ins;
+		ASSERT_TRUE(ins.Init(DID_INS_1, { "lla[0]" }));
+		EXPECT_EQ(101u, ins.Read(logger, 0, 30.0, 40.0));
+		ASSERT_EQ(101u, ins.RowCount());
+		EXPECT_NEAR(30.0, ins.Timestamps().front(), 1.0e-9);
+		EXPECT_NEAR(40.0, ins.Timestamps().back(), 1.0e-9);
+		EXPECT_EQ(3000.0, ins.Columns()[0].Values<double>()[0]);
+	}
+
+	ISFileManager::DeleteDirectory(LOG_COLUMNS_TEST_DIRECTORY);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <vector>
+#include "../ISConstants.h"
+
+#if PLATFORM_IS_LINUX
+#include <sys/stat.h>
+#include "../ISLogFileAsync.h"
+
+static std::vector<uint8_t> readFile(const char* path)
+{
+	std::vector<uint8_t> data;
+	FILE* f = fopen(path, "rb");
+	if (f)
+	{
+		uint8_t buf[4096];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+		{
+			data.insert(data.end(), buf, buf + n);
+		}
+		fclose(f);
+	}
+	return data;
+}
+
+TEST(LogFileAsync, WriteBehindMatchesInputTest)
+{
+	const char* paths[3] = { "test_async_log_0.dat", "test_async_log_1.dat", "test_async_log_2.dat" };
+	std::vector<uint8_t> expected[3];
+
+	// Several files open back to back like a log rollover, writes span many buffers
+	for (int f = 0; f < 3; f++)
+	{
+		cISLogFileAsync file(paths[f], "wb", 4 * 1024 * 1024, 10);
+		ASSERT_TRUE(file.isOpened());
+
+		uint32_t seed = 1234 + f;
+		for (int i = 0; i < 2000; i++)
+		{
+			uint8_t chunk[1500];
+			size_t len = 1 + (seed = seed * 1103515245 + 12345) % sizeof(chunk);
+			for (size_t j = 0; j < len; j++)
+			{
+				chunk[j] = (uint8_t)(seed >> (j % 24));
+			}
+			EXPECT_EQ(len, file.write(chunk, len));
+			expected[f].insert(expected[f].end(), chunk, chunk + len);
+		}
+		file.lprintf("end %d\n", f);
+		const char* tail = "end x\n";
+		expected[f].insert(expected[f].end(), tail, tail + 6);
+		expected[f][expected[f].size() - 2] = (uint8_t)('0' + f);
+
+		EXPECT_EQ((long int)expected[f].size(), file.tell());
+		EXPECT_TRUE(file.flush());
+		EXPECT_TRUE(file.good());
+	}
+
+	cISLogFileAsync::WaitForWrites();
+
+	for (int f = 0; f < 3; f++)
+	{
+		std::vector<uint8_t> actual = readFile(paths[f]);
+		ASSERT_EQ(expected[f].size(), actual.size());
+		EXPECT_TRUE(actual == expected[f]);
+		remove(paths[f]);
+	}
+}
+
+TEST(LogFileAsync, CloseReleasesPreallocatedSpaceTest)
+{
+	const char* path = "test_async_log_prealloc.dat";
+	{
+		cISLogFileAsync file(path, "wb", 16 * 1024 * 1024, 0);
+		ASSERT_TRUE(file.isOpened());
+		uint8_t chunk[4096] = {};
+		EXPECT_EQ(sizeof(chunk), file.write(chunk, sizeof(chunk)));
+	}
+	cISLogFileAsync::WaitForWrites();
+
+	struct stat st;
+	ASSERT_EQ(0, stat(path, &st));
+	EXPECT_EQ(4096, st.st_size);
+	EXPECT_LT((long long)st.st_blocks * 512, 1024 * 1024LL);
+	remove(path);
+}
+
+TEST(LogFileAsync, ReadModeRejectedTest)
+{
+	cISLogFileAsync file;
+	EXPECT_FALSE(file.open("test_async_log_r.dat", "rb"));
+	EXPECT_FALSE(file.isOpened());
+	EXPECT_EQ(0u, file.write("x", 1));
+}
+
+#endif
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "../ISConstants.h"
+
+#if PLATFORM_IS_LINUX || PLATFORM_IS_APPLE
+#include "../ISLogFileMapped.h"
+
+TEST(LogFileMapped, ReadMatchesFileTest)
+{
+	const char* path = "test_mapped_log.dat";
+	std::vector<uint8_t> expected(3 * MAPPED_LOG_FILE_READAHEAD + 123);
+	uint32_t seed = 42;
+	for (size_t i = 0; i < expected.size(); i++)
+	{
+		expected[i] = (uint8_t)((seed = seed * 1103515245 + 12345) >> 16);
+	}
+	FILE* f = fopen(path, "wb");
+	ASSERT_TRUE(f != NULL);
+	ASSERT_EQ(expected.size(), fwrite(expected.data(), 1, expected.size(), f));
+	fclose(f);
+
+	cISLogFileMapped file(path, "rb");
+	ASSERT_TRUE(file.isOpened());
+
+	size_t size;
+	const uint8_t* data = file.mappedData(size);
+	ASSERT_TRUE(data != NULL);
+	ASSERT_EQ(expected.size(), size);
+	EXPECT_EQ(0, memcmp(expected.data(), data, size));
+
+	// Sequential reads cross several read ahead windows
+	std::vector<uint8_t> actual;
+	uint8_t buf[7777];
+	size_t n;
+	while ((n = file.read(buf, sizeof(buf))) > 0)
+	{
+		actual.insert(actual.end(), buf, buf + n);
+	}
+	EXPECT_TRUE(actual == expected);
+	EXPECT_TRUE(file.eof() != 0);
+
+	// Seek and tell behave like stdio
+	EXPECT_EQ(0, file.seek(100, SEEK_SET));
+	EXPECT_EQ(100, file.tell());
+	EXPECT_EQ(expected[100], file.getch());
+	EXPECT_EQ(0, file.seek(-1, SEEK_END));
+	EXPECT_EQ(expected.back(), file.getch());
+	EXPECT_EQ(EOF, file.getch());
+
+	// Writes are rejected
+	EXPECT_EQ(0u, file.write("x", 1));
+
+	file.close();
+	remove(path);
+}
+
+TEST(LogFileMapped, EmptyAndMissingFileTest)
+{
+	cISLogFileMapped missing("test_mapped_missing.dat", "rb");
+	EXPECT_FALSE(missing.isOpened());
+
+	const char* path = "test_mapped_empty.dat";
+	FILE* f = fopen(path, "wb");
+	ASSERT_TRUE(f != NULL);
+	fclose(f);
+
+	cISLogFileMapped empty(path, "rb");
+	uint8_t buf[16];
+	EXPECT_EQ(0u, empty.read(buf, sizeof(buf)));
+	empty.close();
+	remove(path);
+}
+
+#endif
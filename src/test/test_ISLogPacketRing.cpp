@@ -0,0 +1,340 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include "../ISLogPacketRing.h"
+#include "../ISLogger.h"
+#include "../ISFileManager.h"
+
+#define PACKET_RING_TEST_DIRECTORY	"test_packet_ring_log"
+
+
+static void fillRecord(uint32_t seq, p_data_hdr_t &hdr, uint8_t *buf)
+{
+	hdr.id = seq % DID_COUNT;
+	hdr.size = 1 + (seq * 7) % 200;
+	hdr.offset = seq;
+	for (uint32_t i = 0; i < hdr.size; i++)
+	{
+		buf[i] = (uint8_t)(seq + i);
+	}
+}
+
+static bool checkRecord(const p_data_hdr_t *hdr, const uint8_t *buf)
+{
+	p_data_hdr_t ref;
+	uint8_t refBuf[256];
+	fillRecord(hdr->offset, ref, refBuf);
+	return ref.id == hdr->id && ref.size == hdr->size && memcmp(refBuf, buf, ref.size) == 0;
+}
+
+TEST(LogPacketRing, WrapAroundTest)
+{
+	cISLogPacketRing ring(1024);
+	p_data_hdr_t hdr;
+	uint8_t buf[256];
+	const uint8_t *data;
+	uint32_t pushed = 0, popped = 0;
+
+	// Push and pop with a few records queued so records land at every position, including the end of the buffer
+	for (int n = 0; n < 2000; n++)
+	{
+		while (true)
+		{
+			fillRecord(pushed, hdr, buf);
+			if (!ring.Push(&hdr, buf))
+			{
+				ring.Drop(&hdr);
+				break;
+			}
+			pushed++;
+		}
+
+		const p_data_hdr_t *rec = ring.Front(&data);
+		ASSERT_TRUE(rec != NULL);
+		EXPECT_EQ(popped, rec->offset);
+		EXPECT_TRUE(checkRecord(rec, data));
+		ring.Pop();
+		popped++;
+	}
+
+	cISLogPacketRing::stats_t stats = ring.Stats();
+	EXPECT_EQ(pushed, stats.pushCount);
+	EXPECT_EQ(pushed - popped, stats.depth);
+	EXPECT_GT(stats.dropCount, 0u);
+	EXPECT_LE(stats.peakBytes, stats.capacity);
+
+	while (ring.Front(&data) != NULL)
+	{
+		ring.Pop();
+	}
+	EXPECT_TRUE(ring.Empty());
+	EXPECT_EQ(0u, ring.Stats().bytes);
+}
+
+TEST(LogPacketRing, ProducerConsumerThreadTest)
+{
+	cISLogPacketRing ring(4096);
+	const uint32_t count = 200000;
+	uint64_t drops = 0;
+
+	std::thread producer([&]()
+	{
+		p_data_hdr_t hdr;
+		uint8_t buf[256];
+		for (uint32_t seq = 0; seq < count; seq++)
+		{
+			fillRecord(seq, hdr, buf);
+			while (!ring.Push(&hdr, buf))
+			{
+				std::this_thread::yield();
+			}
+			if (seq % 1000 == 0)
+			{
+				// Counted drops are separate from the queue
+				ring.Drop(&hdr);
+				drops++;
+			}
+		}
+	});
+
+	uint32_t expected = 0;
+	while (expected < count)
+	{
+		const uint8_t *data;
+		const p_data_hdr_t *rec = ring.Front(&data);
+		if (rec == NULL)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		ASSERT_EQ(expected, rec->offset);
+		ASSERT_TRUE(checkRecord(rec, data));
+		ring.Pop();
+		expected++;
+	}
+	producer.join();
+
+	cISLogPacketRing::stats_t stats = ring.Stats();
+	EXPECT_EQ(count, stats.pushCount);
+	EXPECT_EQ(drops, stats.dropCount);
+	EXPECT_EQ(0u, stats.depth);
+}
+
+TEST(LogPacketRing, DropCountersTest)
+{
+	cISLogPacketRing ring(1024);
+	p_data_hdr_t hdr = {};
+	uint8_t buf[64] = {};
+
+	hdr.id = DID_DEBUG_ARRAY;
+	hdr.size = sizeof(buf);
+	ring.Drop(&hdr);
+	ring.Drop(&hdr);
+	hdr.id = DID_INS_1;
+	EXPECT_TRUE(ring.Push(&hdr, buf));
+
+	// Consumer side discard counts against the queued data id
+	const uint8_t *data;
+	ASSERT_TRUE(ring.Front(&data) != NULL);
+	ring.Discard();
+	EXPECT_TRUE(ring.Empty());
+
+	EXPECT_TRUE(ring.DropsPending());
+	EXPECT_FALSE(ring.DropsPending());
+	EXPECT_EQ(2u, ring.TakeDataIdDrops(DID_DEBUG_ARRAY));
+	EXPECT_EQ(1u, ring.TakeDataIdDrops(DID_INS_1));
+	EXPECT_EQ(0u, ring.TakeDataIdDrops(DID_DEBUG_ARRAY));
+	EXPECT_EQ(3u, ring.Stats().dropCount);
+	EXPECT_EQ(1024u, ring.Capacity());
+}
+
+TEST(LogPacketRing, CapacityTest)
+{
+	EXPECT_EQ(1024u, cISLogPacketRing::CapacityFor(0));
+	EXPECT_EQ(4096u, cISLogPacketRing::CapacityFor(8191));
+	EXPECT_EQ(8192u, cISLogPacketRing::CapacityFor(8192));
+
+	// Records over half the ring are never queued, even when empty
+	cISLogPacketRing ring(cISLogPacketRing::CapacityFor(4096));
+	EXPECT_EQ(4096u, ring.Capacity());
+	p_data_hdr_t hdr = {};
+	uint8_t buf[MAX_DATASET_SIZE] = {};
+	hdr.id = DID_GPS1_RAW;
+	hdr.size = 2048;
+	EXPECT_FALSE(ring.Push(&hdr, buf));
+	hdr.size = MAX_DATASET_SIZE;
+	EXPECT_LE(2 * cISLogPacketRing::RecordSize(MAX_DATASET_SIZE), ring.Capacity());
+	EXPECT_TRUE(ring.Push(&hdr, buf));
+	EXPECT_TRUE(ring.Push(&hdr, buf));
+}
+
+TEST(LogPacketRing, DropOldestTest)
+{
+	cISLogPacketRing ring(1024);
+	p_data_hdr_t hdr;
+	uint8_t buf[256];
+
+	// Nothing is read, the newest records are kept
+	const uint32_t count = 100;
+	for (uint32_t seq = 0; seq < count; seq++)
+	{
+		fillRecord(seq, hdr, buf);
+		EXPECT_TRUE(ring.PushDropOldest(&hdr, buf));
+	}
+
+	uint32_t taken = 0;
+	uint32_t expected = 0;
+	while (ring.Take(&hdr, buf, sizeof(buf)))
+	{
+		if (taken == 0)
+		{
+			EXPECT_GT(hdr.offset, 0u);
+			expected = hdr.offset;
+		}
+		EXPECT_EQ(expected, hdr.offset);
+		EXPECT_TRUE(checkRecord(&hdr, buf));
+		expected++;
+		taken++;
+	}
+	EXPECT_EQ(count, expected);
+
+	cISLogPacketRing::stats_t stats = ring.Stats();
+	EXPECT_EQ(count, stats.pushCount);
+	EXPECT_EQ(count - taken, stats.dropCount);
+	EXPECT_EQ(0u, stats.depth);
+	EXPECT_TRUE(ring.Empty());
+
+	// Too large for the ring
+	hdr.size = 600;
+	EXPECT_FALSE(ring.PushDropOldest(&hdr, buf));
+}
+
+TEST(LogPacketRing, DropOldestThreadTest)
+{
+	cISLogPacketRing ring(4096);
+	const uint32_t count = 200000;
+	std::atomic<bool> done(false);
+
+	std::thread producer([&]()
+	{
+		p_data_hdr_t hdr;
+		uint8_t buf[256];
+		for (uint32_t seq = 0; seq < count; seq++)
+		{
+			fillRecord(seq, hdr, buf);
+			EXPECT_TRUE(ring.PushDropOldest(&hdr, buf));
+		}
+		done = true;
+	});
+
+	// A consumer that stalls now and then, as LogData does on a slow disk
+	uint32_t taken = 0;
+	uint32_t last = 0;
+	p_data_hdr_t hdr;
+	uint8_t buf[256];
+	while (!done || !ring.Empty())
+	{
+		if (!ring.Take(&hdr, buf, sizeof(buf)))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		ASSERT_TRUE(checkRecord(&hdr, buf));
+		if (taken != 0)
+		{
+			ASSERT_GT(hdr.offset, last);
+		}
+		last = hdr.offset;
+		if (++taken % 1000 == 0)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+	producer.join();
+
+	cISLogPacketRing::stats_t stats = ring.Stats();
+	EXPECT_EQ(count - 1, last);
+	EXPECT_GT(stats.dropCount, 0u);
+	EXPECT_EQ(count, taken + stats.dropCount);
+	EXPECT_EQ(0u, stats.depth);
+}
+
+TEST(LogPacketRing, PushWaitBoundedTest)
+{
+	ISFileManager::DeleteDirectory(PACKET_RING_TEST_DIRECTORY);
+	cISLogPacketRing ring(4096);
+	cISLogger logger;
+	std::atomic<bool> running(true);
+	std::atomic<bool> recover(false);
+
+	// Logger thread as under BACKPRESSURE_BLOCK, a record that fails to log is kept and tried again.  The logger is not 
+	// enabled so every LogData fails, as with a full disk, until it is told to recover.
+	std::thread consumer([&]()
+	{
+		while (running)
+		{
+			if (recover && !logger.Enabled())
+			{
+				logger.InitSaveTimestamp("20230101_000000", PACKET_RING_TEST_DIRECTORY, "", 1, cISLogger::LOGTYPE_DAT, 0.5f, 500000, false);
+				logger.EnableLogging(true);
+			}
+			const uint8_t *data;
+			const p_data_hdr_t *rec = ring.Front(&data);
+			if (rec == NULL)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			p_data_hdr_t hdr = *rec;
+			if (logger.LogData(0, &hdr, data))
+			{
+				ring.Pop();
+			}
+			else
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			}
+		}
+		logger.CloseAllFiles();
+	});
+
+	std::function<bool()> wait = []() { std::this_thread::sleep_for(std::chrono::milliseconds(1)); return true; };
+	p_data_hdr_t hdr;
+	uint8_t buf[256];
+	uint32_t seq = 0;
+	uint32_t dropped = 0;
+
+	// The producer waits for the stuck logger once, not for every record
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (; seq < 1000; seq++)
+	{
+		fillRecord(seq, hdr, buf);
+		if (!ring.PushWait(&hdr, buf, 50, wait))
+		{
+			ring.Drop(&hdr);
+			dropped++;
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	EXPECT_LT(seconds, 0.5);
+	EXPECT_GT(dropped, 900u);
+	EXPECT_EQ(dropped, ring.Stats().dropCount);
+
+	// Once the logger takes records again the producer waits for room and nothing more is dropped
+	recover = true;
+	for (int i = 0; i < 1000 && !ring.Empty(); i++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	EXPECT_TRUE(ring.Empty());
+	for (; seq < 3000; seq++)
+	{
+		fillRecord(seq, hdr, buf);
+		EXPECT_TRUE(ring.PushWait(&hdr, buf, 1000, wait));
+	}
+	EXPECT_EQ(dropped, ring.Stats().dropCount);
+
+	running = false;
+	consumer.join();
+	ISFileManager::DeleteDirectory(PACKET_RING_TEST_DIRECTORY);
+}
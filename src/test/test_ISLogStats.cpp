@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "../ISLogger.h"
+#include "../ISFileManager.h"
+#include "../ISDataMappings.h"
+
+#define STATS_TEST_DIRECTORY	"test_stats_log"
+
+TEST(ISLogStats, HistogramTest)
+{
+	EXPECT_EQ(0, cLogStatHistogram::Bucket(0.0));
+	EXPECT_EQ(0, cLogStatHistogram::Bucket(1.0e-7));
+	EXPECT_EQ(LOG_STATS_HISTOGRAM_SIZE - 1, cLogStatHistogram::Bucket(1.0e9));
+	for (double value = 2.0e-6; value < 1.0e5; value *= 1.37)
+	{
+		int bucket = cLogStatHistogram::Bucket(value);
+		EXPECT_LE(cLogStatHistogram::BucketStart(bucket), value);
+		EXPECT_GT(cLogStatHistogram::BucketStart(bucket + 1), value);
+		EXPECT_LT(cLogStatHistogram::BucketStart(bucket + 1), value * 1.07);
+	}
+
+	cLogStatHistogram histogram;
+	EXPECT_EQ(0.0, histogram.Percentile(0.5));
+	for (int i = 0; i < 1000; i++)
+	{
+		histogram.Add(i < 990 ? 0.001 : 0.1);
+	}
+	EXPECT_NEAR(0.001, histogram.Percentile(0.5), 0.001 * 0.07);
+	EXPECT_NEAR(0.001, histogram.Percentile(0.99), 0.001 * 0.07);
+	EXPECT_NEAR(0.1, histogram.Percentile(0.999), 0.1 * 0.07);
+	EXPECT_NEAR(0.001, histogram.Mode(), 0.001 * 0.07);
+}
+
+TEST(ISLogStats, StreamingAnalysisTest)
+{
+	// 100 Hz with one 0.5 s gap, one duplicate and one out of order timestamp
+	cLogStats stats;
+	double time = 100.0;
+	for (int i = 0; i < 2000; i++)
+	{
+		time += (i == 1000 ? 0.5 : 0.01) + (i % 2 ? 0.0002 : -0.0002);
+		stats.LogDataAndTimestamp(DID_INS_2, time);
+		if (i == 500)
+		{
+			stats.LogDataAndTimestamp(DID_INS_2, time);
+		}
+		if (i == 1500)
+		{
+			stats.LogDataAndTimestamp(DID_INS_2, time - 0.005);
+		}
+	}
+
+	const cLogStatDataId& ins = stats.dataIdStats[DID_INS_2];
+	EXPECT_EQ(2002u, ins.count);
+	EXPECT_EQ(2002u, ins.timestampCount);
+	EXPECT_EQ(1u, ins.duplicateCount);
+	EXPECT_EQ(1u, ins.outOfOrderCount);
+	ASSERT_EQ(1u, ins.gaps.size());
+	EXPECT_EQ(1u, ins.gapCount);
+	EXPECT_NEAR(0.5, ins.gaps[0].duration, 0.001);
+	EXPECT_NEAR(0.49, ins.gapTime, 0.01);
+	EXPECT_NEAR(100.0 + 1000 * 0.01, ins.gaps[0].timestamp, 0.001);
+	EXPECT_NEAR(2001 / (time - 100.0 - 0.01), ins.EffectiveRate(), 0.5);
+	EXPECT_NEAR(0.01, ins.deltaHistogram.Percentile(0.5), 0.01 * 0.07);
+	EXPECT_NEAR(0.0004, ins.jitterHistogram.Percentile(0.5), 0.0004 * 0.07);
+
+	// Stats gathered in parts merge to the same result
+	cLogStats first, second;
+	time = 100.0;
+	for (int i = 0; i < 2000; i++)
+	{
+		time += (i == 1000 ? 0.5 : 0.01);
+		(i < 500 ? first : second).LogDataAndTimestamp(DID_INS_2, time);
+	}
+	first.Merge(second);
+	EXPECT_EQ(2000u, first.dataIdStats[DID_INS_2].timestampCount);
+	EXPECT_EQ(1u, first.dataIdStats[DID_INS_2].gapCount);
+	EXPECT_EQ(1998u, first.dataIdStats[DID_INS_2].deltaHistogram.total);
+}
+
+TEST(ISLogStats, StatsJsonTest)
+{
+	ISFileManager::DeleteDirectory(STATS_TEST_DIRECTORY);
+	{
+		cISLogger logger;
+		ASSERT_TRUE(logger.InitSaveTimestamp("20230101_000000", STATS_TEST_DIRECTORY, "", 2, cISLogger::LOGTYPE_DAT, 0.5f, 1024 * 1024, false));
+		for (unsigned int dev = 0; dev < 2; dev++)
+		{
+			dev_info_t info = {};
+			info.serialNumber = 1000 + dev;
+			logger.SetDeviceInfo(&info, dev);
+		}
+		logger.EnableLogging(true);
+		for (int i = 0; i < 1000; i++)
+		{
+			for (unsigned int dev = 0; dev < 2; dev++)
+			{
+				if (dev == 1 && i >= 300 && i < 400)
+				{	// gap on the second device only
+					continue;
+				}
+				pimu_t imu = {};
+				imu.time = 1000.0 + i * 0.001;
+				p_data_hdr_t hdr = { DID_PIMU, sizeof(pimu_t), 0 };
+				ASSERT_TRUE(logger.LogData(dev, &hdr, (uint8_t*)&imu));
+			}
+		}
+		logger.CloseAllFiles();
+	}
+
+	// Written next to the log, one entry per device
+	std::ifstream file(STATS_TEST_DIRECTORY "/stats.json");
+	ASSERT_TRUE(file.good());
+	std::ostringstream stream;
+	stream << file.rdbuf();
+	std::string json = stream.str();
+	EXPECT_NE(std::string::npos, json.find("\"serialNumber\": 1000"));
+	EXPECT_NE(std::string::npos, json.find("\"serialNumber\": 1001"));
+	EXPECT_NE(std::string::npos, json.find("\"gapCount\": 0,"));
+	EXPECT_NE(std::string::npos, json.find("\"gapCount\": 1,"));
+	EXPECT_NE(std::string::npos, json.find("\"gaps\": [[1000.299000, 0.101"));
+	EXPECT_NE(std::string::npos, json.find(std::string("\"name\": \"") + cISDataMappings::GetDataSetName(DID_PIMU) + "\""));
+
+	// Reading the log gathers the same analysis
+	cISLogger logger;
+	ASSERT_TRUE(logger.LoadFromDirectory(STATS_TEST_DIRECTORY));
+	unsigned int device = 0;
+	while (logger.ReadNextData(device) != NULL) {}
+	ASSERT_EQ(2u, logger.GetDeviceCount());
+	for (unsigned int dev = 0; dev < 2; dev++)
+	{
+		const cLogStatDataId& imu = logger.GetDeviceStats(dev)->dataIdStats[DID_PIMU];
+		EXPECT_EQ(dev == 0 ? 1000u : 900u, imu.timestampCount);
+		EXPECT_EQ(dev == 0 ? 0u : 1u, imu.gapCount);
+	}
+	EXPECT_TRUE(logger.WriteStatsJson(STATS_TEST_DIRECTORY "/read_stats.json"));
+
+	ISFileManager::DeleteDirectory(STATS_TEST_DIRECTORY);
+}
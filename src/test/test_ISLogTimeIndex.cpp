@@ -0,0 +1,261 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include "../ISLogTimeIndex.h"
+#include "../ISDataMappings.h"
+#include "../ISLogger.h"
+#include "../ISFileManager.h"
+
+#define TIME_INDEX_TEST_DIRECTORY	"test_time_index_log"
+
+TEST(LogTimeIndex, FindTest)
+{
+	const char* path = "test_time_index.idx";
+	{
+		cISLogTimeIndex index;
+		ASSERT_TRUE(index.OpenForWriting(path, 1000));
+		EXPECT_FALSE(index.Add(0.0, 1, 0));			// no timestamp
+		EXPECT_TRUE(index.Add(100.0, 1, 0));
+		EXPECT_FALSE(index.Add(100.5, 1, 1000));		// inside index period
+		EXPECT_TRUE(index.Add(101.0, 1, 2000));
+		EXPECT_TRUE(index.Add(105.0, 2, 0));
+	}
+
+	cISLogTimeIndex index;
+	ASSERT_TRUE(index.Load(path));
+	ASSERT_EQ(3u, index.Entries().size());
+	EXPECT_EQ(100.0, index.Find(50.0)->time);		// before the log, first entry
+	EXPECT_EQ(100.0, index.Find(100.9)->time);
+	EXPECT_EQ(101.0, index.Find(101.0)->time);
+	EXPECT_EQ(2000u, index.Find(104.0)->offset);
+	EXPECT_EQ(2u, index.Find(1000.0)->fileNumber);
+	remove(path);
+}
+
+TEST(LogTimeIndex, FindAcrossRolloverTest)
+{
+	const char* path = "test_time_index.idx";
+	{
+		cISLogTimeIndex index;
+		ASSERT_TRUE(index.OpenForWriting(path, 1000));
+		EXPECT_TRUE(index.Add(604700.0, 1, 0));
+		EXPECT_TRUE(index.Add(604750.0, 1, 1000));
+		EXPECT_TRUE(index.Add(604790.0, 2, 0));
+		EXPECT_TRUE(index.Add(10.0, 2, 1000));		// week rollover
+		EXPECT_TRUE(index.Add(50.0, 3, 0));
+		EXPECT_TRUE(index.Add(30.0, 3, 1000));		// fix reacquired, time jumped back
+		EXPECT_TRUE(index.Add(90.0, 4, 0));
+	}
+
+	cISLogTimeIndex index;
+	ASSERT_TRUE(index.Load(path));
+	ASSERT_EQ(7u, index.Entries().size());
+	EXPECT_EQ(604750.0, index.Find(604760.0)->time);
+	EXPECT_EQ(604790.0, index.Find(604799.0)->time);	// after the last entry of the week
+	EXPECT_EQ(10.0, index.Find(20.0)->time);
+	EXPECT_EQ(10.0, index.Find(45.0)->time);			// first run spanning the time
+	EXPECT_EQ(30.0, index.Find(60.0)->time);
+	EXPECT_EQ(90.0, index.Find(1000.0)->time);
+	EXPECT_EQ(604700.0, index.Find(5.0)->time);			// before the log, first entry
+	EXPECT_EQ(90.0, index.Find(300000.0)->time);
+	remove(path);
+}
+
+// Time range reads on each side of a GPS week rollover
+TEST(LogTimeIndex, SeekAcrossWeekRolloverTest)
+{
+	ISFileManager::DeleteDirectory(TIME_INDEX_TEST_DIRECTORY);
+
+	// 5 minutes of 100 Hz INS data across the end of week 2250
+	const uint32_t week = 2250;
+	{
+		cISLogger logger;
+		logger.SetTimeIndex(true, 1000);
+		ASSERT_TRUE(logger.InitSaveTimestamp("20230101_000000", TIME_INDEX_TEST_DIRECTORY, "", 1, cISLogger::LOGTYPE_DAT, 0.5f, 500000, false));
+		dev_info_t info = {};
+		info.serialNumber = 12345;
+		logger.SetDeviceInfo(&info);
+		logger.EnableLogging(true);
+
+		ins_2_t ins = {};
+		p_data_hdr_t hdr = { DID_INS_2, sizeof(ins_2_t), 0 };
+		for (uint32_t i = 0; i < 30000; i++)
+		{
+			uint32_t towMs = (uint32_t)(SECONDS_PER_WEEK * 1000) - 150000 + 10 * i;
+			ins.week = week + towMs / (uint32_t)(SECONDS_PER_WEEK * 1000);
+			ins.timeOfWeek = (towMs % (uint32_t)(SECONDS_PER_WEEK * 1000)) / 1000.0;
+			ASSERT_TRUE(logger.LogData(0, &hdr, (uint8_t*)&ins));
+		}
+		logger.CloseAllFiles();
+	}
+
+	for (int mapped = 0; mapped < 2; mapped++)
+	{
+		cISLogger logger;
+		logger.SetMappedRead(mapped != 0);
+		ASSERT_TRUE(logger.LoadFromDirectory(TIME_INDEX_TEST_DIRECTORY));
+
+		const double startTimes[] = { SECONDS_PER_WEEK - 100.0, 100.0 };
+		for (int w = 0; w < 2; w++)
+		{
+			ASSERT_TRUE(logger.SeekToTime(0, startTimes[w]));
+			int count = 0;
+			p_data_t* data;
+			while ((data = logger.ReadDataInTimeRange(0, startTimes[w], startTimes[w] + 10.0 - 0.005)) != NULL)
+			{
+				const ins_2_t* read = (const ins_2_t*)data->buf;
+				EXPECT_EQ(week + w, read->week);
+				EXPECT_NEAR(startTimes[w] + 0.01 * count, read->timeOfWeek, 1.0e-6);
+				count++;
+			}
+			EXPECT_EQ(1000, count);
+		}
+	}
+
+	ISFileManager::DeleteDirectory(TIME_INDEX_TEST_DIRECTORY);
+}
+
+TEST(LogTimeIndex, SeekToTimeTest)
+{
+	ISFileManager::DeleteDirectory(TIME_INDEX_TEST_DIRECTORY);
+
+	// 10 minutes of 100 Hz INS data across several files
+	{
+		cISLogger logger;
+		logger.SetTimeIndex(true, 1000);
+		ASSERT_TRUE(logger.InitSaveTimestamp("20230101_000000", TIME_INDEX_TEST_DIRECTORY, "", 1, cISLogger::LOGTYPE_DAT, 0.5f, 500000, false));
+		dev_info_t info = {};
+		info.serialNumber = 12345;
+		logger.SetDeviceInfo(&info);
+		logger.EnableLogging(true);
+
+		ins_2_t ins = {};
+		p_data_hdr_t hdr = { DID_INS_2, sizeof(ins_2_t), 0 };
+		for (int i = 0; i < 60000; i++)
+		{
+			ins.timeOfWeek = 0.01 * i;
+			ASSERT_TRUE(logger.LogData(0, &hdr, (uint8_t*)&ins));
+		}
+		logger.CloseAllFiles();
+		EXPECT_GT(logger.FileCount(0), 3u);
+	}
+
+	for (int mapped = 0; mapped < 2; mapped++)
+	{
+		cISLogger logger;
+		logger.SetMappedRead(mapped != 0);
+		ASSERT_TRUE(logger.LoadFromDirectory(TIME_INDEX_TEST_DIRECTORY));
+
+		// Lands on the chunk holding the time, chunks are about 20 seconds of data
+		ASSERT_TRUE(logger.SeekToTime(0, 300.0));
+		p_data_t* data = logger.ReadData(0);
+		ASSERT_TRUE(data != NULL);
+		double time = ((ins_2_t*)data->buf)->timeOfWeek;
+		EXPECT_LE(time, 300.0);
+		EXPECT_GT(time, 270.0);
+
+		// Time range read
+		ASSERT_TRUE(logger.SeekToTime(0, 300.0));
+		int count = 0;
+		while ((data = logger.ReadDataInTimeRange(0, 300.0, 310.0 - 0.005)) != NULL)
+		{
+			EXPECT_NEAR(300.0 + 0.01 * count, ((ins_2_t*)data->buf)->timeOfWeek, 1.0e-6);
+			count++;
+		}
+		EXPECT_EQ(1000, count);
+
+		// Seeking backward
+		ASSERT_TRUE(logger.SeekToTime(0, 5.0));
+		data = logger.ReadData(0);
+		ASSERT_TRUE(data != NULL);
+		EXPECT_LE(((ins_2_t*)data->buf)->timeOfWeek, 5.0);
+	}
+
+	ISFileManager::DeleteDirectory(TIME_INDEX_TEST_DIRECTORY);
+}
+
+// IMU data is stamped with time since boot and raw GPS observations with GPS time since the unix epoch, only GPS time of 
+// week is used for the index and time range reads
+TEST(LogTimeIndex, MixedTimeBasesTest)
+{
+	ISFileManager::DeleteDirectory(TIME_INDEX_TEST_DIRECTORY);
+
+	// 5 minutes of 100 Hz INS and PIMU data with 5 Hz raw GPS observations
+	const uint32_t week = 2250;
+	{
+		cISLogger logger;
+		logger.SetTimeIndex(true, 1000);
+		ASSERT_TRUE(logger.InitSaveTimestamp("20230101_000000", TIME_INDEX_TEST_DIRECTORY, "", 1, cISLogger::LOGTYPE_DAT, 0.5f, 500000, false));
+		dev_info_t info = {};
+		info.serialNumber = 12345;
+		logger.SetDeviceInfo(&info);
+		logger.EnableLogging(true);
+
+		ins_2_t ins = {};
+		pimu_t pimu = {};
+		gps_raw_t raw = {};
+		p_data_hdr_t insHdr = { DID_INS_2, sizeof(ins_2_t), 0 };
+		p_data_hdr_t pimuHdr = { DID_PIMU, sizeof(pimu_t), 0 };
+		p_data_hdr_t rawHdr = { DID_GPS1_RAW, (uint32_t)(offsetof(gps_raw_t, data) + sizeof(obsd_t)), 0 };
+		raw.dataType = raw_data_type_observation;
+		raw.obsCount = 1;
+		for (uint32_t i = 0; i < 30000; i++)
+		{
+			uint32_t towMs = 1000000 + 10 * i;
+			ins.week = week;
+			ins.timeOfWeek = towMs / 1000.0;
+			ASSERT_TRUE(logger.LogData(0, &insHdr, (uint8_t*)&ins));
+			pimu.time = 3.0 + 0.01 * i;
+			ASSERT_TRUE(logger.LogData(0, &pimuHdr, (uint8_t*)&pimu));
+			if (i % 20 == 0)
+			{
+				raw.data.obs[0].time.time = GPS_TO_UNIX_OFFSET + (int64_t)week * SECONDS_PER_WEEK + towMs / 1000;
+				raw.data.obs[0].time.sec = (towMs % 1000) / 1000.0;
+				ASSERT_TRUE(logger.LogData(0, &rawHdr, (uint8_t*)&raw));
+			}
+		}
+		logger.CloseAllFiles();
+	}
+
+	for (int mapped = 0; mapped < 2; mapped++)
+	{
+		cISLogger logger;
+		logger.SetMappedRead(mapped != 0);
+		ASSERT_TRUE(logger.LoadFromDirectory(TIME_INDEX_TEST_DIRECTORY));
+
+		cISLogTimeIndex index;
+		ASSERT_TRUE(index.Load(std::string(TIME_INDEX_TEST_DIRECTORY "/" IS_LOG_FILE_PREFIX "12345_20230101_000000" LOG_TIME_INDEX_EXTENSION)));
+		for (size_t i = 1; i < index.Entries().size(); i++)
+		{
+			EXPECT_LT(index.Entries()[i - 1].time, index.Entries()[i].time);
+		}
+		EXPECT_GE(index.Entries().front().time, 1000.0);
+		EXPECT_LT(index.Entries().back().time, 1300.0);
+
+		ASSERT_TRUE(logger.SeekToTime(0, 1200.0));
+		int insCount = 0, pimuCount = 0, rawCount = 0;
+		p_data_t* data;
+		while ((data = logger.ReadDataInTimeRange(0, 1200.0, 1210.0 - 0.005)) != NULL)
+		{
+			switch (data->hdr.id)
+			{
+			case DID_INS_2:
+				EXPECT_NEAR(1200.0 + 0.01 * insCount, ((ins_2_t*)data->buf)->timeOfWeek, 1.0e-6);
+				insCount++;
+				break;
+			case DID_PIMU:
+				EXPECT_NEAR(203.0 + 0.01 * pimuCount, ((pimu_t*)data->buf)->time, 1.0e-6);
+				pimuCount++;
+				break;
+			case DID_GPS1_RAW:
+				EXPECT_NEAR(1200.0 + 0.2 * rawCount, cISDataMappings::GetTimeOfWeek(&data->hdr, data->buf), 1.0e-6);
+				rawCount++;
+				break;
+			}
+		}
+		EXPECT_EQ(1000, insCount);
+		EXPECT_EQ(1000, pimuCount);
+		EXPECT_EQ(50, rawCount);
+	}
+
+	ISFileManager::DeleteDirectory(TIME_INDEX_TEST_DIRECTORY);
+}
@@ -0,0 +1,295 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include "../ISNtripCaster.h"
+#include "../ISUtilities.h"
+#include "test_helpers.h"
+
+using namespace std;
+
+#define NTRIP_CASTER_TEST_PORT		32189
+#define TEST_FRAME_PAYLOAD_SIZE		14
+#define TEST_FRAME_SIZE				(3 + TEST_FRAME_PAYLOAD_SIZE + 3)
+
+static const string s_icyResponse = "ICY 200 OK\r\n\r\n";
+
+// Stands in for the serial port of a base station
+class cFakeBaseStream : public cISStream
+{
+public:
+	void Push(const vector<uint8_t>& data)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_data.insert(m_data.end(), data.begin(), data.end());
+		m_dataReady.notify_one();
+	}
+
+	int Read(void* buffer, int count) OVERRIDE
+	{
+		unique_lock<mutex> lock(m_mutex);
+		m_dataReady.wait_for(lock, chrono::milliseconds(10), [&]() { return !m_data.empty(); });
+		int n = min(count, (int)m_data.size());
+		copy(m_data.begin(), m_data.begin() + n, (uint8_t*)buffer);
+		m_data.erase(m_data.begin(), m_data.begin() + n);
+		return n;
+	}
+
+private:
+	mutex m_mutex;
+	condition_variable m_dataReady;
+	deque<uint8_t> m_data;
+};
+
+static int64_t NowNs()
+{
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// RTCM3 frame carrying a sequence number and the time it was made
+static vector<uint8_t> RtcmFrame(uint16_t messageNumber, uint32_t sequence)
+{
+	vector<uint8_t> frame(TEST_FRAME_SIZE);
+	frame[0] = 0xD3;
+	frame[1] = (TEST_FRAME_PAYLOAD_SIZE >> 8) & 0x03;
+	frame[2] = TEST_FRAME_PAYLOAD_SIZE & 0xFF;
+	frame[3] = (uint8_t)(messageNumber >> 4);
+	frame[4] = (uint8_t)((messageNumber & 0x0F) << 4);
+	memcpy(&frame[5], &sequence, sizeof(sequence));
+	int64_t timeNs = NowNs();
+	memcpy(&frame[9], &timeNs, sizeof(timeNs));
+	unsigned int crc = calculate24BitCRCQ(frame.data(), 3 + TEST_FRAME_PAYLOAD_SIZE);
+	frame[TEST_FRAME_SIZE - 3] = (uint8_t)(crc >> 16);
+	frame[TEST_FRAME_SIZE - 2] = (uint8_t)(crc >> 8);
+	frame[TEST_FRAME_SIZE - 1] = (uint8_t)crc;
+	return frame;
+}
+
+// Fake rover, an NTRIP client that records the frames it receives
+struct sRover
+{
+	cISTcpClient client;
+	vector<uint8_t> pending;
+	bool connected = false;
+	vector<uint16_t> messageNumbers;
+	vector<uint32_t> sequences;
+
+	bool Open(const string& mountpoint)
+	{
+		if (client.Open("127.0.0.1", NTRIP_CASTER_TEST_PORT) != 0)
+		{
+			return false;
+		}
+		client.HttpGet(mountpoint, "NTRIP Inertial Sense Test", "", "");
+		return true;
+	}
+
+	// Read everything available, recording the latency of each frame
+	void Read(vector<double>* latenciesUs = NULLPTR)
+	{
+		uint8_t buf[4096];
+		int count;
+		while ((count = client.Read(buf, sizeof(buf))) > 0)
+		{
+			pending.insert(pending.end(), buf, buf + count);
+		}
+		int64_t nowNs = NowNs();
+
+		size_t i = 0;
+		if (!connected && pending.size() >= s_icyResponse.size())
+		{
+			ASSERT_EQ(s_icyResponse, string(pending.begin(), pending.begin() + s_icyResponse.size()));
+			connected = true;
+			i = s_icyResponse.size();
+		}
+		for (; connected && i + TEST_FRAME_SIZE <= pending.size(); i += TEST_FRAME_SIZE)
+		{
+			ASSERT_EQ(0xD3, pending[i]);
+			messageNumbers.push_back((uint16_t)((pending[i + 3] << 4) | (pending[i + 4] >> 4)));
+			uint32_t sequence;
+			memcpy(&sequence, &pending[i + 5], sizeof(sequence));
+			sequences.push_back(sequence);
+			int64_t timeNs;
+			memcpy(&timeNs, &pending[i + 9], sizeof(timeNs));
+			if (latenciesUs != NULLPTR)
+			{
+				latenciesUs->push_back((nowNs - timeNs) / 1000.0);
+			}
+		}
+		pending.erase(pending.begin(), pending.begin() + i);
+	}
+};
+
+static bool WaitFor(const function<bool()>& done, int timeoutMs = 5000)
+{
+	for (int i = 0; i < timeoutMs && !done(); i++)
+	{
+		SLEEP_MS(1);
+	}
+	return done();
+}
+
+static string ReadSourceTable(const string& mountpoint)
+{
+	cISTcpClient client;
+	if (client.Open("127.0.0.1", NTRIP_CASTER_TEST_PORT) != 0)
+	{
+		return "";
+	}
+	client.HttpGet(mountpoint, "NTRIP Inertial Sense Test", "", "");
+	string response;
+	WaitFor([&]()
+	{
+		char buf[1024];
+		int count;
+		while ((count = client.Read(buf, sizeof(buf))) > 0)
+		{
+			response.append(buf, count);
+		}
+		return response.find("ENDSOURCETABLE\r\n") != string::npos;
+	});
+	return response;
+}
+
+TEST(NtripCaster, SourceTable)
+{
+	cISNtripCaster caster;
+	ASSERT_TRUE(caster.AddMountpoint("BASE1", new cFakeBaseStream()));
+	ASSERT_TRUE(caster.AddMountpoint("BASE2", new cFakeBaseStream(), "BASE2;RTCM 3.3;1005(10),1077(1);2;GPS;;USA;40.25;-111.65;0;0;Test;none;N;N;0;"));
+	cFakeBaseStream notAdded;
+	EXPECT_FALSE(caster.AddMountpoint("BASE1", &notAdded));
+	EXPECT_FALSE(caster.AddMountpoint("BAD/NAME", &notAdded));
+	ASSERT_EQ(0, caster.Open("127.0.0.1", NTRIP_CASTER_TEST_PORT));
+	EXPECT_FALSE(caster.AddMountpoint("BASE3", &notAdded));
+
+	// no mountpoint and an unknown mountpoint both get the source table
+	for (const string& mountpoint : { string(""), string("UNKNOWN") })
+	{
+		string response = ReadSourceTable(mountpoint);
+		EXPECT_EQ(0u, response.find("SOURCETABLE 200 OK\r\n"));
+		EXPECT_NE(string::npos, response.find("\r\nSTR;BASE1;BASE1;RTCM 3;"));
+		EXPECT_NE(string::npos, response.find("\r\nSTR;BASE2;BASE2;RTCM 3.3;1005(10),1077(1);2;GPS;;USA;40.25;-111.65;"));
+		ASSERT_GE(response.size(), 16u);
+		EXPECT_EQ("ENDSOURCETABLE\r\n", response.substr(response.size() - 16));
+		size_t body = response.find("\r\n\r\n") + 4;
+		EXPECT_NE(string::npos, response.find("Content-Length: " + to_string(response.size() - body) + "\r\n"));
+	}
+	caster.Close();
+}
+
+TEST(NtripCaster, MountpointsFromDifferentStreams)
+{
+	cISNtripCaster caster;
+	cFakeBaseStream* base1 = new cFakeBaseStream();
+	cFakeBaseStream* base2 = new cFakeBaseStream();
+	ASSERT_TRUE(caster.AddMountpoint("BASE1", base1));
+	ASSERT_TRUE(caster.AddMountpoint("BASE2", base2));
+	ASSERT_EQ(0, caster.Open("127.0.0.1", NTRIP_CASTER_TEST_PORT));
+
+	sRover rovers[3];
+	ASSERT_TRUE(rovers[0].Open("BASE1"));
+	ASSERT_TRUE(rovers[1].Open("BASE2"));
+	ASSERT_TRUE(rovers[2].Open("BASE2"));
+	ASSERT_TRUE(WaitFor([&]() { return caster.MountpointStats(0).clientCount == 1 && caster.MountpointStats(1).clientCount == 2; }));
+
+	// only whole RTCM3 packets are forwarded, other bytes from the base are not
+	const char* noise = "$GPGGA,not forwarded*00\r\n";
+	for (uint32_t i = 0; i < 20; i++)
+	{
+		base1->Push(RtcmFrame(1005, i));
+		base1->Push(vector<uint8_t>(noise, noise + strlen(noise)));
+		base2->Push(RtcmFrame(1077, 1000 + i));
+	}
+	ASSERT_TRUE(WaitFor([&]()
+	{
+		for (sRover& rover : rovers)
+		{
+			rover.Read();
+		}
+		return rovers[0].sequences.size() >= 20 && rovers[1].sequences.size() >= 20 && rovers[2].sequences.size() >= 20;
+	}));
+
+	for (int r = 0; r < 3; r++)
+	{
+		ASSERT_EQ(20u, rovers[r].sequences.size());
+		for (uint32_t i = 0; i < 20; i++)
+		{
+			EXPECT_EQ((r == 0 ? 1005 : 1077), rovers[r].messageNumbers[i]);
+			EXPECT_EQ((r == 0 ? 0 : 1000) + i, rovers[r].sequences[i]);
+		}
+	}
+	EXPECT_EQ(20u, caster.MountpointStats(0).packetCount);
+	EXPECT_EQ(20u * TEST_FRAME_SIZE, caster.MountpointStats(0).byteCount);
+	EXPECT_EQ(0u, caster.MountpointStats(0).dropCount);
+
+	// a rover leaving is removed from its mountpoint
+	rovers[2].client.Close();
+	EXPECT_TRUE(WaitFor([&]() { return caster.MountpointStats(1).clientCount == 1; }));
+	EXPECT_TRUE(WaitFor([&]() { return caster.ClientCount() == 2; }));
+	caster.Close();
+}
+
+// End to end latency from a base packet being read to each rover receiving it, for growing numbers of rovers.  Benchmark,
+// not part of the default run, use --gtest_also_run_disabled_tests --gtest_filter=*Benchmark
+TEST(NtripCaster, DISABLED_CorrectionLatencyBenchmark)
+{
+	cISNtripCaster caster;
+	cFakeBaseStream* base = new cFakeBaseStream();
+	ASSERT_TRUE(caster.AddMountpoint("BASE", base));
+	ASSERT_EQ(0, caster.Open("127.0.0.1", NTRIP_CASTER_TEST_PORT));
+
+	vector<unique_ptr<sRover>> rovers;
+	const size_t roverCounts[] = { 10, 100, 1000 };
+	const uint32_t frameCount = 50;
+	uint32_t sequence = 0;
+	size_t openFileLimit = RaiseOpenFileLimit();
+	for (size_t roverCount : roverCounts)
+	{
+		// each rover uses a socket on both ends
+		if (2 * roverCount + 64 > openFileLimit)
+		{
+			printf("%5d rovers: skipped, open file limit %d\n", (int)roverCount, (int)openFileLimit);
+			continue;
+		}
+		while (rovers.size() < roverCount)
+		{
+			rovers.push_back(unique_ptr<sRover>(new sRover()));
+			ASSERT_TRUE(rovers.back()->Open("BASE"));
+		}
+		ASSERT_TRUE(WaitFor([&]() { return caster.MountpointStats(0).clientCount == roverCount; }));
+
+		vector<double> latenciesUs;
+		for (uint32_t f = 0; f < frameCount; f++, sequence++)
+		{
+			base->Push(RtcmFrame(1077, sequence));
+			ASSERT_TRUE(WaitFor([&]()
+			{
+				bool all = true;
+				for (size_t r = 0; r < rovers.size(); r++)
+				{
+					rovers[r]->Read(&latenciesUs);
+					all = all && !rovers[r]->sequences.empty() && rovers[r]->sequences.back() == sequence;
+				}
+				return all;
+			}));
+			SLEEP_MS(2);
+		}
+
+		ASSERT_EQ(roverCount * frameCount, latenciesUs.size());
+		sort(latenciesUs.begin(), latenciesUs.end());
+		printf("%5d rovers: latency p50 %8.1f us, p90 %8.1f us, p99 %8.1f us, max %8.1f us\n", (int)roverCount,
+			latenciesUs[latenciesUs.size() / 2], latenciesUs[latenciesUs.size() * 9 / 10], latenciesUs[latenciesUs.size() * 99 / 100], latenciesUs.back());
+		EXPECT_LT(latenciesUs[latenciesUs.size() * 99 / 100], 500000.0);
+		for (size_t r = 0; r < rovers.size(); r++)
+		{
+			rovers[r]->sequences.clear();
+		}
+	}
+	EXPECT_EQ(0u, caster.MountpointStats(0).dropCount);
+	caster.Close();
+}
@@ -0,0 +1,404 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdio.h>
+#include <string.h>
+#include "../ISTcpServer.h"
+#include "../ISUtilities.h"
+#include "test_helpers.h"
+
+#if PLATFORM_IS_LINUX
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#define TCP_SERVER_TEST_PORT	32187
+
+class cTcpServerTestDelegate : public iISTcpServerDelegate
+{
+public:
+	int connected = 0;
+	int disconnected = 0;
+	size_t bytesReceived = 0;
+	vector<socket_t> sockets;
+
+protected:
+	void OnClientConnected(cISTcpServer* server, socket_t socket) OVERRIDE { connected++; sockets.push_back(socket); }
+	void OnClientDisconnected(cISTcpServer* server, socket_t socket) OVERRIDE { disconnected++; }
+	void OnClientDataReceived(cISTcpServer* server, socket_t socket, uint8_t* data, int dataLength) OVERRIDE { bytesReceived += dataLength; }
+};
+
+static void UpdateUntil(cISTcpServer& server, const function<bool()>& done)
+{
+	for (int i = 0; i < 5000 && !done(); i++)
+	{
+		server.Update(1);
+	}
+}
+
+TEST(TcpServer, ConnectReadDisconnect)
+{
+	cTcpServerTestDelegate delegate;
+	cISTcpServer server(&delegate);
+	ASSERT_EQ(0, server.Open("127.0.0.1", TCP_SERVER_TEST_PORT));
+
+	cISTcpClient clients[3];
+	for (int i = 0; i < 3; i++)
+	{
+		ASSERT_EQ(0, clients[i].Open("127.0.0.1", TCP_SERVER_TEST_PORT));
+	}
+	UpdateUntil(server, [&]() { return server.ClientCount() == 3; });
+	EXPECT_EQ(3, delegate.connected);
+
+	// more than one read buffer from a client is all delivered in one update
+	vector<uint8_t> data(20000, 0x55);
+	size_t written = 0;
+	while (written < data.size())
+	{
+		int count = clients[1].Write(data.data() + written, (int)(data.size() - written));
+		ASSERT_GE(count, 0);
+		written += count;
+	}
+	UpdateUntil(server, [&]() { return delegate.bytesReceived == data.size(); });
+	EXPECT_EQ(data.size(), delegate.bytesReceived);
+
+	// a client closing is detected without a write to it
+	clients[0].Close();
+	UpdateUntil(server, [&]() { return server.ClientCount() == 2; });
+	EXPECT_EQ(2u, server.ClientCount());
+	EXPECT_EQ(1, delegate.disconnected);
+
+	EXPECT_EQ(4, server.Write((const uint8_t*)"test", 4));
+	char buf[8] = {};
+	for (int i = 0; i < 1000 && clients[2].Read(buf, sizeof(buf)) <= 0; i++)
+	{
+		SLEEP_MS(1);
+	}
+	EXPECT_STREQ("test", buf);
+	server.Close();
+}
+
+// Write a numbered message of messageSize bytes
+static void WriteMessage(cISTcpServer& server, uint32_t number, size_t messageSize)
+{
+	vector<uint8_t> message(messageSize, (uint8_t)number);
+	memcpy(message.data(), &number, sizeof(number));
+	ASSERT_EQ((int)messageSize, server.Write(message.data(), (int)messageSize));
+}
+
+// Read everything available and check it is a run of whole numbered messages in increasing order
+static void ReadMessages(cISTcpClient& client, vector<uint8_t>& pending, size_t messageSize, vector<uint32_t>& numbers)
+{
+	uint8_t buf[16384];
+	int count;
+	while ((count = client.Read(buf, sizeof(buf))) > 0)
+	{
+		pending.insert(pending.end(), buf, buf + count);
+	}
+	size_t i = 0;
+	for (; i + messageSize <= pending.size(); i += messageSize)
+	{
+		uint32_t number;
+		memcpy(&number, &pending[i], sizeof(number));
+		ASSERT_TRUE(numbers.empty() || number > numbers.back());
+		for (size_t j = sizeof(number); j < messageSize; j++)
+		{
+			ASSERT_EQ((uint8_t)number, pending[i + j]);
+		}
+		numbers.push_back(number);
+	}
+	pending.erase(pending.begin(), pending.begin() + i);
+}
+
+// A client that stops reading does not hold up the others and only keeps the newest writes
+TEST(TcpServer, SlowClientDropOldest)
+{
+	cTcpServerTestDelegate delegate;
+	cISTcpServer server(&delegate);
+	ASSERT_EQ(0, server.Open("127.0.0.1", TCP_SERVER_TEST_PORT));
+	const size_t maxQueueSize = 64 * 1024;
+	server.SetSlowClientPolicy(TCP_SERVER_SLOW_CLIENT_DROP_OLDEST, maxQueueSize);
+
+	cISTcpClient fast, slow;
+	ASSERT_EQ(0, fast.Open("127.0.0.1", TCP_SERVER_TEST_PORT));
+	UpdateUntil(server, [&]() { return server.ClientCount() == 1; });
+	ASSERT_EQ(0, slow.Open("127.0.0.1", TCP_SERVER_TEST_PORT));
+	UpdateUntil(server, [&]() { return server.ClientCount() == 2; });
+	ASSERT_EQ(2u, delegate.sockets.size());
+
+	const size_t messageSize = 1000;
+	const uint32_t messageCount = 20000;
+	vector<uint8_t> fastPending;
+	vector<uint32_t> fastNumbers;
+	for (uint32_t n = 0; n < messageCount; n++)
+	{
+		WriteMessage(server, n, messageSize);
+		server.Update(0);
+		ReadMessages(fast, fastPending, messageSize, fastNumbers);
+		EXPECT_LE(server.QueuedSize(delegate.sockets[1]), maxQueueSize);
+	}
+	for (int i = 0; i < 5000 && fastNumbers.size() < messageCount; i++)
+	{
+		server.Update(1);
+		ReadMessages(fast, fastPending, messageSize, fastNumbers);
+	}
+
+	// the reading client got everything
+	ASSERT_EQ(messageCount, fastNumbers.size());
+	EXPECT_EQ(messageCount - 1, fastNumbers.back());
+	EXPECT_EQ(0u, server.QueuedSize(delegate.sockets[0]));
+
+	// the slow client is still connected and gets whole messages ending with the newest
+	EXPECT_EQ(2u, server.ClientCount());
+	EXPECT_GT(server.QueuedSize(delegate.sockets[1]), 0u);
+	vector<uint8_t> slowPending;
+	vector<uint32_t> slowNumbers;
+	for (int i = 0; i < 5000 && server.QueuedSize(delegate.sockets[1]) != 0; i++)
+	{
+		server.Update(1);
+		ReadMessages(slow, slowPending, messageSize, slowNumbers);
+	}
+	for (int i = 0; i < 100 && (slowNumbers.empty() || slowNumbers.back() != messageCount - 1); i++)
+	{
+		SLEEP_MS(1);
+		ReadMessages(slow, slowPending, messageSize, slowNumbers);
+	}
+	ASSERT_FALSE(slowNumbers.empty());
+	EXPECT_EQ(messageCount - 1, slowNumbers.back());
+	EXPECT_LT(slowNumbers.size(), (size_t)messageCount);
+	EXPECT_TRUE(slowPending.empty());
+	server.Close();
+}
+
+// A client that stays behind is disconnected while the others keep receiving
+TEST(TcpServer, SlowClientDisconnect)
+{
+	cTcpServerTestDelegate delegate;
+	cISTcpServer server(&delegate);
+	ASSERT_EQ(0, server.Open("127.0.0.1", TCP_SERVER_TEST_PORT));
+	server.SetSlowClientPolicy(TCP_SERVER_SLOW_CLIENT_DISCONNECT, 16 * 1024 * 1024, 50);
+
+	cISTcpClient fast, slow;
+	ASSERT_EQ(0, fast.Open("127.0.0.1", TCP_SERVER_TEST_PORT));
+	UpdateUntil(server, [&]() { return server.ClientCount() == 1; });
+	ASSERT_EQ(0, slow.Open("127.0.0.1", TCP_SERVER_TEST_PORT));
+	UpdateUntil(server, [&]() { return server.ClientCount() == 2; });
+
+	const size_t messageSize = 1000;
+	vector<uint8_t> fastPending;
+	vector<uint32_t> fastNumbers;
+	uint32_t n = 0;
+	for (; n < 100000 && server.ClientCount() == 2; n++)
+	{
+		WriteMessage(server, n, messageSize);
+		server.Update(0);
+		ReadMessages(fast, fastPending, messageSize, fastNumbers);
+		if (n % 100 == 0)
+		{
+			SLEEP_MS(1);
+		}
+	}
+
+	EXPECT_EQ(1u, server.ClientCount());
+	EXPECT_EQ(1, delegate.disconnected);
+	for (int i = 0; i < 5000 && fastNumbers.size() < n; i++)
+	{
+		server.Update(1);
+		ReadMessages(fast, fastPending, messageSize, fastNumbers);
+	}
+	EXPECT_EQ((size_t)n, fastNumbers.size());
+	server.Close();
+}
+
+#if PLATFORM_IS_LINUX
+
+static socket_t OpenRawClient(int receiveBufferSize = 0)
+{
+	socket_t client = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (receiveBufferSize != 0)
+	{
+		setsockopt(client, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize));
+	}
+	sockaddr_in addr = sockaddr_in();
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(TCP_SERVER_TEST_PORT);
+	addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+	if (connect(client, (sockaddr*)&addr, sizeof(addr)) != 0)
+	{
+		ISSocketClose(client);
+		return 0;
+	}
+	return client;
+}
+
+// A client whose last data and close arrive together is still seen to disconnect
+TEST(TcpServer, DataAndCloseTogether)
+{
+	cTcpServerTestDelegate delegate;
+	cISTcpServer server(&delegate);
+	ASSERT_EQ(0, server.Open("127.0.0.1", TCP_SERVER_TEST_PORT));
+
+	socket_t client = OpenRawClient();
+	ASSERT_NE(0, client);
+	UpdateUntil(server, [&]() { return server.ClientCount() == 1; });
+	ASSERT_EQ(1u, server.ClientCount());
+
+	ASSERT_EQ(14, send(client, "GET /BASE HTTP", 14, 0));
+	ISSocketClose(client);
+	SLEEP_MS(50);
+	UpdateUntil(server, [&]() { return delegate.disconnected == 1; });
+	EXPECT_EQ(14u, delegate.bytesReceived);
+	EXPECT_EQ(1, delegate.disconnected);
+	EXPECT_EQ(0u, server.ClientCount());
+	server.Close();
+}
+
+// Connections pending while the process is out of file descriptors are accepted once descriptors free up
+TEST(TcpServer, AcceptAfterOutOfFiles)
+{
+	cTcpServerTestDelegate delegate;
+	cISTcpServer server(&delegate);
+	ASSERT_EQ(0, server.Open("127.0.0.1", TCP_SERVER_TEST_PORT));
+	socket_t client = OpenRawClient();
+	ASSERT_NE(0, client);
+
+	// no descriptor left for accept
+	struct rlimit limit;
+	ASSERT_EQ(0, getrlimit(RLIMIT_NOFILE, &limit));
+	int freeFd = dup(0);
+	ASSERT_GE(freeFd, 0);
+	close(freeFd);
+	struct rlimit lowLimit = limit;
+	lowLimit.rlim_cur = (rlim_t)freeFd;
+	ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &lowLimit));
+	for (int i = 0; i < 10; i++)
+	{
+		server.Update(1);
+	}
+	size_t clientCount = server.ClientCount();
+	ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &limit));
+	EXPECT_EQ(0u, clientCount);
+
+	UpdateUntil(server, [&]() { return server.ClientCount() == 1; });
+	EXPECT_EQ(1u, server.ClientCount());
+	EXPECT_EQ(1, delegate.connected);
+	ISSocketClose(client);
+	server.Close();
+}
+
+// A client that keeps up but always has some data queued is not disconnected, only the age of the oldest queued write counts
+TEST(TcpServer, SlowClientDisconnectKeepsSteadyBacklog)
+{
+	cTcpServerTestDelegate delegate;
+	cISTcpServer server(&delegate);
+	ASSERT_EQ(0, server.Open("127.0.0.1", TCP_SERVER_TEST_PORT));
+	server.SetSlowClientPolicy(TCP_SERVER_SLOW_CLIENT_DISCONNECT, 16 * 1024 * 1024, 50);
+
+	// small socket buffers so the queue moves a few writes at a time instead of megabytes
+	int bufferSize = 8192;
+	socket_t client = OpenRawClient(bufferSize);
+	ASSERT_NE(0, client);
+	ISSocketSetBlocking(client, false);
+	UpdateUntil(server, [&]() { return server.ClientCount() == 1; });
+	ASSERT_EQ(1u, delegate.sockets.size());
+	setsockopt(delegate.sockets[0], SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+
+	// fill the socket buffers and queue a backlog
+	const size_t messageSize = 1000;
+	uint32_t n = 0;
+	for (; n < 100000 && server.QueuedSize(delegate.sockets[0]) < 32 * messageSize; n++)
+	{
+		WriteMessage(server, n, messageSize);
+	}
+	ASSERT_GE(server.QueuedSize(delegate.sockets[0]), 32 * messageSize);
+
+	// the client reads as fast as the server writes for several times the limit
+	uint8_t buf[messageSize];
+	uint64_t start = getTickCount();
+	for (int i = 0; getTickCount() - start < 300; i++, n++)
+	{
+		WriteMessage(server, n, messageSize);
+		server.Update(0);
+		ASSERT_EQ(1u, server.ClientCount());
+		for (int count = 0; count < (int)messageSize; )
+		{
+			int read = ISSocketRead(client, buf, (int)messageSize - count);
+			ASSERT_GE(read, 0);
+			count += read;
+			if (read == 0)
+			{
+				server.Update(0);
+			}
+		}
+		if (i % 10 == 0)
+		{
+			SLEEP_MS(1);
+		}
+	}
+	EXPECT_GT(server.QueuedSize(delegate.sockets[0]), 0u);
+	EXPECT_EQ(0, delegate.disconnected);
+	ISSocketClose(client);
+	server.Close();
+}
+
+#endif
+
+// Time of an update with one client sending stays flat as the number of connected clients grows.  Benchmark, not part
+// of the default run, use --gtest_also_run_disabled_tests --gtest_filter=*Benchmark
+TEST(TcpServer, DISABLED_UpdateLatencyBenchmark)
+{
+	cTcpServerTestDelegate delegate;
+	cISTcpServer server(&delegate);
+	ASSERT_EQ(0, server.Open("127.0.0.1", TCP_SERVER_TEST_PORT));
+
+	vector<unique_ptr<cISTcpClient>> clients;
+	const int clientCounts[] = { 1, 10, 100, 500 };
+	const int updates = 200;
+	double averageUs[4] = {};
+	size_t openFileLimit = RaiseOpenFileLimit();
+	int measured = 0;
+	for (int c = 0; c < 4; c++)
+	{
+		// each client uses a socket on both ends
+		if (2 * (size_t)clientCounts[c] + 64 > openFileLimit)
+		{
+			printf("%4d clients: skipped, open file limit %d\n", clientCounts[c], (int)openFileLimit);
+			break;
+		}
+		while ((int)clients.size() < clientCounts[c])
+		{
+			clients.push_back(unique_ptr<cISTcpClient>(new cISTcpClient()));
+			ASSERT_EQ(0, clients.back()->Open("127.0.0.1", TCP_SERVER_TEST_PORT));
+			server.Update(0);
+		}
+		UpdateUntil(server, [&]() { return (int)server.ClientCount() == clientCounts[c]; });
+		ASSERT_EQ(clientCounts[c], (int)server.ClientCount());
+
+		double totalUs = 0.0;
+		for (int i = 0; i < updates; i++)
+		{
+			size_t expected = delegate.bytesReceived + 8;
+			ASSERT_EQ(8, clients[(i * 7919) % clients.size()]->Write("$GPGGA,\n", 8));
+			while (delegate.bytesReceived < expected)
+			{
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+				server.Update(100);
+				totalUs += chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+			}
+		}
+		averageUs[c] = totalUs / updates;
+		printf("%4d clients: %8.1f us per update\n", clientCounts[c], averageUs[c]);
+		measured = c + 1;
+	}
+
+	// select per client took about 1 ms per idle client
+	ASSERT_GT(measured, 0);
+	EXPECT_LT(averageUs[measured - 1], 5000.0);
+	server.Close();
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <deque>
+#include <vector>
 #include "../com_manager.h"
 #include "../ring_buffer.h"
 #include "../protocol_nmea.h"
@@ -1002,3 +1003,314 @@ TEST(ComManager, Evb2DataForwardTest)
 }
 #endif
 
+
+typedef struct
+{
+	protocol_type_t			ptype;
+	uint32_t				rxErrorCount;
+	p_data_hdr_t			dataHdr;
+	std::vector<uint8_t>	data;
+} parse_event_t;
+
+// Parse stream using reads of chunkSize bytes and record every result returned by is_comm_parse()
+static std::vector<parse_event_t> parseStreamEvents(const std::vector<uint8_t> &stream, int chunkSize, int fastScan)
+{
+	std::vector<parse_event_t> events;
+	is_comm_instance_t		comm;
+	uint8_t					comm_buffer[PKT_BUF_SIZE] = { 0 };
+	is_comm_init(&comm, comm_buffer, sizeof(comm_buffer));
+	is_comm_enable_fast_scan(fastScan);
+
+	size_t pos = 0;
+	while (pos < stream.size())
+	{
+		int n = _MIN(is_comm_free(&comm), chunkSize);
+		n = _MIN(n, (int)(stream.size() - pos));
+		memcpy(comm.buf.tail, &stream[pos], n);
+		comm.buf.tail += n;
+		pos += n;
+
+		protocol_type_t ptype;
+		while ((ptype = is_comm_parse(&comm)) != _PTYPE_NONE)
+		{
+			parse_event_t ev = {};
+			ev.ptype = ptype;
+			ev.rxErrorCount = comm.rxErrorCount;
+			switch (ptype)
+			{
+			case _PTYPE_INERTIAL_SENSE_DATA:
+			case _PTYPE_ASCII_NMEA:
+			case _PTYPE_UBLOX:
+			case _PTYPE_RTCM3:
+				ev.dataHdr = comm.dataHdr;
+				ev.data.assign(comm.dataPtr, comm.dataPtr + comm.dataHdr.size);
+				break;
+			default:
+				break;
+			}
+			events.push_back(ev);
+		}
+	}
+
+	is_comm_enable_fast_scan(1);
+	return events;
+}
+
+
+#if 1
+TEST(ComManager, FastScanMatchesByteParserTest)
+{
+	// Build stream of all protocols with garbage and random noise mixed in
+	generateData(g_testRxDeque);
+
+	std::deque<data_holder_t> testRxDequeWithGarbage;
+	data_holder_t garbage = {};
+	garbage.ptype = _PTYPE_ASCII_NMEA;		// Raw bytes written as is
+	garbage.size = 24;
+	garbage.data.buf[1] = 128;
+	garbage.data.buf[19] = 128;
+	garbage.data.buf[23] = 128;
+
+	data_holder_t noise = {};
+	noise.ptype = _PTYPE_ASCII_NMEA;
+	noise.size = 300;
+	srand(1234);
+	for (uint32_t i = 0; i < noise.size; i++)
+	{
+		noise.data.buf[i] = (uint8_t)rand();
+	}
+
+	for (size_t i = 0; i < g_testRxDeque.size(); i++)
+	{
+		if (i % 5 == 0)
+		{
+			testRxDequeWithGarbage.push_back(garbage);
+		}
+		if (i % 7 == 0)
+		{
+			testRxDequeWithGarbage.push_back(noise);
+		}
+		testRxDequeWithGarbage.push_back(g_testRxDeque[i]);
+	}
+
+	ring_buf_t rbuf;
+	uint8_t rbuffer[2 * PORT_BUFFER_SIZE];
+	ringBufInit(&rbuf, rbuffer, sizeof(rbuffer), 1);
+	addDequeToRingBuf(testRxDequeWithGarbage, &rbuf);
+
+	std::vector<uint8_t> stream(ringBufUsed(&rbuf));
+	ringBufRead(&rbuf, stream.data(), (int)stream.size());
+	g_testRxDeque.clear();
+
+	int chunkSizes[] = { 1, 5, 17, 64, 333, PKT_BUF_SIZE };
+	for (int c = 0; c < (int)_ARRAY_ELEMENT_COUNT(chunkSizes); c++)
+	{
+		std::vector<parse_event_t> scalar = parseStreamEvents(stream, chunkSizes[c], 0);
+		std::vector<parse_event_t> fast = parseStreamEvents(stream, chunkSizes[c], 1);
+
+		ASSERT_EQ(scalar.size(), fast.size());
+		int dataCount = 0;
+		for (size_t i = 0; i < scalar.size(); i++)
+		{
+			EXPECT_EQ(scalar[i].ptype, fast[i].ptype);
+			EXPECT_EQ(scalar[i].rxErrorCount, fast[i].rxErrorCount);
+			EXPECT_EQ(scalar[i].dataHdr.id, fast[i].dataHdr.id);
+			EXPECT_EQ(scalar[i].dataHdr.size, fast[i].dataHdr.size);
+			EXPECT_EQ(scalar[i].dataHdr.offset, fast[i].dataHdr.offset);
+			EXPECT_TRUE(scalar[i].data == fast[i].data);
+			dataCount += (scalar[i].ptype != _PTYPE_PARSE_ERROR);
+		}
+
+		// Ensure the stream actually exercised the parser
+		EXPECT_GT(dataCount, 0);
+	}
+}
+#endif
+
+
+#if 1
+TEST(ComManager, DecodeEscapedBodyTest)
+{
+	// Body with every byte value, including long runs with and without special bytes
+	uint8_t body[MAX_DATASET_SIZE];
+	for (int i = 0; i < (int)sizeof(body); i++)
+	{
+		body[i] = (uint8_t)(i < 512 ? i : (i & 0x3F));
+	}
+
+	packet_hdr_t hdr = {};
+	hdr.pid = PID_DATA;
+	hdr.counter = 0xFD;
+	uint8_t encoded[PKT_BUF_SIZE];
+
+	for (int size = 1; size <= (int)sizeof(body); size += 37)
+	{
+		int n = is_encode_binary_packet(body, size, &hdr, 0, encoded, sizeof(encoded));
+		ASSERT_GT(n, 0);
+
+		// Decode in place
+		uint8_t work[PKT_BUF_SIZE];
+		memcpy(work, encoded, n);
+		packet_t pkt = {};
+		pkt.body.ptr = work;
+		ASSERT_EQ(0, is_decode_binary_packet(&pkt, work, n));
+		EXPECT_EQ(PID_DATA, pkt.hdr.pid);
+		EXPECT_EQ(0xFD, pkt.hdr.counter);
+		ASSERT_EQ((uint32_t)size, pkt.body.size);
+		EXPECT_TRUE(memcmp(body, pkt.body.ptr, size) == 0);
+
+		// Unescaped special byte in the body is corrupt data
+		if (n > 12)
+		{
+			memcpy(work, encoded, n);
+			work[n / 2] = PSC_ASCII_START_BYTE;
+			pkt.body.ptr = work;
+			EXPECT_NE(0, is_decode_binary_packet(&pkt, work, n));
+		}
+
+		// Checksum failure
+		memcpy(work, encoded, n);
+		work[4] = (work[4] == 0x11 ? 0x22 : 0x11);
+		pkt.body.ptr = work;
+		EXPECT_NE(0, is_decode_binary_packet(&pkt, work, n));
+	}
+}
+#endif
+
+
+// Byte at a time reference encoder for binary packets
+static int referenceEncodeBinaryPacket(const uint8_t* body, int bodySize, packet_hdr_t hdr, uint8_t* dst)
+{
+	uint8_t* ptr = dst;
+	uint32_t checksum = CHECKSUM_SEED;
+	uint8_t flags = hdr.flags | CPU_IS_LITTLE_ENDIAN | CM_PKT_FLAGS_CHECKSUM_24_BIT;
+	uint8_t hdrBytes[3] = { hdr.pid, hdr.counter, flags };
+	auto encodeByte = [&ptr](uint8_t c)
+	{
+		switch (c)
+		{
+		case PSC_ASCII_START_BYTE: case PSC_ASCII_END_BYTE: case PSC_START_BYTE: case PSC_END_BYTE:
+		case PSC_RESERVED_KEY: case UBLOX_START_BYTE1: case RTCM3_START_BYTE:
+			*ptr++ = PSC_RESERVED_KEY;
+			*ptr++ = (uint8_t)~c;
+			break;
+		default:
+			*ptr++ = c;
+		}
+	};
+
+	*ptr++ = PSC_START_BYTE;
+	for (int i = 0; i < 3; i++)
+	{
+		checksum ^= (uint32_t)hdrBytes[i] << (8 * i);
+		encodeByte(hdrBytes[i]);
+	}
+	for (int i = 0; i < bodySize; i++)
+	{
+		checksum ^= (uint32_t)body[i] << (8 * (i % 3));
+		encodeByte(body[i]);
+	}
+	encodeByte((uint8_t)(checksum >> 16));
+	encodeByte((uint8_t)(checksum >> 8));
+	encodeByte((uint8_t)checksum);
+	*ptr++ = PSC_END_BYTE;
+	return (int)(ptr - dst);
+}
+
+
+#if 1
+TEST(ComManager, EncodeScatterGatherTest)
+{
+	uint8_t body[MAX_PKT_BODY_SIZE];
+	srand(4321);
+	for (int i = 0; i < (int)sizeof(body); i++)
+	{	// Mostly plain runs with some special bytes
+		body[i] = (uint8_t)((i % 29 == 0) ? 0xFD : rand());
+	}
+
+	packet_hdr_t hdr = {};
+	hdr.pid = PID_DATA;
+	hdr.counter = 0x24;
+
+	uint8_t expected[PKT_BUF_SIZE];
+	uint8_t encoded[PKT_BUF_SIZE];
+	for (int size = 0; size <= (int)sizeof(body); size += 53)
+	{
+		int expectedSize = referenceEncodeBinaryPacket(body, size, hdr, expected);
+
+		int n = is_encode_binary_packet(body, size, &hdr, 0, encoded, sizeof(encoded));
+		ASSERT_EQ(expectedSize, n);
+		EXPECT_TRUE(memcmp(expected, encoded, n) == 0);
+
+		// Split body into two buffers at various points
+		for (int split = 0; split <= size; split += 11)
+		{
+			bufPtr_t bufs[2] = { { body, (uint32_t)split }, { body + split, (uint32_t)(size - split) } };
+			memset(encoded, 0, sizeof(encoded));
+			n = is_encode_binary_packet_sg(bufs, 2, &hdr, 0, encoded, sizeof(encoded));
+			ASSERT_EQ(expectedSize, n);
+			EXPECT_TRUE(memcmp(expected, encoded, n) == 0);
+		}
+
+		// Destination too small fails without overrun
+		if (expectedSize > MAX_PKT_OVERHEAD_SIZE + 2)
+		{
+			memset(encoded, 0xAB, sizeof(encoded));
+			EXPECT_LT(is_encode_binary_packet(body, size, &hdr, 0, encoded, expectedSize - 1), 0);
+			EXPECT_EQ(0xAB, encoded[expectedSize - 1]);
+		}
+	}
+}
+#endif
+
+
+static ins_1_t s_viewRxIns1;
+static ins_1_t s_viewRetainedIns1;
+static int s_viewCount;
+
+static void postRxReadView(CMHANDLE cmHandle, int pHandle, const p_data_view_t* view)
+{
+	s_viewCount++;
+	EXPECT_EQ(DID_INS_1, view->hdr.id);
+	EXPECT_EQ(sizeof(ins_1_t), view->hdr.size);
+	EXPECT_EQ(0, comManagerRetainData(&s_viewRetainedIns1, view, sizeof(s_viewRetainedIns1)));
+}
+
+#if 1
+TEST(ComManager, ZeroCopyRxViewTest)
+{
+	init(tcm);
+	memset(&s_viewRxIns1, 0, sizeof(s_viewRxIns1));
+	memset(&s_viewRetainedIns1, 0, sizeof(s_viewRetainedIns1));
+	s_viewCount = 0;
+	comManagerRegisterInstance(&(tcm.cm), DID_INS_1, 0, 0, 0, &s_viewRxIns1, sizeof(ins_1_t), 0);
+	comManagerSetRxViewCallbackInstance(&(tcm.cm), postRxReadView);
+
+	ins_1_t ins1 = {};
+	ins1.timeOfWeek = 123.456;
+	ins1.week = 2100;
+	ins1.lla[0] = 40.0;
+	ins1.lla[1] = -111.0;
+
+	uint8_t buf[PKT_BUF_SIZE];
+	is_comm_instance_t comm;
+	is_comm_init(&comm, buf, sizeof(buf));
+	int n = is_comm_data(&comm, DID_INS_1, 0, sizeof(ins_1_t), &ins1);
+	ASSERT_GT(n, 0);
+	ringBufWrite(&tcm.portRxBuf, buf, n);
+
+	// postRxRead() is replaced by the view callback and would fail on an empty deque
+	while (!ringBufEmpty(&tcm.portRxBuf))
+	{
+		comManagerStepInstance(&tcm.cm);
+	}
+
+	// Registered rx data is only written when retained by the view callback
+	EXPECT_EQ(1, s_viewCount);
+	EXPECT_EQ(0, s_viewRxIns1.week);
+	EXPECT_TRUE(memcmp(&ins1, &s_viewRetainedIns1, sizeof(ins_1_t)) == 0);
+
+	comManagerSetRxViewCallbackInstance(&(tcm.cm), NULL);
+	comManagerRegisterInstance(&(tcm.cm), DID_INS_1, 0, 0, 0, 0, 0, 0);
+}
+#endif
@@ -0,0 +1,36 @@
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../ISConstants.h"
+
+#if PLATFORM_IS_LINUX
+#include <sys/resource.h>
+#endif
+
+// Raise the open file limit as far as allowed and get the number of files that can be open
+inline size_t RaiseOpenFileLimit()
+{
+#if PLATFORM_IS_LINUX
+	struct rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+	{
+		return 1024;
+	}
+	if (limit.rlim_cur < limit.rlim_max)
+	{
+		rlim_t soft = limit.rlim_cur;
+		limit.rlim_cur = limit.rlim_max;
+		if (setrlimit(RLIMIT_NOFILE, &limit) != 0)
+		{
+			limit.rlim_cur = soft;
+		}
+	}
+	return (limit.rlim_cur == RLIM_INFINITY ? SIZE_MAX : (size_t)limit.rlim_cur);
+#else
+	return SIZE_MAX;
+#endif
+}
+
+#endif // TEST_HELPERS_H
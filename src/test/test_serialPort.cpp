@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include "../ISComm.h"
+#include "../ISUtilities.h"
+#include "../serialPortPlatform.h"
+
+#if PLATFORM_IS_LINUX
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace std;
+
+static double NowSeconds()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Pseudo terminal standing in for a device on a serial port, the port opens the slave end and the device writes the master
+struct sFakeDevice
+{
+	int master = -1;
+	string portName;
+
+	bool Open()
+	{
+		master = posix_openpt(O_RDWR | O_NOCTTY);
+		if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+		{
+			return false;
+		}
+		portName = ptsname(master);
+		return true;
+	}
+
+	~sFakeDevice()
+	{
+		if (master >= 0)
+		{
+			close(master);
+		}
+	}
+
+	void Write(const uint8_t* data, int count)
+	{
+		while (count > 0)
+		{
+			int n = (int)write(master, data, count);
+			if (n <= 0)
+			{
+				return;
+			}
+			data += n;
+			count -= n;
+		}
+	}
+
+	// DID_INS_1 stamped with the time it was sent
+	void WriteIns1(uint32_t sequence)
+	{
+		uint8_t buf[PKT_BUF_SIZE];
+		is_comm_instance_t comm;
+		is_comm_init(&comm, buf, sizeof(buf));
+		ins_1_t ins1 = {};
+		ins1.week = sequence;
+		ins1.timeOfWeek = NowSeconds();
+		int n = is_comm_data(&comm, DID_INS_1, 0, sizeof(ins_1_t), &ins1);
+		Write(buf, n);
+	}
+};
+
+// Read the port the way InertialSense does, one short read timeout per step, until count packets or a timeout
+static void ReadIns1(serial_port_t* port, uint32_t count, vector<uint32_t>& sequences, vector<double>* latenciesUs)
+{
+	uint8_t buf[PKT_BUF_SIZE];
+	is_comm_instance_t comm;
+	is_comm_init(&comm, buf, sizeof(buf));
+	double timeout = NowSeconds() + 10.0;
+	while (sequences.size() < count && NowSeconds() < timeout)
+	{
+		int n = serialPortReadTimeout(port, comm.buf.tail, is_comm_free(&comm), 1);
+		if (n <= 0)
+		{
+			continue;
+		}
+		comm.buf.tail += n;
+		double now = NowSeconds();
+		while (is_comm_parse(&comm) != _PTYPE_NONE)
+		{
+			if (comm.dataHdr.id == DID_INS_1)
+			{
+				ins_1_t* ins1 = (ins_1_t*)comm.dataPtr;
+				sequences.push_back(ins1->week);
+				if (latenciesUs != NULLPTR)
+				{
+					latenciesUs->push_back((now - ins1->timeOfWeek) * 1.0e6);
+				}
+			}
+		}
+	}
+}
+
+TEST(SerialPort, ReadThreadDeliversEverythingInOrder)
+{
+	sFakeDevice device;
+	ASSERT_TRUE(device.Open());
+	serial_port_t port;
+	serialPortPlatformInit(&port);
+	ASSERT_EQ(1, serialPortOpen(&port, device.portName.c_str(), 921600, 0));
+	ASSERT_EQ(1, serialPortStartReadThread(&port, 64, 1, 1));
+
+	// more than the reader ring holds, written while the port is not being read
+	const uint32_t count = 2000;
+	thread writer([&]()
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			device.WriteIns1(i);
+		}
+	});
+	SLEEP_MS(50);
+	vector<uint32_t> sequences;
+	ReadIns1(&port, count, sequences, NULLPTR);
+	writer.join();
+
+	ASSERT_EQ(count, sequences.size());
+	for (uint32_t i = 0; i < count; i++)
+	{
+		ASSERT_EQ(i, sequences[i]);
+	}
+
+	// a read with nothing queued waits no longer than its timeout
+	uint8_t buf[16];
+	double start = NowSeconds();
+	EXPECT_EQ(0, serialPortReadTimeout(&port, buf, sizeof(buf), 20));
+	EXPECT_LT(NowSeconds() - start, 1.0);
+
+	// flush drops queued data
+	device.WriteIns1(0);
+	for (int i = 0; i < 1000 && serialPortGetByteCountAvailableToRead(&port) == 0; i++)
+	{
+		SLEEP_MS(1);
+	}
+	EXPECT_GT(serialPortGetByteCountAvailableToRead(&port), 0);
+	serialPortFlush(&port);
+	EXPECT_EQ(0, serialPortReadTimeout(&port, buf, sizeof(buf), 0));
+
+	// close stops the thread while it is blocked in read
+	EXPECT_EQ(1, serialPortClose(&port));
+}
+
+// Time from the device sending a packet to it being parsed, polling the port compared to the reader thread.  Benchmark,
+// not part of the default run, use --gtest_also_run_disabled_tests --gtest_filter=*Benchmark
+TEST(SerialPort, DISABLED_ReadLatencyBenchmark)
+{
+	double p50Us[2], p99Us[2];
+	for (int readThread = 0; readThread < 2; readThread++)
+	{
+		sFakeDevice device;
+		ASSERT_TRUE(device.Open());
+		serial_port_t port;
+		serialPortPlatformInit(&port);
+		ASSERT_EQ(1, serialPortOpen(&port, device.portName.c_str(), 921600, 0));
+		if (readThread)
+		{
+			ASSERT_EQ(1, serialPortStartReadThread(&port, 1, 0, 1));
+		}
+
+		const uint32_t count = 500;
+		thread writer([&]()
+		{
+			for (uint32_t i = 0; i < count; i++)
+			{
+				device.WriteIns1(i);
+				this_thread::sleep_for(chrono::microseconds(2000 + (i * 7919) % 1000));
+			}
+		});
+		vector<uint32_t> sequences;
+		vector<double> latenciesUs;
+		ReadIns1(&port, count, sequences, &latenciesUs);
+		writer.join();
+		serialPortClose(&port);
+
+		ASSERT_EQ(count, latenciesUs.size());
+		sort(latenciesUs.begin(), latenciesUs.end());
+		p50Us[readThread] = latenciesUs[count / 2];
+		p99Us[readThread] = latenciesUs[count * 99 / 100];
+		printf("%s: latency p50 %8.1f us, p90 %8.1f us, p99 %8.1f us, max %8.1f us\n", (readThread ? "read thread" : "polled     "),
+			p50Us[readThread], latenciesUs[count * 9 / 10], p99Us[readThread], latenciesUs.back());
+	}
+
+	// polling waits out the read timeout for any packet smaller than the read buffer
+	EXPECT_LT(p50Us[1], p50Us[0]);
+}
+
+#endif